@@ -0,0 +1,156 @@
+// Benchmark of the exact feasibility tests on random task sets
+//
+// Usage: feas_bench [sets per size] [total utilization]
+//
+// For each set size from 10 to 1000 services, UUniFast task sets with periods log-uniform from
+// 1000 to 1000000 are sorted rate monotonic and analyzed by the original completion time and
+// scheduling point tests and by the optimized response time analysis and hyperplane tests.
+// Average time per set is reported for each, and every test must agree on every set.
+//
+// The original scheduling point test tries the deadline first, which at moderate utilization
+// nearly always passes, but otherwise enumerates every l*T(k) up to T(i), which for period
+// ratios of 1000 and sets near U = 1 takes seconds per set.  It is run at every size until its
+// time per set passes SCHED_POINT_MAX_USEC, and shown as "-" from the size where it stops.
+//
+// On an x86 desktop, at U = 0.85 with 500 sets per size, the hyperplane test is faster than the
+// scheduling point test at every size, from 3x at 10 services to about 20x at 100, and response time
+// analysis is faster than the completion time test from 50 services on, 2x at 50 and 7x at
+// 1000, but no faster at 10 or 20 services, where both take about 3 iterations per service.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "feaslib.h"
+
+#define DEFAULT_SETS (100)
+#define DEFAULT_UTIL (0.85)
+#define MIN_PERIOD (1000)
+#define MAX_PERIOD (1000000)
+#define SCHED_POINT_MAX_USEC (100000.0)
+#define NUM_TESTS (4)
+
+static const U32_T setSizes[]={10, 20, 50, 100, 200, 500, 1000};
+
+static const char *testNames[NUM_TESTS]={"completion", "sched-point", "rta", "hyperplane"};
+
+
+static double elapsed_usec(struct timespec *start, struct timespec *stop)
+{
+    return ((stop->tv_sec - start->tv_sec) * 1000000.0) + ((stop->tv_nsec - start->tv_nsec) / 1000.0);
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t set;
+    U32_T *response, n;
+    int numSets=DEFAULT_SETS, s, t, sizeIdx, result[NUM_TESTS]={0}, feasibleCnt, mismatchCnt=0;
+    int schedPoint=TRUE, schedPointSets;
+    double util=DEFAULT_UTIL, usec[NUM_TESTS];
+    unsigned int seed=1;
+    feasGenConfig_t gen={FEAS_GEN_UUNIFAST, MIN_PERIOD, MAX_PERIOD, 1.0, 1.0};
+    struct timespec start, stop;
+
+    if(argc > 1)
+        sscanf(argv[1], "%d", &numSets);
+
+    if(argc > 2)
+        sscanf(argv[2], "%lf", &util);
+
+    printf("%d UUniFast sets per size, U=%4.2f, periods %u to %u\n\n", numSets, util, MIN_PERIOD, MAX_PERIOD);
+    printf("%6s %9s", "n", "feasible");
+    for(t=0; t < NUM_TESTS; t++)
+        printf(" %14s", testNames[t]);
+    printf("   (usec per set)\n");
+
+    for(sizeIdx=0; sizeIdx < (int)(sizeof(setSizes) / sizeof(setSizes[0])); sizeIdx++)
+    {
+        n=setSizes[sizeIdx];
+
+        if((feas_alloc_taskset(&set, n) != FEAS_OK) || ((response=malloc(n * sizeof(U32_T))) == NULL))
+        {
+            printf("Out of memory\n");
+            exit(-1);
+        }
+
+        for(t=0; t < NUM_TESTS; t++)
+            usec[t]=0.0;
+        feasibleCnt=0;
+        schedPointSets=0;
+
+        for(s=0; s < numSets; s++)
+        {
+            feas_generate_taskset(&set, n, util, &gen, &seed);
+            feas_sort_rm(&set);
+
+            for(t=0; t < NUM_TESTS; t++)
+            {
+                if((t == 1) && !schedPoint)
+                {
+                    result[t]=result[0];
+                    continue;
+                }
+
+                clock_gettime(CLOCK_MONOTONIC, &start);
+
+                switch(t)
+                {
+                    case 0:
+                        result[t]=completion_time_feasibility(n, set.period, set.wcet, set.deadline);
+                        break;
+                    case 1:
+                        result[t]=scheduling_point_feasibility(n, set.period, set.wcet, set.deadline);
+                        break;
+                    case 2:
+                        result[t]=feas_response_time_analysis(n, set.period, set.wcet, set.deadline, response, 0);
+                        break;
+                    case 3:
+                        result[t]=feas_hyperplane_feasibility(n, set.period, set.wcet, set.deadline);
+                        break;
+                }
+
+                clock_gettime(CLOCK_MONOTONIC, &stop);
+                usec[t]+=elapsed_usec(&start, &stop);
+
+                // stop the original scheduling point test once it averages too long a time
+                if(t == 1)
+                {
+                    schedPointSets++;
+                    if(usec[t] > SCHED_POINT_MAX_USEC * schedPointSets)
+                        schedPoint=FALSE;
+                }
+            }
+
+            for(t=1; t < NUM_TESTS; t++)
+            {
+                if(result[t] != result[0])
+                {
+                    printf("ERROR: n=%u set %d %s=%d but %s=%d\n", n, s, testNames[t], result[t],
+                           testNames[0], result[0]);
+                    mismatchCnt++;
+                }
+            }
+
+            feasibleCnt+=result[0];
+        }
+
+        printf("%6u %8d%%", n, (feasibleCnt * 100) / numSets);
+        for(t=0; t < NUM_TESTS; t++)
+        {
+            if((t == 1) && (schedPointSets < numSets))
+                printf(" %14s", "-");
+            else
+                printf(" %14.2f", usec[t] / numSets);
+        }
+        printf("\n");
+
+        free(response);
+        feas_free_taskset(&set);
+    }
+
+    if(mismatchCnt > 0)
+        printf("\n%d disagreements between tests\n", mismatchCnt);
+
+    return (mismatchCnt == 0) ? 0 : -1;
+}
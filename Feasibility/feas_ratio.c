@@ -0,0 +1,334 @@
+// Schedulability ratio of every feasibility test against utilization
+//
+// Usage: feas_ratio [-n services] [-s sets per point] [-u min:max:step] [-g uunifast|randfixedsum]
+//                   [-m max U per service] [-d min D/T] [-t threads] [-r seed] [-o ratio.csv] [-p ratio.gp]
+//
+// For each total utilization from min to max, sets of random services are generated by feasgen.c
+// and every test is run on every set.  The fraction of sets each test accepts is printed as one
+// CSV line per utilization, to stdout or the -o file:
+//
+//   U,sets,rm_lub,rmst,rbound,rm_exact,hyperplane,dm,edf
+//
+// which shows the pessimism of the utilization bounds against the exact RM test, and of RM
+// against DM and EDF.  With -p a gnuplot script is written as well, so the ratios can be
+// plotted with "gnuplot ratio.gp", which makes ratio.png.
+//
+// The sets are spread over -t threads (default one per core), each taking chunks of sets from a
+// shared counter.  Each set is generated from its own seed, made from -r and the set number, so
+// the results do not depend on the number of threads.  A 100k set sweep, e.g.
+//
+//   ./feas_ratio -n 10 -s 5000 -u 0.5:1.0:0.025 -o ratio.csv -p ratio.gp
+//
+// takes seconds on a 4 core machine.  The two exact RM tests must agree, so any disagreement
+// is reported as an error.  With -g randfixedsum, -m caps the utilization of each service
+// (default 1.0), and the total must be at most n times the cap.  With -d below 1 the deadlines
+// are constrained: rm_lub is then applied to the densities C/min(D,T), and rmst and rbound,
+// which assume D = T, accept no set with any D < T.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/sysinfo.h>
+
+#include "feaslib.h"
+
+#define DEFAULT_SERVICES (10)
+#define DEFAULT_SETS (1000)
+#define DEFAULT_UMIN (0.5)
+#define DEFAULT_UMAX (1.0)
+#define DEFAULT_USTEP (0.025)
+#define MIN_PERIOD (1000)
+#define MAX_PERIOD (1000000)
+
+// sets taken from the shared counter at a time
+#define CHUNK_SETS (64)
+
+#define NUM_TESTS (7)
+
+static const char *testNames[NUM_TESTS]={"rm_lub", "rmst", "rbound", "rm_exact", "hyperplane", "dm", "edf"};
+
+typedef struct
+{
+    U32_T numServices;
+    unsigned long long setsPerPoint;
+    U32_T numPoints;
+    double umin, ustep;
+    unsigned int seed;
+    feasGenConfig_t gen;
+    volatile unsigned long long nextSet;    // next set to hand out, over all points
+} ratioConfig_t;
+
+typedef struct
+{
+    pthread_t thread;
+    ratioConfig_t *cfg;
+    unsigned long long *accepted;   // numPoints x NUM_TESTS
+    unsigned long long mismatches;
+    int rc;
+} ratioWorker_t;
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s [-n services] [-s sets per point] [-u min:max:step] [-g uunifast|randfixedsum]\n"
+           "       [-m max U per service] [-d min D/T] [-t threads] [-r seed] [-o ratio.csv] [-p ratio.gp]\n", prog);
+}
+
+
+// Run every test on one set, which is reordered, and count the ones that accept it
+static void ratio_test_set(taskSet_t *set, U32_T response[], unsigned long long accepted[],
+                           unsigned long long *mismatches)
+{
+    U32_T n=set->numServices;
+    int result[NUM_TESTS], t, constrained;
+
+    result[0]=rate_monotonic_least_upper_bound(n, set->period, set->wcet, set->deadline);
+    constrained=feas_constrained_deadlines(n, set->period, set->deadline);
+    result[1]=constrained ? FALSE : feas_rmst_test(n, set->period, set->wcet);
+    result[2]=constrained ? FALSE : feas_rbound_test(n, set->period, set->wcet);
+    result[6]=feas_edf_qpa_feasibility(n, set->period, set->wcet, set->deadline);
+
+    feas_sort_rm(set);
+    result[3]=feas_response_time_analysis(n, set->period, set->wcet, set->deadline, response, 0);
+    result[4]=feas_hyperplane_feasibility(n, set->period, set->wcet, set->deadline);
+
+    feas_sort_dm(set);
+    result[5]=feas_response_time_analysis(n, set->period, set->wcet, set->deadline, response, 0);
+
+    if(result[3] != result[4])
+        (*mismatches)++;
+
+    for(t=0; t < NUM_TESTS; t++)
+        accepted[t]+=(result[t] == TRUE);
+}
+
+
+static void *ratio_worker(void *threadp)
+{
+    ratioWorker_t *worker=(ratioWorker_t *)threadp;
+    ratioConfig_t *cfg=worker->cfg;
+    unsigned long long total=cfg->setsPerPoint * cfg->numPoints, first, last, i, point;
+    unsigned int seed;
+    taskSet_t set;
+    U32_T *response;
+
+    if((feas_alloc_taskset(&set, cfg->numServices) != FEAS_OK) ||
+       ((response=malloc((cfg->numServices + 1) * sizeof(U32_T))) == NULL))
+    {
+        worker->rc=FEAS_ERROR;
+        return NULL;
+    }
+
+    while((first=__atomic_fetch_add(&cfg->nextSet, CHUNK_SETS, __ATOMIC_RELAXED)) < total)
+    {
+        last=(first + CHUNK_SETS < total) ? (first + CHUNK_SETS) : total;
+
+        for(i=first; i < last; i++)
+        {
+            point=i / cfg->setsPerPoint;
+
+            // a seed per set, mixed so that neighbouring sets do not get similar rand_r sequences
+            seed=(unsigned int)((i + 1) * 2654435761ULL) ^ (cfg->seed * 40503U);
+
+            if(feas_generate_taskset(&set, cfg->numServices, cfg->umin + (point * cfg->ustep), &cfg->gen, &seed) != FEAS_OK)
+            {
+                worker->rc=FEAS_ERROR;
+                continue;
+            }
+
+            ratio_test_set(&set, response, &worker->accepted[point * NUM_TESTS], &worker->mismatches);
+        }
+    }
+
+    free(response);
+    feas_free_taskset(&set);
+    return NULL;
+}
+
+
+static void write_plot(const char *plotFile, const char *csvFile, ratioConfig_t *cfg)
+{
+    FILE *fp;
+    int t;
+
+    if((fp=fopen(plotFile, "w")) == NULL)
+    {
+        perror(plotFile);
+        return;
+    }
+
+    fprintf(fp, "# schedulability ratio of %llu sets of %u services per point, plot with gnuplot %s\n",
+            cfg->setsPerPoint, cfg->numServices, plotFile);
+    fprintf(fp, "set datafile separator ','\n");
+    fprintf(fp, "set terminal png size 900,600\n");
+    fprintf(fp, "set output 'ratio.png'\n");
+    fprintf(fp, "set xlabel 'total utilization'\n");
+    fprintf(fp, "set ylabel 'schedulability ratio'\n");
+    fprintf(fp, "set yrange [0:1.05]\n");
+    fprintf(fp, "set key bottom left\n");
+    fprintf(fp, "set grid\n");
+    fprintf(fp, "plot ");
+
+    for(t=0; t < NUM_TESTS; t++)
+        fprintf(fp, "'%s' using 1:%d skip 1 with linespoints title '%s'%s", csvFile, t + 3, testNames[t],
+                (t < NUM_TESTS - 1) ? ", \\\n     " : "\n");
+
+    fclose(fp);
+}
+
+
+int main(int argc, char *argv[])
+{
+    ratioConfig_t cfg;
+    ratioWorker_t *workers;
+    unsigned long long *accepted, mismatches=0;
+    double umax=DEFAULT_UMAX, sec;
+    int numThreads=get_nprocs(), i, t, rc=0;
+    U32_T p;
+    char *outFile=NULL, *plotFile=NULL;
+    const char *badArgs=NULL;
+    FILE *out=stdout;
+    struct timespec start, stop;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.numServices=DEFAULT_SERVICES;
+    cfg.setsPerPoint=DEFAULT_SETS;
+    cfg.umin=DEFAULT_UMIN;
+    cfg.ustep=DEFAULT_USTEP;
+    cfg.seed=1;
+    cfg.gen.method=FEAS_GEN_UUNIFAST;
+    cfg.gen.minPeriod=MIN_PERIOD;
+    cfg.gen.maxPeriod=MAX_PERIOD;
+    cfg.gen.maxUtil=1.0;
+    cfg.gen.minDeadlineRatio=1.0;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-n") == 0) && (i + 1 < argc))
+            cfg.numServices=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            cfg.setsPerPoint=strtoull(argv[++i], NULL, 10);
+        else if((strcmp(argv[i], "-u") == 0) && (i + 1 < argc))
+            sscanf(argv[++i], "%lf:%lf:%lf", &cfg.umin, &umax, &cfg.ustep);
+        else if((strcmp(argv[i], "-g") == 0) && (i + 1 < argc))
+            cfg.gen.method=(strcmp(argv[++i], "randfixedsum") == 0) ? FEAS_GEN_RANDFIXEDSUM : FEAS_GEN_UUNIFAST;
+        else if((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+            cfg.gen.maxUtil=atof(argv[++i]);
+        else if((strcmp(argv[i], "-d") == 0) && (i + 1 < argc))
+            cfg.gen.minDeadlineRatio=atof(argv[++i]);
+        else if((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+            numThreads=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-r") == 0) && (i + 1 < argc))
+            cfg.seed=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+            outFile=argv[++i];
+        else if((strcmp(argv[i], "-p") == 0) && (i + 1 < argc))
+            plotFile=argv[++i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if((cfg.numServices == 0) || (cfg.setsPerPoint == 0))
+        badArgs="-n and -s must be at least 1";
+    else if((cfg.ustep <= 0.0) || (umax < cfg.umin))
+        badArgs="-u needs min no more than max and a step above 0";
+    else if(numThreads < 1)
+        badArgs="-t must be at least 1";
+    else if((plotFile != NULL) && (outFile == NULL))
+        badArgs="-p needs the -o file for the plot to read";
+    else if((cfg.gen.maxUtil <= 0.0) || (cfg.gen.maxUtil > 1.0) ||
+            ((cfg.gen.method == FEAS_GEN_RANDFIXEDSUM) && (umax > (cfg.numServices * cfg.gen.maxUtil))))
+        badArgs="-m must be in (0, 1] and at least U max / services";
+
+    if(badArgs != NULL)
+    {
+        usage(argv[0]);
+        printf("%s\n", badArgs);
+        exit(-1);
+    }
+
+    // half a step of slack so that rounding does not drop the last point
+    cfg.numPoints=(U32_T)(((umax - cfg.umin) / cfg.ustep) + 1.5);
+
+    workers=calloc(numThreads, sizeof(ratioWorker_t));
+    accepted=calloc((size_t)numThreads * cfg.numPoints * NUM_TESTS, sizeof(unsigned long long));
+    if((workers == NULL) || (accepted == NULL))
+    {
+        printf("Out of memory\n");
+        exit(-1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(t=0; t < numThreads; t++)
+    {
+        workers[t].cfg=&cfg;
+        workers[t].accepted=&accepted[(size_t)t * cfg.numPoints * NUM_TESTS];
+
+        if(pthread_create(&workers[t].thread, NULL, ratio_worker, &workers[t]) != 0)
+        {
+            perror("pthread_create");
+            exit(-1);
+        }
+    }
+
+    for(t=0; t < numThreads; t++)
+    {
+        pthread_join(workers[t].thread, NULL);
+        mismatches+=workers[t].mismatches;
+        if(workers[t].rc != FEAS_OK) rc=-1;
+
+        // fold each worker's counts into the first
+        if(t > 0)
+            for(p=0; p < cfg.numPoints * NUM_TESTS; p++)
+                accepted[p]+=workers[t].accepted[p];
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    sec=(stop.tv_sec - start.tv_sec) + ((stop.tv_nsec - start.tv_nsec) / 1000000000.0);
+
+    if((outFile != NULL) && ((out=fopen(outFile, "w")) == NULL))
+    {
+        perror(outFile);
+        exit(-1);
+    }
+
+    fprintf(out, "U,sets");
+    for(t=0; t < NUM_TESTS; t++)
+        fprintf(out, ",%s", testNames[t]);
+    fprintf(out, "\n");
+
+    for(p=0; p < cfg.numPoints; p++)
+    {
+        fprintf(out, "%.4f,%llu", cfg.umin + (p * cfg.ustep), cfg.setsPerPoint);
+        for(t=0; t < NUM_TESTS; t++)
+            fprintf(out, ",%.4f", (double)accepted[(p * NUM_TESTS) + t] / (double)cfg.setsPerPoint);
+        fprintf(out, "\n");
+    }
+
+    if(out != stdout)
+        fclose(out);
+
+    if(plotFile != NULL)
+        write_plot(plotFile, outFile, &cfg);
+
+    printf("%llu %s sets of %u services in %.3f sec on %d threads (%.0f sets per sec)\n",
+           cfg.setsPerPoint * cfg.numPoints, (cfg.gen.method == FEAS_GEN_RANDFIXEDSUM) ? "RandFixedSum" : "UUniFast",
+           cfg.numServices, sec, numThreads, (sec > 0.0) ? ((cfg.setsPerPoint * cfg.numPoints) / sec) : 0.0);
+
+    if(mismatches > 0)
+    {
+        printf("ERROR: %llu sets where the RTA and hyperplane tests disagree\n", mismatches);
+        rc=-1;
+    }
+
+    free(accepted);
+    free(workers);
+
+    return rc;
+}
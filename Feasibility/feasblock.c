@@ -0,0 +1,436 @@
+// Blocking terms for services that share resources
+//
+// The pthread3 examples in example-synch show a low priority service holding a mutex while a
+// middle priority service preempts it, so the high priority service waiting on the mutex is
+// blocked for as long as the middle one runs.  With PTHREAD_PRIO_INHERIT (pthread3ok) that
+// blocking is bounded, and this file computes the bound, B, so it can be added to the response
+// time of each service:
+//
+//   R(i) = C(i) + B(i) + sum over j of higher priority of ceil(R(i)/T(j)) * C(j)
+//
+// A lower priority critical section can only block service i if its resource is used by i or
+// by a service of higher priority than i, i.e. the priority ceiling of the resource is at
+// least the priority of i.  Of those critical sections:
+//
+// 1) PIP - i can be blocked once by each lower priority service and once on each resource, so
+//    B(i) is the smaller of the sum over lower priority services of their longest critical
+//    section, and the sum over resources of their longest lower priority critical section.
+// 2) PCP - i can be blocked by at most one lower priority critical section, the longest.
+// 3) SRP - as PCP, with preemption levels ranked by deadline, which bounds blocking under EDF.
+//
+// Sha, Lui, Ragunathan Rajkumar, and John P. Lehoczky. "Priority inheritance protocols: An
+// approach to real-time synchronization." IEEE Transactions on Computers 39.9 (1990): 1175-1185.
+//
+// Baker, Theodore P. "Stack-based scheduling of realtime processes." Real-Time Systems 3.1
+// (1991): 67-99.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "feaslib.h"
+
+#define CEIL_DIV(a, b) (((a) + (b) - 1) / (b))
+
+#define LINE_LEN (1024)
+#define INITIAL_RESOURCE_SETS (8)
+
+
+// Longest critical section of service s on resource r, 0 if it does not use r
+static U32_T feas_cs(feasResources_t *res, U32_T s, U32_T r)
+{
+    if((res == NULL) || (s >= res->numServices))
+        return 0;
+
+    return res->csLength[(s * FEAS_MAX_RESOURCES) + r];
+}
+
+
+// Find or add the resources of the named set
+static feasResources_t *feas_resource_set(feasResources_t **res, int *numRes, int *maxRes, const char *name)
+{
+    feasResources_t *set;
+    int i;
+
+    for(i=0; i < *numRes; i++)
+        if(strcmp((*res)[i].name, name) == 0)
+            return &(*res)[i];
+
+    if(*numRes == *maxRes)
+    {
+        *maxRes=(*maxRes == 0) ? INITIAL_RESOURCE_SETS : (*maxRes * 2);
+        *res=realloc(*res, *maxRes * sizeof(feasResources_t));
+        if(*res == NULL) return NULL;
+    }
+
+    set=&(*res)[*numRes];
+    memset(set, 0, sizeof(feasResources_t));
+    strncpy(set->name, name, FEAS_NAME_LEN-1);
+    (*numRes)++;
+
+    return set;
+}
+
+
+// Find or add a resource by name, returns its index or FEAS_ERROR if there are too many
+static int feas_resource_index(feasResources_t *set, const char *name)
+{
+    U32_T r;
+
+    for(r=0; r < set->numResources; r++)
+        if(strcmp(set->resource[r], name) == 0)
+            return r;
+
+    if(set->numResources == FEAS_MAX_RESOURCES)
+        return FEAS_ERROR;
+
+    strncpy(set->resource[r], name, FEAS_NAME_LEN-1);
+    set->resource[r][FEAS_NAME_LEN-1]='\0';
+    set->numResources++;
+
+    return r;
+}
+
+
+// Grow the critical section table to hold service s, with zeros for the new rows
+static int feas_resource_rows(feasResources_t *set, U32_T s)
+{
+    U32_T *rows;
+
+    if(s < set->numServices)
+        return FEAS_OK;
+
+    if((rows=realloc(set->csLength, (s + 1) * FEAS_MAX_RESOURCES * sizeof(U32_T))) == NULL)
+        return FEAS_ERROR;
+
+    memset(&rows[set->numServices * FEAS_MAX_RESOURCES], 0,
+           (s + 1 - set->numServices) * FEAS_MAX_RESOURCES * sizeof(U32_T));
+
+    set->csLength=rows;
+    set->numServices=s + 1;
+
+    return FEAS_OK;
+}
+
+
+int feas_load_resources(const char *fileName, feasResources_t **res, int *numRes)
+{
+    FILE *fp;
+    char line[LINE_LEN], *setName, *service, *resource, *length, *end;
+    unsigned long s, len;
+    int maxRes=0, lineNum=0, dataLines=0, r;
+    feasResources_t *set;
+
+    *res=NULL; *numRes=0;
+
+    if((fp=fopen(fileName, "r")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    while(fgets(line, LINE_LEN, fp) != NULL)
+    {
+        lineNum++;
+
+        if((line[0] == '#') || (line[0] == '\n') || (line[0] == '\r'))
+            continue;
+
+        dataLines++;
+
+        setName=strtok(line, ",");
+        service=strtok(NULL, ",");
+        resource=strtok(NULL, ",");
+        length=strtok(NULL, ",\r\n");
+
+        if((setName == NULL) || (service == NULL) || (resource == NULL) || (length == NULL))
+        {
+            printf("%s:%d: expected set,service,resource,length\n", fileName, lineNum);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        while(isspace((unsigned char)*setName)) setName++;
+        while(isspace((unsigned char)*resource)) resource++;
+
+        s=strtoul(service, &end, 10);
+        if(end == service)
+        {
+            // a header line, otherwise a format error
+            if(dataLines == 1) continue;
+
+            printf("%s:%d: service must be the index of the service in its set\n", fileName, lineNum);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        len=strtoul(length, &end, 10);
+        if(end == length)
+        {
+            printf("%s:%d: critical section length must be a number\n", fileName, lineNum);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        if(((set=feas_resource_set(res, numRes, &maxRes, setName)) == NULL) ||
+           (feas_resource_rows(set, s) != FEAS_OK))
+        {
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        if((r=feas_resource_index(set, resource)) == FEAS_ERROR)
+        {
+            printf("%s:%d: more than %d resources in set %s\n", fileName, lineNum, FEAS_MAX_RESOURCES, set->name);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        // a service may enter the same resource more than once, only the longest matters
+        if(len > set->csLength[(s * FEAS_MAX_RESOURCES) + r])
+            set->csLength[(s * FEAS_MAX_RESOURCES) + r]=len;
+    }
+
+    fclose(fp);
+    return FEAS_OK;
+}
+
+
+void feas_free_resources(feasResources_t *res, int numRes)
+{
+    int i;
+
+    for(i=0; i < numRes; i++)
+        free(res[i].csLength);
+
+    free(res);
+}
+
+
+feasResources_t *feas_find_resources(feasResources_t *res, int numRes, const char *setName)
+{
+    int i;
+
+    for(i=0; i < numRes; i++)
+        if(strcmp(res[i].name, setName) == 0)
+            return &res[i];
+
+    return NULL;
+}
+
+
+// Priority rank of each service, 0 for the highest, by period or by deadline with ties in
+// file order, which is the order feas_sort_rm and feas_sort_dm would put them in
+static void feas_rank(taskSet_t *set, int byDeadline, U32_T rank[])
+{
+    U32_T *key=byDeadline ? set->deadline : set->period;
+    U32_T i, j;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        rank[i]=0;
+
+        for(j=0; j < set->numServices; j++)
+            if((key[j] < key[i]) || ((key[j] == key[i]) && (j < i)))
+                rank[i]++;
+    }
+}
+
+
+int feas_blocking(taskSet_t *set, feasResources_t *res, feasBlockProtocol_t protocol, int byDeadline,
+                  feasBlocking_t block[])
+{
+    U32_T n=set->numServices, ceiling[FEAS_MAX_RESOURCES], *rank;
+    U32_T i, j, r, numResources, cs, longest, longestRes, sumServices, sumResources;
+    int servicesRes, servicesBlocker, resourcesRes, resourcesBlocker, longestBlocker;
+    U32_T servicesTerm, resourcesTerm;
+
+    if((res != NULL) && (res->numServices > n))
+    {
+        printf("%s: resources given for service %u, but the set has %u services\n", set->name,
+               res->numServices - 1, n);
+        return FEAS_ERROR;
+    }
+
+    if((rank=malloc((n + 1) * sizeof(U32_T))) == NULL)
+        return FEAS_ERROR;
+
+    // SRP preemption levels are always by deadline
+    feas_rank(set, byDeadline || (protocol == FEAS_BLOCK_SRP), rank);
+
+    // the ceiling of each resource is the highest priority, lowest rank, of its users
+    numResources=(res == NULL) ? 0 : res->numResources;
+    for(r=0; r < numResources; r++)
+    {
+        ceiling[r]=n;
+        for(j=0; j < n; j++)
+            if((feas_cs(res, j, r) > 0) && (rank[j] < ceiling[r]))
+                ceiling[r]=rank[j];
+    }
+
+    for(i=0; i < n; i++)
+    {
+        block[i].blocking=0;
+        block[i].resource=FEAS_RESOURCE_NONE;
+        block[i].blocker=FEAS_RESOURCE_NONE;
+
+        // one blocking term per lower priority service, the longest of its critical sections
+        // on resources that can block service i, which is also the PCP and SRP blocking
+        sumServices=0; servicesTerm=0; servicesRes=FEAS_RESOURCE_NONE; servicesBlocker=FEAS_RESOURCE_NONE;
+
+        for(j=0; j < n; j++)
+        {
+            if(rank[j] <= rank[i])
+                continue;
+
+            longest=0; longestRes=0;
+            for(r=0; r < numResources; r++)
+            {
+                cs=feas_cs(res, j, r);
+                if((ceiling[r] <= rank[i]) && (cs > longest))
+                {
+                    longest=cs;
+                    longestRes=r;
+                }
+            }
+
+            sumServices+=longest;
+            if(longest > servicesTerm)
+            {
+                servicesTerm=longest;
+                servicesRes=longestRes;
+                servicesBlocker=j;
+            }
+        }
+
+        if(protocol != FEAS_BLOCK_PIP)
+        {
+            block[i].blocking=servicesTerm;
+            block[i].resource=servicesRes;
+            block[i].blocker=servicesBlocker;
+            continue;
+        }
+
+        // one blocking term per resource, the longest lower priority critical section on it
+        sumResources=0; resourcesTerm=0; resourcesRes=FEAS_RESOURCE_NONE; resourcesBlocker=FEAS_RESOURCE_NONE;
+
+        for(r=0; r < numResources; r++)
+        {
+            if(ceiling[r] > rank[i])
+                continue;
+
+            longest=0; longestBlocker=FEAS_RESOURCE_NONE;
+            for(j=0; j < n; j++)
+            {
+                cs=feas_cs(res, j, r);
+                if((rank[j] > rank[i]) && (cs > longest))
+                {
+                    longest=cs;
+                    longestBlocker=j;
+                }
+            }
+
+            sumResources+=longest;
+            if(longest > resourcesTerm)
+            {
+                resourcesTerm=longest;
+                resourcesRes=r;
+                resourcesBlocker=longestBlocker;
+            }
+        }
+
+        // the dominant resource is the largest term of whichever sum is the bound
+        if(sumServices <= sumResources)
+        {
+            block[i].blocking=sumServices;
+            block[i].resource=servicesRes;
+            block[i].blocker=servicesBlocker;
+        }
+        else
+        {
+            block[i].blocking=sumResources;
+            block[i].resource=resourcesRes;
+            block[i].blocker=resourcesBlocker;
+        }
+    }
+
+    free(rank);
+    return FEAS_OK;
+}
+
+
+// Response time analysis with blocking, in file order.  Every service is analyzed, rather than
+// stopping at the first miss, so the caller can report all of them.
+int feas_blocking_rta(taskSet_t *set, feasBlocking_t block[], int byDeadline, U32_T response[])
+{
+    U32_T n=set->numServices, *rank, i, j;
+    unsigned long long r, next;
+    int feasible=TRUE;
+
+    if((rank=malloc((n + 1) * sizeof(U32_T))) == NULL)
+        return FEAS_ERROR;
+
+    feas_rank(set, byDeadline, rank);
+
+    for(i=0; i < n; i++)
+    {
+        r=(unsigned long long)set->wcet[i] + block[i].blocking;
+
+        while(r <= set->deadline[i])
+        {
+            next=(unsigned long long)set->wcet[i] + block[i].blocking;
+
+            for(j=0; (j < n) && (next <= set->deadline[i]); j++)
+                if(rank[j] < rank[i])
+                    next += CEIL_DIV(r, (unsigned long long)set->period[j]) * set->wcet[j];
+
+            if(next == r)
+                break;
+
+            r=next;
+        }
+
+        if(r > set->deadline[i])
+            feasible=FALSE;
+
+        response[i]=(r > 0xffffffffULL) ? 0xffffffff : (U32_T)r;
+    }
+
+    free(rank);
+    return feasible;
+}
+
+
+// Baker's sufficient EDF test with SRP blocking, for D <= T.  With the services in deadline
+// order, every k must have
+//
+//   sum over i <= k of C(i)/D(i) + B(k)/D(k) <= 1
+//
+// where block[] was computed with FEAS_BLOCK_SRP.
+int feas_edf_srp_feasibility(taskSet_t *set, feasBlocking_t block[])
+{
+    U32_T n=set->numServices, *rank, i, k;
+    double density;
+    int feasible=TRUE;
+
+    if((rank=malloc((n + 1) * sizeof(U32_T))) == NULL)
+        return FEAS_ERROR;
+
+    feas_rank(set, TRUE, rank);
+
+    for(k=0; (k < n) && feasible; k++)
+    {
+        density=(double)block[k].blocking / (double)set->deadline[k];
+
+        for(i=0; i < n; i++)
+            if(rank[i] <= rank[k])
+                density += (double)set->wcet[i] / (double)set->deadline[i];
+
+        if(density > 1.0)
+            feasible=FALSE;
+    }
+
+    free(rank);
+    return feasible;
+}
@@ -0,0 +1,425 @@
+// Static schedule tables for cyclic executives
+//
+// The major frame is the hyperperiod H and is divided into minor frames of length f.  A cyclic
+// executive wakes at each frame boundary and runs the jobs placed in that frame to completion,
+// one after the other, as lab1.c and the VxWorks ex0.c and ex3.c sequencers do by hand.  The
+// frame must satisfy the constraints of Baker and Shaw, as given by Liu:
+//
+// 1) f >= C for every service, so that each job fits in one frame without being split.
+// 2) f divides the period of at least one service, so that H is a whole number of frames.
+// 3) 2f - gcd(f, T) <= D for every service, so that there is a whole frame between the release
+//    and the deadline of every job, whatever its phase relative to the frame boundaries.
+//
+// Each job may then be placed in any frame that starts at or after its release and ends by
+// its deadline.  Placing jobs is bin packing, so a heuristic is used: in order of deadline, each
+// job goes in the least loaded frame of its window, which leaves slack in every frame for WCET
+// overruns at run time, or if that fails, in the earliest frame with room.  The largest frame
+// that works is chosen, since fewer frames means fewer wake-ups of the executive.
+//
+// A deadline past the period (D > T) is taken as D = T, since a job that ran in a frame of the
+// next period would share the frame with the next job of its service, and the window would run
+// off the end of the major frame for the last job.  The table is then stricter than needed but
+// still meets the longer deadline.
+//
+// Jobs are not split across frames, so a set with a long job and a short deadline elsewhere may
+// have no frame size at all, even though it is feasible with preemption.
+//
+// Baker, T. P., and Alan Shaw. "The cyclic executive model and Ada." Real-Time Systems 1.1
+// (1989): 7-25.
+//
+// Liu, Jane W. S. "Real-Time Systems." Prentice Hall (2000), section 5.3.
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+#include "seqcyclic.h"
+
+typedef struct
+{
+    U32_T service;
+    U32_T first;        // first frame the job may run in
+    U32_T last;         // last frame the job may run in
+    U32_T frame;        // frame the job is placed in
+} cyclicJob_t;
+
+
+static unsigned long long cyclic_gcd(unsigned long long a, unsigned long long b)
+{
+    unsigned long long t;
+
+    while(b != 0)
+    {
+        t=a % b; a=b; b=t;
+    }
+
+    return a;
+}
+
+
+// Hyperperiod, or 0 if it is longer than limit
+static unsigned long long cyclic_hyperperiod(taskSet_t *set, unsigned long long limit)
+{
+    unsigned long long hyper=1;
+    U32_T i;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        hyper=(hyper / cyclic_gcd(hyper, set->period[i])) * set->period[i];
+
+        if(hyper > limit)
+            return 0;
+    }
+
+    return hyper;
+}
+
+
+// Deadline the table is built for, at most the period
+static U32_T cyclic_deadline(taskSet_t *set, U32_T i)
+{
+    return (set->deadline[i] < set->period[i]) ? set->deadline[i] : set->period[i];
+}
+
+
+static int cyclic_frame_ok(taskSet_t *set, U32_T frame)
+{
+    U32_T i;
+
+    for(i=0; i < set->numServices; i++)
+        if((frame < set->wcet[i]) || ((2ULL * frame) - cyclic_gcd(frame, set->period[i]) > cyclic_deadline(set, i)))
+            return FALSE;
+
+    return TRUE;
+}
+
+
+static int cyclic_job_order(const void *a, const void *b)
+{
+    const cyclicJob_t *ja=(const cyclicJob_t *)a, *jb=(const cyclicJob_t *)b;
+
+    if(ja->last != jb->last) return (ja->last < jb->last) ? -1 : 1;
+    if(ja->first != jb->first) return (ja->first < jb->first) ? -1 : 1;
+    if(ja->service != jb->service) return (ja->service < jb->service) ? -1 : 1;
+    return 0;
+}
+
+
+static int cyclic_size_order(const void *a, const void *b)
+{
+    U32_T fa=*(const U32_T *)a, fb=*(const U32_T *)b;
+
+    return (fa > fb) ? -1 : (fa < fb);
+}
+
+
+int feas_cyclic_frame_sizes(taskSet_t *set, U32_T frame[], U32_T maxSizes, U32_T *numSizes)
+{
+    U32_T i, j, d, f, n=0, k;
+
+    *numSizes=0;
+
+    if((set->numServices == 0) || (maxSizes == 0))
+        return FEAS_ERROR;
+
+    // every divisor of every period, by trial division up to its square root
+    for(i=0; i < set->numServices; i++)
+    {
+        for(d=1; ((unsigned long long)d * d <= set->period[i]) && (n < maxSizes); d++)
+        {
+            if((set->period[i] % d) != 0)
+                continue;
+
+            for(j=0; j < 2; j++)
+            {
+                f=(j == 0) ? d : (set->period[i] / d);
+
+                if(!cyclic_frame_ok(set, f))
+                    continue;
+
+                for(k=0; (k < n) && (frame[k] != f); k++);
+                if((k == n) && (n < maxSizes))
+                    frame[n++]=f;
+            }
+        }
+    }
+
+    qsort(frame, n, sizeof(U32_T), cyclic_size_order);
+    *numSizes=n;
+
+    return (n > 0) ? FEAS_OK : FEAS_ERROR;
+}
+
+
+void feas_cyclic_free(feasCyclic_t *table)
+{
+    free(table->firstEntry);
+    free(table->entry);
+    free(table->load);
+    memset(table, 0, sizeof(feasCyclic_t));
+}
+
+
+// Place each job, in order of last frame, in the least loaded frame of its window with room for
+// it, or with balance FALSE in the earliest frame with room
+static int cyclic_place(taskSet_t *set, cyclicJob_t job[], U32_T numJobs, U32_T frame, U32_T load[], int balance)
+{
+    U32_T k, j, best, wcet;
+
+    for(k=0; k < numJobs; k++)
+    {
+        wcet=set->wcet[job[k].service];
+        best=FEAS_CYCLIC_MAX_FRAMES;
+
+        for(j=job[k].first; j <= job[k].last; j++)
+        {
+            if(load[j] + wcet > frame)
+                continue;
+
+            if((best == FEAS_CYCLIC_MAX_FRAMES) || (balance && (load[j] < load[best])))
+                best=j;
+
+            if(!balance)
+                break;
+        }
+
+        if(best == FEAS_CYCLIC_MAX_FRAMES)
+            return FEAS_ERROR;
+
+        load[best]+=wcet;
+        job[k].frame=best;
+    }
+
+    return FEAS_OK;
+}
+
+
+int feas_cyclic_schedule(taskSet_t *set, U32_T frame, feasCyclic_t *table)
+{
+    unsigned long long hyper, release;
+    U32_T i, j, k, s, numJobs=0;
+    cyclicJob_t *job;
+    int balance;
+
+    memset(table, 0, sizeof(feasCyclic_t));
+
+    if((frame == 0) || !cyclic_frame_ok(set, frame) ||
+       ((hyper=cyclic_hyperperiod(set, (unsigned long long)frame * FEAS_CYCLIC_MAX_FRAMES)) == 0) ||
+       ((hyper % frame) != 0))
+        return FEAS_ERROR;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        if(numJobs + (hyper / set->period[i]) > FEAS_CYCLIC_MAX_ENTRIES)
+            return FEAS_ERROR;
+        numJobs+=(U32_T)(hyper / set->period[i]);
+    }
+
+    table->frame=frame;
+    table->numFrames=(U32_T)(hyper / frame);
+    table->numEntries=numJobs;
+
+    job=malloc(numJobs * sizeof(cyclicJob_t));
+    table->firstEntry=calloc(table->numFrames + 1, sizeof(U32_T));
+    table->entry=malloc(numJobs * sizeof(U32_T));
+    table->load=malloc(table->numFrames * sizeof(U32_T));
+
+    if((job == NULL) || (table->firstEntry == NULL) || (table->entry == NULL) || (table->load == NULL))
+    {
+        free(job);
+        feas_cyclic_free(table);
+        return FEAS_ERROR;
+    }
+
+    // frames each job may run in, from the first to start at or after its release to the last
+    // to end by its deadline, which constraint 3 guarantees is no earlier, and with D <= T no
+    // later than the last frame of the major frame
+    for(i=0, k=0; i < set->numServices; i++)
+    {
+        for(release=0; release < hyper; release+=set->period[i], k++)
+        {
+            job[k].service=i;
+            job[k].first=(U32_T)((release + frame - 1) / frame);
+            job[k].last=(U32_T)(((release + cyclic_deadline(set, i)) / frame) - 1);
+        }
+    }
+
+    qsort(job, numJobs, sizeof(cyclicJob_t), cyclic_job_order);
+
+    // spread the load over the frames to leave slack in each for overruns, and if that does not
+    // fit, pack each job into the earliest frame it can go in
+    for(balance=TRUE; balance >= FALSE; balance--)
+    {
+        memset(table->load, 0, table->numFrames * sizeof(U32_T));
+
+        if(cyclic_place(set, job, numJobs, frame, table->load, balance) == FEAS_OK)
+            break;
+    }
+
+    if(balance < FALSE)
+    {
+        free(job);
+        feas_cyclic_free(table);
+        return FEAS_ERROR;
+    }
+
+    // group the entries by frame
+    for(k=0; k < numJobs; k++)
+        table->firstEntry[job[k].frame + 1]++;
+
+    for(j=0; j < table->numFrames; j++)
+        table->firstEntry[j+1]+=table->firstEntry[j];
+
+    for(k=0; k < numJobs; k++)
+        table->entry[table->firstEntry[job[k].frame]++]=job[k].service;
+
+    for(j=table->numFrames; j > 0; j--)
+        table->firstEntry[j]=table->firstEntry[j-1];
+    table->firstEntry[0]=0;
+
+    // within a frame the jobs all meet their deadlines in any order, so the shortest periods run
+    // first, right after the frame starts, for the least release jitter
+    for(j=0; j < table->numFrames; j++)
+    {
+        for(k=table->firstEntry[j] + 1; k < table->firstEntry[j+1]; k++)
+        {
+            for(i=k, s=table->entry[k]; (i > table->firstEntry[j]) && (set->period[table->entry[i-1]] > set->period[s]); i--)
+                table->entry[i]=table->entry[i-1];
+            table->entry[i]=s;
+        }
+    }
+
+    free(job);
+    return FEAS_OK;
+}
+
+
+int feas_cyclic_build(taskSet_t *set, U32_T frame, feasCyclic_t *table)
+{
+    U32_T size[FEAS_CYCLIC_MAX_SIZES], numSizes, i;
+
+    if(frame != 0)
+        return feas_cyclic_schedule(set, frame, table);
+
+    if(feas_cyclic_frame_sizes(set, size, FEAS_CYCLIC_MAX_SIZES, &numSizes) != FEAS_OK)
+        return FEAS_ERROR;
+
+    for(i=0; i < numSizes; i++)
+        if(feas_cyclic_schedule(set, size[i], table) == FEAS_OK)
+            return FEAS_OK;
+
+    return FEAS_ERROR;
+}
+
+
+int feas_cyclic_write_header(const char *fileName, taskSet_t *set, feasCyclic_t *table, U32_T nsecPerUnit)
+{
+    FILE *fp;
+    U32_T i, e;
+
+    if((fp=fopen(fileName, "w")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    fprintf(fp, "// Cyclic executive table for %s, generated by Feasibility/feasibility_cyclic\n", set->name);
+    fprintf(fp, "//\n");
+    fprintf(fp, "// %u minor frames of %llu nsec in the major frame, %u jobs.  Give the tables to\n",
+            table->numFrames, (unsigned long long)table->frame * nsecPerUnit, table->numEntries);
+    fprintf(fp, "// seq_set_cyclic() with the services registered in the order of the task set file.\n\n");
+    fprintf(fp, "#ifndef _SEQ_CYCLIC_TABLE_H\n#define _SEQ_CYCLIC_TABLE_H\n\n");
+    fprintf(fp, "#include \"seqcyclic.h\"\n\n");
+    fprintf(fp, "#define SEQ_CYCLIC_FRAME_NSEC (%lluULL)\n", (unsigned long long)table->frame * nsecPerUnit);
+    fprintf(fp, "#define SEQ_CYCLIC_NUM_SERVICES (%u)\n", set->numServices);
+    fprintf(fp, "#define SEQ_CYCLIC_NUM_FRAMES (%u)\n", table->numFrames);
+    fprintf(fp, "#define SEQ_CYCLIC_NUM_ENTRIES (%u)\n\n", table->numEntries);
+
+    fprintf(fp, "static const unsigned long long seqCyclicPeriodNsec[SEQ_CYCLIC_NUM_SERVICES]=\n{\n");
+    for(i=0; i < set->numServices; i++)
+        fprintf(fp, "    %lluULL%s\n", (unsigned long long)set->period[i] * nsecPerUnit,
+                (i < set->numServices - 1) ? "," : "");
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const seqCyclicFrame_t seqCyclicFrames[SEQ_CYCLIC_NUM_FRAMES]=\n{\n");
+    for(i=0; i < table->numFrames; i++)
+        fprintf(fp, "    {%u, %u}%s    // frame %u, load %llu nsec\n", table->firstEntry[i],
+                table->firstEntry[i+1] - table->firstEntry[i], (i < table->numFrames - 1) ? "," : " ", i,
+                (unsigned long long)table->load[i] * nsecPerUnit);
+    fprintf(fp, "};\n\n");
+
+    fprintf(fp, "static const uint32_t seqCyclicEntries[SEQ_CYCLIC_NUM_ENTRIES]=\n{\n");
+    for(i=0; i < table->numFrames; i++)
+    {
+        if(table->firstEntry[i] == table->firstEntry[i+1])
+            continue;
+
+        fprintf(fp, "   ");
+        for(e=table->firstEntry[i]; e < table->firstEntry[i+1]; e++)
+            fprintf(fp, " %u%s", table->entry[e], (e < table->numEntries - 1) ? "," : "");
+        fprintf(fp, "\n");
+    }
+    fprintf(fp, "};\n\n#endif\n");
+
+    fclose(fp);
+    return FEAS_OK;
+}
+
+
+int feas_cyclic_write_table(const char *fileName, taskSet_t *set, feasCyclic_t *table, U32_T nsecPerUnit)
+{
+    FILE *fp;
+    seqCyclicHeader_t header;
+    seqCyclicFrame_t desc;
+    uint64_t periodNsec;
+    uint32_t entry;
+    U32_T i;
+    int rc=FEAS_OK;
+
+    if((fp=fopen(fileName, "wb")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    memset(&header, 0, sizeof(header));
+    header.magic=SEQ_CYCLIC_MAGIC;
+    header.version=SEQ_CYCLIC_VERSION;
+    header.numServices=set->numServices;
+    header.numFrames=table->numFrames;
+    header.numEntries=table->numEntries;
+    header.frameNsec=(uint64_t)table->frame * nsecPerUnit;
+
+    if(fwrite(&header, sizeof(header), 1, fp) != 1)
+        rc=FEAS_ERROR;
+
+    for(i=0; (i < set->numServices) && (rc == FEAS_OK); i++)
+    {
+        periodNsec=(uint64_t)set->period[i] * nsecPerUnit;
+        if(fwrite(&periodNsec, sizeof(periodNsec), 1, fp) != 1)
+            rc=FEAS_ERROR;
+    }
+
+    for(i=0; (i < table->numFrames) && (rc == FEAS_OK); i++)
+    {
+        desc.firstEntry=table->firstEntry[i];
+        desc.numEntries=table->firstEntry[i+1] - table->firstEntry[i];
+        if(fwrite(&desc, sizeof(desc), 1, fp) != 1)
+            rc=FEAS_ERROR;
+    }
+
+    for(i=0; (i < table->numEntries) && (rc == FEAS_OK); i++)
+    {
+        entry=table->entry[i];
+        if(fwrite(&entry, sizeof(entry), 1, fp) != 1)
+            rc=FEAS_ERROR;
+    }
+
+    if(fclose(fp) != 0)
+        rc=FEAS_ERROR;
+
+    if(rc != FEAS_OK)
+        printf("Failed to write cyclic table %s\n", fileName);
+
+    return rc;
+}
@@ -0,0 +1,184 @@
+// Random task set generation for benchmarking the feasibility tests
+//
+// Bini, Enrico, and Giorgio C. Buttazzo. "Measuring the performance of schedulability tests."
+// Real-Time Systems 30.1 (2005): 129-154.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "feaslib.h"
+
+
+static double feas_uniform(unsigned int *seed)
+{
+    // open interval (0,1) so that pow() and log() below are always defined
+    return ((double)rand_r(seed) + 1.0) / ((double)RAND_MAX + 2.0);
+}
+
+
+void feas_uunifast(U32_T numServices, double totalUtil, double util[], unsigned int *seed)
+{
+    double sumU=totalUtil, nextSumU;
+    U32_T i;
+
+    for(i=1; i < numServices; i++)
+    {
+        nextSumU=sumU * pow(feas_uniform(seed), 1.0 / (double)(numServices - i));
+        util[i-1]=sumU - nextSumU;
+        sumU=nextSumU;
+    }
+
+    util[numServices-1]=sumU;
+}
+
+
+// RandFixedSum (Stafford, as used by Emberson, Stafford and Davis) draws numServices values
+// uniformly distributed over those in [0, maxUtil] summing to totalUtil, which unlike UUniFast
+// keeps every utilization below maxUtil when totalUtil is above 1 for multi-core sets.
+//
+// Each value is drawn in turn from the simplex slice that the remaining sum allows, with the
+// choice between neighbouring unit cubes made by the probabilities in t[][], which come from the
+// volumes w[][] of the slices.  Rows of w[][] are rescaled so they cannot underflow for large n,
+// which leaves the ratios that t[][] is made of unchanged.
+int feas_randfixedsum(U32_T numServices, double totalUtil, double maxUtil, double util[], unsigned int *seed)
+{
+    U32_T n=numServices, i, c, j, k, r;
+    double s, *s1, *s2, *w, *t, tmp1, tmp2, rowMax, sm=0.0, pr=1.0, sx, swap;
+    int e;
+
+    if((n == 0) || (maxUtil <= 0.0) || (totalUtil < 0.0) || (totalUtil > (n * maxUtil)))
+        return FEAS_ERROR;
+
+    if(n == 1)
+    {
+        util[0]=totalUtil;
+        return FEAS_OK;
+    }
+
+    // 1 based tables as in the published MATLAB code, w is n x (n+1) and t is (n-1) x n
+    s1=malloc((n + 1) * sizeof(double));
+    s2=malloc((n + 1) * sizeof(double));
+    w=calloc((n + 1) * (n + 2), sizeof(double));
+    t=calloc((n + 1) * (n + 1), sizeof(double));
+
+    if(!s1 || !s2 || !w || !t)
+    {
+        free(s1); free(s2); free(w); free(t);
+        return FEAS_ERROR;
+    }
+
+#define W(a, b) w[((a) * (n + 2)) + (b)]
+#define T(a, b) t[((a) * (n + 1)) + (b)]
+
+    // rescale to values in [0, 1] summing to s, which lies in unit cube slice k
+    s=totalUtil / maxUtil;
+    k=(s >= (double)(n - 1)) ? (n - 1) : (U32_T)floor(s);
+    if(s < (double)k) s=(double)k;
+    if(s > (double)(k + 1)) s=(double)(k + 1);
+
+    for(i=1; i <= n; i++)
+    {
+        s1[i]=s - ((double)k - (double)(i - 1));
+        s2[i]=((double)(k + n) - (double)(i - 1)) - s;
+    }
+
+    W(1, 2)=1.0;
+
+    for(i=2; i <= n; i++)
+    {
+        rowMax=0.0;
+
+        for(c=1; c <= i; c++)
+        {
+            tmp1=W(i-1, c+1) * s1[c] / (double)i;
+            tmp2=W(i-1, c) * s2[n-i+c] / (double)i;
+            W(i, c+1)=tmp1 + tmp2;
+
+            if(W(i, c+1) > 0.0)
+                T(i-1, c)=(s2[n-i+c] > s1[c]) ? (tmp2 / W(i, c+1)) : (1.0 - (tmp1 / W(i, c+1)));
+            else
+                T(i-1, c)=(s2[n-i+c] > s1[c]) ? 0.0 : 1.0;
+
+            if(W(i, c+1) > rowMax) rowMax=W(i, c+1);
+        }
+
+        if(rowMax > 0.0)
+            for(c=2; c <= i+1; c++)
+                W(i, c)/=rowMax;
+    }
+
+    j=k + 1;
+
+    for(i=n-1; i >= 1; i--)
+    {
+        e=(feas_uniform(seed) <= T(i, j)) ? 1 : 0;
+        sx=pow(feas_uniform(seed), 1.0 / (double)i);
+        sm+=(1.0 - sx) * pr * s / (double)(i + 1);
+        pr*=sx;
+        util[n-i-1]=sm + (pr * e);
+        s-=e;
+        j-=e;
+    }
+
+    util[n-1]=sm + (pr * s);
+
+#undef W
+#undef T
+
+    // the draw is ordered, so shuffle it and scale back to [0, maxUtil]
+    for(i=n-1; i > 0; i--)
+    {
+        r=(U32_T)(feas_uniform(seed) * (double)(i + 1));
+        if(r > i) r=i;
+        swap=util[i]; util[i]=util[r]; util[r]=swap;
+    }
+
+    for(i=0; i < n; i++)
+        util[i]*=maxUtil;
+
+    free(s1); free(s2); free(w); free(t);
+    return FEAS_OK;
+}
+
+
+int feas_generate_taskset(taskSet_t *set, U32_T numServices, double totalUtil, feasGenConfig_t *cfg,
+                          unsigned int *seed)
+{
+    double *util, logMin=log((double)cfg->minPeriod), logMax=log((double)cfg->maxPeriod), minDeadline;
+    U32_T i, period, wcet, deadline;
+    int rc=FEAS_OK;
+
+    if((util=malloc(numServices * sizeof(double))) == NULL)
+        return FEAS_ERROR;
+
+    if(cfg->method == FEAS_GEN_RANDFIXEDSUM)
+        rc=feas_randfixedsum(numServices, totalUtil, cfg->maxUtil, util, seed);
+    else
+        feas_uunifast(numServices, totalUtil, util, seed);
+
+    set->numServices=0;
+
+    for(i=0; (i < numServices) && (rc == FEAS_OK); i++)
+    {
+        period=(U32_T)(exp(logMin + (feas_uniform(seed) * (logMax - logMin))) + 0.5);
+        wcet=(U32_T)((util[i] * (double)period) + 0.5);
+        if(wcet == 0) wcet=1;
+        if(wcet > period) wcet=period;
+
+        // constrained deadlines only draw a random number when asked for, so sets with D = T
+        // are the same for a given seed as before
+        deadline=period;
+        if(cfg->minDeadlineRatio < 1.0)
+        {
+            minDeadline=cfg->minDeadlineRatio * (double)period;
+            if(minDeadline < (double)wcet) minDeadline=(double)wcet;
+            deadline=(U32_T)(minDeadline + (feas_uniform(seed) * ((double)period - minDeadline)) + 0.5);
+            if(deadline < wcet) deadline=wcet;
+        }
+
+        rc=feas_append_task(set, period, wcet, deadline, 0, 0);
+    }
+
+    free(util);
+    return rc;
+}
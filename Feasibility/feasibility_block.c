@@ -0,0 +1,170 @@
+// Feasibility analysis with blocking on shared resources
+//
+// Usage: feasibility_block <tasksets.csv | tasksets.json> <resources.csv> [-p rm|dm] [-s set]
+//
+// The critical sections of each set are read from the resource file (see feaslib.h for the
+// format) and the blocking bound of each service computed by feasblock.c for priority
+// inheritance, priority ceiling and, under EDF, the stack resource policy.  One CSV line is
+// printed per set:
+//
+//   set,n,U,fp,fp_pip,fp_pcp,edf,edf_srp
+//
+// where fp is response time analysis without blocking, in RM or DM (-p) priority order, fp_pip
+// and fp_pcp add the PIP and PCP blocking, edf is QPA without blocking and edf_srp is Baker's
+// test with SRP blocking.  With -s the blocking, the service and resource that dominate it and
+// the response times of each service of the named set are printed as well, e.g. for the
+// pthread3ok model of a shared memory mutex in synch.csv:
+//
+//   ./feasibility_block synch.csv synch_resources.csv -s pthread3
+//
+// Without any protocol, as in pthread3.c, the blocking of a high priority service is unbounded,
+// since any middle priority service can preempt the holder of the mutex.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> <resources.csv> [-p rm|dm] [-s set]\n", prog);
+}
+
+
+// Blocking in the form B(blocker:resource), or just B when there is none
+static void print_blocking(feasBlocking_t *block, feasResources_t *res)
+{
+    char text[FEAS_NAME_LEN + 32];
+
+    if(block->resource == FEAS_RESOURCE_NONE)
+        snprintf(text, sizeof(text), "%u", block->blocking);
+    else
+        snprintf(text, sizeof(text), "%u(S%d:%s)", block->blocking, block->blocker, res->resource[block->resource]);
+
+    printf(" %-24s", text);
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets, *set, sorted;
+    feasResources_t *res, *setRes;
+    feasBlocking_t *pip=NULL, *pcp=NULL, *srp=NULL;
+    U32_T *response=NULL, *responsePip=NULL, *responsePcp=NULL, maxServices=0, s;
+    int numSets, numRes, i, byDeadline=FALSE, fp, fpPip, fpPcp, edf, edfSrp;
+    char *inFile=NULL, *resFile=NULL, *setName=NULL;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-p") == 0) && (i + 1 < argc))
+            byDeadline=(strcmp(argv[++i], "dm") == 0);
+        else if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            setName=argv[++i];
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else if(resFile == NULL)
+            resFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if((inFile == NULL) || (resFile == NULL))
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    if(feas_load_resources(resFile, &res, &numRes) != FEAS_OK)
+    {
+        printf("Failed to load resources from %s\n", resFile);
+        feas_free_tasksets(sets, numSets);
+        exit(-1);
+    }
+
+    for(i=0; i < numSets; i++)
+        if(sets[i].numServices > maxServices)
+            maxServices=sets[i].numServices;
+
+    pip=malloc((maxServices + 1) * sizeof(feasBlocking_t));
+    pcp=malloc((maxServices + 1) * sizeof(feasBlocking_t));
+    srp=malloc((maxServices + 1) * sizeof(feasBlocking_t));
+    response=malloc((maxServices + 1) * sizeof(U32_T));
+    responsePip=malloc((maxServices + 1) * sizeof(U32_T));
+    responsePcp=malloc((maxServices + 1) * sizeof(U32_T));
+
+    if((pip == NULL) || (pcp == NULL) || (srp == NULL) || (response == NULL) || (responsePip == NULL) ||
+       (responsePcp == NULL) || (feas_alloc_taskset(&sorted, maxServices) != FEAS_OK))
+    {
+        printf("Out of memory\n");
+        exit(-1);
+    }
+
+    printf("set,n,U,fp,fp_pip,fp_pcp,edf,edf_srp\n");
+
+    for(i=0; i < numSets; i++)
+    {
+        set=&sets[i];
+        setRes=feas_find_resources(res, numRes, set->name);
+
+        if((feas_blocking(set, setRes, FEAS_BLOCK_PIP, byDeadline, pip) != FEAS_OK) ||
+           (feas_blocking(set, setRes, FEAS_BLOCK_PCP, byDeadline, pcp) != FEAS_OK) ||
+           (feas_blocking(set, setRes, FEAS_BLOCK_SRP, TRUE, srp) != FEAS_OK))
+            continue;
+
+        fpPip=feas_blocking_rta(set, pip, byDeadline, responsePip);
+        fpPcp=feas_blocking_rta(set, pcp, byDeadline, responsePcp);
+        edfSrp=feas_edf_srp_feasibility(set, srp);
+        edf=feas_edf_qpa_feasibility(set->numServices, set->period, set->wcet, set->deadline);
+
+        // the plain fixed priority test needs the services in priority order
+        sorted.numServices=0;
+        for(s=0; s < set->numServices; s++)
+            feas_append_task(&sorted, set->period[s], set->wcet[s], set->deadline[s], 0, 0);
+
+        if(byDeadline) feas_sort_dm(&sorted);
+        else feas_sort_rm(&sorted);
+
+        fp=feas_response_time_analysis(sorted.numServices, sorted.period, sorted.wcet, sorted.deadline, response, 0);
+
+        printf("%s,%u,%.4f,%d,%d,%d,%d,%d\n", set->name, set->numServices,
+               feas_utilization(set->numServices, set->period, set->wcet), fp, fpPip, fpPcp, edf, edfSrp);
+
+        if((setName == NULL) || (strcmp(set->name, setName) != 0))
+            continue;
+
+        printf("\n%s in %s priority order, blocking as B(blocker:resource):\n\n", set->name, byDeadline ? "DM" : "RM");
+        printf("%8s %8s %8s %8s %-24s %-24s %-24s %8s %8s\n", "service", "T", "C", "D",
+               "B PIP", "B PCP", "B SRP", "R PIP", "R PCP");
+
+        for(s=0; s < set->numServices; s++)
+        {
+            printf("%8u %8u %8u %8u", s, set->period[s], set->wcet[s], set->deadline[s]);
+            print_blocking(&pip[s], setRes);
+            print_blocking(&pcp[s], setRes);
+            print_blocking(&srp[s], setRes);
+            printf(" %7u%s %7u%s\n", responsePip[s], (responsePip[s] > set->deadline[s]) ? "*" : " ",
+                   responsePcp[s], (responsePcp[s] > set->deadline[s]) ? "*" : " ");
+        }
+
+        printf("\n* misses its deadline\n");
+    }
+
+    feas_free_taskset(&sorted);
+    free(pip); free(pcp); free(srp);
+    free(response); free(responsePip); free(responsePcp);
+    feas_free_resources(res, numRes);
+    feas_free_tasksets(sets, numSets);
+
+    return 0;
+}
@@ -0,0 +1,147 @@
+// Bulk feasibility analysis of task sets loaded from CSV or JSON files
+//
+// Usage: feasibility_cli <tasksets.csv | tasksets.json> [-o results.csv] [-q]
+//
+// Each task set is sorted into rate monotonic priority order and then screened with the RM LUB,
+// scheduling point and completion time tests from feaslib.c, using the optimized hyperplane
+// and response time analysis versions of the two exact tests.  For services with deadlines
+// shorter than their periods, the set is also tested in deadline monotonic order by response
+// time analysis and under EDF by processor demand analysis (QPA).  One CSV line of results is
+// written per set, to stdout or the -o file, followed by a summary on stdout:
+//
+//   set,n,U,rm_lub,sched_point,completion_time,dm,edf
+//   ex0,3,0.7333,1,1,1,1,1
+//
+// The two exact RM tests must always agree, so any disagreement is reported as an error.  With -q
+// only the summary is printed, which is useful for timing large files.
+//
+// See examples.csv and examples.json for the five examples from feasibility_tests.c.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "feaslib.h"
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> [-o results.csv] [-q]\n", prog);
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets;
+    U32_T *response=NULL, maxServices=0;
+    int numSets, i, quiet=FALSE, lubCnt=0, spCnt=0, ctCnt=0, dmCnt=0, edfCnt=0, mismatchCnt=0;
+    int lub, sp, ct, dm, edf;
+    char *inFile=NULL, *outFile=NULL;
+    FILE *out=stdout;
+    struct timespec start, stop;
+    double loadSec, analysisSec;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+            outFile=argv[++i];
+        else if(strcmp(argv[i], "-q") == 0)
+            quiet=TRUE;
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if(inFile == NULL)
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    loadSec=(stop.tv_sec - start.tv_sec) + ((stop.tv_nsec - start.tv_nsec) / 1000000000.0);
+
+    for(i=0; i < numSets; i++)
+        if(sets[i].numServices > maxServices)
+            maxServices=sets[i].numServices;
+
+    if((response=malloc((maxServices + 1) * sizeof(U32_T))) == NULL)
+    {
+        feas_free_tasksets(sets, numSets);
+        exit(-1);
+    }
+
+    if(outFile != NULL)
+    {
+        if((out=fopen(outFile, "w")) == NULL)
+        {
+            perror(outFile);
+            free(response);
+            feas_free_tasksets(sets, numSets);
+            exit(-1);
+        }
+    }
+
+    if(!quiet || (outFile != NULL))
+        fprintf(out, "set,n,U,rm_lub,sched_point,completion_time,dm,edf\n");
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+
+    for(i=0; i < numSets; i++)
+    {
+        feas_sort_rm(&sets[i]);
+
+        lub=rate_monotonic_least_upper_bound(sets[i].numServices, sets[i].period, sets[i].wcet, sets[i].deadline);
+        sp=feas_hyperplane_feasibility(sets[i].numServices, sets[i].period, sets[i].wcet, sets[i].deadline);
+        ct=feas_response_time_analysis(sets[i].numServices, sets[i].period, sets[i].wcet, sets[i].deadline,
+                                       response, 0);
+
+        edf=feas_edf_qpa_feasibility(sets[i].numServices, sets[i].period, sets[i].wcet, sets[i].deadline);
+
+        feas_sort_dm(&sets[i]);
+        dm=feas_response_time_analysis(sets[i].numServices, sets[i].period, sets[i].wcet, sets[i].deadline,
+                                       response, 0);
+
+        lubCnt+=lub; spCnt+=sp; ctCnt+=ct; dmCnt+=dm; edfCnt+=edf;
+
+        if(sp != ct)
+        {
+            printf("ERROR: %s scheduling point and completion time tests disagree\n", sets[i].name);
+            mismatchCnt++;
+        }
+
+        if(!quiet || (outFile != NULL))
+            fprintf(out, "%s,%u,%.4f,%d,%d,%d,%d,%d\n", sets[i].name, sets[i].numServices,
+                    feas_utilization(sets[i].numServices, sets[i].period, sets[i].wcet), lub, sp, ct, dm, edf);
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    analysisSec=(stop.tv_sec - start.tv_sec) + ((stop.tv_nsec - start.tv_nsec) / 1000000000.0);
+
+    if(out != stdout)
+        fclose(out);
+
+    printf("\n%d task sets from %s: RM LUB feasible=%d, scheduling point feasible=%d, completion time feasible=%d\n",
+           numSets, inFile, lubCnt, spCnt, ctCnt);
+    printf("DM feasible=%d, EDF feasible=%d\n", dmCnt, edfCnt);
+    printf("load %.3f sec, analysis %.3f sec (%.1f usec per set)\n", loadSec, analysisSec,
+           (numSets > 0) ? (analysisSec * 1000000.0 / numSets) : 0.0);
+
+    free(response);
+    feas_free_tasksets(sets, numSets);
+
+    return (mismatchCnt == 0) ? 0 : -1;
+}
@@ -0,0 +1,189 @@
+// Cyclic executive frame tables for task sets loaded from CSV or JSON files
+//
+// Usage: feasibility_cyclic <tasksets.csv | tasksets.json> [-s set] [-f frame] [-u nsec per unit]
+//                           [-h table.h] [-b table.bin]
+//
+// For each set the minor frames that meet the Baker-Shaw constraints are found by feascyclic.c
+// and the jobs of one hyperperiod are placed in the longest one that works, or in the frame
+// given by -f, one CSV line per set:
+//
+//   set,n,U,sizes,frame,frames,jobs,max_load
+//
+// where sizes is the number of frame sizes meeting the constraints, frame is the size used, 0 if
+// the jobs could not be placed in any, and max_load the fraction of the fullest frame in use.
+//
+// With -s the frame table of the named set is printed and can be written as a C header (-h) to
+// compile into a program, or as a binary table (-b) for seq_load_cyclic(), with times in the
+// units of the set scaled by -u nanoseconds (default 1000, for sets in microseconds), e.g.
+//
+//   ./feasibility_cyclic seqgen4.csv -s seqgen4cyclic -h ../sequencer_generic/seqgen4_cyclic.h
+//   ./feasibility_cyclic seqgen4.csv -s seqgen4cyclic -b seqgen4.cyclic
+//   sudo ../sequencer_generic/seqgen4 cyclic 1000 table=seqgen4.cyclic
+//
+// The services must be registered with the sequencer in the order of the task set file.
+//
+// Every table is checked to hold each job of the hyperperiod once, with no frame over its length,
+// and the exit status is non-zero if one does not, e.g. for the sets with D > T in cyclic.csv:
+//
+//   ./feasibility_cyclic cyclic.csv
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+#define DEFAULT_NSEC_PER_UNIT (1000)
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> [-s set] [-f frame] [-u nsec per unit]\n"
+           "       [-h table.h] [-b table.bin]\n", prog);
+}
+
+
+static void print_table(taskSet_t *set, feasCyclic_t *table, U32_T size[], U32_T numSizes)
+{
+    U32_T i, e;
+
+    printf("\n%s frame sizes meeting the constraints:", set->name);
+    for(i=0; i < numSizes; i++)
+        printf(" %u", size[i]);
+
+    printf("\n\n%s major frame %llu, %u minor frames of %u:\n\n", set->name,
+           (unsigned long long)table->numFrames * table->frame, table->numFrames, table->frame);
+    printf("%8s %10s %10s  %s\n", "frame", "start", "load", "services");
+
+    for(i=0; i < table->numFrames; i++)
+    {
+        printf("%8u %10llu %10u ", i, (unsigned long long)i * table->frame, table->load[i]);
+        for(e=table->firstEntry[i]; e < table->firstEntry[i+1]; e++)
+            printf(" %u", table->entry[e]);
+        printf("\n");
+    }
+}
+
+
+// TRUE if the table has H/T entries for every service and no frame is loaded past its length
+static int check_table(taskSet_t *set, feasCyclic_t *table)
+{
+    unsigned long long hyper=(unsigned long long)table->numFrames * table->frame, load;
+    U32_T i, f, e, count;
+
+    if(table->firstEntry[table->numFrames] != table->numEntries)
+        return FALSE;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        for(e=0, count=0; e < table->numEntries; e++)
+            if(table->entry[e] == i) count++;
+
+        if(count != hyper / set->period[i])
+            return FALSE;
+    }
+
+    for(f=0; f < table->numFrames; f++)
+    {
+        for(e=table->firstEntry[f], load=0; e < table->firstEntry[f+1]; e++)
+            load+=set->wcet[table->entry[e]];
+
+        if((load != table->load[f]) || (load > table->frame))
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets, *set;
+    feasCyclic_t table;
+    U32_T size[FEAS_CYCLIC_MAX_SIZES], numSizes, frame=0, nsecPerUnit=DEFAULT_NSEC_PER_UNIT, maxLoad, f;
+    int numSets, i, rc=0;
+    char *inFile=NULL, *setName=NULL, *headerFile=NULL, *tableFile=NULL;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            setName=argv[++i];
+        else if((strcmp(argv[i], "-f") == 0) && (i + 1 < argc))
+            frame=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-u") == 0) && (i + 1 < argc))
+            nsecPerUnit=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-h") == 0) && (i + 1 < argc))
+            headerFile=argv[++i];
+        else if((strcmp(argv[i], "-b") == 0) && (i + 1 < argc))
+            tableFile=argv[++i];
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if((inFile == NULL) || (nsecPerUnit == 0) || (((headerFile != NULL) || (tableFile != NULL)) && (setName == NULL)))
+    {
+        usage(argv[0]);
+        if(setName == NULL) printf("-h and -b need the set to be named with -s\n");
+        exit(-1);
+    }
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    printf("set,n,U,sizes,frame,frames,jobs,max_load\n");
+
+    for(i=0; i < numSets; i++)
+    {
+        set=&sets[i];
+
+        if((setName != NULL) && (strcmp(set->name, setName) != 0))
+            continue;
+
+        feas_cyclic_frame_sizes(set, size, FEAS_CYCLIC_MAX_SIZES, &numSizes);
+
+        if(feas_cyclic_build(set, frame, &table) != FEAS_OK)
+        {
+            printf("%s,%u,%.4f,%u,0,0,0,0\n", set->name, set->numServices,
+                   feas_utilization(set->numServices, set->period, set->wcet), numSizes);
+            if(setName != NULL) rc=-1;
+            continue;
+        }
+
+        for(f=0, maxLoad=0; f < table.numFrames; f++)
+            if(table.load[f] > maxLoad) maxLoad=table.load[f];
+
+        printf("%s,%u,%.4f,%u,%u,%u,%u,%.4f\n", set->name, set->numServices,
+               feas_utilization(set->numServices, set->period, set->wcet), numSizes, table.frame,
+               table.numFrames, table.numEntries, (double)maxLoad / (double)table.frame);
+
+        if(!check_table(set, &table))
+        {
+            printf("TABLE ERROR: %s does not hold every job once within the frame length\n", set->name);
+            rc=-1;
+        }
+
+        if(setName != NULL)
+        {
+            print_table(set, &table, size, numSizes);
+
+            if((headerFile != NULL) && (feas_cyclic_write_header(headerFile, set, &table, nsecPerUnit) == FEAS_OK))
+                printf("\nC header written to %s\n", headerFile);
+            if((tableFile != NULL) && (feas_cyclic_write_table(tableFile, set, &table, nsecPerUnit) == FEAS_OK))
+                printf("\nBinary table written to %s\n", tableFile);
+        }
+
+        feas_cyclic_free(&table);
+    }
+
+    feas_free_tasksets(sets, numSets);
+
+    return rc;
+}
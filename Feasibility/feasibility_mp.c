@@ -0,0 +1,174 @@
+// Multi-core feasibility analysis of task sets loaded from CSV or JSON files
+//
+// Usage: feasibility_mp <tasksets.csv | tasksets.json> [-m cores] [-s set] [-p method] [-o affinity.csv]
+//
+// Every set is tested on m cores (default 4) by each method in feasmp.c, one CSV line per set:
+//
+//   set,n,U,ff_exact,bf_exact,ff_rmst,ff_rbound,gedf_gfb
+//
+// where the partitioned columns give the number of cores used, or 0 if the set does not fit on
+// m cores, and gedf_gfb is 1 if the set passes the global EDF bound on m cores.
+//
+// With -s the core assignment of the named set is printed for the chosen method, which is one
+// of ff, bf, rmst, rbound or gedf (default ff), and with -o it is also written as an affinity
+// file that seqgen4 can load with seq_load_affinity() in place of its own partitioning, e.g.
+//
+//   ./feasibility_mp seqgen4.csv -m 3 -s seqgen4 -p bf -o ../sequencer_generic/seqgen4_affinity.csv
+//
+// The periods and WCETs in the file only need consistent units, microseconds in seqgen4.csv.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+#define DEFAULT_CORES (4)
+
+typedef struct
+{
+    const char *name;
+    feasFit_t fit;
+    feasCoreTest_t test;
+} partitionMethod_t;
+
+static const partitionMethod_t methods[]=
+{
+    {"ff", FEAS_FIRST_FIT, FEAS_CORE_EXACT},
+    {"bf", FEAS_BEST_FIT, FEAS_CORE_EXACT},
+    {"rmst", FEAS_FIRST_FIT, FEAS_CORE_RMST},
+    {"rbound", FEAS_FIRST_FIT, FEAS_CORE_RBOUND}
+};
+
+#define NUM_METHODS (sizeof(methods) / sizeof(methods[0]))
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> [-m cores] [-s set] [-p ff|bf|rmst|rbound|gedf] [-o affinity.csv]\n", prog);
+}
+
+
+// Assign the set by the named method, returns the number of cores used or FEAS_ERROR
+static int assign_cores(taskSet_t *set, U32_T numCores, const char *method, int core[])
+{
+    U32_T i, m;
+
+    if(strcmp(method, "gedf") == 0)
+    {
+        for(i=0; i < set->numServices; i++)
+            core[i]=FEAS_CORE_NONE;
+
+        return feas_global_edf_gfb(set, numCores) ? (int)numCores : FEAS_ERROR;
+    }
+
+    for(m=0; m < NUM_METHODS; m++)
+        if(strcmp(method, methods[m].name) == 0)
+            return feas_partition_rm(set, numCores, methods[m].fit, methods[m].test, core);
+
+    printf("Unknown method %s\n", method);
+    return FEAS_ERROR;
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets, *chosen=NULL;
+    U32_T numCores=DEFAULT_CORES, maxServices=0, m, i;
+    int numSets, s, used, *core;
+    char *inFile=NULL, *setName=NULL, *method="ff", *outFile=NULL;
+
+    for(s=1; s < argc; s++)
+    {
+        if((strcmp(argv[s], "-m") == 0) && (s + 1 < argc))
+            numCores=atoi(argv[++s]);
+        else if((strcmp(argv[s], "-s") == 0) && (s + 1 < argc))
+            setName=argv[++s];
+        else if((strcmp(argv[s], "-p") == 0) && (s + 1 < argc))
+            method=argv[++s];
+        else if((strcmp(argv[s], "-o") == 0) && (s + 1 < argc))
+            outFile=argv[++s];
+        else if(inFile == NULL)
+            inFile=argv[s];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if((inFile == NULL) || (numCores == 0))
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    for(s=0; s < numSets; s++)
+    {
+        if(sets[s].numServices > maxServices)
+            maxServices=sets[s].numServices;
+
+        if((setName != NULL) && (strcmp(sets[s].name, setName) == 0))
+            chosen=&sets[s];
+    }
+
+    if((core=malloc((maxServices + 1) * sizeof(int))) == NULL)
+    {
+        feas_free_tasksets(sets, numSets);
+        exit(-1);
+    }
+
+    printf("set,n,U,ff_exact,bf_exact,ff_rmst,ff_rbound,gedf_gfb\n");
+
+    for(s=0; s < numSets; s++)
+    {
+        printf("%s,%u,%.4f", sets[s].name, sets[s].numServices,
+               feas_utilization(sets[s].numServices, sets[s].period, sets[s].wcet));
+
+        for(m=0; m < NUM_METHODS; m++)
+        {
+            used=feas_partition_rm(&sets[s], numCores, methods[m].fit, methods[m].test, core);
+            printf(",%d", (used == FEAS_ERROR) ? 0 : used);
+        }
+
+        printf(",%d\n", feas_global_edf_gfb(&sets[s], numCores));
+    }
+
+    if(setName != NULL)
+    {
+        if(chosen == NULL)
+        {
+            printf("\nNo set named %s in %s\n", setName, inFile);
+        }
+        else if((used=assign_cores(chosen, numCores, method, core)) == FEAS_ERROR)
+        {
+            printf("\n%s does not fit on %u cores by %s\n", chosen->name, numCores, method);
+        }
+        else
+        {
+            printf("\n%s by %s on %d of %u cores:\n", chosen->name, method, used, numCores);
+
+            for(i=0; i < chosen->numServices; i++)
+            {
+                if(core[i] == FEAS_CORE_NONE)
+                    printf("  service %u T=%u C=%u core=any\n", i, chosen->period[i], chosen->wcet[i]);
+                else
+                    printf("  service %u T=%u C=%u core=%d\n", i, chosen->period[i], chosen->wcet[i], core[i]);
+            }
+
+            if((outFile != NULL) && (feas_write_affinity(outFile, chosen, core, method) == FEAS_OK))
+                printf("Affinity written to %s\n", outFile);
+        }
+    }
+
+    free(core);
+    feas_free_tasksets(sets, numSets);
+
+    return 0;
+}
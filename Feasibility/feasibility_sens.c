@@ -0,0 +1,116 @@
+// Sensitivity analysis of task sets loaded from CSV or JSON files
+//
+// Usage: feasibility_sens <tasksets.csv | tasksets.json> [-p rm|dm|edf] [-s set]
+//
+// For each set the exact test for the policy (default rm) is run and the critical scaling
+// factor found by feassens.c, the largest factor all WCETs can be multiplied by with the set
+// still feasible, one CSV line per set:
+//
+//   set,n,U,feasible,scaling
+//
+// With -s each service of the named set is also searched on its own, for the longest WCET it
+// can have and the shortest period it can run at, which is the headroom left for that service
+// alone before the set becomes infeasible, e.g. for the services of seqv4l2.c:
+//
+//   ./feasibility_sens seqv4l2.csv -s seqv4l2
+//
+// A scaling below 1.0 means the set is infeasible and the WCETs must shrink by that factor.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+static const char *policyNames[]={"rm", "dm", "edf"};
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> [-p rm|dm|edf] [-s set]\n", prog);
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets, *set;
+    feasSensPolicy_t policy=FEAS_SENS_RM;
+    int numSets, i, p, feasible;
+    U32_T s, minPeriod;
+    double factor;
+    char *inFile=NULL, *setName=NULL;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-p") == 0) && (i + 1 < argc))
+        {
+            i++;
+            for(p=0; p < 3; p++)
+                if(strcmp(argv[i], policyNames[p]) == 0)
+                    policy=(feasSensPolicy_t)p;
+        }
+        else if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            setName=argv[++i];
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if(inFile == NULL)
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    printf("set,n,U,feasible,scaling\n");
+
+    for(i=0; i < numSets; i++)
+    {
+        set=&sets[i];
+
+        feasible=feas_set_feasible(set, policy);
+
+        if(feas_wcet_scaling(set, policy, FEAS_SENS_ALL, &factor) != FEAS_OK)
+            continue;
+
+        printf("%s,%u,%.4f,%d,%.4f\n", set->name, set->numServices,
+               feas_utilization(set->numServices, set->period, set->wcet), feasible, factor);
+
+        if((setName == NULL) || (strcmp(set->name, setName) != 0))
+            continue;
+
+        printf("\n%s under %s, each service on its own:\n\n", set->name, policyNames[policy]);
+        printf("%8s %10s %10s %10s %10s %8s %10s %10s\n", "service", "T", "C", "D", "max C", "C scale",
+               "min T", "T slack");
+
+        for(s=0; s < set->numServices; s++)
+        {
+            printf("%8u %10u %10u %10u", s, set->period[s], set->wcet[s], set->deadline[s]);
+
+            if(feas_wcet_scaling(set, policy, s, &factor) == FEAS_OK)
+                printf(" %10.0f %8.3f", factor * set->wcet[s], factor);
+            else
+                printf(" %10s %8s", "-", "-");
+
+            if(feas_min_period(set, policy, s, &minPeriod) == FEAS_OK)
+                printf(" %10u %9.1f%%\n", minPeriod,
+                       100.0 * ((double)set->period[s] - (double)minPeriod) / (double)set->period[s]);
+            else
+                printf(" %10s %10s\n", "none", "-");
+        }
+    }
+
+    feas_free_tasksets(sets, numSets);
+
+    return 0;
+}
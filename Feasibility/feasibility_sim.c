@@ -0,0 +1,165 @@
+// Schedule simulation of task sets loaded from CSV or JSON files
+//
+// Usage: feasibility_sim <tasksets.csv | tasksets.json> [-p rm|dm|edf|llf] [-s set] [-d duration]
+//                        [-c context switch] [-r seed] [-t trace.txt] [-j jobs.csv]
+//
+// Each set, or only the set named by -s, is simulated by feassim.c for one hyperperiod or for
+// -d time units, and a summary line printed per set.  With -s the per-service response times,
+// misses and blocking are printed as well, and -t and -j write the execution trace and one line
+// per job (see feaslib.h for the formats).
+//
+// Jitter and non-preemptive sections come from the optional 5th and 6th CSV columns, e.g.
+//
+//   set,period,wcet,deadline,jitter,np
+//   ex5,7,3,6,1,0
+//
+// Checking a hand drawn schedule, e.g. for ex3:
+//
+//   ./feasibility_sim examples.csv -s ex3 -t ex3.txt
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "feaslib.h"
+
+static const char *policyNames[]={"rm", "dm", "edf", "llf"};
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <tasksets.csv | tasksets.json> [-p rm|dm|edf|llf] [-s set] [-d duration]\n"
+           "       [-c context switch] [-r seed] [-t trace.txt] [-j jobs.csv]\n", prog);
+}
+
+
+static FILE *open_output(const char *fileName)
+{
+    FILE *fp;
+
+    if(fileName == NULL)
+        return NULL;
+
+    if((fp=fopen(fileName, "w")) == NULL)
+    {
+        perror(fileName);
+        exit(-1);
+    }
+
+    return fp;
+}
+
+
+int main(int argc, char *argv[])
+{
+    taskSet_t *sets;
+    feasSimConfig_t cfg;
+    feasSimResult_t result;
+    feasSimServiceStats_t *stats;
+    int numSets, i, p, simulated=0;
+    U32_T s;
+    char *inFile=NULL, *setName=NULL, *traceFile=NULL, *jobsFile=NULL;
+    struct timespec start, stop;
+    double sec;
+
+    memset(&cfg, 0, sizeof(cfg));
+    cfg.policy=FEAS_SIM_RM;
+    cfg.seed=1;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-p") == 0) && (i + 1 < argc))
+        {
+            i++;
+            for(p=0; p < 4; p++)
+                if(strcmp(argv[i], policyNames[p]) == 0)
+                    cfg.policy=(feasSimPolicy_t)p;
+        }
+        else if((strcmp(argv[i], "-s") == 0) && (i + 1 < argc))
+            setName=argv[++i];
+        else if((strcmp(argv[i], "-d") == 0) && (i + 1 < argc))
+            cfg.duration=strtoull(argv[++i], NULL, 10);
+        else if((strcmp(argv[i], "-c") == 0) && (i + 1 < argc))
+            cfg.contextSwitch=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-r") == 0) && (i + 1 < argc))
+            cfg.seed=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-t") == 0) && (i + 1 < argc))
+            traceFile=argv[++i];
+        else if((strcmp(argv[i], "-j") == 0) && (i + 1 < argc))
+            jobsFile=argv[++i];
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if(inFile == NULL)
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    if(feas_load_tasksets(inFile, &sets, &numSets) != FEAS_OK)
+    {
+        printf("Failed to load task sets from %s\n", inFile);
+        exit(-1);
+    }
+
+    cfg.trace=open_output(traceFile);
+    cfg.jobs=open_output(jobsFile);
+
+    if(cfg.jobs != NULL)
+        fprintf(cfg.jobs, "service,job,arrival,release,start,finish,response,blocked,missed\n");
+
+    printf("set,policy,duration,jobs,misses,switches,overhead,idle,sim_sec\n");
+
+    for(i=0; i < numSets; i++)
+    {
+        if((setName != NULL) && (strcmp(sets[i].name, setName) != 0))
+            continue;
+
+        clock_gettime(CLOCK_MONOTONIC, &start);
+
+        if(feas_simulate(&sets[i], &cfg, &result) != FEAS_OK)
+        {
+            printf("%s: simulation failed, the hyperperiod may be too long so give a duration with -d\n", sets[i].name);
+            continue;
+        }
+
+        clock_gettime(CLOCK_MONOTONIC, &stop);
+        sec=(stop.tv_sec - start.tv_sec) + ((stop.tv_nsec - start.tv_nsec) / 1000000000.0);
+        simulated++;
+
+        printf("%s,%s,%llu,%llu,%llu,%llu,%llu,%llu,%.3f\n", sets[i].name, policyNames[cfg.policy], result.duration,
+               result.jobs, result.misses, result.switches, result.overhead, result.idle, sec);
+
+        if(setName != NULL)
+        {
+            printf("\n%8s %8s %8s %8s %6s %6s %10s %8s %10s %10s %10s\n", "service", "T", "C", "D", "J", "np",
+                   "jobs", "misses", "avg R", "max R", "max B");
+
+            for(s=0; s < sets[i].numServices; s++)
+            {
+                stats=&result.service[s];
+                printf("%8u %8u %8u %8u %6u %6u %10llu %8llu %10.1f %10llu %10llu\n", s, sets[i].period[s],
+                       sets[i].wcet[s], sets[i].deadline[s], sets[i].jitter[s], sets[i].nonPreemptive[s],
+                       stats->jobs, stats->misses,
+                       (stats->jobs > 0) ? ((double)stats->sumResponse / (double)stats->jobs) : 0.0,
+                       stats->maxResponse, stats->maxBlocking);
+            }
+        }
+
+        free(result.service);
+    }
+
+    if(cfg.trace != NULL) fclose(cfg.trace);
+    if(cfg.jobs != NULL) fclose(cfg.jobs);
+
+    feas_free_tasksets(sets, numSets);
+
+    return (simulated > 0) ? 0 : -1;
+}
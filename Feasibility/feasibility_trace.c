@@ -0,0 +1,153 @@
+// Feasibility analysis of measured sequencer traces
+//
+// Usage: feasibility_trace <syslog.txt | trace.bin> [-b block] [-x exceedance] [-w observed|pwcet]
+//                          [-m min scaling] [-o taskset.csv]
+//
+// The period, jitter and execution times of each service are estimated from the trace by
+// feastrace.c, then the services with execution times are tested as one task set, in
+// microseconds, by the exact RM test and by EDF, and the critical scaling factor of feassens.c
+// gives the margin left.  Both tests include the measured release jitter, RM by response time
+// analysis with jitter and EDF with each deadline shortened by its jitter.  The WCET used is the pWCET (default) where the trace has enough jobs
+// for the Gumbel fit, or the largest observed execution time with -w observed.
+//
+// A binary trace comes from seqgen4 with trace=file, e.g.
+//
+//   sudo ../sequencer_generic/seqgen4 fifo 1000 trace=seqgen4.trace
+//   ./feasibility_trace seqgen4.trace -o measured.csv
+//
+// and the -o task set can be fed back to the other tools, e.g. feasibility_sim.  The exit status
+// is non-zero when the scaling factor is below -m (default 1.0, i.e. infeasible), so a build can
+// fail on a trace that has lost its margin.  The syslog traces of seqgen.c, such as
+// ../sequencer_generic/syslog-trace.txt, only have release times, so they give periods and
+// jitter but cannot be tested.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+#define DEFAULT_BLOCK_SIZE (20)
+#define DEFAULT_EXCEEDANCE (1.0e-9)
+
+
+static void usage(const char *prog)
+{
+    printf("Usage: %s <syslog.txt | trace.bin> [-b block] [-x exceedance] [-w observed|pwcet]\n"
+           "       [-m min scaling] [-o taskset.csv]\n", prog);
+}
+
+
+int main(int argc, char *argv[])
+{
+    feasTraceService_t *svc;
+    taskSet_t set;
+    FILE *out;
+    U32_T blockSize=DEFAULT_BLOCK_SIZE, period, wcet;
+    double exceedance=DEFAULT_EXCEEDANCE, minScaling=1.0, factor, c;
+    int numServices, i, usePwcet=TRUE, rm, edf, rc=0;
+    char *inFile=NULL, *outFile=NULL;
+
+    for(i=1; i < argc; i++)
+    {
+        if((strcmp(argv[i], "-b") == 0) && (i + 1 < argc))
+            blockSize=atoi(argv[++i]);
+        else if((strcmp(argv[i], "-x") == 0) && (i + 1 < argc))
+            exceedance=atof(argv[++i]);
+        else if((strcmp(argv[i], "-w") == 0) && (i + 1 < argc))
+            usePwcet=(strcmp(argv[++i], "observed") != 0);
+        else if((strcmp(argv[i], "-m") == 0) && (i + 1 < argc))
+            minScaling=atof(argv[++i]);
+        else if((strcmp(argv[i], "-o") == 0) && (i + 1 < argc))
+            outFile=argv[++i];
+        else if(inFile == NULL)
+            inFile=argv[i];
+        else
+        {
+            usage(argv[0]);
+            exit(-1);
+        }
+    }
+
+    if((inFile == NULL) || (blockSize == 0) || (exceedance <= 0.0) || (exceedance >= 1.0))
+    {
+        usage(argv[0]);
+        exit(-1);
+    }
+
+    if(feas_load_trace(inFile, blockSize, exceedance, &svc, &numServices) != FEAS_OK)
+    {
+        printf("Failed to load trace %s\n", inFile);
+        exit(-1);
+    }
+
+    printf("%-40s %8s %8s %12s %10s %10s %10s %10s %10s\n", "service", "releases", "jobs", "T us", "J us",
+           "mean C us", "max C us", "pWCET us", "max R us");
+
+    if(feas_alloc_taskset(&set, numServices) != FEAS_OK)
+        exit(-1);
+    strcpy(set.name, "trace");
+
+    for(i=0; i < numServices; i++)
+    {
+        printf("%-40s %8llu %8llu %12.1f %10.1f %10.1f %10.1f %10.1f %10.1f\n", svc[i].name, svc[i].releases,
+               svc[i].jobs, svc[i].periodUsec, svc[i].jitterUsec, svc[i].meanExecUsec, svc[i].wcetUsec,
+               svc[i].pwcetUsec, svc[i].maxResponseUsec);
+
+        // the pWCET is never used below the observed WCET
+        c=(usePwcet && (svc[i].pwcetUsec > svc[i].wcetUsec)) ? svc[i].pwcetUsec : svc[i].wcetUsec;
+        period=(U32_T)(svc[i].periodUsec + 0.5);
+        wcet=(U32_T)ceil(c);
+
+        if((period > 0) && (wcet > 0))
+            feas_append_task(&set, period, wcet, period, (U32_T)ceil(svc[i].jitterUsec), 0);
+    }
+
+    printf("\nBlock size %u, pWCET exceedance %g per block, WCET used: %s\n", blockSize, exceedance,
+           usePwcet ? "pWCET where available" : "observed");
+
+    if(set.numServices == 0)
+    {
+        printf("No execution times in %s, so the feasibility tests cannot be run\n", inFile);
+    }
+    else
+    {
+        rm=feas_set_feasible(&set, FEAS_SENS_RM);
+        edf=feas_set_feasible(&set, FEAS_SENS_EDF);
+        feas_wcet_scaling(&set, FEAS_SENS_RM, FEAS_SENS_ALL, &factor);
+
+        printf("%u services, U=%.4f, RM %s, EDF %s\n", set.numServices,
+               feas_utilization(set.numServices, set.period, set.wcet),
+               rm ? "feasible" : "INFEASIBLE", edf ? "feasible" : "INFEASIBLE");
+        printf("RM critical scaling %.3f, the WCETs can grow by %.1f%%\n", factor, (factor - 1.0) * 100.0);
+
+        if(factor < minScaling)
+        {
+            printf("MARGIN FAIL: scaling %.3f is below %.3f\n", factor, minScaling);
+            rc=-1;
+        }
+
+        if(outFile != NULL)
+        {
+            if((out=fopen(outFile, "w")) == NULL)
+            {
+                perror(outFile);
+            }
+            else
+            {
+                fprintf(out, "# measured from %s, in microseconds\n", inFile);
+                fprintf(out, "set,period,wcet,deadline,jitter\n");
+                for(i=0; i < (int)set.numServices; i++)
+                    fprintf(out, "%s,%u,%u,%u,%u\n", set.name, set.period[i], set.wcet[i], set.deadline[i], set.jitter[i]);
+                fclose(out);
+                printf("Task set written to %s\n", outFile);
+            }
+        }
+    }
+
+    feas_free_taskset(&set);
+    free(svc);
+
+    return rc;
+}
@@ -0,0 +1,520 @@
+// Task set file loading for feasibility_cli
+//
+// See feaslib.h for the CSV and JSON formats.  The JSON reader is a small recursive descent
+// parser for just the task set schema, so no JSON library is needed.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <limits.h>
+
+#include "feaslib.h"
+
+#define LINE_LEN (1024)
+#define INITIAL_TASKS (8)
+#define INITIAL_SETS (64)
+
+
+int feas_alloc_taskset(taskSet_t *set, U32_T numServices)
+{
+    if(numServices == 0) numServices=INITIAL_TASKS;
+
+    set->numServices=0;
+    set->capacity=numServices;
+    set->period=malloc(numServices * sizeof(U32_T));
+    set->wcet=malloc(numServices * sizeof(U32_T));
+    set->deadline=malloc(numServices * sizeof(U32_T));
+    set->jitter=malloc(numServices * sizeof(U32_T));
+    set->nonPreemptive=malloc(numServices * sizeof(U32_T));
+
+    if((set->period == NULL) || (set->wcet == NULL) || (set->deadline == NULL) ||
+       (set->jitter == NULL) || (set->nonPreemptive == NULL))
+        return FEAS_ERROR;
+
+    return FEAS_OK;
+}
+
+
+int feas_append_task(taskSet_t *set, U32_T period, U32_T wcet, U32_T deadline, U32_T jitter, U32_T nonPreemptive)
+{
+    if(set->numServices == set->capacity)
+    {
+        set->capacity*=2;
+        set->period=realloc(set->period, set->capacity * sizeof(U32_T));
+        set->wcet=realloc(set->wcet, set->capacity * sizeof(U32_T));
+        set->deadline=realloc(set->deadline, set->capacity * sizeof(U32_T));
+        set->jitter=realloc(set->jitter, set->capacity * sizeof(U32_T));
+        set->nonPreemptive=realloc(set->nonPreemptive, set->capacity * sizeof(U32_T));
+
+        if((set->period == NULL) || (set->wcet == NULL) || (set->deadline == NULL) ||
+           (set->jitter == NULL) || (set->nonPreemptive == NULL))
+            return FEAS_ERROR;
+    }
+
+    set->period[set->numServices]=period;
+    set->wcet[set->numServices]=wcet;
+    set->deadline[set->numServices]=(deadline == 0) ? period : deadline;
+    set->jitter[set->numServices]=jitter;
+    set->nonPreemptive[set->numServices]=(nonPreemptive > wcet) ? wcet : nonPreemptive;
+    set->numServices++;
+
+    return FEAS_OK;
+}
+
+
+void feas_free_taskset(taskSet_t *set)
+{
+    free(set->period);
+    free(set->wcet);
+    free(set->deadline);
+    free(set->jitter);
+    free(set->nonPreemptive);
+}
+
+
+void feas_free_tasksets(taskSet_t *sets, int numSets)
+{
+    int i;
+
+    for(i=0; i < numSets; i++)
+        feas_free_taskset(&sets[i]);
+
+    free(sets);
+}
+
+
+// Add a new empty set to the array, growing it as needed, and return it
+static taskSet_t *feas_new_set(taskSet_t **sets, int *numSets, int *maxSets, const char *name)
+{
+    taskSet_t *set;
+
+    if(*numSets == *maxSets)
+    {
+        *maxSets=(*maxSets == 0) ? INITIAL_SETS : (*maxSets * 2);
+        *sets=realloc(*sets, *maxSets * sizeof(taskSet_t));
+        if(*sets == NULL) return NULL;
+    }
+
+    set=&(*sets)[*numSets];
+    memset(set, 0, sizeof(taskSet_t));
+    strncpy(set->name, name, FEAS_NAME_LEN-1);
+
+    if(feas_alloc_taskset(set, 0) != FEAS_OK)
+        return NULL;
+
+    (*numSets)++;
+    return set;
+}
+
+
+// Parse a U32_T from text, digits after any white space with no sign, setting *end past them.
+// Returns FEAS_ERROR if there are no digits or the value is more than a U32_T holds.
+static int feas_parse_u32(const char *text, char **end, U32_T *value)
+{
+    unsigned long long v;
+
+    while(isspace((unsigned char)*text)) text++;
+    *end=(char *)text;
+
+    if(!isdigit((unsigned char)*text))
+        return FEAS_ERROR;
+
+    errno=0;
+    v=strtoull(text, end, 10);
+    if((errno == ERANGE) || (v > UINT_MAX))
+        return FEAS_ERROR;
+
+    *value=(U32_T)v;
+    return FEAS_OK;
+}
+
+
+int feas_load_csv(const char *fileName, taskSet_t **sets, int *numSets)
+{
+    FILE *fp;
+    char line[LINE_LEN], name[FEAS_NAME_LEN], *field, *end, *badField;
+    U32_T value[5];
+    int maxSets=0, lineNum=0, dataLines=0, nvalues;
+    taskSet_t *set=NULL;
+
+    *sets=NULL; *numSets=0;
+
+    if((fp=fopen(fileName, "r")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    while(fgets(line, LINE_LEN, fp) != NULL)
+    {
+        lineNum++;
+
+        if((line[0] == '#') || (line[0] == '\n') || (line[0] == '\r'))
+            continue;
+
+        dataLines++;
+
+        // set name
+        if((field=strtok(line, ",")) == NULL)
+            continue;
+        while(isspace((unsigned char)*field)) field++;
+        strncpy(name, field, FEAS_NAME_LEN-1);
+        name[FEAS_NAME_LEN-1]='\0';
+
+        // period, wcet and optional deadline, jitter and non-preemptive section, each a whole
+        // number with nothing but white space after it
+        value[2]=0; value[3]=0; value[4]=0;
+        badField=NULL;
+        for(nvalues=0; (nvalues < 5) && ((field=strtok(NULL, ",\r\n")) != NULL); nvalues++)
+        {
+            if((feas_parse_u32(field, &end, &value[nvalues]) != FEAS_OK) || (end[strspn(end, " \t")] != '\0'))
+            {
+                badField=field;
+                break;
+            }
+        }
+
+        // a header line has no number in it, otherwise it is a format error
+        if((nvalues == 0) && (badField != NULL) && (dataLines == 1))
+            continue;
+
+        if(badField != NULL)
+        {
+            printf("%s:%d: \"%s\" is not a whole number from 0 to %u\n", fileName, lineNum, badField, UINT_MAX);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        if(nvalues < 2)
+        {
+            printf("%s:%d: expected set,period,wcet[,deadline[,jitter[,np]]]\n", fileName, lineNum);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        if((value[0] == 0) || (value[1] == 0))
+        {
+            printf("%s:%d: period and wcet must be positive\n", fileName, lineNum);
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+
+        if((set == NULL) || (strcmp(set->name, name) != 0))
+        {
+            if((set=feas_new_set(sets, numSets, &maxSets, name)) == NULL)
+            {
+                fclose(fp);
+                return FEAS_ERROR;
+            }
+        }
+
+        if(feas_append_task(set, value[0], value[1], value[2], value[3], value[4]) != FEAS_OK)
+        {
+            fclose(fp);
+            return FEAS_ERROR;
+        }
+    }
+
+    fclose(fp);
+    return FEAS_OK;
+}
+
+
+// Minimal JSON reader for the task set schema
+typedef struct
+{
+    const char *text;
+    const char *pos;
+    const char *fileName;
+} jsonParser_t;
+
+
+static void json_skip_ws(jsonParser_t *p)
+{
+    while(isspace((unsigned char)*p->pos)) p->pos++;
+}
+
+
+// line of the file the parser is at, from 1
+static int json_line(jsonParser_t *p)
+{
+    const char *c;
+    int line=1;
+
+    for(c=p->text; c < p->pos; c++)
+        if(*c == '\n') line++;
+
+    return line;
+}
+
+
+static int json_expect(jsonParser_t *p, char c)
+{
+    json_skip_ws(p);
+
+    if(*p->pos != c)
+    {
+        printf("%s:%d: expected '%c'\n", p->fileName, json_line(p), c);
+        return FEAS_ERROR;
+    }
+
+    p->pos++;
+    return FEAS_OK;
+}
+
+
+static int json_string(jsonParser_t *p, char *out, int maxLen)
+{
+    int len=0;
+
+    if(json_expect(p, '"') != FEAS_OK) return FEAS_ERROR;
+
+    while((*p->pos != '"') && (*p->pos != '\0'))
+    {
+        if((*p->pos == '\\') && (p->pos[1] != '\0')) p->pos++;
+        if(len < (maxLen - 1)) out[len++]=*p->pos;
+        p->pos++;
+    }
+
+    out[len]='\0';
+    return json_expect(p, '"');
+}
+
+
+// a whole number from 0 to the most a U32_T holds, ended by white space, ',' or '}'
+static int json_number(jsonParser_t *p, U32_T *value)
+{
+    char *end;
+
+    json_skip_ws(p);
+
+    if((feas_parse_u32(p->pos, &end, value) != FEAS_OK) ||
+       ((*end != '\0') && !isspace((unsigned char)*end) && (*end != ',') && (*end != '}')))
+    {
+        printf("%s:%d: expected a whole number from 0 to %u\n", p->fileName, json_line(p), UINT_MAX);
+        return FEAS_ERROR;
+    }
+
+    p->pos=end;
+    return FEAS_OK;
+}
+
+
+// Skip any value for keys that are not part of the schema
+static int json_skip_value(jsonParser_t *p)
+{
+    int depth=0, inString=FALSE;
+
+    json_skip_ws(p);
+
+    while(*p->pos != '\0')
+    {
+        if(inString)
+        {
+            if((*p->pos == '\\') && (p->pos[1] != '\0')) p->pos++;
+            else if(*p->pos == '"') inString=FALSE;
+        }
+        else if(*p->pos == '"') inString=TRUE;
+        else if((*p->pos == '{') || (*p->pos == '[')) depth++;
+        else if((*p->pos == '}') || (*p->pos == ']'))
+        {
+            // end of the enclosing object or array
+            if(depth == 0) return FEAS_OK;
+            depth--;
+        }
+        else if((*p->pos == ',') && (depth == 0)) return FEAS_OK;
+
+        p->pos++;
+    }
+
+    return FEAS_ERROR;
+}
+
+
+static int json_task(jsonParser_t *p, taskSet_t *set)
+{
+    char key[FEAS_NAME_LEN];
+    U32_T value, period=0, wcet=0, deadline=0, jitter=0, nonPreemptive=0;
+
+    if(json_expect(p, '{') != FEAS_OK) return FEAS_ERROR;
+
+    json_skip_ws(p);
+    while(*p->pos != '}')
+    {
+        if(json_string(p, key, FEAS_NAME_LEN) != FEAS_OK) return FEAS_ERROR;
+        if(json_expect(p, ':') != FEAS_OK) return FEAS_ERROR;
+
+        if(!strcmp(key, "period") || !strcmp(key, "T") || !strcmp(key, "wcet") || !strcmp(key, "C") ||
+           !strcmp(key, "deadline") || !strcmp(key, "D") || !strcmp(key, "jitter") || !strcmp(key, "J") ||
+           !strcmp(key, "np"))
+        {
+            if(json_number(p, &value) != FEAS_OK) return FEAS_ERROR;
+
+            if(!strcmp(key, "period") || !strcmp(key, "T")) period=value;
+            else if(!strcmp(key, "wcet") || !strcmp(key, "C")) wcet=value;
+            else if(!strcmp(key, "deadline") || !strcmp(key, "D")) deadline=value;
+            else if(!strcmp(key, "jitter") || !strcmp(key, "J")) jitter=value;
+            else nonPreemptive=value;
+        }
+        else if(json_skip_value(p) != FEAS_OK) return FEAS_ERROR;
+
+        json_skip_ws(p);
+        if(*p->pos == ',') p->pos++;
+        json_skip_ws(p);
+    }
+    p->pos++;
+
+    if((period == 0) || (wcet == 0))
+    {
+        printf("%s:%d: set %s: task needs a positive period and wcet\n", p->fileName, json_line(p), set->name);
+        return FEAS_ERROR;
+    }
+
+    return feas_append_task(set, period, wcet, deadline, jitter, nonPreemptive);
+}
+
+
+static int json_taskset(jsonParser_t *p, taskSet_t *set)
+{
+    char key[FEAS_NAME_LEN];
+
+    if(json_expect(p, '{') != FEAS_OK) return FEAS_ERROR;
+
+    json_skip_ws(p);
+    while(*p->pos != '}')
+    {
+        if(json_string(p, key, FEAS_NAME_LEN) != FEAS_OK) return FEAS_ERROR;
+        if(json_expect(p, ':') != FEAS_OK) return FEAS_ERROR;
+
+        if(!strcmp(key, "name"))
+        {
+            if(json_string(p, set->name, FEAS_NAME_LEN) != FEAS_OK) return FEAS_ERROR;
+        }
+        else if(!strcmp(key, "tasks"))
+        {
+            if(json_expect(p, '[') != FEAS_OK) return FEAS_ERROR;
+
+            json_skip_ws(p);
+            while(*p->pos != ']')
+            {
+                if(json_task(p, set) != FEAS_OK) return FEAS_ERROR;
+                json_skip_ws(p);
+                if(*p->pos == ',') p->pos++;
+                json_skip_ws(p);
+            }
+            p->pos++;
+        }
+        else if(json_skip_value(p) != FEAS_OK) return FEAS_ERROR;
+
+        json_skip_ws(p);
+        if(*p->pos == ',') p->pos++;
+        json_skip_ws(p);
+    }
+    p->pos++;
+
+    return FEAS_OK;
+}
+
+
+int feas_load_json(const char *fileName, taskSet_t **sets, int *numSets)
+{
+    FILE *fp;
+    long size;
+    char *text, defaultName[FEAS_NAME_LEN];
+    int maxSets=0, rc=FEAS_OK;
+    jsonParser_t parser;
+    taskSet_t *set;
+
+    *sets=NULL; *numSets=0;
+
+    if((fp=fopen(fileName, "r")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    fseek(fp, 0, SEEK_END);
+    size=ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+
+    if((text=malloc(size + 1)) == NULL)
+    {
+        fclose(fp);
+        return FEAS_ERROR;
+    }
+
+    size=fread(text, 1, size, fp);
+    text[size]='\0';
+    fclose(fp);
+
+    parser.text=text; parser.pos=text; parser.fileName=fileName;
+
+    if(json_expect(&parser, '[') != FEAS_OK)
+    {
+        free(text);
+        return FEAS_ERROR;
+    }
+
+    json_skip_ws(&parser);
+    while(*parser.pos != ']')
+    {
+        snprintf(defaultName, FEAS_NAME_LEN, "set%d", *numSets);
+
+        if(((set=feas_new_set(sets, numSets, &maxSets, defaultName)) == NULL) ||
+           (json_taskset(&parser, set) != FEAS_OK))
+        {
+            rc=FEAS_ERROR;
+            break;
+        }
+
+        json_skip_ws(&parser);
+        if(*parser.pos == ',') parser.pos++;
+        json_skip_ws(&parser);
+
+        if(*parser.pos == '\0')
+        {
+            printf("%s: unterminated array\n", fileName);
+            rc=FEAS_ERROR;
+            break;
+        }
+    }
+
+    free(text);
+    return rc;
+}
+
+
+// Choose the loader by file extension, CSV unless the name ends in .json
+int feas_load_tasksets(const char *fileName, taskSet_t **sets, int *numSets)
+{
+    const char *ext=strrchr(fileName, '.');
+
+    if((ext != NULL) && (strcmp(ext, ".json") == 0))
+        return feas_load_json(fileName, sets, numSets);
+    else
+        return feas_load_csv(fileName, sets, numSets);
+}
+
+
+int feas_write_affinity(const char *fileName, taskSet_t *set, int core[], const char *method)
+{
+    FILE *fp;
+    U32_T i;
+
+    if((fp=fopen(fileName, "w")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    fprintf(fp, "# core assignment for %s by %s, core -1 is any core\n", set->name, method);
+    fprintf(fp, "service,period,wcet,core\n");
+
+    for(i=0; i < set->numServices; i++)
+        fprintf(fp, "%u,%u,%u,%d\n", i, set->period[i], set->wcet[i], core[i]);
+
+    fclose(fp);
+    return FEAS_OK;
+}
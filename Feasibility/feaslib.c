@@ -0,0 +1,684 @@
+// Sam Siewert, August 2020 - feasibility tests from feasibility_tests.c
+//
+// Library version of the RM LUB, scheduling point and completion time tests.  See
+// feasibility_tests.c for the original references and discussion of each test.
+//
+// Changes from the original example code:
+//
+// 1) No printing, so the tests can be run in bulk by feasibility_cli.
+// 2) Ceilings are computed in integer arithmetic, ceil(a/b) = (a + b - 1) / b, rather than with
+//    floating point ceil() and floor(), and sums are 64 bit so they cannot overflow.
+// 3) Both exact tests return as soon as one service is found infeasible, and the completion
+//    time iteration stops as soon as the response time passes the deadline, so an overloaded
+//    set (U > 1) can no longer iterate without bound.
+//
+// Faster exact tests for large sets, which give the same answers as the two above:
+//
+// 1) feas_response_time_analysis - completion time test seeded with R(i-1) + C(i) rather than
+//    the sum of C(j), which saves most of the iterations for low priority services, and which
+//    keeps the response times so a caller can re-analyze from the first changed service.
+// 2) feas_hyperplane_feasibility - scheduling point test over the reduced point set of
+//    Bini and Buttazzo, searched depth first with utilization bound pruning, rather than every
+//    l*T(k) up to T(i), whose number grows with the period ratios.
+//
+// Both keep the job counts ceil(t/T(j)) of the higher priority services from one iteration, and
+// one service, to the next.  The response times grow down the priority order, as do the
+// deadlines under RM with D = T, so each count only moves up, by one release in nearly every
+// step, and an iteration is a compare per service rather than a 64 bit division.  Over a set
+// the divisions drop from one per service pair and iteration to about one per service, which
+// the original tests spend their time on.  The hyperplane test first bounds the demand at the
+// deadline by U D + the sum of C(j), from prefix sums without any counts, then tries the
+// deadline itself, as the original scheduling point test does, and only searches the reduced
+// point set for a service whose demand at its deadline is too high.
+//
+// feas_bench measures all four.  The hyperplane test is the faster of the two scheduling point
+// tests at every size, and response time analysis the faster of the two completion time tests
+// from about 50 services, with no gain below that, where both take about 3 iterations per
+// service and the counts save little.
+//
+// Bini, Enrico, and Giorgio C. Buttazzo. "Schedulability analysis of periodic fixed priority systems."
+// IEEE Transactions on Computers 53.11 (2004): 1462-1473.
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "feaslib.h"
+
+#define CEIL_DIV(a, b) (((a) + (b) - 1) / (b))
+
+// search size for one service before the hyperplane test falls back to its response time
+#define FEAS_HYPERPLANE_MAX_NODES (5000)
+
+// sets up to this size keep their job counts on the stack rather than the heap
+#define FEAS_STACK_COUNTS (64)
+
+// busy period iterations before QPA treats the set as overloaded
+#define FEAS_QPA_MAX_BUSY_ITERATIONS (1000000)
+
+
+double feas_utilization(U32_T numServices, U32_T period[], U32_T wcet[])
+{
+    double utility_sum=0.0;
+    U32_T idx;
+
+    // Sum the C(i) over the T(i)
+    for(idx=0; idx < numServices; idx++)
+        utility_sum += ((double)wcet[idx] / (double)period[idx]);
+
+    return utility_sum;
+}
+
+
+// With D < T the bound is applied to the density, C(i) over the lesser of D(i) and T(i), which
+// is sufficient for deadline monotonic priorities and the same as the utilization when D = T.
+int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+    double utility_sum=0.0, lub=0.0;
+    U32_T idx;
+
+    for(idx=0; idx < numServices; idx++)
+        utility_sum += ((double)wcet[idx] / (double)((deadline[idx] < period[idx]) ? deadline[idx] : period[idx]));
+
+    // Compute LUB for number of services
+    lub = (double)numServices * (pow(2.0, (1.0/((double)numServices))) - 1.0);
+
+    // Compare the utilty to the bound and return feasibility
+    if(utility_sum <= lub)
+        return TRUE;
+    else
+        return FALSE;
+}
+
+
+int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+    U32_T i, j;
+    unsigned long long an, anext;
+
+    // For all services in the analysis
+    for (i=0; i < numServices; i++)
+    {
+        an=0;
+
+        for (j=0; j <= i; j++)
+            an+=wcet[j];
+
+        // iterate to the fixed point, or until the deadline is already passed
+        while(an <= deadline[i])
+        {
+            anext=wcet[i];
+
+            for (j=0; j < i; j++)
+                anext += CEIL_DIV(an, (unsigned long long)period[j]) * wcet[j];
+
+            if (anext == an)
+                break;
+            else
+                an=anext;
+        }
+
+        if (an > deadline[i])
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+// The scheduling points of service i are the multiples l*T(k) up to D(i), and D(i) itself,
+// which with D = T are the l*T(k) up to T(i) of the original test.
+int scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+    U32_T i, j, k, l, lmax;
+    unsigned long long temp, point;
+    int status;
+
+    // For all services in the analysis
+    for (i=0; i < numServices; i++) // iterate from highest to lowest priority
+    {
+        status=0;
+
+        // the deadline itself, the last point at which the service may complete
+        point=deadline[i];
+        temp=0;
+        for (j=0; (j<=i) && (temp <= point); j++)
+            temp += wcet[j] * CEIL_DIV(point, (unsigned long long)period[j]);
+        if (temp <= point)
+            status=1;
+
+        // Look for all available CPU minus what has been used by higher priority services
+        for (k=0; (k<=i) && !status; k++)
+        {
+            lmax=deadline[i]/period[k];
+
+            // find available CPU windows and take them
+            for (l=1; l <= lmax; l++)
+            {
+                point=(unsigned long long)l*period[k];
+                temp=0;
+
+                for (j=0; (j<=i) && (temp <= point); j++)
+                    temp += wcet[j] * CEIL_DIV(point, (unsigned long long)period[j]);
+
+                // Can we get the CPU we need or not?
+                if (temp <= point)
+                {
+                    // sufficient CPU during our period, therefore feasible
+                    status=1;
+                    break;
+                }
+            }
+        }
+
+        if (!status)
+            return FALSE;
+    }
+
+    return TRUE;
+}
+
+
+// Insertion sort of all the service arrays by key, which is one of them.  Insertion sort is
+// stable, so services with equal keys keep their order in the file.
+static void feas_sort_by(taskSet_t *set, U32_T *key)
+{
+    U32_T i, j, k, t, c, d, jit, np;
+
+    for(i=1; i < set->numServices; i++)
+    {
+        k=key[i];
+        t=set->period[i]; c=set->wcet[i]; d=set->deadline[i]; jit=set->jitter[i]; np=set->nonPreemptive[i];
+
+        for(j=i; (j > 0) && (key[j-1] > k); j--)
+        {
+            set->period[j]=set->period[j-1];
+            set->wcet[j]=set->wcet[j-1];
+            set->deadline[j]=set->deadline[j-1];
+            set->jitter[j]=set->jitter[j-1];
+            set->nonPreemptive[j]=set->nonPreemptive[j-1];
+        }
+
+        set->period[j]=t; set->wcet[j]=c; set->deadline[j]=d; set->jitter[j]=jit; set->nonPreemptive[j]=np;
+    }
+}
+
+
+// Sort into rate monotonic priority order, shortest period first
+void feas_sort_rm(taskSet_t *set)
+{
+    feas_sort_by(set, set->period);
+}
+
+
+// Job counts cnt[j] = ceil(t/T(j)) of services 0 to n-1 at t, and their demand, the sum of
+// cnt[j] * C(j), moved up from an earlier t.  Nearly every count that moves moves by one
+// release, which needs no division.
+static void feas_advance_counts(U32_T n, U32_T period[], U32_T wcet[], unsigned long long t,
+                                unsigned long long cnt[], unsigned long long *demand)
+{
+    unsigned long long c;
+    U32_T j;
+
+    for(j=0; j < n; j++)
+    {
+        if(t <= cnt[j] * period[j])
+            continue;
+
+        if(t <= (cnt[j] + 1) * period[j])
+            c=cnt[j] + 1;
+        else
+            c=CEIL_DIV(t, (unsigned long long)period[j]);
+
+        *demand+=(c - cnt[j]) * wcet[j];
+        cnt[j]=c;
+    }
+}
+
+
+// Fixed point iteration for the response time of service i, starting from seed, which must be
+// no larger than the true response time.  Returns the response time, or a value above
+// deadline[i] as soon as the iteration passes it.
+static unsigned long long feas_iterate_response(U32_T i, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                                unsigned long long seed)
+{
+    unsigned long long r=seed, next;
+    U32_T j;
+
+    while(r <= deadline[i])
+    {
+        next=wcet[i];
+
+        for(j=0; (j < i) && (next <= deadline[i]); j++)
+            next += CEIL_DIV(r, (unsigned long long)period[j]) * wcet[j];
+
+        if(next == r)
+            break;
+
+        r=next;
+    }
+
+    return r;
+}
+
+
+int feas_response_time_analysis(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                U32_T response[], U32_T firstService)
+{
+    unsigned long long r, next, demand=0, stackCnt[FEAS_STACK_COUNTS]={0}, *cnt=stackCnt;
+    U32_T i;
+
+    if((numServices > FEAS_STACK_COUNTS) &&
+       ((cnt=calloc(numServices, sizeof(unsigned long long))) == NULL))
+        return FEAS_ERROR;
+
+    for(i=firstService; i < numServices; i++)
+    {
+        // R(i) >= R(i-1) + C(i), since everything that delays service i-1 also delays service i
+        r=(i == 0) ? wcet[0] : ((unsigned long long)response[i-1] + wcet[i]);
+
+        // the interference at r of services 0 to i-1, from their counts at R(i-1)
+        for(;;)
+        {
+            feas_advance_counts(i, period, wcet, r, cnt, &demand);
+            next=wcet[i] + demand;
+
+            if((next == r) || (next > deadline[i]))
+                break;
+
+            r=next;
+        }
+
+        r=next;
+
+        if(r > deadline[i])
+        {
+            response[i]=(r > 0xffffffffULL) ? 0xffffffff : (U32_T)r;
+            if(cnt != stackCnt) free(cnt);
+            return FALSE;
+        }
+
+        response[i]=(U32_T)r;
+    }
+
+    if(cnt != stackCnt) free(cnt);
+    return TRUE;
+}
+
+
+// Response time analysis with release jitter (Audsley et al. 1993, Tindell and Clark 1994).  A
+// higher priority service released late, then on time, can interfere J(j) earlier than its
+// period alone allows, and the response is measured from the arrival, J(i) before the release:
+//
+//   w(i) = C(i) + sum over j < i of ceil((w(i) + J(j)) / T(j)) * C(j),   R(i) = J(i) + w(i) <= D(i)
+//
+// With every J = 0 this is feas_response_time_analysis().
+int feas_response_time_jitter(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                              U32_T jitter[], U32_T response[])
+{
+    unsigned long long w, next, limit;
+    U32_T i, j;
+
+    for(i=0; i < numServices; i++)
+    {
+        if(jitter[i] >= deadline[i])
+        {
+            response[i]=0xffffffff;
+            return FALSE;
+        }
+
+        limit=deadline[i] - jitter[i];
+        w=wcet[i];
+
+        while(w <= limit)
+        {
+            next=wcet[i];
+
+            for(j=0; (j < i) && (next <= limit); j++)
+                next += CEIL_DIV(w + jitter[j], (unsigned long long)period[j]) * wcet[j];
+
+            if(next == w)
+                break;
+
+            w=next;
+        }
+
+        if(w > limit)
+        {
+            response[i]=0xffffffff;
+            return FALSE;
+        }
+
+        response[i]=(U32_T)(w + jitter[i]);
+    }
+
+    return TRUE;
+}
+
+
+// Branch and bound search of the Bini-Buttazzo reduced scheduling point set.
+//
+// Returns TRUE if some point t in P_k(b) has W_k(t) + (b - t) <= budget, where W_k(t) is the
+// demand of the k highest priority services in [0, t].  Each level either keeps b, charging
+// ceil(b/T) jobs of service k-1, or moves down to the last release floor(b/T)*T before b,
+// charging the idle gap in between.  A level whose utilization bound already exceeds the
+// budget cannot contain a feasible point and is pruned.
+static int feas_hyperplane_search(U32_T k, unsigned long long b, long long budget, U32_T period[],
+                                  U32_T wcet[], double utilPrefix[], unsigned long *nodes)
+{
+    unsigned long long f, c, t;
+    double lb;
+    int rc;
+    U32_T m;
+
+    if(budget < 0)
+        return FALSE;
+
+    if(k == 0)
+        return TRUE;
+
+    if(++(*nodes) > FEAS_HYPERPLANE_MAX_NODES)
+        return FEAS_ERROR;
+
+    // W_k(t) + (b - t) >= U_k * t + (b - t) >= min(U_k, 1) * b for every t <= b
+    lb=((utilPrefix[k] < 1.0) ? utilPrefix[k] : 1.0) * (double)b;
+    if(lb > (double)budget + 1e-6)
+        return FALSE;
+
+    m=k-1;
+    f=b / period[m];
+    c=CEIL_DIV(b, (unsigned long long)period[m]);
+
+    rc=feas_hyperplane_search(m, b, budget - (long long)(c * wcet[m]), period, wcet, utilPrefix, nodes);
+    if(rc != FALSE)
+        return rc;
+
+    // the lower point is only distinct when b is not a release of service m, and t=0 is not a point
+    t=f * period[m];
+    if((f == 0) || (t == b))
+        return FALSE;
+
+    return feas_hyperplane_search(m, t, budget - (long long)(b - t) - (long long)(f * wcet[m]),
+                                  period, wcet, utilPrefix, nodes);
+}
+
+
+int feas_hyperplane_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+    double *utilPrefix;
+    unsigned long nodes;
+    unsigned long long r, demand=0, last=0, wcetSum=0, *cnt;
+    U32_T i, j;
+    int rc=TRUE, found;
+
+    utilPrefix=malloc((numServices + 1) * sizeof(double));
+    cnt=calloc(numServices + 1, sizeof(unsigned long long));
+
+    if((utilPrefix == NULL) || (cnt == NULL))
+    {
+        free(utilPrefix); free(cnt);
+        return FEAS_ERROR;
+    }
+
+    utilPrefix[0]=0.0;
+    for(i=0; i < numServices; i++)
+        utilPrefix[i+1]=utilPrefix[i] + ((double)wcet[i] / (double)period[i]);
+
+    for(i=0; (i < numServices) && (rc == TRUE); i++)
+    {
+        if(wcet[i] > deadline[i])
+        {
+            rc=FALSE;
+            break;
+        }
+
+        // ceil(D/T) < D/T + 1, so W(D) < U D + sum of C(j) bounds the demand without the counts
+        wcetSum+=wcet[i];
+        if((utilPrefix[i+1] * (double)deadline[i]) + (double)wcetSum <= (double)deadline[i])
+            continue;
+
+        // the demand at the deadline, from the counts at the last deadline unless it was later
+        if(deadline[i] < last)
+        {
+            for(j=0; j < numServices; j++)
+                cnt[j]=0;
+            demand=0;
+        }
+        last=deadline[i];
+
+        feas_advance_counts(i + 1, period, wcet, deadline[i], cnt, &demand);
+        if(demand <= deadline[i])
+            continue;
+
+        nodes=0;
+        found=feas_hyperplane_search(i, deadline[i], (long long)deadline[i] - wcet[i],
+                                     period, wcet, utilPrefix, &nodes);
+
+        // pathological sets can still need exponentially many points, so fall back to the
+        // response time for this service when the search gets too large
+        if(found == FEAS_ERROR)
+        {
+            for(r=0, j=0; j <= i; j++)
+                r+=wcet[j];
+
+            found=(feas_iterate_response(i, period, wcet, deadline, r) <= deadline[i]) ? TRUE : FALSE;
+        }
+
+        if(found != TRUE)
+            rc=FALSE;
+    }
+
+    free(utilPrefix); free(cnt);
+    return rc;
+}
+
+
+// Deadline monotonic priority order, shortest relative deadline first, which is the optimal
+// fixed priority order when D <= T (Leung and Whitehead)
+void feas_sort_dm(taskSet_t *set)
+{
+    feas_sort_by(set, set->deadline);
+}
+
+
+// Processor demand h(t), the execution time of all jobs released at or after 0 with deadlines
+// at or before t, for synchronous release
+static unsigned long long feas_demand(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                      unsigned long long t)
+{
+    unsigned long long h=0;
+    U32_T i;
+
+    for(i=0; i < numServices; i++)
+        if(t >= deadline[i])
+            h+=(((t - deadline[i]) / period[i]) + 1) * wcet[i];
+
+    return h;
+}
+
+
+// Largest absolute deadline k*T(i) + D(i) strictly before t, or 0 if there is none
+static unsigned long long feas_prev_deadline(U32_T numServices, U32_T period[], U32_T deadline[],
+                                             unsigned long long t)
+{
+    unsigned long long d, dmax=0;
+    U32_T i;
+
+    for(i=0; i < numServices; i++)
+    {
+        if(t <= deadline[i]) continue;
+
+        d=(((t - deadline[i] - 1) / period[i]) * period[i]) + deadline[i];
+        if(d > dmax) dmax=d;
+    }
+
+    return dmax;
+}
+
+
+// EDF processor demand test with Quick Processor-demand Analysis (Zhang and Burns).  Rather than
+// checking h(t) <= t at every absolute deadline up to the bound L, QPA steps backwards from L,
+// jumping straight to h(t) whenever h(t) < t, which skips most deadlines.  The set is EDF
+// feasible iff the walk ends with h(t) <= the smallest relative deadline.
+//
+// L is the smaller of the synchronous busy period and, for U < 1, the bound of Zhang and Burns
+// max(D(i), sum((T(i) - D(i)) U(i)) / (1 - U)).
+//
+// Zhang, Fengxiang, and Alan Burns. "Schedulability analysis for real-time systems with EDF
+// scheduling." IEEE Transactions on Computers 58.9 (2009): 1250-1258.
+int feas_edf_qpa_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[])
+{
+    unsigned long long busy, next, t, h, dmin, dmax=0, la;
+    double u, laBound=0.0;
+    U32_T i, iter;
+
+    if(numServices == 0)
+        return TRUE;
+
+    // U > 1 is never feasible
+    u=feas_utilization(numServices, period, wcet);
+    if(u > 1.0 + 1e-9)
+        return FALSE;
+
+    dmin=deadline[0];
+    for(i=0; i < numServices; i++)
+    {
+        if(wcet[i] > deadline[i]) return FALSE;
+        if(deadline[i] < dmin) dmin=deadline[i];
+        if(deadline[i] > dmax) dmax=deadline[i];
+    }
+
+    // synchronous busy period, which converges for U <= 1.  U within rounding of 1 but above it
+    // would grow without bound, so give up after FEAS_QPA_MAX_BUSY_ITERATIONS.
+    for(busy=0, i=0; i < numServices; i++)
+        busy+=wcet[i];
+
+    for(iter=0; iter < FEAS_QPA_MAX_BUSY_ITERATIONS; iter++)
+    {
+        for(next=0, i=0; i < numServices; i++)
+            next+=CEIL_DIV(busy, (unsigned long long)period[i]) * wcet[i];
+
+        if(next == busy)
+            break;
+
+        busy=next;
+    }
+
+    if(iter == FEAS_QPA_MAX_BUSY_ITERATIONS)
+        return FALSE;
+
+    t=busy;
+
+    if(u < 1.0 - 1e-9)
+    {
+        for(i=0; i < numServices; i++)
+            if(period[i] > deadline[i])
+                laBound+=(double)(period[i] - deadline[i]) * ((double)wcet[i] / (double)period[i]);
+
+        la=(unsigned long long)ceil(laBound / (1.0 - u));
+        if(la < dmax) la=dmax;
+        if(la < t) t=la;
+    }
+
+    // start from the last absolute deadline at or before the bound L
+    t=feas_prev_deadline(numServices, period, deadline, t + 1);
+    h=feas_demand(numServices, period, wcet, deadline, t);
+
+    while((h <= t) && (h > dmin))
+    {
+        if(h < t)
+            t=h;
+        else
+            t=feas_prev_deadline(numServices, period, deadline, t);
+
+        h=feas_demand(numServices, period, wcet, deadline, t);
+    }
+
+    return (h <= dmin) ? TRUE : FALSE;
+}
+
+
+// Least laxity first in integer time steps over the hyperperiod, with synchronous release and
+// D <= T so that at most one job of each service is active.  Laxity is D - t - remaining, and
+// ties go to the lower service index.  Returns TRUE with no deadline miss, FALSE on a miss, or
+// FEAS_ERROR if the hyperperiod exceeds maxTime.
+//
+// LLF is optimal on one core, like EDF, so this agrees with feas_edf_qpa_feasibility() but
+// switches context far more often, which is what the simulation is for (see switches).
+int feas_llf_simulate(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                      unsigned long long maxTime, unsigned long long *switches)
+{
+    unsigned long long hyper=1, t, g, a, b, *absDeadline, *remaining;
+    long long laxity, best;
+    U32_T i;
+    int run, last=-1, rc=TRUE;
+
+    for(i=0; i < numServices; i++)
+    {
+        // lcm, stopping once past maxTime so it cannot overflow
+        for(a=hyper, b=period[i]; b != 0; g=b, b=a % b, a=g);
+        hyper=(hyper / a) * period[i];
+
+        if(hyper > maxTime)
+            return FEAS_ERROR;
+    }
+
+    absDeadline=calloc(numServices, sizeof(unsigned long long));
+    remaining=calloc(numServices, sizeof(unsigned long long));
+    if((absDeadline == NULL) || (remaining == NULL))
+    {
+        free(absDeadline); free(remaining);
+        return FEAS_ERROR;
+    }
+
+    if(switches != NULL)
+        *switches=0;
+
+    for(t=0; (t < hyper) && (rc == TRUE); t++)
+    {
+        run=-1; best=0;
+
+        for(i=0; i < numServices; i++)
+        {
+            if((t % period[i]) == 0)
+            {
+                // the previous job of this service must be done by now, since D <= T
+                if(remaining[i] > 0)
+                    rc=FALSE;
+
+                remaining[i]=wcet[i];
+                absDeadline[i]=t + deadline[i];
+            }
+
+            if(remaining[i] == 0)
+                continue;
+
+            laxity=(long long)absDeadline[i] - (long long)t - (long long)remaining[i];
+            if(laxity < 0)
+                rc=FALSE;
+
+            if((run < 0) || (laxity < best))
+            {
+                run=i; best=laxity;
+            }
+        }
+
+        if(run >= 0)
+        {
+            remaining[run]--;
+
+            if((run != last) && (last >= 0) && (switches != NULL))
+                (*switches)++;
+
+            last=run;
+        }
+    }
+
+    // anything left at the hyperperiod missed its deadline
+    for(i=0; i < numServices; i++)
+        if(remaining[i] > 0)
+            rc=FALSE;
+
+    free(absDeadline); free(remaining);
+    return rc;
+}
@@ -0,0 +1,319 @@
+#ifndef FEASLIB_H
+#define FEASLIB_H
+
+// Feasibility test library
+//
+// The single core fixed priority tests from feasibility_tests.c, without any printing so they
+// can be run over thousands of task sets, plus task set loading from CSV or JSON files.
+//
+// The fixed priority tests assume the services are in priority order, highest first, so the
+// arrays must be sorted by period for rate monotonic (see feas_sort_rm) or by deadline for
+// deadline monotonic (see feas_sort_dm).  The exact tests use integer arithmetic only and stop
+// at the first service found to miss its deadline.
+
+#include <stdio.h>
+
+#define TRUE 1
+#define FALSE 0
+#define U32_T unsigned int
+
+#define FEAS_OK (0)
+#define FEAS_ERROR (-1)
+
+#define FEAS_NAME_LEN (64)
+
+// core assignment for a service that is not bound to one core
+#define FEAS_CORE_NONE (-1)
+
+typedef struct
+{
+    char name[FEAS_NAME_LEN];
+    U32_T numServices;
+    U32_T capacity;
+    U32_T *period;
+    U32_T *wcet;
+    U32_T *deadline;
+    U32_T *jitter;          // release jitter, used by the simulator and feassens.c
+    U32_T *nonPreemptive;   // non-preemptive section at the start of each job, used by the simulator
+} taskSet_t;
+
+typedef enum
+{
+    FEAS_FIRST_FIT=0,
+    FEAS_BEST_FIT=1
+} feasFit_t;
+
+typedef enum
+{
+    FEAS_CORE_EXACT=0,
+    FEAS_CORE_RMST=1,
+    FEAS_CORE_RBOUND=2
+} feasCoreTest_t;
+
+
+// feaslib.c - feasibility decision tests
+int rate_monotonic_least_upper_bound(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int completion_time_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int scheduling_point_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Optimized exact tests, response[] receives the response time of each service analyzed and
+// entries before firstService must hold results of an earlier call on the same services
+int feas_response_time_analysis(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                                U32_T response[], U32_T firstService);
+int feas_hyperplane_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+
+// Response time analysis with release jitter, R(i) = J(i) + w(i) where each higher priority
+// service interferes ceil((w + J(j))/T(j)) times, in the priority order given
+int feas_response_time_jitter(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                              U32_T jitter[], U32_T response[]);
+
+// Dynamic priority tests for D <= T, in any service order
+int feas_edf_qpa_feasibility(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[]);
+int feas_llf_simulate(U32_T numServices, U32_T period[], U32_T wcet[], U32_T deadline[],
+                      unsigned long long maxTime, unsigned long long *switches);
+
+double feas_utilization(U32_T numServices, U32_T period[], U32_T wcet[]);
+void feas_sort_rm(taskSet_t *set);
+void feas_sort_dm(taskSet_t *set);
+
+
+// feasio.c - task set files
+//
+// CSV: one service per line as "set,period,wcet[,deadline[,jitter[,np]]]", consecutive lines
+//      with the same set name form one task set.  Lines starting with # and a header line are
+//      skipped.
+//
+// JSON: [ { "name": "ex0", "tasks": [ { "period": 2, "wcet": 1, "deadline": 2 }, ... ] }, ... ]
+//       with "T", "C", "D" and "J" accepted as short keys, and "jitter" and "np" optional.
+//
+// deadline defaults to period, jitter and np (the non-preemptive section) to 0.  Every value is
+// a whole number that fits a U32_T, and a negative, too large or malformed one fails the load
+// with the line of the file it is on.
+int feas_load_tasksets(const char *fileName, taskSet_t **sets, int *numSets);
+int feas_load_csv(const char *fileName, taskSet_t **sets, int *numSets);
+int feas_load_json(const char *fileName, taskSet_t **sets, int *numSets);
+void feas_free_tasksets(taskSet_t *sets, int numSets);
+
+// Core assignment for seq_load_affinity() in sequencer_generic/seqlib.c, one line per service in
+// the order of the task set file as "service,period,wcet,core", with core -1 for any core
+int feas_write_affinity(const char *fileName, taskSet_t *set, int core[], const char *method);
+
+int feas_alloc_taskset(taskSet_t *set, U32_T numServices);
+void feas_free_taskset(taskSet_t *set);
+int feas_append_task(taskSet_t *set, U32_T period, U32_T wcet, U32_T deadline, U32_T jitter, U32_T nonPreemptive);
+
+
+// feasmp.c - multi-core tests
+//
+// feas_partition_rm() fills core[] with the core, 0 to numCores-1, of each service in set order
+// and returns the number of cores used, or FEAS_ERROR if the set does not fit on numCores.
+// The set itself is not reordered.
+int feas_partition_rm(taskSet_t *set, U32_T numCores, feasFit_t fit, feasCoreTest_t test, int core[]);
+// The RMST and RBound bounds assume D = T, and FEAS_CORE_RMST and FEAS_CORE_RBOUND fall back to
+// response time analysis on a core with any D < T.
+int feas_constrained_deadlines(U32_T numServices, U32_T period[], U32_T deadline[]);
+int feas_rmst_test(U32_T numServices, U32_T period[], U32_T wcet[]);
+int feas_rbound_test(U32_T numServices, U32_T period[], U32_T wcet[]);
+int feas_global_edf_gfb(taskSet_t *set, U32_T numCores);
+
+
+// feassim.c - discrete-event simulation on one core
+//
+// Trace lines are "from to what" with what one of S<service>.<job>, idle or cs (context switch).
+// Job lines are "service,job,arrival,release,start,finish,response,blocked,missed".
+// result->service is allocated by feas_simulate() and must be freed by the caller.
+typedef enum
+{
+    FEAS_SIM_RM=0,
+    FEAS_SIM_DM=1,
+    FEAS_SIM_EDF=2,
+    FEAS_SIM_LLF=3
+} feasSimPolicy_t;
+
+typedef struct
+{
+    feasSimPolicy_t policy;
+    unsigned long long duration;    // time to simulate, 0 for one hyperperiod
+    U32_T contextSwitch;            // overhead of each switch between jobs
+    unsigned int seed;              // rand_r seed for release jitter
+    FILE *trace;                    // execution trace, or NULL
+    FILE *jobs;                     // one line per completed job, or NULL
+} feasSimConfig_t;
+
+typedef struct
+{
+    unsigned long long jobs;
+    unsigned long long misses;
+    unsigned long long maxResponse;
+    unsigned long long sumResponse;
+    unsigned long long maxBlocking;
+} feasSimServiceStats_t;
+
+typedef struct
+{
+    unsigned long long duration;
+    unsigned long long jobs;
+    unsigned long long misses;
+    unsigned long long switches;
+    unsigned long long overhead;    // time spent switching
+    unsigned long long idle;
+    feasSimServiceStats_t *service;
+} feasSimResult_t;
+
+int feas_simulate(taskSet_t *set, feasSimConfig_t *cfg, feasSimResult_t *result);
+
+
+// feasgen.c - random task sets
+//
+// UUniFast (Bini and Buttazzo) draws numServices utilizations uniformly distributed over those
+// summing to totalUtil, and RandFixedSum (Emberson, Stafford and Davis) the same with every
+// utilization at most maxUtil, for totals above 1.  Periods are log-uniform in [minPeriod,
+// maxPeriod], wcet is rounded to at least 1, and the deadline is uniform in
+// [max(wcet, minDeadlineRatio * period), period].  seed is for rand_r, so threads can each have one.
+typedef enum
+{
+    FEAS_GEN_UUNIFAST=0,
+    FEAS_GEN_RANDFIXEDSUM=1
+} feasGenMethod_t;
+
+typedef struct
+{
+    feasGenMethod_t method;
+    U32_T minPeriod;
+    U32_T maxPeriod;
+    double maxUtil;             // largest utilization of one service, RandFixedSum only
+    double minDeadlineRatio;    // 1.0 for implicit deadlines, D = T
+} feasGenConfig_t;
+
+void feas_uunifast(U32_T numServices, double totalUtil, double util[], unsigned int *seed);
+int feas_randfixedsum(U32_T numServices, double totalUtil, double maxUtil, double util[], unsigned int *seed);
+int feas_generate_taskset(taskSet_t *set, U32_T numServices, double totalUtil, feasGenConfig_t *cfg,
+                          unsigned int *seed);
+
+
+// feassens.c - sensitivity analysis
+//
+// feas_wcet_scaling() gives the largest factor the WCET of service, or of all services with
+// FEAS_SENS_ALL, can be multiplied by with the set still feasible, and feas_min_period() the
+// shortest feasible period of service, or FEAS_ERROR if no period makes the set feasible.
+// Services are numbered in set order and the set itself is not reordered.
+#define FEAS_SENS_ALL (-1)
+
+typedef enum
+{
+    FEAS_SENS_RM=0,
+    FEAS_SENS_DM=1,
+    FEAS_SENS_EDF=2
+} feasSensPolicy_t;
+
+int feas_set_feasible(taskSet_t *set, feasSensPolicy_t policy);
+int feas_wcet_scaling(taskSet_t *set, feasSensPolicy_t policy, int service, double *factor);
+int feas_min_period(taskSet_t *set, feasSensPolicy_t policy, U32_T service, U32_T *period);
+
+
+// feastrace.c - service timing from measured traces
+//
+// feas_load_trace() reads a syslog trace of the sequencer examples or a binary job trace from
+// seq_trace_write() in sequencer_generic/seqlib.c and estimates the timing of each service it
+// finds, in microseconds.  The pWCET is a Gumbel fit to the maxima of blocks of blockSize
+// execution times, exceeded by a block maximum with probability exceedance.  Times the trace
+// does not have are 0, e.g. syslog release lines give no execution times.
+typedef struct
+{
+    char name[FEAS_NAME_LEN];
+    unsigned long long releases;
+    unsigned long long jobs;            // jobs with execution times
+    double declaredPeriodUsec;          // period the service was registered with, binary traces only
+    double periodUsec;
+    double jitterUsec;                  // peak to peak release jitter
+    double meanExecUsec;
+    double wcetUsec;                    // largest observed execution time
+    double pwcetUsec;
+    double maxResponseUsec;
+} feasTraceService_t;
+
+int feas_load_trace(const char *fileName, U32_T blockSize, double exceedance, feasTraceService_t **svc,
+                    int *numServices);
+
+
+// feasblock.c - blocking on shared resources
+//
+// Resource files list the critical sections of each service as "set,service,resource,length",
+// where service is the index of the service in the task set file, counting from 0, and length
+// is the longest critical section the service holds on the named resource.  Nested critical
+// sections are given as the length of the outermost one.  Lines for sets that are not in the
+// task set file are ignored, and a set with no lines has no blocking.
+//
+// Priorities are ranked by period (RM) or by deadline (DM) with ties in file order, and the
+// same deadline ranking gives the SRP preemption levels for EDF.  block[] and response[] are
+// indexed in file order, so the set does not need to be sorted.
+#define FEAS_MAX_RESOURCES (16)
+#define FEAS_RESOURCE_NONE (-1)
+
+typedef struct
+{
+    char name[FEAS_NAME_LEN];               // task set the resources belong to
+    U32_T numResources;
+    char resource[FEAS_MAX_RESOURCES][FEAS_NAME_LEN];
+    U32_T numServices;                      // services with critical sections, rows of csLength
+    U32_T *csLength;                        // service s on resource r at [s * FEAS_MAX_RESOURCES + r], 0 if unused
+} feasResources_t;
+
+typedef enum
+{
+    FEAS_BLOCK_PIP=0,       // priority inheritance, PTHREAD_PRIO_INHERIT
+    FEAS_BLOCK_PCP=1,       // priority ceiling, PTHREAD_PRIO_PROTECT
+    FEAS_BLOCK_SRP=2        // stack resource policy, PCP with preemption levels for EDF
+} feasBlockProtocol_t;
+
+typedef struct
+{
+    U32_T blocking;         // worst case blocking B by lower priority critical sections
+    int resource;           // resource of the longest blocking critical section, or FEAS_RESOURCE_NONE
+    int blocker;            // service that holds it, or FEAS_RESOURCE_NONE
+} feasBlocking_t;
+
+int feas_load_resources(const char *fileName, feasResources_t **res, int *numRes);
+void feas_free_resources(feasResources_t *res, int numRes);
+feasResources_t *feas_find_resources(feasResources_t *res, int numRes, const char *setName);
+
+// res may be NULL for a set without shared resources
+int feas_blocking(taskSet_t *set, feasResources_t *res, feasBlockProtocol_t protocol, int byDeadline,
+                  feasBlocking_t block[]);
+int feas_blocking_rta(taskSet_t *set, feasBlocking_t block[], int byDeadline, U32_T response[]);
+int feas_edf_srp_feasibility(taskSet_t *set, feasBlocking_t block[]);
+
+
+// feascyclic.c - static schedule tables for cyclic executives
+//
+// feas_cyclic_frame_sizes() lists the minor frames that meet the Baker-Shaw constraints, longest
+// first, and feas_cyclic_schedule() places every job of the hyperperiod in one frame of the
+// given size, without splitting jobs, or returns FEAS_ERROR if it cannot.  feas_cyclic_build()
+// does the same with the longest frame that works when frame is 0.  Services are numbered in
+// set order and the set is not reordered.
+//
+// The tables are written in the set's time units scaled by nsecPerUnit, as a C header for
+// seq_set_cyclic() or a binary file for seq_load_cyclic() in sequencer_generic/seqlib.c, whose
+// layout is in sequencer_generic/seqcyclic.h.
+#define FEAS_CYCLIC_MAX_FRAMES (65536)
+#define FEAS_CYCLIC_MAX_ENTRIES (1048576)
+#define FEAS_CYCLIC_MAX_SIZES (256)
+
+typedef struct
+{
+    U32_T frame;            // minor frame
+    U32_T numFrames;        // minor frames in the major frame, the hyperperiod
+    U32_T numEntries;       // jobs in the major frame
+    U32_T *firstEntry;      // frame k runs entry[firstEntry[k]] to entry[firstEntry[k+1]-1]
+    U32_T *entry;           // service of each job, in run order
+    U32_T *load;            // sum of the WCETs of each frame
+} feasCyclic_t;
+
+int feas_cyclic_frame_sizes(taskSet_t *set, U32_T frame[], U32_T maxSizes, U32_T *numSizes);
+int feas_cyclic_schedule(taskSet_t *set, U32_T frame, feasCyclic_t *table);
+int feas_cyclic_build(taskSet_t *set, U32_T frame, feasCyclic_t *table);
+void feas_cyclic_free(feasCyclic_t *table);
+int feas_cyclic_write_header(const char *fileName, taskSet_t *set, feasCyclic_t *table, U32_T nsecPerUnit);
+int feas_cyclic_write_table(const char *fileName, taskSet_t *set, feasCyclic_t *table, U32_T nsecPerUnit);
+
+#endif
@@ -0,0 +1,262 @@
+// Multi-core feasibility tests
+//
+// Partitioned rate monotonic, where each service is bound to one core and each core is then a
+// single core RM system, and global EDF, where services may run on any core.
+//
+// Partitioning places services one at a time on the first core (first-fit) or the most loaded
+// core (best-fit) that still passes a per-core test:
+//
+// 1) FEAS_CORE_EXACT  - response time analysis, services in decreasing utilization order
+// 2) FEAS_CORE_RMST   - the RMST bound of Burchard et al., services in increasing order of
+//                       S(i) = log2 T(i) - floor(log2 T(i)), so each core gets nearly harmonic periods
+// 3) FEAS_CORE_RBOUND - the RBound of Lauzac, Melhem and Mosse, services in increasing order of
+//                       period scaled into [Tmin, 2 Tmin)
+//
+// The two bounds are sufficient only, but allow more than the RM LUB per core when the periods
+// on a core are close to harmonic.  Both assume D = T, so a core holding any service with D < T
+// is checked by response time analysis instead.
+//
+// Global EDF uses the Goossens, Funk and Baruah (GFB) bound with densities C/min(D,T), which for
+// D=T is the utilization bound U <= m - (m-1) Umax.
+//
+// References:
+//
+// 1) Burchard, Almut, et al. "New strategies for assigning real-time tasks to multiprocessor systems."
+//    IEEE Transactions on Computers 44.12 (1995): 1429-1442.
+// 2) Lauzac, Sylvain, Rami Melhem, and Daniel Mosse. "An efficient RMS admission control and its
+//    application to multiprocessor scheduling." IPPS/SPDP 1998: 511-518.
+// 3) Goossens, Joel, Shelby Funk, and Sanjoy Baruah. "Priority-driven scheduling of periodic task
+//    systems on multiprocessors." Real-Time Systems 25.2-3 (2003): 187-205.
+// 4) Dhall and Liu, 1978 - see feasibility_tests.c, why global RM or EDF alone is not enough
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "feaslib.h"
+
+
+// fractional part of log2 of the period
+static double feas_rmst_s(U32_T period)
+{
+    double l=log2((double)period);
+
+    return l - floor(l);
+}
+
+
+// period scaled by a power of 2 into [minPeriod, 2 minPeriod)
+static double feas_rbound_scaled(U32_T period, U32_T minPeriod)
+{
+    double scaled=(double)period;
+
+    while(scaled >= (2.0 * (double)minPeriod))
+        scaled/=2.0;
+
+    return scaled;
+}
+
+
+// TRUE if any service has D < T
+int feas_constrained_deadlines(U32_T numServices, U32_T period[], U32_T deadline[])
+{
+    U32_T i;
+
+    for(i=0; i < numServices; i++)
+        if(deadline[i] < period[i])
+            return TRUE;
+
+    return FALSE;
+}
+
+
+int feas_rmst_test(U32_T numServices, U32_T period[], U32_T wcet[])
+{
+    double s, smin=1.0, smax=0.0, beta, n=(double)numServices, bound;
+    U32_T i;
+
+    if(numServices <= 1)
+        return (numServices == 0) || (wcet[0] <= period[0]);
+
+    for(i=0; i < numServices; i++)
+    {
+        s=feas_rmst_s(period[i]);
+        if(s < smin) smin=s;
+        if(s > smax) smax=s;
+    }
+
+    beta=smax - smin;
+
+    // Burchard et al. Theorem 2, falling back to the Liu and Layland bound when beta is large
+    if(beta < (1.0 - (1.0 / n)))
+        bound=((n - 1.0) * (pow(2.0, beta / (n - 1.0)) - 1.0)) + pow(2.0, 1.0 - beta) - 1.0;
+    else
+        bound=n * (pow(2.0, 1.0 / n) - 1.0);
+
+    return (feas_utilization(numServices, period, wcet) <= bound) ? TRUE : FALSE;
+}
+
+
+int feas_rbound_test(U32_T numServices, U32_T period[], U32_T wcet[])
+{
+    double scaled, smin, smax, r, n=(double)numServices, bound;
+    U32_T i, minPeriod;
+
+    if(numServices <= 1)
+        return (numServices == 0) || (wcet[0] <= period[0]);
+
+    minPeriod=period[0];
+    for(i=1; i < numServices; i++)
+        if(period[i] < minPeriod) minPeriod=period[i];
+
+    smin=2.0 * (double)minPeriod; smax=0.0;
+    for(i=0; i < numServices; i++)
+    {
+        scaled=feas_rbound_scaled(period[i], minPeriod);
+        if(scaled < smin) smin=scaled;
+        if(scaled > smax) smax=scaled;
+    }
+
+    r=smax / smin;
+    bound=((n - 1.0) * (pow(r, 1.0 / (n - 1.0)) - 1.0)) + (2.0 / r) - 1.0;
+
+    return (feas_utilization(numServices, period, wcet) <= bound) ? TRUE : FALSE;
+}
+
+
+int feas_global_edf_gfb(taskSet_t *set, U32_T numCores)
+{
+    double density, dsum=0.0, dmax=0.0;
+    U32_T i, d;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        d=(set->deadline[i] < set->period[i]) ? set->deadline[i] : set->period[i];
+        density=(double)set->wcet[i] / (double)d;
+
+        dsum+=density;
+        if(density > dmax) dmax=density;
+    }
+
+    if(dmax > 1.0)
+        return FALSE;
+
+    return (dsum <= ((double)numCores - ((double)(numCores - 1) * dmax))) ? TRUE : FALSE;
+}
+
+
+// Run the per-core test on the services currently assigned to core, plus candidate
+static int feas_core_fits(taskSet_t *set, int core[], int c, U32_T candidate, feasCoreTest_t test,
+                          U32_T period[], U32_T wcet[], U32_T deadline[], U32_T response[])
+{
+    U32_T i, j, n=0;
+
+    // gather the services on this core in RM order, insertion by period
+    for(i=0; i < set->numServices; i++)
+    {
+        if((core[i] != c) && (i != candidate)) continue;
+
+        for(j=n; (j > 0) && (period[j-1] > set->period[i]); j--)
+        {
+            period[j]=period[j-1]; wcet[j]=wcet[j-1]; deadline[j]=deadline[j-1];
+        }
+
+        period[j]=set->period[i]; wcet[j]=set->wcet[i]; deadline[j]=set->deadline[i];
+        n++;
+    }
+
+    // the bounds ignore deadlines, so they cannot vouch for a constrained deadline core
+    if((test != FEAS_CORE_EXACT) && feas_constrained_deadlines(n, period, deadline))
+        test=FEAS_CORE_EXACT;
+
+    switch(test)
+    {
+        case FEAS_CORE_RMST:
+            return feas_rmst_test(n, period, wcet);
+
+        case FEAS_CORE_RBOUND:
+            return feas_rbound_test(n, period, wcet);
+
+        default:
+            return feas_response_time_analysis(n, period, wcet, deadline, response, 0);
+    }
+}
+
+
+int feas_partition_rm(taskSet_t *set, U32_T numCores, feasFit_t fit, feasCoreTest_t test, int core[])
+{
+    U32_T *order, *period, *wcet, *deadline, *response, minPeriod, i, j, t, n=set->numServices;
+    double *key, *coreUtil, tmp;
+    int c, chosen, used=0, rc=FEAS_OK;
+
+    order=malloc(n * sizeof(U32_T));
+    period=malloc(n * sizeof(U32_T));
+    wcet=malloc(n * sizeof(U32_T));
+    deadline=malloc(n * sizeof(U32_T));
+    response=malloc(n * sizeof(U32_T));
+    key=malloc(n * sizeof(double));
+    coreUtil=calloc(numCores, sizeof(double));
+
+    if(!order || !period || !wcet || !deadline || !response || !key || !coreUtil)
+    {
+        free(order); free(period); free(wcet); free(deadline); free(response); free(key); free(coreUtil);
+        return FEAS_ERROR;
+    }
+
+    minPeriod=(n > 0) ? set->period[0] : 1;
+    for(i=0; i < n; i++)
+        if(set->period[i] < minPeriod) minPeriod=set->period[i];
+
+    // order in which to place the services, smallest key first
+    for(i=0; i < n; i++)
+    {
+        core[i]=FEAS_CORE_NONE;
+        order[i]=i;
+
+        if(test == FEAS_CORE_RMST)
+            key[i]=feas_rmst_s(set->period[i]);
+        else if(test == FEAS_CORE_RBOUND)
+            key[i]=feas_rbound_scaled(set->period[i], minPeriod);
+        else
+            key[i]=-((double)set->wcet[i] / (double)set->period[i]);
+    }
+
+    for(i=1; i < n; i++)
+    {
+        t=order[i]; tmp=key[t];
+        for(j=i; (j > 0) && (key[order[j-1]] > tmp); j--)
+            order[j]=order[j-1];
+        order[j]=t;
+    }
+
+    for(i=0; (i < n) && (rc == FEAS_OK); i++)
+    {
+        t=order[i];
+        chosen=FEAS_CORE_NONE;
+
+        for(c=0; c < (int)numCores; c++)
+        {
+            if(!feas_core_fits(set, core, c, t, test, period, wcet, deadline, response))
+                continue;
+
+            if((chosen == FEAS_CORE_NONE) || (coreUtil[c] > coreUtil[chosen]))
+                chosen=c;
+
+            if(fit == FEAS_FIRST_FIT)
+                break;
+        }
+
+        if(chosen == FEAS_CORE_NONE)
+        {
+            rc=FEAS_ERROR;
+            break;
+        }
+
+        core[t]=chosen;
+        coreUtil[chosen]+=(double)set->wcet[t] / (double)set->period[t];
+        if(chosen >= used)
+            used=chosen + 1;
+    }
+
+    free(order); free(period); free(wcet); free(deadline); free(response); free(key); free(coreUtil);
+    return (rc == FEAS_OK) ? used : FEAS_ERROR;
+}
@@ -0,0 +1,300 @@
+// Sensitivity analysis on top of the exact tests
+//
+// How much slower can a service get, or how much faster can it run, before its set is no
+// longer feasible?  Each answer is a binary search over one parameter, running the exact test
+// for the policy at every step on a copy of the set, since the tests sort their arrays:
+//
+// 1) WCET scaling - the largest factor by which the WCET of one service, or of every service
+//    together (the critical scaling factor of Lehoczky, Sha and Ding), can be multiplied with
+//    the set still feasible.  Below 1.0 the set is infeasible as given and the factor is how
+//    much the WCETs must shrink.
+// 2) Minimum period - the shortest period of one service with the set still feasible, where an
+//    implicit deadline (D = T) follows the period and a constrained one is kept unless the new
+//    period is shorter.
+//
+// The tests include the release jitter of each service, so a set measured with jitter has less
+// margin than the same set released on time.
+//
+// The WCETs are integers, so scaling them all by a factor and rounding up would only try the
+// factors that make a whole number of time units of the smallest WCET, e.g. 0.5 or 1.0 for a
+// WCET of 2.  The search for all services runs the test on the set with every period, deadline
+// and jitter multiplied by FEAS_SENS_RESOLUTION, or the largest power of 10 below it that does
+// not overflow 32 bits, so the rounding is to a thousandth of a time unit.  For ex1 of
+// examples.csv (T = 2, 5, 7, C = 1, 1, 2) under DM this gives 0.8750, the factor f at which the
+// third service just completes by t = 7, f(ceil(7/2) + ceil(7/5) + 2) = 8f = 7.
+//
+// Binary search needs feasibility to be monotone in the parameter, which holds for longer WCETs
+// under any of the policies, and for shorter periods under RM with D = T and under DM and EDF,
+// since these are optimal for their task models.
+//
+// Lehoczky, John, Lui Sha, and Yuqin Ding. "The rate monotonic scheduling algorithm: Exact
+// characterization and average case behavior." IEEE Real-Time Systems Symposium (1989): 166-171.
+//
+// Bini, Enrico, Marco Di Natale, and Giorgio Buttazzo. "Sensitivity analysis for fixed-priority
+// real-time systems." Real-Time Systems 39.1 (2008): 5-30.
+
+#include <math.h>
+#include <stdlib.h>
+
+#include "feaslib.h"
+
+// iterations of the search for the scaling of all services, enough for 6 significant digits
+#define FEAS_SENS_ITERATIONS (40)
+
+// longest period tried when a set is infeasible at the period it was given
+#define FEAS_SENS_MAX_PERIOD (0x7fffffffU)
+
+// time units per unit of the set when scaling all of its WCETs
+#define FEAS_SENS_RESOLUTION (1000)
+
+
+// Copy set into work, which must have room for all its services
+static void feas_sens_copy(taskSet_t *set, taskSet_t *work)
+{
+    U32_T i;
+
+    work->numServices=set->numServices;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        work->period[i]=set->period[i];
+        work->wcet[i]=set->wcet[i];
+        work->deadline[i]=set->deadline[i];
+        work->jitter[i]=set->jitter[i];
+        work->nonPreemptive[i]=set->nonPreemptive[i];
+    }
+}
+
+
+// Exact test of work, which is reordered for the fixed priority policies, taking release jitter
+// into account.  Under EDF a job released J late has J less of its relative deadline, while the
+// later jobs may be released on time, so the demand bound is that of deadlines D - J.
+static int feas_sens_test(taskSet_t *work, feasSensPolicy_t policy, U32_T response[])
+{
+    U32_T i;
+
+    if(policy == FEAS_SENS_EDF)
+    {
+        for(i=0; i < work->numServices; i++)
+        {
+            if(work->jitter[i] >= work->deadline[i])
+                return FALSE;
+            work->deadline[i]-=work->jitter[i];
+        }
+
+        return feas_edf_qpa_feasibility(work->numServices, work->period, work->wcet, work->deadline);
+    }
+
+    if(policy == FEAS_SENS_DM)
+        feas_sort_dm(work);
+    else
+        feas_sort_rm(work);
+
+    return feas_response_time_jitter(work->numServices, work->period, work->wcet, work->deadline, work->jitter, response);
+}
+
+
+int feas_set_feasible(taskSet_t *set, feasSensPolicy_t policy)
+{
+    taskSet_t work;
+    U32_T *response;
+    int feasible;
+
+    if((feas_alloc_taskset(&work, set->numServices) != FEAS_OK) ||
+       ((response=malloc((set->numServices + 1) * sizeof(U32_T))) == NULL))
+        return FEAS_ERROR;
+
+    feas_sens_copy(set, &work);
+    feasible=feas_sens_test(&work, policy, response);
+
+    free(response);
+    feas_free_taskset(&work);
+
+    return feasible;
+}
+
+
+// Test set with the WCET of service replaced
+static int feas_sens_wcet(taskSet_t *set, taskSet_t *work, feasSensPolicy_t policy, U32_T service,
+                          U32_T wcet, U32_T response[])
+{
+    feas_sens_copy(set, work);
+    work->wcet[service]=wcet;
+
+    return feas_sens_test(work, policy, response);
+}
+
+
+// The finest resolution, FEAS_SENS_RESOLUTION or a power of 10 below it, at which no period,
+// deadline or jitter of set passes 32 bits
+static U32_T feas_sens_resolution(taskSet_t *set)
+{
+    U32_T i, res=FEAS_SENS_RESOLUTION;
+    unsigned long long largest=1;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        if(set->period[i] > largest) largest=set->period[i];
+        if(set->deadline[i] > largest) largest=set->deadline[i];
+        if(set->jitter[i] > largest) largest=set->jitter[i];
+    }
+
+    while((res > 1) && ((largest * res) > 0xffffffffULL))
+        res/=10;
+
+    return res;
+}
+
+
+// Test set with every time multiplied by res and every WCET scaled by factor as well, rounding up
+static int feas_sens_scaled(taskSet_t *set, taskSet_t *work, feasSensPolicy_t policy, double factor,
+                            U32_T res, U32_T response[])
+{
+    double wcet;
+    U32_T i;
+
+    feas_sens_copy(set, work);
+
+    for(i=0; i < set->numServices; i++)
+    {
+        wcet=ceil(factor * (double)set->wcet[i] * (double)res);
+
+        // a WCET past the deadline can never be feasible, and cannot overflow either
+        if(wcet > (double)set->deadline[i] * (double)res)
+            return FALSE;
+
+        work->period[i]=set->period[i] * res;
+        work->deadline[i]=set->deadline[i] * res;
+        work->jitter[i]=set->jitter[i] * res;
+        work->wcet[i]=(wcet < 1.0) ? 1 : (U32_T)wcet;
+    }
+
+    return feas_sens_test(work, policy, response);
+}
+
+
+int feas_wcet_scaling(taskSet_t *set, feasSensPolicy_t policy, int service, double *factor)
+{
+    taskSet_t work;
+    U32_T *response, i, lowWcet, highWcet, midWcet, res;
+    double low, high, mid, util;
+    int k;
+
+    if((service != FEAS_SENS_ALL) && ((service < 0) || ((U32_T)service >= set->numServices)))
+        return FEAS_ERROR;
+
+    if((feas_alloc_taskset(&work, set->numServices) != FEAS_OK) ||
+       ((response=malloc((set->numServices + 1) * sizeof(U32_T))) == NULL))
+        return FEAS_ERROR;
+
+    if(service != FEAS_SENS_ALL)
+    {
+        // integer search over the WCET of the one service, from 1 up to its deadline
+        lowWcet=0; highWcet=set->deadline[service] + 1;
+
+        while(highWcet - lowWcet > 1)
+        {
+            midWcet=lowWcet + ((highWcet - lowWcet) / 2);
+
+            if(feas_sens_wcet(set, &work, policy, service, midWcet, response))
+                lowWcet=midWcet;
+            else
+                highWcet=midWcet;
+        }
+
+        *factor=(double)lowWcet / (double)set->wcet[service];
+    }
+    else
+    {
+        // U scaled by the factor cannot pass 1, and no C can pass its D
+        util=feas_utilization(set->numServices, set->period, set->wcet);
+        high=1.0 / util;
+        for(i=0; i < set->numServices; i++)
+            if((double)set->deadline[i] / (double)set->wcet[i] < high)
+                high=(double)set->deadline[i] / (double)set->wcet[i];
+
+        low=0.0;
+        res=feas_sens_resolution(set);
+
+        if(feas_sens_scaled(set, &work, policy, high, res, response))
+            low=high;
+
+        for(k=0; (k < FEAS_SENS_ITERATIONS) && (low < high); k++)
+        {
+            mid=(low + high) / 2.0;
+
+            if(feas_sens_scaled(set, &work, policy, mid, res, response))
+                low=mid;
+            else
+                high=mid;
+        }
+
+        *factor=low;
+    }
+
+    free(response);
+    feas_free_taskset(&work);
+
+    return FEAS_OK;
+}
+
+
+// Test set with the period of service replaced
+static int feas_sens_period(taskSet_t *set, taskSet_t *work, feasSensPolicy_t policy, U32_T service,
+                            U32_T period, U32_T response[])
+{
+    feas_sens_copy(set, work);
+
+    work->period[service]=period;
+
+    if((set->deadline[service] == set->period[service]) || (set->deadline[service] > period))
+        work->deadline[service]=period;
+
+    return feas_sens_test(work, policy, response);
+}
+
+
+int feas_min_period(taskSet_t *set, feasSensPolicy_t policy, U32_T service, U32_T *period)
+{
+    taskSet_t work;
+    U32_T *response, low, high, mid;
+    int rc=FEAS_OK;
+
+    if(service >= set->numServices)
+        return FEAS_ERROR;
+
+    if((feas_alloc_taskset(&work, set->numServices) != FEAS_OK) ||
+       ((response=malloc((set->numServices + 1) * sizeof(U32_T))) == NULL))
+        return FEAS_ERROR;
+
+    // feasible at high and not below low, where a period shorter than the WCET never is
+    high=set->period[service];
+    low=set->wcet[service] - 1;
+
+    if(!feas_sens_period(set, &work, policy, service, high, response))
+    {
+        low=high;
+        high=FEAS_SENS_MAX_PERIOD;
+
+        // no period helps if a higher priority service misses its deadline
+        if(!feas_sens_period(set, &work, policy, service, high, response))
+            rc=FEAS_ERROR;
+    }
+
+    while((rc == FEAS_OK) && (high - low > 1))
+    {
+        mid=low + ((high - low) / 2);
+
+        if(feas_sens_period(set, &work, policy, service, mid, response))
+            high=mid;
+        else
+            low=mid;
+    }
+
+    *period=(rc == FEAS_OK) ? high : 0;
+
+    free(response);
+    feas_free_taskset(&work);
+
+    return rc;
+}
@@ -0,0 +1,506 @@
+// Discrete-event schedule simulator for one core
+//
+// Simulates a task set under RM, DM, EDF or LLF from a synchronous start, by default for one
+// hyperperiod, jumping from event to event (releases, completions, the end of non-preemptive
+// sections and, for LLF, the time a waiting job's laxity drops below the running job's) rather
+// than stepping through every time unit, so the cost is per job rather than per tick.
+//
+// Model:
+//
+// 1) Release jitter - job k arrives at k*T(i) but is released at a uniformly random time up to
+//    jitter[i] later.  Deadlines and response times are measured from the arrival.
+// 2) Blocking - the first nonPreemptive[i] units of each job of service i run without preemption,
+//    as a critical section under a non-preemptive protocol would, so higher priority jobs that
+//    arrive meanwhile are blocked.  The blocking each job suffers is measured.
+// 3) Context switch overhead - every dispatch of a job other than the one that ran last costs
+//    contextSwitch time units of CPU before the job runs.
+//
+// A job that misses its deadline is counted and still runs to completion.  RM, DM and EDF keep
+// the ready services in a binary heap, so each event is O(log n); LLF priorities change with
+// time, so LLF scans the ready services at each event.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "feaslib.h"
+
+// longest hyperperiod simulated by default, otherwise a duration must be given
+#define FEAS_SIM_MAX_HYPERPERIOD (1000000000000ULL)
+
+#define NO_SERVICE (-1)
+
+typedef struct
+{
+    unsigned long long index;       // job number within the service
+    unsigned long long arrival;     // k*T
+    unsigned long long release;     // arrival plus jitter
+    unsigned long long deadline;    // absolute deadline
+    unsigned long long remaining;
+    unsigned long long np;          // non-preemptive time left
+    unsigned long long start;
+    unsigned long long blocked;
+    int started;
+} simJob_t;
+
+typedef struct
+{
+    simJob_t *job;                  // ring of pending jobs, oldest first
+    U32_T head, count, capacity;
+    unsigned long long nextIndex;
+    unsigned long long nextRelease;
+    U32_T rank;                     // fixed priority, 0 highest
+} simService_t;
+
+typedef struct sim sim_t;
+
+// Binary min-heap of service indices with the position of each service kept, so that a service
+// whose key has changed can be moved from anywhere in the heap
+typedef struct
+{
+    U32_T *heap;
+    int *pos;
+    U32_T size;
+    int (*before)(sim_t *sim, U32_T a, U32_T b);
+} simHeap_t;
+
+struct sim
+{
+    taskSet_t *set;
+    feasSimConfig_t *cfg;
+    simService_t *svc;
+    simHeap_t ready, release;
+
+    // trace segment not yet written, extended while the same job keeps running
+    const char *traceWhat;
+    int traceService;
+    unsigned long long traceIndex, traceFrom, traceTo;
+};
+
+
+static simJob_t *sim_head(sim_t *sim, U32_T s)
+{
+    return &sim->svc[s].job[sim->svc[s].head];
+}
+
+
+static int sim_before_fixed(sim_t *sim, U32_T a, U32_T b)
+{
+    return sim->svc[a].rank < sim->svc[b].rank;
+}
+
+
+static int sim_before_edf(sim_t *sim, U32_T a, U32_T b)
+{
+    unsigned long long da=sim_head(sim, a)->deadline, db=sim_head(sim, b)->deadline;
+
+    return (da < db) || ((da == db) && (a < b));
+}
+
+
+static int sim_before_release(sim_t *sim, U32_T a, U32_T b)
+{
+    unsigned long long ra=sim->svc[a].nextRelease, rb=sim->svc[b].nextRelease;
+
+    return (ra < rb) || ((ra == rb) && (a < b));
+}
+
+
+static void heap_swap(simHeap_t *h, U32_T i, U32_T j)
+{
+    U32_T tmp=h->heap[i];
+
+    h->heap[i]=h->heap[j]; h->heap[j]=tmp;
+    h->pos[h->heap[i]]=i; h->pos[h->heap[j]]=j;
+}
+
+
+static void heap_fix(sim_t *sim, simHeap_t *h, U32_T i)
+{
+    U32_T child;
+
+    while((i > 0) && h->before(sim, h->heap[i], h->heap[(i - 1) / 2]))
+    {
+        heap_swap(h, i, (i - 1) / 2);
+        i=(i - 1) / 2;
+    }
+
+    while((child=(2 * i) + 1) < h->size)
+    {
+        if(((child + 1) < h->size) && h->before(sim, h->heap[child + 1], h->heap[child]))
+            child++;
+
+        if(!h->before(sim, h->heap[child], h->heap[i]))
+            break;
+
+        heap_swap(h, i, child);
+        i=child;
+    }
+}
+
+
+static void heap_push(sim_t *sim, simHeap_t *h, U32_T s)
+{
+    h->heap[h->size]=s;
+    h->pos[s]=h->size;
+    h->size++;
+    heap_fix(sim, h, h->size - 1);
+}
+
+
+static void heap_remove(sim_t *sim, simHeap_t *h, U32_T s)
+{
+    U32_T i=h->pos[s];
+
+    h->size--;
+    h->pos[s]=-1;
+
+    if(i != h->size)
+    {
+        h->heap[i]=h->heap[h->size];
+        h->pos[h->heap[i]]=i;
+        heap_fix(sim, h, i);
+    }
+}
+
+
+static int heap_alloc(simHeap_t *h, U32_T n, int (*before)(sim_t *, U32_T, U32_T))
+{
+    U32_T i;
+
+    h->heap=malloc(n * sizeof(U32_T));
+    h->pos=malloc(n * sizeof(int));
+    h->size=0;
+    h->before=before;
+
+    if((h->heap == NULL) || (h->pos == NULL))
+        return FEAS_ERROR;
+
+    for(i=0; i < n; i++)
+        h->pos[i]=-1;
+
+    return FEAS_OK;
+}
+
+
+static unsigned long long sim_jitter(sim_t *sim, U32_T s)
+{
+    U32_T j=sim->set->jitter[s];
+
+    return (j == 0) ? 0 : ((unsigned long long)rand_r(&sim->cfg->seed) % ((unsigned long long)j + 1));
+}
+
+
+static long long sim_laxity(simJob_t *job, unsigned long long t)
+{
+    return (long long)job->deadline - (long long)t - (long long)job->remaining;
+}
+
+
+// Highest priority service with a pending job, NO_SERVICE if none.  For LLF ties keep the
+// running service, so that equal laxities do not switch at every time unit.
+static int sim_pick(sim_t *sim, unsigned long long t, int running)
+{
+    U32_T s;
+    int best=NO_SERVICE;
+    long long lax, bestLax=0;
+
+    if(sim->cfg->policy != FEAS_SIM_LLF)
+        return (sim->ready.size > 0) ? (int)sim->ready.heap[0] : NO_SERVICE;
+
+    for(s=0; s < sim->set->numServices; s++)
+    {
+        if(sim->svc[s].count == 0) continue;
+
+        lax=sim_laxity(sim_head(sim, s), t);
+        if((best == NO_SERVICE) || (lax < bestLax) || ((lax == bestLax) && ((int)s == running)))
+        {
+            best=s; bestLax=lax;
+        }
+    }
+
+    return best;
+}
+
+
+static void sim_trace_flush(sim_t *sim)
+{
+    if((sim->cfg->trace == NULL) || (sim->traceTo <= sim->traceFrom))
+        return;
+
+    if(sim->traceService == NO_SERVICE)
+        fprintf(sim->cfg->trace, "%llu %llu %s\n", sim->traceFrom, sim->traceTo, sim->traceWhat);
+    else
+        fprintf(sim->cfg->trace, "%llu %llu S%d.%llu\n", sim->traceFrom, sim->traceTo, sim->traceService, sim->traceIndex);
+
+    sim->traceFrom=sim->traceTo;
+}
+
+
+// Add a segment to the trace, one line per run of the same job, idle or context switch
+static void sim_trace(sim_t *sim, const char *what, int s, unsigned long long index,
+                      unsigned long long from, unsigned long long to)
+{
+    if((sim->cfg->trace == NULL) || (to <= from))
+        return;
+
+    if((from == sim->traceTo) && (s == sim->traceService) && (index == sim->traceIndex) && (what == sim->traceWhat))
+    {
+        sim->traceTo=to;
+        return;
+    }
+
+    sim_trace_flush(sim);
+
+    sim->traceWhat=what; sim->traceService=s; sim->traceIndex=index;
+    sim->traceFrom=from; sim->traceTo=to;
+}
+
+
+static unsigned long long sim_hyperperiod(taskSet_t *set)
+{
+    unsigned long long hyper=1, a, b, g;
+    U32_T i;
+
+    for(i=0; i < set->numServices; i++)
+    {
+        for(a=hyper, b=set->period[i]; b != 0; g=b, b=a % b, a=g);
+        hyper=(hyper / a) * set->period[i];
+
+        if(hyper > FEAS_SIM_MAX_HYPERPERIOD)
+            return 0;
+    }
+
+    return hyper;
+}
+
+
+int feas_simulate(taskSet_t *set, feasSimConfig_t *cfg, feasSimResult_t *result)
+{
+    sim_t sim;
+    simService_t *svc;
+    simJob_t *job, *ring;
+    unsigned long long t=0, end, run, overtake, lastIndex=0, segStart=0;
+    U32_T n=set->numServices, s, i, j, k, *order;
+    int running=NO_SERVICE, best, last=NO_SERVICE, rc=FEAS_OK;
+    feasSimServiceStats_t *stats;
+
+    memset(result, 0, sizeof(feasSimResult_t));
+
+    result->duration=(cfg->duration != 0) ? cfg->duration : sim_hyperperiod(set);
+    if((result->duration == 0) || (n == 0))
+        return FEAS_ERROR;
+
+    memset(&sim, 0, sizeof(sim_t));
+    sim.set=set; sim.cfg=cfg;
+    sim.svc=calloc(n, sizeof(simService_t));
+    result->service=calloc(n, sizeof(feasSimServiceStats_t));
+    order=malloc(n * sizeof(U32_T));
+
+    if((sim.svc == NULL) || (result->service == NULL) || (order == NULL) ||
+       (heap_alloc(&sim.ready, n, (cfg->policy == FEAS_SIM_EDF) ? sim_before_edf : sim_before_fixed) != FEAS_OK) ||
+       (heap_alloc(&sim.release, n, sim_before_release) != FEAS_OK))
+    {
+        free(sim.svc); free(result->service); free(order);
+        result->service=NULL;
+        return FEAS_ERROR;
+    }
+
+    // fixed priority ranks by period for RM or deadline for DM, ties by service index
+    for(i=0; i < n; i++)
+    {
+        order[i]=i;
+        for(j=i; j > 0; j--)
+        {
+            k=order[j-1];
+            if(((cfg->policy == FEAS_SIM_DM) ? set->deadline[k] : set->period[k]) <=
+               ((cfg->policy == FEAS_SIM_DM) ? set->deadline[i] : set->period[i]))
+                break;
+            order[j]=k;
+        }
+        order[j]=i;
+    }
+
+    for(i=0; i < n; i++)
+    {
+        svc=&sim.svc[order[i]];
+        svc->rank=i;
+        svc->capacity=4;
+        if((svc->job=malloc(svc->capacity * sizeof(simJob_t))) == NULL)
+            rc=FEAS_ERROR;
+    }
+
+    for(s=0; (s < n) && (rc == FEAS_OK); s++)
+    {
+        sim.svc[s].nextRelease=sim_jitter(&sim, s);
+        heap_push(&sim, &sim.release, s);
+    }
+
+    while((t < result->duration) && (rc == FEAS_OK))
+    {
+        // release every job due by now
+        while((sim.release.size > 0) && (sim.svc[sim.release.heap[0]].nextRelease <= t))
+        {
+            s=sim.release.heap[0];
+            svc=&sim.svc[s];
+
+            if(svc->count == svc->capacity)
+            {
+                // grow the ring, unwrapping it so the oldest job is first
+                if((ring=malloc(2 * svc->capacity * sizeof(simJob_t))) == NULL)
+                {
+                    rc=FEAS_ERROR;
+                    break;
+                }
+
+                for(i=0; i < svc->count; i++)
+                    ring[i]=svc->job[(svc->head + i) % svc->capacity];
+
+                free(svc->job);
+                svc->job=ring; svc->head=0; svc->capacity*=2;
+            }
+
+            job=&svc->job[(svc->head + svc->count) % svc->capacity];
+            memset(job, 0, sizeof(simJob_t));
+            job->index=svc->nextIndex;
+            job->arrival=svc->nextIndex * set->period[s];
+            job->release=svc->nextRelease;
+            job->deadline=job->arrival + set->deadline[s];
+            job->remaining=set->wcet[s];
+            job->np=set->nonPreemptive[s];
+            svc->count++;
+
+            if(svc->count == 1)
+                heap_push(&sim, &sim.ready, s);
+
+            svc->nextIndex++;
+            svc->nextRelease=(svc->nextIndex * set->period[s]) + sim_jitter(&sim, s);
+            heap_fix(&sim, &sim.release, 0);
+        }
+
+        if(rc != FEAS_OK)
+            break;
+
+        // a job inside its non-preemptive section keeps the CPU
+        best=sim_pick(&sim, t, running);
+        if((running == NO_SERVICE) || !sim_head(&sim, running)->started || (sim_head(&sim, running)->np == 0))
+            running=best;
+
+        end=result->duration;
+        if((sim.release.size > 0) && (sim.svc[sim.release.heap[0]].nextRelease < end))
+            end=sim.svc[sim.release.heap[0]].nextRelease;
+
+        if(running == NO_SERVICE)
+        {
+            sim_trace(&sim, "idle", NO_SERVICE, 0, t, end);
+            result->idle+=end - t;
+            t=end;
+            continue;
+        }
+
+        job=sim_head(&sim, running);
+
+        // context switch to a different job
+        if((running != last) || (job->index != lastIndex))
+        {
+            result->switches++;
+            last=running; lastIndex=job->index;
+
+            if(cfg->contextSwitch > 0)
+            {
+                run=(t + cfg->contextSwitch < result->duration) ? cfg->contextSwitch : (result->duration - t);
+                sim_trace(&sim, "cs", NO_SERVICE, 0, t, t + run);
+                result->overhead+=run;
+                t+=run;
+                continue;
+            }
+        }
+
+        if(!job->started)
+        {
+            job->started=TRUE;
+            job->start=t;
+        }
+
+        // run to the next event
+        if(t + job->remaining < end)
+            end=t + job->remaining;
+
+        if((job->np > 0) && (t + job->np < end))
+            end=t + job->np;
+
+        if(cfg->policy == FEAS_SIM_LLF)
+        {
+            for(s=0; s < n; s++)
+            {
+                if((sim.svc[s].count == 0) || ((int)s == running)) continue;
+
+                // a waiting job loses one unit of laxity per unit of time, the running job none
+                overtake=(unsigned long long)(sim_laxity(sim_head(&sim, s), t) - sim_laxity(job, t)) + 1;
+                if((sim_laxity(sim_head(&sim, s), t) >= sim_laxity(job, t)) && (t + overtake < end))
+                    end=t + overtake;
+            }
+        }
+
+        run=end - t;
+        segStart=t;
+        job->remaining-=run;
+        job->np-=(job->np < run) ? job->np : run;
+
+        // a higher priority job held off by a non-preemptive section is blocked
+        if((best != NO_SERVICE) && (best != running))
+            sim_head(&sim, best)->blocked+=run;
+
+        t=end;
+        sim_trace(&sim, NULL, running, job->index, segStart, t);
+
+        if(job->remaining == 0)
+        {
+            stats=&result->service[running];
+            stats->jobs++;
+            stats->sumResponse+=t - job->arrival;
+            if((t - job->arrival) > stats->maxResponse) stats->maxResponse=t - job->arrival;
+            if(job->blocked > stats->maxBlocking) stats->maxBlocking=job->blocked;
+            if(t > job->deadline) stats->misses++;
+
+            if(cfg->jobs != NULL)
+                fprintf(cfg->jobs, "%d,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%d\n", running, job->index, job->arrival,
+                        job->release, job->start, t, t - job->arrival, job->blocked, (t > job->deadline));
+
+            svc=&sim.svc[running];
+            svc->head=(svc->head + 1) % svc->capacity;
+            svc->count--;
+
+            if(svc->count == 0)
+                heap_remove(&sim, &sim.ready, running);
+            else
+                heap_fix(&sim, &sim.ready, sim.ready.pos[running]);
+
+            running=NO_SERVICE;
+        }
+    }
+
+    sim_trace_flush(&sim);
+
+    // jobs still pending whose deadline has passed missed it
+    for(s=0; s < n; s++)
+    {
+        svc=&sim.svc[s];
+        for(i=0; i < svc->count; i++)
+            if(svc->job[(svc->head + i) % svc->capacity].deadline <= result->duration)
+                result->service[s].misses++;
+    }
+
+    for(s=0; s < n; s++)
+    {
+        result->jobs+=result->service[s].jobs;
+        result->misses+=result->service[s].misses;
+        free(sim.svc[s].job);
+    }
+
+    free(sim.svc); free(order);
+    free(sim.ready.heap); free(sim.ready.pos);
+    free(sim.release.heap); free(sim.release.pos);
+
+    return rc;
+}
@@ -0,0 +1,385 @@
+// Service timing estimated from measured traces
+//
+// Two kinds of trace are read, told apart by the magic number at the start of the binary one:
+//
+// 1) syslog - the release lines of the seqgen*.c and seqv4l2.c examples, e.g.
+//
+//      Dec  5 22:09:32 host seqgen: Frame Sampler release 7 @ sec=3, msec=998
+//      ... seqv4l2: S1 at 25 Hz on core 2 for release 5 @ sec=0.200123456
+//
+//    which give the period and release jitter of each service, and the summary lines written
+//    by seq_report() in seqlib.c, "<name> releases=... maxexec=<n> nsec maxresp=<n> nsec ...",
+//    which give the largest execution and response times.  The examples do not log completions,
+//    so a syslog trace without summary lines has no execution times at all.
+// 2) binary - the job trace written by seq_trace_write() in sequencer_generic/seqlib.c (see
+//    seqtrace.h), with the release, start and completion time and the CPU time of every job.
+//
+// The period is the average release spacing, from the first to the last release, and the
+// jitter the peak to peak deviation of the releases from that ideal grid.  Release k of a
+// syslog trace is numbered by its line, and of a binary trace by rounding its offset from the
+// first release to the declared period, so skipped releases do not distort the period.
+//
+// The pWCET is a Gumbel fit to the maxima of blocks of execution times, by the method of
+// moments, and is the execution time a block maximum exceeds with the given probability:
+//
+//   beta = s * sqrt(6) / pi,  mu = mean - 0.5772 * beta,  pWCET = mu - beta * ln(-ln(1 - p))
+//
+// The execution time of a job is the CPU time of its thread, so it does not include the time
+// the job was preempted, which completion minus start would for all but the highest priority
+// service.  Version 1 traces have no CPU time and fall back to completion minus start, which is
+// pessimistic under preemption.
+//
+// Cucu-Grosjean, Liliana, et al. "Measurement-based probabilistic timing analysis for
+// multi-path programs." 24th Euromicro Conference on Real-Time Systems (2012): 91-101.
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+
+#include "feaslib.h"
+#include "seqtrace.h"
+
+#define LINE_LEN (1024)
+#define INITIAL_SAMPLES (256)
+
+// fewest block maxima the Gumbel fit is made from
+#define FEAS_TRACE_MIN_BLOCKS (5)
+
+#define EULER_GAMMA (0.5772156649)
+
+
+// Samples gathered for one service while reading a trace, times in microseconds
+typedef struct
+{
+    double *release;
+    double *releaseIndex;
+    double *exec;
+    unsigned long long numReleases, maxReleases;
+    unsigned long long numExec, maxExec;
+    double maxExecUsec, maxResponseUsec;
+} feasTraceSamples_t;
+
+
+static int feas_trace_push(double **array, unsigned long long *num, unsigned long long *max, double value)
+{
+    if(*num == *max)
+    {
+        *max=(*max == 0) ? INITIAL_SAMPLES : (*max * 2);
+        if((*array=realloc(*array, *max * sizeof(double))) == NULL)
+            return FEAS_ERROR;
+    }
+
+    (*array)[(*num)++]=value;
+    return FEAS_OK;
+}
+
+
+static int feas_trace_add_release(feasTraceSamples_t *samples, double index, double releaseUsec)
+{
+    unsigned long long num=samples->numReleases, max=samples->maxReleases;
+
+    if(feas_trace_push(&samples->releaseIndex, &num, &max, index) != FEAS_OK)
+        return FEAS_ERROR;
+
+    return feas_trace_push(&samples->release, &samples->numReleases, &samples->maxReleases, releaseUsec);
+}
+
+
+static int feas_trace_add_exec(feasTraceSamples_t *samples, double execUsec, double responseUsec)
+{
+    if(execUsec > samples->maxExecUsec) samples->maxExecUsec=execUsec;
+    if(responseUsec > samples->maxResponseUsec) samples->maxResponseUsec=responseUsec;
+
+    return feas_trace_push(&samples->exec, &samples->numExec, &samples->maxExec, execUsec);
+}
+
+
+// Find or add a service by name, growing both arrays together
+static int feas_trace_service(feasTraceService_t **svc, feasTraceSamples_t **samples, int *numServices,
+                              int *maxServices, const char *name)
+{
+    int i;
+
+    for(i=0; i < *numServices; i++)
+        if(strcmp((*svc)[i].name, name) == 0)
+            return i;
+
+    if(*numServices == *maxServices)
+    {
+        *maxServices=(*maxServices == 0) ? 8 : (*maxServices * 2);
+        *svc=realloc(*svc, *maxServices * sizeof(feasTraceService_t));
+        *samples=realloc(*samples, *maxServices * sizeof(feasTraceSamples_t));
+        if((*svc == NULL) || (*samples == NULL)) return FEAS_ERROR;
+    }
+
+    memset(&(*svc)[i], 0, sizeof(feasTraceService_t));
+    memset(&(*samples)[i], 0, sizeof(feasTraceSamples_t));
+    strncpy((*svc)[i].name, name, FEAS_NAME_LEN-1);
+    (*numServices)++;
+
+    return i;
+}
+
+
+// Service name of a syslog line, the text after the "ident: " prefix up to end, without any
+// " on core N" part, which changes from release to release
+static void feas_trace_name(const char *line, const char *end, char *name)
+{
+    const char *begin=strstr(line, ": "), *core;
+    int len;
+
+    begin=((begin == NULL) || (begin > end)) ? line : (begin + 2);
+
+    if(((core=strstr(begin, " on core ")) != NULL) && (core < end))
+        end=core;
+
+    while((end > begin) && isspace((unsigned char)end[-1])) end--;
+
+    len=(int)(end - begin);
+    if(len > FEAS_NAME_LEN-1) len=FEAS_NAME_LEN-1;
+
+    memcpy(name, begin, len);
+    name[len]='\0';
+}
+
+
+static int feas_load_syslog(FILE *fp, feasTraceService_t **svc, feasTraceSamples_t **samples,
+                            int *numServices, int *maxServices)
+{
+    char line[LINE_LEN], name[FEAS_NAME_LEN], *field;
+    unsigned long long releaseNum, execNsec, responseNsec;
+    double sec, msec;
+    int i;
+
+    while(fgets(line, LINE_LEN, fp) != NULL)
+    {
+        if((field=strstr(line, " release ")) != NULL)
+        {
+            // "<name> release <n> @ sec=<s>[, msec=<ms>]"
+            if(sscanf(field, " release %llu @ sec=%lf", &releaseNum, &sec) != 2)
+                continue;
+
+            msec=0.0;
+            if((field=strstr(field, "msec=")) != NULL)
+                sscanf(field, "msec=%lf", &msec);
+
+            feas_trace_name(line, strstr(line, " release "), name);
+
+            if(((i=feas_trace_service(svc, samples, numServices, maxServices, name)) == FEAS_ERROR) ||
+               (feas_trace_add_release(&(*samples)[i], (double)releaseNum, (sec * 1000000.0) + (msec * 1000.0)) != FEAS_OK))
+                return FEAS_ERROR;
+        }
+        else if((field=strstr(line, " releases=")) != NULL)
+        {
+            // seq_report() summary
+            if((strstr(field, "maxexec=") == NULL) || (strstr(field, "maxresp=") == NULL))
+                continue;
+
+            sscanf(strstr(field, "maxexec="), "maxexec=%llu", &execNsec);
+            sscanf(strstr(field, "maxresp="), "maxresp=%llu", &responseNsec);
+
+            feas_trace_name(line, field, name);
+
+            if((i=feas_trace_service(svc, samples, numServices, maxServices, name)) == FEAS_ERROR)
+                return FEAS_ERROR;
+
+            if((double)execNsec / 1000.0 > (*samples)[i].maxExecUsec)
+                (*samples)[i].maxExecUsec=(double)execNsec / 1000.0;
+            if((double)responseNsec / 1000.0 > (*samples)[i].maxResponseUsec)
+                (*samples)[i].maxResponseUsec=(double)responseNsec / 1000.0;
+        }
+    }
+
+    return FEAS_OK;
+}
+
+
+static int feas_load_binary(FILE *fp, const char *fileName, feasTraceService_t **svc,
+                            feasTraceSamples_t **samples, int *numServices, int *maxServices)
+{
+    seqTraceHeader_t header;
+    seqTraceService_t *desc;
+    seqTraceJob_t job;
+    unsigned long long j;
+    double first=0.0, period;
+    size_t jobSize=sizeof(job);
+    U32_T s;
+    int i, rc=FEAS_OK;
+
+    if((fread(&header, sizeof(header), 1, fp) != 1) || (header.version < 1) || (header.version > SEQ_TRACE_VERSION))
+    {
+        printf("%s: unsupported trace version\n", fileName);
+        return FEAS_ERROR;
+    }
+
+    // version 1 job records end before execNsec
+    if(header.version == 1)
+        jobSize=offsetof(seqTraceJob_t, execNsec);
+
+    if((desc=malloc((header.numServices + 1) * sizeof(seqTraceService_t))) == NULL)
+        return FEAS_ERROR;
+
+    if(fread(desc, sizeof(seqTraceService_t), header.numServices, fp) != header.numServices)
+    {
+        printf("%s: truncated service table\n", fileName);
+        free(desc);
+        return FEAS_ERROR;
+    }
+
+    for(s=0; (s < header.numServices) && (rc == FEAS_OK); s++)
+    {
+        desc[s].name[SEQ_TRACE_NAME_LEN-1]='\0';
+
+        if((i=feas_trace_service(svc, samples, numServices, maxServices, desc[s].name)) == FEAS_ERROR)
+        {
+            rc=FEAS_ERROR;
+            break;
+        }
+
+        (*svc)[i].declaredPeriodUsec=(double)desc[s].periodNsec / 1000.0;
+        period=(desc[s].periodNsec > 0) ? ((double)desc[s].periodNsec / 1000.0) : 1.0;
+
+        for(j=0; (j < desc[s].numJobs) && (rc == FEAS_OK); j++)
+        {
+            if(fread(&job, jobSize, 1, fp) != 1)
+            {
+                printf("%s: truncated jobs of %s\n", fileName, desc[s].name);
+                rc=FEAS_ERROR;
+                break;
+            }
+
+            if(header.version == 1)
+                job.execNsec=job.endNsec - job.startNsec;
+
+            if(j == 0) first=(double)job.releaseNsec / 1000.0;
+
+            if((feas_trace_add_release(&(*samples)[i], floor((((double)job.releaseNsec / 1000.0) - first) / period + 0.5),
+                                       (double)job.releaseNsec / 1000.0) != FEAS_OK) ||
+               (feas_trace_add_exec(&(*samples)[i], (double)job.execNsec / 1000.0,
+                                    (double)(job.endNsec - job.releaseNsec) / 1000.0) != FEAS_OK))
+                rc=FEAS_ERROR;
+        }
+    }
+
+    free(desc);
+    return rc;
+}
+
+
+// Gumbel fit to block maxima of the execution times, 0 if there are too few blocks
+static double feas_gumbel_pwcet(double exec[], unsigned long long numExec, U32_T blockSize, double exceedance)
+{
+    unsigned long long numBlocks=numExec / blockSize, b, j;
+    double blockMax, sum=0.0, sumSq=0.0, mean, var, beta, mu;
+
+    if((blockSize == 0) || (numBlocks < FEAS_TRACE_MIN_BLOCKS))
+        return 0.0;
+
+    for(b=0; b < numBlocks; b++)
+    {
+        blockMax=exec[b * blockSize];
+        for(j=1; j < blockSize; j++)
+            if(exec[(b * blockSize) + j] > blockMax)
+                blockMax=exec[(b * blockSize) + j];
+
+        sum+=blockMax;
+        sumSq+=blockMax * blockMax;
+    }
+
+    mean=sum / (double)numBlocks;
+    var=(sumSq - (sum * mean)) / (double)(numBlocks - 1);
+    if(var < 0.0) var=0.0;
+
+    beta=sqrt(var * 6.0) / M_PI;
+    mu=mean - (EULER_GAMMA * beta);
+
+    // -ln(1 - p) computed as -log1p(-p) so small probabilities do not round to 0
+    return mu - (beta * log(-log1p(-exceedance)));
+}
+
+
+static void feas_trace_estimate(feasTraceService_t *svc, feasTraceSamples_t *samples, U32_T blockSize,
+                                double exceedance)
+{
+    unsigned long long k, n=samples->numReleases;
+    double ideal, dev, minDev=0.0, maxDev=0.0, sum=0.0;
+
+    svc->releases=n;
+    svc->jobs=samples->numExec;
+    svc->wcetUsec=samples->maxExecUsec;
+    svc->maxResponseUsec=samples->maxResponseUsec;
+
+    if((n > 1) && (samples->releaseIndex[n-1] > samples->releaseIndex[0]))
+    {
+        svc->periodUsec=(samples->release[n-1] - samples->release[0]) /
+                        (samples->releaseIndex[n-1] - samples->releaseIndex[0]);
+
+        for(k=0; k < n; k++)
+        {
+            ideal=samples->release[0] + ((samples->releaseIndex[k] - samples->releaseIndex[0]) * svc->periodUsec);
+            dev=samples->release[k] - ideal;
+
+            if((k == 0) || (dev < minDev)) minDev=dev;
+            if((k == 0) || (dev > maxDev)) maxDev=dev;
+        }
+
+        svc->jitterUsec=maxDev - minDev;
+    }
+    else
+    {
+        svc->periodUsec=svc->declaredPeriodUsec;
+    }
+
+    for(k=0; k < samples->numExec; k++)
+        sum+=samples->exec[k];
+
+    svc->meanExecUsec=(samples->numExec > 0) ? (sum / (double)samples->numExec) : 0.0;
+    svc->pwcetUsec=feas_gumbel_pwcet(samples->exec, samples->numExec, blockSize, exceedance);
+}
+
+
+int feas_load_trace(const char *fileName, U32_T blockSize, double exceedance, feasTraceService_t **svc,
+                    int *numServices)
+{
+    FILE *fp;
+    uint32_t magic=0;
+    feasTraceSamples_t *samples=NULL;
+    int maxServices=0, rc, i;
+
+    *svc=NULL; *numServices=0;
+
+    if((fp=fopen(fileName, "rb")) == NULL)
+    {
+        perror(fileName);
+        return FEAS_ERROR;
+    }
+
+    if((fread(&magic, sizeof(magic), 1, fp) == 1) && (magic == SEQ_TRACE_MAGIC))
+    {
+        rewind(fp);
+        rc=feas_load_binary(fp, fileName, svc, &samples, numServices, &maxServices);
+    }
+    else
+    {
+        rewind(fp);
+        rc=feas_load_syslog(fp, svc, &samples, numServices, &maxServices);
+    }
+
+    fclose(fp);
+
+    for(i=0; i < *numServices; i++)
+    {
+        if(rc == FEAS_OK)
+            feas_trace_estimate(&(*svc)[i], &samples[i], blockSize, exceedance);
+
+        free(samples[i].release);
+        free(samples[i].releaseIndex);
+        free(samples[i].exec);
+    }
+
+    free(samples);
+    return rc;
+}
@@ -1,10 +1,218 @@
 #include "raidtest.h"
 
 
+// stripe PERF_FILE_INPUT, then restore it with chunk 2 deleted, and print the MB/s of each
+void timeStripeFile(void)
+{
+    struct timeval StartTime, StopTime;
+    long long bytes, restored, microsecs;
+    double mbps[2];
+
+    gettimeofday(&StartTime, 0);
+    bytes=stripeFile(PERF_FILE_INPUT, 0);
+    gettimeofday(&StopTime, 0);
+    assert(bytes == PERF_FILE_BYTES);
+    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+    mbps[0]=(double)bytes / (double)microsecs;
+
+    unlink("StripeChunk2.bin");
+
+    gettimeofday(&StartTime, 0);
+    restored=restoreFile(PERF_FILE_OUTPUT, 0, bytes, 2);
+    assert(restored == bytes);
+    gettimeofday(&StopTime, 0);
+    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+    mbps[1]=(double)bytes / (double)microsecs;
+
+    printf("%-8d %8d %-9s %6d %14.1f %14.1f\n", raidGetChunkSize() / 1024, raidGetThreads(),
+           raidIOEngineName(raidGetIOEngine()), raidGetQueueDepth(), mbps[0], mbps[1]);
+}
+
+
+// stripe PERF_FILE_INPUT, restore it whole, then with chunk target 2 deleted, and print the
+// MB/s of each for the layout set
+void timeLayout(void)
+{
+    struct timeval StartTime, StopTime;
+    long long bytes, restored, microsecs;
+    double mbps[3];
+    int missing;
+
+    gettimeofday(&StartTime, 0);
+    bytes=stripeFile(PERF_FILE_INPUT, 0);
+    gettimeofday(&StopTime, 0);
+    assert(bytes == PERF_FILE_BYTES);
+    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+    mbps[0]=(double)bytes / (double)microsecs;
+
+    for(missing=0; missing <= 2; missing+=2)
+    {
+        if(missing > 0)
+            unlink(raidGetChunkPath(missing));
+
+        gettimeofday(&StartTime, 0);
+        restored=restoreFile(PERF_FILE_OUTPUT, 0, bytes, missing);
+        assert(restored == bytes);
+        gettimeofday(&StopTime, 0);
+        microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+        mbps[1 + missing / 2]=(double)bytes / (double)microsecs;
+    }
+
+    printf("%-9s %8d %14.1f %14.1f %14.1f\n", raidLayoutName(raidGetLayout()), raidGetChunkSize() / 1024,
+           mbps[0], mbps[1], mbps[2]);
+}
+
+
+// PERF_BLOCK_WRITES writes of PERF_WRITE_SECTORS, in order from sector 0 or at random
+// aligned sectors, to an array on the chunk targets, then print the MB/s and writes a second,
+// the stripes written whole and by read-modify-write, and the busiest target's share of the
+// chunk writes
+void timeBlockWrites(int sequential)
+{
+    struct timeval StartTime, StopTime;
+    raidArray_t *array;
+    raidArrayStats_t stats;
+    unsigned char *buf;
+    long long microsecs, lba, maxWrites=0, allWrites=0;
+    int idx, rc;
+
+    buf=malloc(PERF_WRITE_SECTORS * SECTOR_SIZE);
+    memset(buf, 0xa5, PERF_WRITE_SECTORS * SECTOR_SIZE);
+    array=raidOpenArray(0, PERF_ARRAY_SECTORS);
+    assert(array != NULL);
+
+    gettimeofday(&StartTime, 0);
+    for(idx=0; idx < PERF_BLOCK_WRITES; idx++)
+    {
+        lba=sequential ? ((long long)idx * PERF_WRITE_SECTORS) :
+                         (((long long)rand() * PERF_WRITE_SECTORS) % PERF_ARRAY_SECTORS);
+        rc=raidWriteLBA(array, lba % PERF_ARRAY_SECTORS, PERF_WRITE_SECTORS, buf);
+        assert(rc == OK);
+    }
+    rc=raidFlushArray(array);
+    assert(rc == OK);
+    gettimeofday(&StopTime, 0);
+    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+
+    raidGetArrayStats(array, &stats);
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        allWrites+=stats.targetWrites[idx];
+        if(stats.targetWrites[idx] > maxWrites) maxWrites=stats.targetWrites[idx];
+    }
+
+    printf("%-9s %6d %-7s %10.1f %10.0f %8lld %8lld %13.1f%%\n", raidLayoutName(raidGetLayout()),
+           raidGetCacheStripes(), sequential ? "seq" : "random",
+           ((double)PERF_BLOCK_WRITES * PERF_WRITE_SECTORS * SECTOR_SIZE) / (double)microsecs,
+           (double)PERF_BLOCK_WRITES * 1000000.0 / (double)microsecs,
+           stats.fullStripeWrites, stats.rmwWrites, 100.0 * (double)maxWrites / (double)allWrites);
+
+    raidCloseArray(array);
+    free(buf);
+}
+
+
+// Lose target 2 of an array written end to end and time random PERF_WRITE_SECTORS reads,
+// degraded, while rebuilding it at rate MB/s, 0 for no limit, printing the progress every
+// half second, or for PERF_BLOCK_WRITES reads with no rebuild if rate is negative
+void timeRebuild(int rate)
+{
+    struct timeval StartTime, StopTime, LastReport;
+    raidArray_t *array;
+    raidRebuildStatus_t status;
+    unsigned char *buf;
+    long long microsecs, maxMicrosecs=0, totalMicrosecs=0, lba, numReads=0;
+    int rc;
+
+    buf=malloc(RAID_DATA_CHUNKS * RAID_MAX_CHUNK_SIZE);
+    memset(buf, 0x3c, RAID_DATA_CHUNKS * RAID_MAX_CHUNK_SIZE);
+    array=raidOpenArray(0, PERF_ARRAY_SECTORS);
+    assert(array != NULL);
+    for(lba=0; lba < PERF_ARRAY_SECTORS; lba+=RAID_DATA_CHUNKS * raidGetChunkSize() / SECTOR_SIZE)
+    {
+        rc=raidWriteLBA(array, lba, RAID_DATA_CHUNKS * raidGetChunkSize() / SECTOR_SIZE, buf);
+        assert(rc == OK);
+    }
+
+    rc=raidFailTarget(array, 2);
+    assert(rc == OK);
+    if(rate >= 0)
+    {
+        rc=raidSetRebuildRate(rate);
+        assert(rc == OK);
+        rc=raidStartRebuild(array, NULL);
+        assert(rc == OK);
+    }
+    gettimeofday(&LastReport, 0);
+
+    while(TRUE)
+    {
+        raidGetRebuildStatus(array, &status);
+        if((rate >= 0) ? !status.active : (numReads == PERF_BLOCK_WRITES))
+            break;
+
+        lba=((long long)rand() * PERF_WRITE_SECTORS) % PERF_ARRAY_SECTORS;
+        gettimeofday(&StartTime, 0);
+        rc=raidReadLBA(array, lba, PERF_WRITE_SECTORS, buf);
+        assert(rc == OK);
+        gettimeofday(&StopTime, 0);
+        microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+        totalMicrosecs+=microsecs;
+        if(microsecs > maxMicrosecs) maxMicrosecs=microsecs;
+        numReads++;
+
+        if((rate >= 0) && (((StopTime.tv_sec - LastReport.tv_sec)*1000000LL) + (StopTime.tv_usec - LastReport.tv_usec) > 500000))
+        {
+            printf("    rebuilding target %d: %5.1f%% %8.1f MB/s, %.1f s to go\n", status.chunk, status.percent,
+                   status.mbPerSec, status.etaSeconds);
+            LastReport=StopTime;
+        }
+    }
+
+    if(rate >= 0)
+    {
+        rc=raidWaitRebuild(array);
+        assert(rc == OK);
+    }
+    raidGetRebuildStatus(array, &status);
+
+    if(rate < 0)
+        printf("%-10s %12s %10s %10lld %12.1f %12lld\n", "degraded", "-", "-", numReads,
+               (double)totalMicrosecs / (double)numReads, maxMicrosecs);
+    else if(rate == 0)
+        printf("%-10s %12.1f %10.2f %10lld %12.1f %12lld\n", "no limit", status.mbPerSec, status.seconds, numReads,
+               numReads ? (double)totalMicrosecs / (double)numReads : 0.0, maxMicrosecs);
+    else
+        printf("%-4d MB/s  %12.1f %10.2f %10lld %12.1f %12lld\n", rate, status.mbPerSec, status.seconds, numReads,
+               numReads ? (double)totalMicrosecs / (double)numReads : 0.0, maxMicrosecs);
+
+    raidSetRebuildRate(0);
+    raidCloseArray(array);
+    free(buf);
+}
+
+
+// time a scrub of the striped PERF_FILE_INPUT, and print its MB/s of data and what it found
+void timeScrub(const char *name, int repair)
+{
+    struct timeval StartTime, StopTime;
+    raidScrubStats_t stats;
+    long long microsecs, stripes;
+
+    gettimeofday(&StartTime, 0);
+    stripes=raidScrub(0, PERF_ARRAY_SECTORS, repair, &stats);
+    assert(stripes != ERROR);
+    gettimeofday(&StopTime, 0);
+    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000LL) + (StopTime.tv_usec - StartTime.tv_usec);
+
+    printf("%-22s %10.1f %12lld %10lld %10lld\n", name, (double)(PERF_ARRAY_SECTORS * SECTOR_SIZE) / (double)microsecs,
+           stats.checksumErrors, stats.parityErrors, stats.repaired);
+}
+
 
 int main(int argc, char *argv[])
 {
-	int idx, LBAidx, numTestIterations, rc;
+	int idx, LBAidx, numTestIterations, rc, written;
 	double rate=0.0;
 	double totalRate=0.0, aveRate=0.0;
 	struct timeval StartTime, StopTime;
@@ -82,4 +290,401 @@ int main(int argc, char *argv[])
         // END TEST CASE #1
 
 
+        // TEST CASE #2
+        //
+        // Parity throughput of each kernel supported on this CPU, XOR of 4 data buffers into
+        // parity as in xorLBA(), for single sectors which stay in cache and for large blocks
+        // which stream from memory as a rebuild does.  GB/s counts the data bytes read.
+        //
+        printf("\nParity Kernel Throughput Test (default kernel %s)\n", xorKernelName(xorCurrentKernel()));
+        printf("%-8s %14s %14s\n", "kernel", "512B GB/s", "1MB GB/s");
+
+        {
+            unsigned char *blockBuf[5], *src[4];
+            int kernel, defaultKernel=xorCurrentKernel(), size, len, loops, s;
+            double gbps[2];
+
+            for(s=0; s < 5; s++)
+            {
+                rc=posix_memalign((void **)&blockBuf[s], 64, PERF_BLOCK_SIZE);
+                assert(rc == 0);
+                memset(blockBuf[s], s + 1, PERF_BLOCK_SIZE);
+            }
+
+            for(kernel=0; kernel < xorKernelCount(); kernel++)
+            {
+                if(xorSelectKernel(kernel) != OK)
+                {
+                    printf("%-8s %14s %14s\n", xorKernelName(kernel), "unsupported", "unsupported");
+                    continue;
+                }
+
+                for(size=0; size < 2; size++)
+                {
+                    len=(size == 0) ? SECTOR_SIZE : PERF_BLOCK_SIZE;
+                    loops=PERF_BYTES / (4 * len);
+
+                    // successive sectors through the buffer, so the 512B case is not one line
+                    gettimeofday(&StartTime, 0);
+                    for(idx=0; idx < loops; idx++)
+                    {
+                        LBAidx=(size == 0) ? ((idx % (PERF_BLOCK_SIZE / SECTOR_SIZE)) * SECTOR_SIZE) : 0;
+                        for(s=0; s < 4; s++) src[s]=&blockBuf[s][LBAidx];
+                        xorBlocks(src, 4, &blockBuf[4][LBAidx], len);
+                    }
+                    gettimeofday(&StopTime, 0);
+
+                    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000) + (StopTime.tv_usec - StartTime.tv_usec);
+                    gbps[size]=((double)loops * 4.0 * (double)len) / ((double)microsecs * 1000.0);
+                }
+
+                printf("%-8s %14.2f %14.2f\n", xorKernelName(kernel), gbps[0], gbps[1]);
+            }
+
+            xorSelectKernel(defaultKernel);
+            for(s=0; s < 5; s++) free(blockBuf[s]);
+        }
+        //
+        // END TEST CASE #2
+
+
+        // TEST CASE #3
+        //
+        // Stripe coding throughput for each width in PERF_WIDTHS, with 64 KB chunks: N+1 encode
+        // (P only), N+2 encode (P and Q) and N+2 recovery of the two first data chunks, the
+        // slowest case, which multiplies every surviving chunk.  GB/s counts the data bytes of
+        // the stripe.  The GF kernel is the default, see TEST CASE 4 of raidtest for the others.
+        //
+        printf("\nStripe Coding Throughput Test (GF kernel %s, %d KB chunks)\n",
+               gfKernelName(gfCurrentKernel()), PERF_CHUNK_SIZE / 1024);
+        printf("%-8s %14s %14s %14s\n", "width", "N+1 GB/s", "N+2 GB/s", "2 lost GB/s");
+
+        {
+            unsigned char *chunk[RAID_MAX_DATA + 2];
+            int width[]=PERF_WIDTHS, w, numData, test, loops, s;
+            double gbps[3];
+
+            for(w=0; w < (int)(sizeof(width)/sizeof(int)); w++)
+            {
+                numData=width[w];
+                loops=PERF_BYTES / (numData * PERF_CHUNK_SIZE);
+
+                for(s=0; s < numData + 2; s++)
+                {
+                    rc=posix_memalign((void **)&chunk[s], 64, PERF_CHUNK_SIZE);
+                    assert(rc == 0);
+                    memset(chunk[s], s + 1, PERF_CHUNK_SIZE);
+                }
+
+                for(test=0; test < 3; test++)
+                {
+                    raidEncodeStripe(chunk, numData, 2, PERF_CHUNK_SIZE);
+
+                    gettimeofday(&StartTime, 0);
+                    for(idx=0; idx < loops; idx++)
+                    {
+                        if(test == 0)
+                            raidEncodeStripe(chunk, numData, 1, PERF_CHUNK_SIZE);
+                        else if(test == 1)
+                            raidEncodeStripe(chunk, numData, 2, PERF_CHUNK_SIZE);
+                        else
+                            raidRecoverStripe(chunk, numData, 2, PERF_CHUNK_SIZE, 0, (numData > 1) ? 1 : numData);
+                    }
+                    gettimeofday(&StopTime, 0);
+
+                    microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000) + (StopTime.tv_usec - StartTime.tv_usec);
+                    gbps[test]=((double)loops * (double)numData * (double)PERF_CHUNK_SIZE) / ((double)microsecs * 1000.0);
+                }
+
+                printf("%-8d %14.2f %14.2f %14.2f\n", numData, gbps[0], gbps[1], gbps[2]);
+
+                for(s=0; s < numData + 2; s++) free(chunk[s]);
+            }
+        }
+        //
+        // END TEST CASE #3
+
+
+        // TEST CASE #4
+        //
+        // File stripe and restore throughput for each stripe unit in PERF_CHUNK_SIZES, with a
+        // data chunk file deleted before the restore so it is rebuilt, then for 1, 2, 4 up to
+        // PERF_MAX_THREADS parity threads, and then for each I/O engine, io_uring with 1, 4
+        // and 16 batches in flight.  MB/s counts the bytes of the file.  The files go
+        // through the page cache, so this is the rate the library can feed a device, not the
+        // device rate, unless the file is larger than memory, and the threads only scale with
+        // as many CPUs.
+        //
+        printf("\nFile Stripe Throughput Test (%lld MB file, %d parity threads, %ld CPUs)\n",
+               PERF_FILE_BYTES / (1024*1024), raidGetThreads(), sysconf(_SC_NPROCESSORS_ONLN));
+        printf("%-8s %8s %-9s %6s %14s %14s\n", "unit KB", "threads", "engine", "depth", "stripe MB/s", "rebuild MB/s");
+
+        {
+            unsigned char *fileBuf;
+            int chunkSize[]=PERF_CHUNK_SIZES, c, fd, threads, defaultChunkSize=raidGetChunkSize();
+            int defaultThreads=raidGetThreads(), defaultEngine=raidGetIOEngine(), depth;
+            long long done;
+
+            fileBuf=malloc(PERF_BLOCK_SIZE);
+            for(idx=0; idx < PERF_BLOCK_SIZE; idx++) fileBuf[idx]=idx * 7;
+
+            fd=open(PERF_FILE_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            for(done=0; done < PERF_FILE_BYTES; done+=PERF_BLOCK_SIZE)
+            {
+                written=write(fd, fileBuf, PERF_BLOCK_SIZE);
+                assert(written == PERF_BLOCK_SIZE);
+            }
+            close(fd);
+
+            for(c=0; c < (int)(sizeof(chunkSize)/sizeof(int)); c++)
+            {
+                rc=raidSetChunkSize(chunkSize[c]);
+                assert(rc == OK);
+                timeStripeFile();
+            }
+
+            rc=raidSetChunkSize(64*1024);
+            assert(rc == OK);
+            for(threads=1; threads <= PERF_MAX_THREADS; threads*=2)
+            {
+                rc=raidSetThreads(threads);
+                assert(rc == OK);
+                timeStripeFile();
+            }
+            raidSetThreads(defaultThreads);
+
+            if(raidSetIOEngine(RAID_IO_THREADS) == OK)
+                timeStripeFile();
+
+            for(depth=1; (depth <= RAID_MAX_QUEUE_DEPTH) && (raidSetIOEngine(RAID_IO_URING) == OK); depth*=4)
+            {
+                rc=raidSetQueueDepth(depth);
+                assert(rc == OK);
+                timeStripeFile();
+            }
+
+            raidSetChunkSize(defaultChunkSize);
+            raidSetIOEngine(defaultEngine);
+            raidSetQueueDepth(RAID_DEFAULT_QUEUE_DEPTH);
+            unlink(PERF_FILE_INPUT);
+            unlink(PERF_FILE_OUTPUT);
+            free(fileBuf);
+        }
+        //
+        // END TEST CASE #4
+
+
+        // TEST CASE #5
+        //
+        // File stripe (write), restore (read) and degraded restore throughput with the XOR
+        // chunk on the fifth target, RAID-4, and rotating, RAID-5 left symmetric, for each
+        // stripe unit in PERF_CHUNK_SIZES.  A whole file moves as many bytes to or from each
+        // target with either layout, so the rotation shows as the cost of mapping each stripe,
+        // and its gain, spreading the parity writes of small updates, needs random writes.
+        //
+        printf("\nLayout Throughput Test (%lld MB file)\n", PERF_FILE_BYTES / (1024*1024));
+        printf("%-9s %8s %14s %14s %14s\n", "layout", "unit KB", "stripe MB/s", "read MB/s", "degraded MB/s");
+
+        {
+            unsigned char *fileBuf;
+            int chunkSize[]=PERF_CHUNK_SIZES, c, fd, layout, defaultChunkSize=raidGetChunkSize();
+            long long done;
+
+            fileBuf=malloc(PERF_BLOCK_SIZE);
+            for(idx=0; idx < PERF_BLOCK_SIZE; idx++) fileBuf[idx]=idx * 7;
+
+            fd=open(PERF_FILE_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            for(done=0; done < PERF_FILE_BYTES; done+=PERF_BLOCK_SIZE)
+            {
+                written=write(fd, fileBuf, PERF_BLOCK_SIZE);
+                assert(written == PERF_BLOCK_SIZE);
+            }
+            close(fd);
+
+            for(c=0; c < (int)(sizeof(chunkSize)/sizeof(int)); c++)
+            {
+                rc=raidSetChunkSize(chunkSize[c]);
+                assert(rc == OK);
+                for(layout=RAID_LAYOUT_FIXED; layout <= RAID_LAYOUT_LEFT_SYMMETRIC; layout++)
+                {
+                    rc=raidSetLayout(layout);
+                    assert(rc == OK);
+                    timeLayout();
+                }
+            }
+
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetChunkSize(defaultChunkSize);
+            unlink(PERF_FILE_INPUT);
+            unlink(PERF_FILE_OUTPUT);
+            free(fileBuf);
+        }
+        //
+        // END TEST CASE #5
+
+
+        // TEST CASE #6
+        //
+        // Block writes of PERF_WRITE_SECTORS sectors through raidWriteLBA(), for each layout
+        // written through and with the stripe cache, in order so the cache can make whole
+        // stripes of them with no reads, and at random so each is a read-modify-write.  With
+        // the fixed layout every read-modify-write also writes the fifth target, so it takes
+        // near half the chunk writes of random updates, against a fifth when rotated.
+        //
+        printf("\nBlock Write Test (%d writes of %d KB, %lld MB array, %d KB stripe unit)\n",
+               PERF_BLOCK_WRITES, PERF_WRITE_SECTORS * SECTOR_SIZE / 1024,
+               PERF_ARRAY_SECTORS * SECTOR_SIZE / (1024*1024), raidGetChunkSize() / 1024);
+        printf("%-9s %6s %-7s %10s %10s %8s %8s %14s\n", "layout", "cache", "writes", "MB/s", "writes/s",
+               "full", "rmw", "busiest target");
+
+        {
+            int layout, cache, sequential;
+
+            for(layout=RAID_LAYOUT_FIXED; layout <= RAID_LAYOUT_LEFT_SYMMETRIC; layout++)
+            {
+                rc=raidSetLayout(layout);
+                assert(rc == OK);
+                for(cache=0; cache <= RAID_DEFAULT_CACHE_STRIPES; cache+=RAID_DEFAULT_CACHE_STRIPES)
+                {
+                    rc=raidSetCacheStripes(cache);
+                    assert(rc == OK);
+                    for(sequential=TRUE; sequential >= FALSE; sequential--)
+                        timeBlockWrites(sequential);
+                }
+            }
+
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetCacheStripes(RAID_DEFAULT_CACHE_STRIPES);
+            for(idx=1; idx <= RAID_CHUNKS; idx++)
+                unlink(raidGetChunkPath(idx));
+        }
+        //
+        // END TEST CASE #6
+
+
+        // TEST CASE #7
+        //
+        // Random reads of PERF_WRITE_SECTORS from an array with a target lost, first with it
+        // only read degraded, then while it is rebuilt with no limit and at PERF_REBUILD_RATE
+        // MB/s.  A rebuild step holds the array for RAID_REBUILD_BYTES of each target, so it
+        // bounds the worst read, and the rate limit leaves the targets to the reads between
+        // steps, trading a longer rebuild for more reads and a lower mean read time.
+        //
+        printf("\nDegraded Read and Rebuild Test (%lld MB array, %d KB stripe unit, %d KB reads)\n",
+               PERF_ARRAY_SECTORS * SECTOR_SIZE / (1024*1024), raidGetChunkSize() / 1024,
+               PERF_WRITE_SECTORS * SECTOR_SIZE / 1024);
+        printf("%-10s %12s %10s %10s %12s %12s\n", "rebuild", "rebuild MB/s", "seconds", "reads", "mean usecs", "max usecs");
+
+        {
+            timeRebuild(-1);
+            timeRebuild(0);
+            timeRebuild(PERF_REBUILD_RATE);
+
+            for(idx=1; idx <= RAID_CHUNKS; idx++)
+                unlink(raidGetChunkPath(idx));
+        }
+        //
+        // END TEST CASE #7
+
+
+        // TEST CASE #8
+        //
+        // CRC32C throughput of each kernel a sector at a time, as the sector checksums are
+        // taken, then the cost of the checksums to stripeFile(), and a scrub of the striped
+        // file checking only the XOR, then the checksums too, then repairing PERF_SCRUB_CORRUPT
+        // sectors corrupted on the targets.  A scrub reads every target in full, so it runs at
+        // the speed of a whole file restore plus the XOR and checksums of every sector.
+        //
+        printf("\nChecksum Throughput Test (%d KB in sectors)\n", PERF_CHUNK_SIZE / 1024);
+        printf("%-8s %10s\n", "kernel", "GB/s");
+
+        {
+            unsigned char *buf;
+            unsigned int crc=0;
+            int kernel, defaultKernel=crcCurrentKernel(), sec, loops=PERF_BYTES / PERF_CHUNK_SIZE;
+
+            rc=posix_memalign((void **)&buf, 64, PERF_CHUNK_SIZE);
+            assert(rc == 0);
+            for(idx=0; idx < PERF_CHUNK_SIZE; idx++) buf[idx]=idx * 7;
+
+            for(kernel=0; kernel < crcKernelCount(); kernel++)
+            {
+                if(crcSelectKernel(kernel) != OK)
+                    continue;
+
+                gettimeofday(&StartTime, 0);
+                for(idx=0; idx < loops; idx++)
+                    for(sec=0; sec < PERF_CHUNK_SIZE; sec+=SECTOR_SIZE)
+                        crc^=crc32c(0, buf + sec, SECTOR_SIZE);
+                gettimeofday(&StopTime, 0);
+
+                microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000) + (StopTime.tv_usec - StartTime.tv_usec);
+                printf("%-8s %10.2f\n", crcKernelName(kernel), (double)loops * PERF_CHUNK_SIZE / ((double)microsecs * 1000.0));
+            }
+
+            // so the loops aren't optimized away
+            if(crc == 1) printf("\n");
+
+            crcSelectKernel(defaultKernel);
+            free(buf);
+        }
+
+        printf("\nScrub Test (%lld MB file, %d KB stripe unit, CRC32C kernel %s)\n",
+               PERF_ARRAY_SECTORS * SECTOR_SIZE / (1024*1024), raidGetChunkSize() / 1024, crcKernelName(crcCurrentKernel()));
+        printf("%-22s %10s %12s %10s %10s\n", "", "MB/s", "crc errors", "xor errors", "repaired");
+
+        {
+            unsigned char *fileBuf, junk=0xa5;
+            long long done, targetBytes, bytes;
+            int fd, crcOn;
+
+            fileBuf=malloc(PERF_BLOCK_SIZE);
+            for(idx=0; idx < PERF_BLOCK_SIZE; idx++) fileBuf[idx]=idx * 7;
+
+            fd=open(PERF_FILE_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            for(done=0; done < PERF_ARRAY_SECTORS * SECTOR_SIZE; done+=PERF_BLOCK_SIZE)
+            {
+                written=write(fd, fileBuf, PERF_BLOCK_SIZE);
+                assert(written == PERF_BLOCK_SIZE);
+            }
+            close(fd);
+
+            for(crcOn=FALSE; crcOn <= TRUE; crcOn++)
+            {
+                raidSetChecksumPath(crcOn ? "StripeChunkCRC.bin" : NULL);
+
+                gettimeofday(&StartTime, 0);
+                bytes=stripeFile(PERF_FILE_INPUT, 0);
+                assert(bytes == PERF_ARRAY_SECTORS * SECTOR_SIZE);
+                gettimeofday(&StopTime, 0);
+                microsecs=((StopTime.tv_sec - StartTime.tv_sec)*1000000) + (StopTime.tv_usec - StartTime.tv_usec);
+                printf("%-22s %10.1f\n", crcOn ? "stripe, checksums" : "stripe", (double)(PERF_ARRAY_SECTORS * SECTOR_SIZE) / (double)microsecs);
+            }
+
+            raidSetChecksumPath(NULL);
+            timeScrub("scrub, XOR only", FALSE);
+            raidSetChecksumPath("StripeChunkCRC.bin");
+            timeScrub("scrub, checksums", FALSE);
+
+            targetBytes=PERF_ARRAY_SECTORS * SECTOR_SIZE / RAID_DATA_CHUNKS;
+            for(idx=0; idx < PERF_SCRUB_CORRUPT; idx++)
+            {
+                fd=open(raidGetChunkPath(idx % RAID_CHUNKS + 1), O_RDWR);
+                written=pwrite(fd, &junk, 1, (((long long)rand() * SECTOR_SIZE) % targetBytes) + 1);
+                assert(written == 1);
+                close(fd);
+            }
+            timeScrub("scrub, repair", TRUE);
+
+            raidSetChecksumPath(NULL);
+            for(idx=1; idx <= RAID_CHUNKS; idx++)
+                unlink(raidGetChunkPath(idx));
+            unlink("StripeChunkCRC.bin");
+            unlink(PERF_FILE_INPUT);
+            free(fileBuf);
+        }
+        //
+        // END TEST CASE #8
+
+
 }
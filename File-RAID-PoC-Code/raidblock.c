@@ -0,0 +1,1098 @@
+// O_DIRECT
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <time.h>
+#include <sys/stat.h>
+
+#include "raidlib.h"
+
+
+// Block access to the striped data
+//
+// raidOpenArray() opens the chunk targets as stripeFile() lays them out, with the stripe
+// unit, layout, paths and O_DIRECT set at the time, and raidReadLBA() and raidWriteLBA() read
+// and write any sectors of the data, numbered from 0 at the start of stripe 0, as if it were
+// one disk.  Sectors never written read as zeros, and chunk files are grown to hold every
+// stripe of the array.  With O_DIRECT the stripes must start on a block of each target, of
+// raidTargetBlockSize(), and the sectors are read and written in whole blocks.
+//
+// A write of a whole stripe computes its XOR chunk from the new data and writes all five
+// chunks with no reads.  A smaller write is kept in a stripe cache of RAID_DEFAULT_CACHE_STRIPES
+// stripes, set with raidSetCacheStripes(), so that later writes to the same stripe, e.g. the
+// next sectors of a sequential stream, add to it.  Once a stripe has every data sector
+// written it too goes out whole with no reads.  Otherwise, when the stripe is evicted, least
+// recently used first, or on raidFlushArray() or raidCloseArray(), only the sectors written
+// are updated, by read-modify-write:
+//
+//   P' = P ^ Dold ^ Dnew
+//
+// reading the old data and XOR sectors under them, one read and one write of each chunk
+// touched and of the XOR chunk.  With the cache set to 0 stripes every write smaller than a
+// stripe is written through this way at once.  Reads take the sectors written but not yet
+// out from the cache.
+//
+// With a target lost, given by raidFailTarget(), the array runs degraded: a read of sectors on
+// the lost target reads the same sectors of the other four and XORs them, a whole stripe write
+// skips the lost target, and an update of a stripe whose XOR chunk is lost just writes the
+// data.  An update of a stripe with a lost data chunk is a reconstruct-write instead, reading
+// the span of the stripe being updated on the other targets, rebuilding the lost chunk's part
+// from them, and writing the XOR chunk computed from the new data.
+//
+// raidStartRebuild() regenerates the lost target onto a replacement from a background thread,
+// RAID_REBUILD_BYTES of it at a time, from the first stripe up.  Each step holds the array
+// lock, so reads and writes wait for at most one step, and stripes below those rebuilt use the
+// replacement as any other target while the rest are still degraded.  raidSetRebuildRate()
+// limits the rebuild to a rate, leaving the targets to the foreground I/O between steps, and
+// raidGetRebuildStatus() reports the progress, rate and time to go.  Once every stripe is
+// rebuilt the array is whole again.
+//
+// With a checksum file set, every write to a target, rebuild writes too, rewrites the
+// checksums of the sectors written, so raidScrub() finds the array clean after.  They are
+// kept a sector each so a write needs no reads of the target to checksum it.  Sectors
+// stripeFile() never wrote are zeros, with the checksum of a zero sector.
+//
+// Calls on an array are serialized by its lock, so it may be shared between threads.  Writes
+// in the cache are lost if the array is not flushed or closed, and as with any RAID-5
+// without a journal, a crash between the data and XOR writes of a stripe leaves the XOR
+// chunk stale until the stripe is written again.
+
+static int raidCacheStripes=RAID_DEFAULT_CACHE_STRIPES;
+static int raidRebuildRate=0;
+
+typedef struct
+{
+    long long stripe;                   // -1 if the entry is free
+    unsigned char *data;                // the data chunks of the stripe, one after another
+    unsigned char *dirty;               // TRUE for each sector of data newer than the targets
+    int numDirty;
+    unsigned long long lastUse;
+} raidCacheEntry_t;
+
+struct raidArray
+{
+    pthread_mutex_t lock;
+
+    int fd[RAID_CHUNKS];
+    long long chunkOffset;              // of the first stripe on each chunk target
+    long long numSectors;
+    int chunkSize;
+    int unitSectors;                    // sectors of a chunk
+    int stripeSectors;                  // data sectors of a stripe
+    int layout;
+    int directIO;
+    int blockSize[RAID_CHUNKS];         // smallest O_DIRECT I/O to each target, SECTOR_SIZE without
+    int blockSectors;                   // sectors of the largest, spans read and written are widened to
+    long long numStripes;
+    int failed;                         // the target lost, -1 if none
+
+    raidCacheEntry_t cache[RAID_MAX_CACHE_STRIPES];
+    int numCache;
+    int writeThrough;                   // no cache set, each write goes out at once
+    unsigned long long useCount;
+
+    unsigned char *oldData;             // a chunk each, aligned for O_DIRECT
+    unsigned char *parity;
+    unsigned char *bounce;
+    unsigned char *stripeBuf;           // a chunk for each target
+
+    // the rebuild, the stripes below rebuilt are on the replacement for the lost target
+    pthread_t rebuildThread;
+    int rebuilding;
+    int stopRebuild;
+    int rebuildError;
+    int rebuildChunk;
+    int rebuildRate;
+    long long rebuilt;
+    struct timespec rebuildStart;
+    double rebuildSeconds;              // taken, once the thread has finished
+    unsigned char *rebuildBuf;          // RAID_REBUILD_BYTES for each target
+
+    int fdCrc;                          // the checksum file, -1 if none
+    unsigned int *crcBuf;               // rows of checksums for the most sectors written at once
+
+    raidArrayStats_t stats;
+};
+
+
+// returns OK, or ERROR unless 0 to RAID_MAX_CACHE_STRIPES, for arrays opened after
+int raidSetCacheStripes(int numStripes)
+{
+    if((numStripes < 0) || (numStripes > RAID_MAX_CACHE_STRIPES))
+        return ERROR;
+
+    raidCacheStripes=numStripes;
+
+    return OK;
+}
+
+
+int raidGetCacheStripes(void)
+{
+    return raidCacheStripes;
+}
+
+
+// returns OK, or ERROR if negative, MB/s of the rebuilds started after, 0 for no limit
+int raidSetRebuildRate(int mbPerSec)
+{
+    if(mbPerSec < 0)
+        return ERROR;
+
+    raidRebuildRate=mbPerSec;
+
+    return OK;
+}
+
+
+int raidGetRebuildRate(void)
+{
+    return raidRebuildRate;
+}
+
+
+// the target lost for a stripe, or -1 if none or if the stripe is rebuilt
+static int raidLostTarget(raidArray_t *array, long long stripe)
+{
+    return ((array->failed >= 0) && (stripe >= array->rebuilt)) ? array->failed : -1;
+}
+
+
+// Rewrite the checksums of the sectors written to a target, len bytes at offset from the
+// start of the stripes, reading the rows holding them for the other targets' checksums
+static int raidChecksumWrite(raidArray_t *array, int target, unsigned char *buf, int len, long long offset)
+{
+    long long sector=offset / SECTOR_SIZE, rowBytes=RAID_CHUNKS * sizeof(unsigned int);
+    int idx, numSectors=len / SECTOR_SIZE;
+    ssize_t rc;
+
+    rc=pread(array->fdCrc, array->crcBuf, numSectors * rowBytes, sector * rowBytes);
+    if(rc < 0)
+        return ERROR;
+    if(rc < numSectors * rowBytes)
+        bzero((unsigned char *)array->crcBuf + rc, numSectors * rowBytes - rc);
+
+    for(idx=0; idx < numSectors; idx++)
+        array->crcBuf[idx * RAID_CHUNKS + target]=crc32c(0, buf + (size_t)idx * SECTOR_SIZE, SECTOR_SIZE);
+
+    if(pwrite(array->fdCrc, array->crcBuf, numSectors * rowBytes, sector * rowBytes) != numSectors * rowBytes)
+        return ERROR;
+
+    return OK;
+}
+
+
+// Read or write len bytes at offset from the start of the stripes on a target, all of them
+// or ERROR.  Reads past the end of a chunk file are zeros.
+static int raidTargetRW(raidArray_t *array, int target, unsigned char *buf, int len, long long offset, int write)
+{
+    ssize_t rc;
+    int done=0;
+
+    while(done < len)
+    {
+        if(write)
+            rc=pwrite(array->fd[target], buf + done, len - done, array->chunkOffset + offset + done);
+        else
+            rc=pread(array->fd[target], buf + done, len - done, array->chunkOffset + offset + done);
+
+        if((rc < 0) && (errno == EINTR))
+            continue;
+
+        if((rc < 0) || ((rc == 0) && write))
+        {
+            printf("%s %s failed\n", write ? "write to" : "read from", raidGetChunkPath(target + 1));
+            return ERROR;
+        }
+
+        if(rc == 0)
+        {
+            bzero(buf + done, len - done);
+            break;
+        }
+
+        done+=rc;
+    }
+
+    return OK;
+}
+
+
+// Read or write len bytes, at most a chunk, at offset from the start of the stripes on a
+// target, through the bounce buffer where O_DIRECT needs an aligned one.  O_DIRECT I/O not
+// on whole blocks of the target is widened to them in the bounce buffer, a write reading
+// the blocks first to keep the sectors either side as they are.
+static int raidTargetIO(raidArray_t *array, int target, unsigned char *buf, int len, long long offset, int write)
+{
+    unsigned char *ioBuf=buf;
+    long long ioOffset=offset;
+    int ioLen=len, head=0, block=array->blockSize[target];
+
+    if(array->directIO && (((offset % block) != 0) || ((len % block) != 0)))
+    {
+        head=offset % block;
+        ioOffset=offset - head;
+        ioLen=(head + len + block - 1) / block * block;
+        ioBuf=array->bounce;
+
+        if(write)
+        {
+            if(raidTargetRW(array, target, ioBuf, ioLen, ioOffset, FALSE) != OK)
+                return ERROR;
+            array->stats.targetReads[target]++;
+        }
+    }
+    else if(array->directIO && (((unsigned long)buf % RAID_MIN_CHUNK_SIZE) != 0))
+        ioBuf=array->bounce;
+
+    if(write && (ioBuf != buf))
+        memcpy(ioBuf + head, buf, len);
+
+    if(raidTargetRW(array, target, ioBuf, ioLen, ioOffset, write) != OK)
+        return ERROR;
+
+    if(!write && (ioBuf != buf))
+        memcpy(buf, ioBuf + head, len);
+
+    if(write && (array->fdCrc >= 0) && (raidChecksumWrite(array, target, buf, len, offset) != OK))
+    {
+        printf("write to %s failed\n", raidGetChecksumPath());
+        return ERROR;
+    }
+
+    if(write)
+        array->stats.targetWrites[target]++;
+    else
+        array->stats.targetReads[target]++;
+
+    return OK;
+}
+
+
+// Read len bytes at offset into the chunk of a stripe on the lost target, at most a chunk,
+// as the XOR of the same bytes of the other targets, whichever of them holds the XOR chunk
+static int raidDegradedRead(raidArray_t *array, long long stripe, int lost, unsigned char *buf, int len, int offset)
+{
+    unsigned char *src[RAID_CHUNKS - 1];
+    int idx, numSrc=0;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        if(idx == lost)
+            continue;
+
+        src[numSrc]=array->stripeBuf + (size_t)numSrc * array->chunkSize;
+        if(raidTargetIO(array, idx, src[numSrc], len, stripe * array->chunkSize + offset, FALSE) != OK)
+            return ERROR;
+        numSrc++;
+    }
+
+    xorBlocks(src, numSrc, buf, len);
+    array->stats.degradedReads++;
+
+    return OK;
+}
+
+
+// write a whole stripe from its data chunks, one after another, with the XOR chunk computed
+// from them and nothing read, but for a lost target
+static int raidWriteStripe(raidArray_t *array, long long stripe, unsigned char *data)
+{
+    unsigned char *unit[RAID_CHUNKS];
+    int target[RAID_CHUNKS], idx, lost=raidLostTarget(array, stripe);
+
+    raidStripeTargets(array->layout, stripe, target);
+
+    for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+        unit[idx]=data + (size_t)idx * array->chunkSize;
+    unit[RAID_DATA_CHUNKS]=array->parity;
+    raidEncodeStripe(unit, RAID_DATA_CHUNKS, 1, array->chunkSize);
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        if((target[idx] != lost) &&
+           (raidTargetIO(array, target[idx], unit[idx], array->chunkSize, stripe * array->chunkSize, TRUE) != OK))
+            return ERROR;
+
+    array->stats.fullStripeWrites++;
+
+    return OK;
+}
+
+
+// widen a span of sectors within a chunk to whole blocks of the targets, for O_DIRECT
+static void raidBlockSpan(raidArray_t *array, int *first, int *last)
+{
+    *first-=*first % array->blockSectors;
+    *last+=array->blockSectors - 1 - *last % array->blockSectors;
+}
+
+
+// the first and last sectors within a chunk that are dirty in any chunk of a cached stripe,
+// widened to whole blocks, FALSE if none are
+static int raidDirtySpan(raidArray_t *array, raidCacheEntry_t *entry, int *lo, int *hi)
+{
+    int sec;
+
+    *lo=array->unitSectors;
+    *hi=-1;
+
+    for(sec=0; sec < array->stripeSectors; sec++)
+    {
+        if(!entry->dirty[sec])
+            continue;
+        if(sec % array->unitSectors < *lo) *lo=sec % array->unitSectors;
+        if(sec % array->unitSectors > *hi) *hi=sec % array->unitSectors;
+    }
+
+    if(*hi < 0)
+        return FALSE;
+
+    raidBlockSpan(array, lo, hi);
+
+    return TRUE;
+}
+
+
+// Write the dirty sectors of a cached stripe by read-modify-write.  The XOR sectors across
+// the span dirty in any chunk are read once, each chunk with sectors dirty is read over its
+// dirty span, and P' = P ^ Dold ^ Dnew is taken for each run of dirty sectors before the
+// chunks and then the XOR chunk are written back over the same spans.  With O_DIRECT the
+// spans are whole blocks of the targets, so the writes need no more reads.
+static int raidUpdateStripe(raidArray_t *array, raidCacheEntry_t *entry)
+{
+    unsigned char *src[3], *dirty, *data;
+    int target[RAID_CHUNKS], unitSectors=array->unitSectors, idx, sec, first, last, run, lo, hi;
+    long long base=entry->stripe * array->chunkSize;
+
+    raidStripeTargets(array->layout, entry->stripe, target);
+
+    if(!raidDirtySpan(array, entry, &lo, &hi))
+        return OK;
+
+    if(raidTargetIO(array, target[RAID_DATA_CHUNKS], array->parity, (hi - lo + 1) * SECTOR_SIZE,
+                    base + lo * SECTOR_SIZE, FALSE) != OK)
+        return ERROR;
+
+    for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+    {
+        dirty=entry->dirty + idx * unitSectors;
+        data=entry->data + (size_t)idx * array->chunkSize;
+
+        for(first=0; (first < unitSectors) && !dirty[first]; first++);
+        if(first == unitSectors)
+            continue;
+        for(last=unitSectors - 1; !dirty[last]; last--);
+        raidBlockSpan(array, &first, &last);
+
+        if(raidTargetIO(array, target[idx], array->oldData, (last - first + 1) * SECTOR_SIZE,
+                        base + first * SECTOR_SIZE, FALSE) != OK)
+            return ERROR;
+
+        for(sec=first; sec <= last; sec+=run)
+        {
+            for(run=1; (sec + run <= last) && (dirty[sec + run] == dirty[sec]); run++);
+            if(!dirty[sec])
+                continue;
+
+            src[0]=array->parity + (sec - lo) * SECTOR_SIZE;
+            src[1]=array->oldData + (sec - first) * SECTOR_SIZE;
+            src[2]=data + sec * SECTOR_SIZE;
+            xorBlocks(src, 3, src[0], run * SECTOR_SIZE);
+            memcpy(src[1], src[2], run * SECTOR_SIZE);
+        }
+
+        // the clean sectors between go back as they were read
+        if(raidTargetIO(array, target[idx], array->oldData, (last - first + 1) * SECTOR_SIZE,
+                        base + first * SECTOR_SIZE, TRUE) != OK)
+            return ERROR;
+    }
+
+    if(raidTargetIO(array, target[RAID_DATA_CHUNKS], array->parity, (hi - lo + 1) * SECTOR_SIZE,
+                    base + lo * SECTOR_SIZE, TRUE) != OK)
+        return ERROR;
+
+    array->stats.rmwWrites++;
+
+    return OK;
+}
+
+
+// Write the dirty sectors of a cached stripe with a target lost.  Unless it is the XOR chunk,
+// over the span dirty in any chunk the other targets are read, the lost chunk's old data is
+// their XOR, the dirty sectors are laid over the data, and the XOR chunk is computed from it
+// and written with the chunks that have sectors dirty.
+static int raidReconstructStripe(raidArray_t *array, raidCacheEntry_t *entry, int lost)
+{
+    unsigned char *unit[RAID_CHUNKS], *src[RAID_CHUNKS - 1], *dirty;
+    int target[RAID_CHUNKS], unitSectors=array->unitSectors, idx, numSrc=0, sec, lo, hi, len, written;
+    long long base=entry->stripe * array->chunkSize;
+
+    raidStripeTargets(array->layout, entry->stripe, target);
+
+    // with the XOR chunk lost there is nothing to keep up, the dirty runs are just written
+    if(target[RAID_DATA_CHUNKS] == lost)
+    {
+        for(sec=0; sec < array->stripeSectors; sec+=len)
+        {
+            for(len=1; (sec + len < array->stripeSectors) && ((sec + len) % unitSectors != 0) &&
+                       (entry->dirty[sec + len] == entry->dirty[sec]); len++);
+
+            if(entry->dirty[sec] &&
+               (raidTargetIO(array, target[sec / unitSectors], entry->data + (size_t)sec * SECTOR_SIZE, len * SECTOR_SIZE,
+                             base + (sec % unitSectors) * SECTOR_SIZE, TRUE) != OK))
+                return ERROR;
+        }
+
+        return OK;
+    }
+
+    if(!raidDirtySpan(array, entry, &lo, &hi))
+        return OK;
+    len=(hi - lo + 1) * SECTOR_SIZE;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        unit[idx]=array->stripeBuf + (size_t)idx * array->chunkSize;
+        if(target[idx] == lost)
+            continue;
+
+        if(raidTargetIO(array, target[idx], unit[idx], len, base + lo * SECTOR_SIZE, FALSE) != OK)
+            return ERROR;
+        src[numSrc++]=unit[idx];
+    }
+
+    for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+        if(target[idx] == lost)
+            xorBlocks(src, numSrc, unit[idx], len);
+
+    for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+        for(sec=lo; sec <= hi; sec++)
+            if(entry->dirty[idx * unitSectors + sec])
+                memcpy(unit[idx] + (sec - lo) * SECTOR_SIZE, entry->data + (size_t)(idx * unitSectors + sec) * SECTOR_SIZE,
+                       SECTOR_SIZE);
+
+    xorBlocks(unit, RAID_DATA_CHUNKS, unit[RAID_DATA_CHUNKS], len);
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        if(target[idx] == lost)
+            continue;
+
+        dirty=entry->dirty + idx * unitSectors;
+        for(sec=lo, written=(idx == RAID_DATA_CHUNKS); (sec <= hi) && !written; sec++)
+            written=(idx < RAID_DATA_CHUNKS) && dirty[sec];
+
+        if(written && (raidTargetIO(array, target[idx], unit[idx], len, base + lo * SECTOR_SIZE, TRUE) != OK))
+            return ERROR;
+    }
+
+    array->stats.rmwWrites++;
+
+    return OK;
+}
+
+
+// write out a cached stripe, whole if every data sector is dirty, and free its entry
+static int raidFlushEntry(raidArray_t *array, raidCacheEntry_t *entry)
+{
+    int rc=OK, lost=raidLostTarget(array, entry->stripe);
+
+    if(entry->numDirty == array->stripeSectors)
+        rc=raidWriteStripe(array, entry->stripe, entry->data);
+    else if((entry->numDirty > 0) && (lost < 0))
+        rc=raidUpdateStripe(array, entry);
+    else if(entry->numDirty > 0)
+        rc=raidReconstructStripe(array, entry, lost);
+
+    bzero(entry->dirty, array->stripeSectors);
+    entry->numDirty=0;
+    entry->stripe=-1;
+
+    return rc;
+}
+
+
+static raidCacheEntry_t *raidCacheFind(raidArray_t *array, long long stripe)
+{
+    int idx;
+
+    for(idx=0; idx < array->numCache; idx++)
+        if(array->cache[idx].stripe == stripe)
+            return &array->cache[idx];
+
+    return NULL;
+}
+
+
+// the entry of a stripe, else a free one, else the least recently used written out first
+static raidCacheEntry_t *raidCacheGet(raidArray_t *array, long long stripe)
+{
+    raidCacheEntry_t *entry;
+    int idx;
+
+    if((entry=raidCacheFind(array, stripe)) == NULL)
+    {
+        for(idx=0; idx < array->numCache; idx++)
+        {
+            if(array->cache[idx].stripe < 0)
+            {
+                entry=&array->cache[idx];
+                break;
+            }
+            if((entry == NULL) || (array->cache[idx].lastUse < entry->lastUse))
+                entry=&array->cache[idx];
+        }
+
+        if((entry->stripe >= 0) && (raidFlushEntry(array, entry) != OK))
+            return NULL;
+
+        entry->stripe=stripe;
+    }
+
+    entry->lastUse=++array->useCount;
+
+    return entry;
+}
+
+
+static void raidFreeArray(raidArray_t *array)
+{
+    int idx;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        if(array->fd[idx] >= 0) close(array->fd[idx]);
+    if(array->fdCrc >= 0) close(array->fdCrc);
+
+    for(idx=0; idx < RAID_MAX_CACHE_STRIPES; idx++)
+    {
+        free(array->cache[idx].data);
+        free(array->cache[idx].dirty);
+    }
+
+    free(array->oldData);
+    free(array->parity);
+    free(array->bounce);
+    free(array->stripeBuf);
+    free(array->rebuildBuf);
+    free(array->crcBuf);
+    pthread_mutex_destroy(&array->lock);
+    free(array);
+}
+
+
+// Open the checksum file, and fill any rows of it short of every stripe with the checksums of
+// zero sectors, as the chunk files are grown with
+static int raidOpenChecksums(raidArray_t *array)
+{
+    static const unsigned char zero[SECTOR_SIZE];
+    long long rowBytes=RAID_CHUNKS * sizeof(unsigned int), numRows, row, end;
+    int idx, maxRows;
+    off_t size;
+
+    maxRows=((array->chunkSize > RAID_REBUILD_BYTES) ? array->chunkSize : RAID_REBUILD_BYTES) / SECTOR_SIZE;
+    if(((array->fdCrc=open(raidGetChecksumPath(), O_RDWR | O_CREAT, 00644)) < 0) ||
+       ((array->crcBuf=malloc(maxRows * rowBytes)) == NULL) ||
+       ((size=lseek(array->fdCrc, 0, SEEK_END)) < 0))
+        return ERROR;
+
+    for(idx=0; idx < maxRows * RAID_CHUNKS; idx++)
+        array->crcBuf[idx]=crc32c(0, zero, SECTOR_SIZE);
+
+    end=array->numStripes * array->unitSectors;
+    for(row=size / rowBytes; row < end; row+=numRows)
+    {
+        numRows=(end - row < maxRows) ? (end - row) : maxRows;
+        if(pwrite(array->fdCrc, array->crcBuf, numRows * rowBytes, row * rowBytes) != numRows * rowBytes)
+            return ERROR;
+    }
+
+    return OK;
+}
+
+
+// Open the chunk targets for block access to numSectors sectors of data from offsetSectors
+// on each.  Block devices must hold every stripe, and chunk files are created or grown to
+// hold them.  Returns NULL on error, or with O_DIRECT if offsetSectors is not on a block.
+raidArray_t *raidOpenArray(int offsetSectors, long long numSectors)
+{
+    raidArray_t *array;
+    struct stat chunkStat;
+    long long numStripes;
+    int idx, flags;
+
+    if((offsetSectors < 0) || (numSectors < 0) || ((array=calloc(1, sizeof(raidArray_t))) == NULL))
+        return NULL;
+
+    pthread_mutex_init(&array->lock, NULL);
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        array->fd[idx]=-1;
+    array->fdCrc=-1;
+
+    array->chunkOffset=(long long)offsetSectors * SECTOR_SIZE;
+    array->numSectors=numSectors;
+    array->chunkSize=raidGetChunkSize();
+    array->unitSectors=array->chunkSize / SECTOR_SIZE;
+    array->stripeSectors=RAID_DATA_CHUNKS * array->unitSectors;
+    array->layout=raidGetLayout();
+    array->directIO=raidGetDirectIO();
+    array->numCache=(raidCacheStripes > 0) ? raidCacheStripes : 1;
+    array->writeThrough=(raidCacheStripes == 0);
+    numStripes=(numSectors + array->stripeSectors - 1) / array->stripeSectors;
+    array->numStripes=numStripes;
+    array->failed=-1;
+    array->blockSectors=1;
+
+    flags=O_RDWR | O_CREAT | (array->directIO ? O_DIRECT : 0);
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        if((array->fd[idx]=open(raidGetChunkPath(idx + 1), flags, 00644)) < 0)
+        {
+            printf("can't open %s%s\n", raidGetChunkPath(idx + 1),
+                   ((errno == EINVAL) && array->directIO) ? " with O_DIRECT" : "");
+            raidFreeArray(array);
+            return NULL;
+        }
+
+        // O_DIRECT I/O is whole blocks of the target from the offset, which must start one
+        array->blockSize[idx]=array->directIO ? raidTargetBlockSize(array->fd[idx]) : SECTOR_SIZE;
+        if((array->chunkOffset % array->blockSize[idx]) != 0)
+        {
+            printf("sector %d is not on a %d byte block of %s for O_DIRECT\n", offsetSectors,
+                   array->blockSize[idx], raidGetChunkPath(idx + 1));
+            raidFreeArray(array);
+            return NULL;
+        }
+        if(array->blockSize[idx] / SECTOR_SIZE > array->blockSectors)
+            array->blockSectors=array->blockSize[idx] / SECTOR_SIZE;
+
+        if(fstat(array->fd[idx], &chunkStat) != 0)
+            chunkStat.st_mode=0;
+
+        if(S_ISBLK(chunkStat.st_mode) &&
+           (lseek(array->fd[idx], 0, SEEK_END) < array->chunkOffset + numStripes * array->chunkSize))
+        {
+            printf("%s is too small for %lld stripe units from sector %d\n", raidGetChunkPath(idx + 1),
+                   numStripes, offsetSectors);
+            raidFreeArray(array);
+            return NULL;
+        }
+
+        // a chunk file is grown, with zeros, to every stripe, so restoreFile() can read it all
+        if(S_ISREG(chunkStat.st_mode) && (chunkStat.st_size < array->chunkOffset + numStripes * array->chunkSize) &&
+           (ftruncate(array->fd[idx], array->chunkOffset + numStripes * array->chunkSize) != 0))
+        {
+            printf("can't extend %s\n", raidGetChunkPath(idx + 1));
+            raidFreeArray(array);
+            return NULL;
+        }
+    }
+
+    if((posix_memalign((void **)&array->oldData, RAID_MIN_CHUNK_SIZE, array->chunkSize) != 0) ||
+       (posix_memalign((void **)&array->parity, RAID_MIN_CHUNK_SIZE, array->chunkSize) != 0) ||
+       (posix_memalign((void **)&array->bounce, RAID_MIN_CHUNK_SIZE, array->chunkSize) != 0) ||
+       (posix_memalign((void **)&array->stripeBuf, RAID_MIN_CHUNK_SIZE, (size_t)RAID_CHUNKS * array->chunkSize) != 0))
+    {
+        raidFreeArray(array);
+        return NULL;
+    }
+
+    if((raidGetChecksumPath() != NULL) && (raidOpenChecksums(array) != OK))
+    {
+        printf("can't open %s\n", raidGetChecksumPath());
+        raidFreeArray(array);
+        return NULL;
+    }
+
+    for(idx=0; idx < array->numCache; idx++)
+    {
+        array->cache[idx].stripe=-1;
+        if((posix_memalign((void **)&array->cache[idx].data, RAID_MIN_CHUNK_SIZE,
+                           (size_t)array->stripeSectors * SECTOR_SIZE) != 0) ||
+           ((array->cache[idx].dirty=calloc(array->stripeSectors, 1)) == NULL))
+        {
+            raidFreeArray(array);
+            return NULL;
+        }
+    }
+
+    return array;
+}
+
+
+// Read numSectors sectors from lba into buf, the runs of each chunk not in the cache with
+// one read each.  Returns OK, or ERROR past the end of the array or if a target fails.
+int raidReadLBA(raidArray_t *array, long long lba, int numSectors, unsigned char *buf)
+{
+    raidCacheEntry_t *entry;
+    int target[RAID_CHUNKS], unitSectors=array->unitSectors, offset, count, sec, end, run, lost, rc=OK;
+    long long stripe;
+
+    if((lba < 0) || (numSectors < 0) || (lba + numSectors > array->numSectors))
+        return ERROR;
+
+    pthread_mutex_lock(&array->lock);
+
+    while((numSectors > 0) && (rc == OK))
+    {
+        stripe=lba / array->stripeSectors;
+        offset=lba % array->stripeSectors;
+        count=array->stripeSectors - offset;
+        if(count > numSectors) count=numSectors;
+
+        raidStripeTargets(array->layout, stripe, target);
+        entry=raidCacheFind(array, stripe);
+        lost=raidLostTarget(array, stripe);
+
+        for(sec=offset; (sec < offset + count) && (rc == OK); sec+=run)
+        {
+            if((entry != NULL) && entry->dirty[sec])
+            {
+                memcpy(buf + (sec - offset) * SECTOR_SIZE, entry->data + sec * SECTOR_SIZE, SECTOR_SIZE);
+                run=1;
+                continue;
+            }
+
+            // up to the end of the chunk, or of the request, or the next sector cached
+            end=(sec / unitSectors + 1) * unitSectors;
+            if(end > offset + count) end=offset + count;
+            for(run=1; (sec + run < end) && ((entry == NULL) || !entry->dirty[sec + run]); run++);
+
+            if(target[sec / unitSectors] == lost)
+                rc=raidDegradedRead(array, stripe, lost, buf + (sec - offset) * SECTOR_SIZE, run * SECTOR_SIZE,
+                                    (sec % unitSectors) * SECTOR_SIZE);
+            else
+                rc=raidTargetIO(array, target[sec / unitSectors], buf + (sec - offset) * SECTOR_SIZE, run * SECTOR_SIZE,
+                                stripe * array->chunkSize + (sec % unitSectors) * SECTOR_SIZE, FALSE);
+        }
+
+        lba+=count;
+        numSectors-=count;
+        buf+=(size_t)count * SECTOR_SIZE;
+    }
+
+    pthread_mutex_unlock(&array->lock);
+
+    return rc;
+}
+
+
+// Write numSectors sectors from buf to lba, whole stripes at once with no reads and the
+// rest through the stripe cache.  Returns OK, or ERROR past the end of the array or if a
+// target fails.
+int raidWriteLBA(raidArray_t *array, long long lba, int numSectors, unsigned char *buf)
+{
+    raidCacheEntry_t *entry;
+    int offset, count, sec, rc=OK;
+    long long stripe;
+
+    if((lba < 0) || (numSectors < 0) || (lba + numSectors > array->numSectors))
+        return ERROR;
+
+    pthread_mutex_lock(&array->lock);
+
+    while((numSectors > 0) && (rc == OK))
+    {
+        stripe=lba / array->stripeSectors;
+        offset=lba % array->stripeSectors;
+        count=array->stripeSectors - offset;
+        if(count > numSectors) count=numSectors;
+
+        if(count == array->stripeSectors)
+        {
+            // anything cached for the stripe is written over
+            if((entry=raidCacheFind(array, stripe)) != NULL)
+            {
+                bzero(entry->dirty, array->stripeSectors);
+                entry->numDirty=0;
+                entry->stripe=-1;
+            }
+
+            rc=raidWriteStripe(array, stripe, buf);
+        }
+        else if((entry=raidCacheGet(array, stripe)) == NULL)
+            rc=ERROR;
+        else
+        {
+            memcpy(entry->data + offset * SECTOR_SIZE, buf, (size_t)count * SECTOR_SIZE);
+            for(sec=offset; sec < offset + count; sec++)
+            {
+                entry->numDirty+=!entry->dirty[sec];
+                entry->dirty[sec]=TRUE;
+            }
+
+            // small writes that have filled in the stripe go out whole, with no reads
+            if(array->writeThrough || (entry->numDirty == array->stripeSectors))
+                rc=raidFlushEntry(array, entry);
+        }
+
+        lba+=count;
+        numSectors-=count;
+        buf+=(size_t)count * SECTOR_SIZE;
+    }
+
+    pthread_mutex_unlock(&array->lock);
+
+    return rc;
+}
+
+
+// write out every stripe in the cache
+int raidFlushArray(raidArray_t *array)
+{
+    int idx, rc=OK;
+
+    pthread_mutex_lock(&array->lock);
+
+    for(idx=0; idx < array->numCache; idx++)
+        if((array->cache[idx].stripe >= 0) && (raidFlushEntry(array, &array->cache[idx]) != OK))
+            rc=ERROR;
+
+    pthread_mutex_unlock(&array->lock);
+
+    return rc;
+}
+
+
+// Mark target chunk, 1 to RAID_CHUNKS, as lost, so the array runs degraded.  Returns ERROR
+// if a target is already lost or being rebuilt, as one is all the XOR chunk covers.
+int raidFailTarget(raidArray_t *array, int chunk)
+{
+    int rc=ERROR;
+
+    pthread_mutex_lock(&array->lock);
+
+    if((chunk >= 1) && (chunk <= RAID_CHUNKS) && (array->failed < 0))
+    {
+        close(array->fd[chunk - 1]);
+        array->fd[chunk - 1]=-1;
+        array->failed=chunk - 1;
+        array->rebuilt=0;
+        rc=OK;
+    }
+
+    pthread_mutex_unlock(&array->lock);
+
+    return rc;
+}
+
+
+static double raidSecondsSince(struct timespec *start)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (double)(now.tv_sec - start->tv_sec) + (double)(now.tv_nsec - start->tv_nsec) / 1e9;
+}
+
+
+// The rebuild thread, a step of stripes at a time under the array lock, sleeping after each
+// as long as the rate set needs
+static void *raidRebuildThread(void *arg)
+{
+    raidArray_t *array=(raidArray_t *)arg;
+    unsigned char *src[RAID_CHUNKS - 1], *dst;
+    long long numStripes, stepStripes, bytes=0;
+    double ahead;
+    int idx, numSrc, len;
+
+    stepStripes=(RAID_REBUILD_BYTES > array->chunkSize) ? (RAID_REBUILD_BYTES / array->chunkSize) : 1;
+    dst=array->rebuildBuf + (size_t)(RAID_CHUNKS - 1) * stepStripes * array->chunkSize;
+
+    while(TRUE)
+    {
+        pthread_mutex_lock(&array->lock);
+
+        if(array->stopRebuild || array->rebuildError || (array->rebuilt >= array->numStripes))
+        {
+            pthread_mutex_unlock(&array->lock);
+            break;
+        }
+
+        numStripes=array->numStripes - array->rebuilt;
+        if(numStripes > stepStripes) numStripes=stepStripes;
+        len=numStripes * array->chunkSize;
+
+        for(idx=0, numSrc=0; (idx < RAID_CHUNKS) && !array->rebuildError; idx++)
+        {
+            if(idx == array->failed)
+                continue;
+
+            src[numSrc]=array->rebuildBuf + (size_t)numSrc * stepStripes * array->chunkSize;
+            if(raidTargetIO(array, idx, src[numSrc], len, array->rebuilt * array->chunkSize, FALSE) != OK)
+                array->rebuildError=TRUE;
+            numSrc++;
+        }
+
+        if(!array->rebuildError)
+        {
+            xorBlocks(src, numSrc, dst, len);
+            if(raidTargetIO(array, array->failed, dst, len, array->rebuilt * array->chunkSize, TRUE) != OK)
+                array->rebuildError=TRUE;
+            else
+                array->rebuilt+=numStripes;
+        }
+
+        pthread_mutex_unlock(&array->lock);
+
+        bytes+=len;
+        if(array->rebuildRate > 0)
+        {
+            ahead=(double)bytes / ((double)array->rebuildRate * 1024 * 1024) - raidSecondsSince(&array->rebuildStart);
+            if(ahead > 0)
+                usleep((useconds_t)(ahead * 1e6));
+        }
+    }
+
+    pthread_mutex_lock(&array->lock);
+    if(array->rebuilt >= array->numStripes)
+        array->failed=-1;
+    array->rebuildSeconds=raidSecondsSince(&array->rebuildStart);
+    pthread_mutex_unlock(&array->lock);
+
+    return NULL;
+}
+
+
+// Start rebuilding the lost target onto path, or with path NULL onto the target's own path,
+// created or replaced.  Returns ERROR if no target is lost or a rebuild is running, or if
+// the replacement can't be opened.
+int raidStartRebuild(raidArray_t *array, const char *path)
+{
+    struct stat chunkStat;
+    long long size;
+    int fd, blockSize=SECTOR_SIZE, rc=ERROR;
+
+    pthread_mutex_lock(&array->lock);
+
+    if((array->failed >= 0) && !array->rebuilding)
+    {
+        if(path == NULL)
+            path=raidGetChunkPath(array->failed + 1);
+        size=array->chunkOffset + array->numStripes * array->chunkSize;
+
+        if((fd=open(path, O_RDWR | O_CREAT | (array->directIO ? O_DIRECT : 0), 00644)) < 0)
+            printf("can't open %s to rebuild onto\n", path);
+        else if((fstat(fd, &chunkStat) != 0) ||
+                (S_ISREG(chunkStat.st_mode) && (ftruncate(fd, size) != 0)) ||
+                (S_ISBLK(chunkStat.st_mode) && (lseek(fd, 0, SEEK_END) < size)))
+        {
+            printf("%s can't hold %lld stripe units\n", path, array->numStripes);
+            close(fd);
+        }
+        else if(array->directIO && ((array->chunkOffset % (blockSize=raidTargetBlockSize(fd))) != 0))
+        {
+            printf("the stripes are not on a %d byte block of %s for O_DIRECT\n", blockSize, path);
+            close(fd);
+        }
+        else if((array->rebuildBuf == NULL) &&
+                (posix_memalign((void **)&array->rebuildBuf, RAID_MIN_CHUNK_SIZE,
+                                (size_t)RAID_CHUNKS * ((RAID_REBUILD_BYTES > array->chunkSize) ? RAID_REBUILD_BYTES : array->chunkSize)) != 0))
+        {
+            array->rebuildBuf=NULL;
+            close(fd);
+        }
+        else
+        {
+            array->fd[array->failed]=fd;
+            array->blockSize[array->failed]=blockSize;
+            if(blockSize / SECTOR_SIZE > array->blockSectors)
+                array->blockSectors=blockSize / SECTOR_SIZE;
+            array->rebuilt=0;
+            array->rebuildChunk=array->failed + 1;
+            array->rebuildRate=raidRebuildRate;
+            array->rebuildError=FALSE;
+            array->rebuildSeconds=0.0;
+            array->stopRebuild=FALSE;
+            array->rebuilding=TRUE;
+            clock_gettime(CLOCK_MONOTONIC, &array->rebuildStart);
+            pthread_create(&array->rebuildThread, NULL, raidRebuildThread, array);
+            rc=OK;
+        }
+    }
+
+    pthread_mutex_unlock(&array->lock);
+
+    return rc;
+}
+
+
+// Wait for the rebuild to finish, returns OK if the array is whole, ERROR if the rebuild
+// failed or none was running
+int raidWaitRebuild(raidArray_t *array)
+{
+    if(!array->rebuilding)
+        return ERROR;
+
+    pthread_join(array->rebuildThread, NULL);
+    array->rebuilding=FALSE;
+
+    return ((array->failed < 0) && !array->rebuildError) ? OK : ERROR;
+}
+
+
+void raidGetRebuildStatus(raidArray_t *array, raidRebuildStatus_t *status)
+{
+    pthread_mutex_lock(&array->lock);
+
+    bzero(status, sizeof(raidRebuildStatus_t));
+    status->chunk=array->rebuildChunk;
+    status->active=array->rebuilding && (array->failed >= 0) && !array->rebuildError;
+    status->error=array->rebuildError;
+    status->stripesDone=array->rebuilt;
+    status->totalStripes=array->numStripes;
+    if(array->failed < 0)
+        status->stripesDone=array->numStripes;
+    if(status->totalStripes > 0)
+        status->percent=100.0 * (double)status->stripesDone / (double)status->totalStripes;
+
+    // the rate and the time to go of the rebuild running, or the last one
+    if(array->rebuildChunk > 0)
+        status->seconds=(array->rebuildSeconds > 0.0) ? array->rebuildSeconds : raidSecondsSince(&array->rebuildStart);
+
+    if((status->seconds > 0.0) && (array->rebuilt > 0))
+    {
+        status->mbPerSec=(double)array->rebuilt * array->chunkSize / (1024.0 * 1024.0) / status->seconds;
+        status->etaSeconds=status->seconds * (double)(status->totalStripes - status->stripesDone) / (double)array->rebuilt;
+    }
+
+    pthread_mutex_unlock(&array->lock);
+}
+
+
+// flush and close, stopping a rebuild where it is, returns ERROR if the flush fails, the
+// array is freed either way
+int raidCloseArray(raidArray_t *array)
+{
+    int rc;
+
+    if(array->rebuilding)
+    {
+        pthread_mutex_lock(&array->lock);
+        array->stopRebuild=TRUE;
+        pthread_mutex_unlock(&array->lock);
+        pthread_join(array->rebuildThread, NULL);
+        array->rebuilding=FALSE;
+    }
+
+    rc=raidFlushArray(array);
+    raidFreeArray(array);
+
+    return rc;
+}
+
+
+void raidGetArrayStats(raidArray_t *array, raidArrayStats_t *stats)
+{
+    pthread_mutex_lock(&array->lock);
+    *stats=array->stats;
+    pthread_mutex_unlock(&array->lock);
+}
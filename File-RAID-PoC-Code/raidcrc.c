@@ -0,0 +1,240 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#define CRC_X86
+#endif
+
+#if defined(__aarch64__) && defined(__linux__)
+#include <arm_acle.h>
+#include <sys/auxv.h>
+#include <asm/hwcap.h>
+#define CRC_ARM
+#endif
+
+#include "raidlib.h"
+
+
+// CRC32C kernels
+//
+// crc32c() is the Castagnoli CRC, polynomial 0x1EDC6F41 bit reflected as 0x82F63B78, used for
+// the sector checksums, as in iSCSI, ext4 and btrfs.  It is started with crc 0 and may be
+// continued over more buffers with the result, as zlib's crc32() is.
+//
+// The table kernel takes 8 bytes a step with eight 256 entry tables (slicing-by-8), and the
+// sse4.2 and armv8 kernels use the CRC32C instructions of those CPUs, 8 bytes an instruction,
+// compiled with the target attribute as the XOR kernels are.  The first call picks the
+// fastest kernel the CPU supports, unless RAID_CRC_KERNEL names another one, and
+// crcSelectKernel() can switch at any time.
+
+#define CRC32C_POLY (0x82F63B78)
+
+typedef uint32_t (*crcKernelFn_t)(uint32_t crc, const unsigned char *buf, int len);
+
+typedef struct
+{
+    const char *name;
+    crcKernelFn_t fn;
+    int supported;
+} crcKernel_t;
+
+static uint32_t crcTable[8][256];
+
+
+static void crcTableInit(void)
+{
+    uint32_t crc;
+    int idx, bit, slice;
+
+    for(idx=0; idx < 256; idx++)
+    {
+        crc=idx;
+        for(bit=0; bit < 8; bit++)
+            crc=(crc & 1) ? ((crc >> 1) ^ CRC32C_POLY) : (crc >> 1);
+        crcTable[0][idx]=crc;
+    }
+
+    for(idx=0; idx < 256; idx++)
+        for(slice=1; slice < 8; slice++)
+            crcTable[slice][idx]=(crcTable[slice-1][idx] >> 8) ^ crcTable[0][crcTable[slice-1][idx] & 0xff];
+}
+
+
+// slicing-by-8, with the crc already inverted
+static uint32_t crcTableKernel(uint32_t crc, const unsigned char *buf, int len)
+{
+    uint64_t word;
+    int idx=0;
+
+    // memcpy is a plain unaligned 64-bit load once optimized, the words are little endian
+    for(; idx + 8 <= len; idx+=8)
+    {
+        memcpy(&word, &buf[idx], 8);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+        word=__builtin_bswap64(word);
+#endif
+        word^=crc;
+        crc=crcTable[7][word & 0xff] ^ crcTable[6][(word >> 8) & 0xff] ^
+            crcTable[5][(word >> 16) & 0xff] ^ crcTable[4][(word >> 24) & 0xff] ^
+            crcTable[3][(word >> 32) & 0xff] ^ crcTable[2][(word >> 40) & 0xff] ^
+            crcTable[1][(word >> 48) & 0xff] ^ crcTable[0][word >> 56];
+    }
+
+    for(; idx < len; idx++)
+        crc=(crc >> 8) ^ crcTable[0][(crc ^ buf[idx]) & 0xff];
+
+    return crc;
+}
+
+
+#ifdef CRC_X86
+
+__attribute__((target("sse4.2")))
+static uint32_t crcSse42(uint32_t crc, const unsigned char *buf, int len)
+{
+    uint64_t word, crc64=crc;
+    int idx=0;
+
+    for(; idx + 8 <= len; idx+=8)
+    {
+        memcpy(&word, &buf[idx], 8);
+        crc64=_mm_crc32_u64(crc64, word);
+    }
+
+    crc=(uint32_t)crc64;
+    for(; idx < len; idx++)
+        crc=_mm_crc32_u8(crc, buf[idx]);
+
+    return crc;
+}
+
+#endif
+
+
+#ifdef CRC_ARM
+
+__attribute__((target("+crc")))
+static uint32_t crcArmv8(uint32_t crc, const unsigned char *buf, int len)
+{
+    uint64_t word;
+    int idx=0;
+
+    for(; idx + 8 <= len; idx+=8)
+    {
+        memcpy(&word, &buf[idx], 8);
+        crc=__crc32cd(crc, word);
+    }
+
+    for(; idx < len; idx++)
+        crc=__crc32cb(crc, buf[idx]);
+
+    return crc;
+}
+
+#endif
+
+
+// slowest to fastest, so the last supported one is the default
+static crcKernel_t crcKernel[]=
+{
+    {"table", crcTableKernel, TRUE},
+#ifdef CRC_X86
+    {"sse4.2", crcSse42, FALSE},
+#endif
+#ifdef CRC_ARM
+    {"armv8", crcArmv8, FALSE},
+#endif
+};
+
+#define NUM_CRC_KERNELS ((int)(sizeof(crcKernel)/sizeof(crcKernel_t)))
+
+static crcKernelFn_t crcFn=NULL;
+static pthread_once_t crcOnce=PTHREAD_ONCE_INIT;
+static int crcCurrent=-1;
+
+
+static void crcInit(void)
+{
+    int idx;
+    char *name;
+
+    crcTableInit();
+
+#ifdef CRC_X86
+    __builtin_cpu_init();
+
+    for(idx=0; idx < NUM_CRC_KERNELS; idx++)
+        if(strcmp(crcKernel[idx].name, "sse4.2") == 0)
+            crcKernel[idx].supported=__builtin_cpu_supports("sse4.2");
+#endif
+
+#ifdef CRC_ARM
+    for(idx=0; idx < NUM_CRC_KERNELS; idx++)
+        if(strcmp(crcKernel[idx].name, "armv8") == 0)
+            crcKernel[idx].supported=((getauxval(AT_HWCAP) & HWCAP_CRC32) != 0);
+#endif
+
+    for(idx=0; idx < NUM_CRC_KERNELS; idx++)
+        if(crcKernel[idx].supported) crcCurrent=idx;
+
+    if((name=getenv("RAID_CRC_KERNEL")) != NULL)
+    {
+        for(idx=0; idx < NUM_CRC_KERNELS; idx++)
+            if((strcmp(crcKernel[idx].name, name) == 0) && crcKernel[idx].supported)
+                crcCurrent=idx;
+    }
+
+    crcFn=crcKernel[crcCurrent].fn;
+}
+
+
+int crcKernelCount(void)
+{
+    pthread_once(&crcOnce, crcInit);
+    return NUM_CRC_KERNELS;
+}
+
+
+const char *crcKernelName(int kernel)
+{
+    pthread_once(&crcOnce, crcInit);
+    return ((kernel >= 0) && (kernel < NUM_CRC_KERNELS)) ? crcKernel[kernel].name : "none";
+}
+
+
+int crcKernelSupported(int kernel)
+{
+    pthread_once(&crcOnce, crcInit);
+    return ((kernel >= 0) && (kernel < NUM_CRC_KERNELS)) ? crcKernel[kernel].supported : FALSE;
+}
+
+
+int crcCurrentKernel(void)
+{
+    pthread_once(&crcOnce, crcInit);
+    return crcCurrent;
+}
+
+
+// returns OK, or ERROR if the kernel is not supported on this CPU
+int crcSelectKernel(int kernel)
+{
+    if(!crcKernelSupported(kernel))
+        return ERROR;
+
+    crcCurrent=kernel;
+    crcFn=crcKernel[kernel].fn;
+
+    return OK;
+}
+
+
+unsigned int crc32c(unsigned int crc, const unsigned char *buf, int len)
+{
+    pthread_once(&crcOnce, crcInit);
+    return ~crcFn(~crc, buf, len);
+}
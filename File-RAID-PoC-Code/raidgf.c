@@ -0,0 +1,492 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define GF_X86
+#endif
+
+#if defined(__aarch64__)
+#include <arm_neon.h>
+#define GF_NEON
+#endif
+
+#include "raidlib.h"
+
+
+// N+1 and N+2 stripe coding for any stripe width
+//
+// A stripe is numData data chunks D0...Dn-1 plus one or two parity chunks of the same size:
+//
+//   P = D0 ^ D1 ^ ... ^ Dn-1                       XOR parity, as in xorLBA()
+//   Q = g^0*D0 ^ g^1*D1 ^ ... ^ g^(n-1)*Dn-1       Reed-Solomon syndrome over GF(2^8)
+//
+// with the multiplication in GF(2^8) modulo x^8+x^4+x^3+x^2+1 (0x11d) and generator g=2, the
+// same code as Linux md RAID-6, so up to 253 data chunks each have a distinct coefficient.
+// P alone (N+1) survives the loss of any one chunk, and P and Q (N+2) of any two:
+//
+// 1) one data chunk, or P:        XOR of the others, as rebuildLBA() does
+// 2) Q, or P and Q:               re-encode
+// 3) data chunk x and Q:          x from P, then re-encode Q
+// 4) data chunk x and P:          Dx = g^-x * (Q ^ Qx), then re-encode P
+// 5) data chunks x and y:         Dx = A*(P ^ Pxy) ^ B*(Q ^ Qxy), Dy = (P ^ Pxy) ^ Dx
+//
+// where Pxy and Qxy are P and Q computed without x and y, A = g^(y-x) / (g^(y-x) ^ 1) and
+// B = g^-x / (g^(y-x) ^ 1).  See H. Peter Anvin, "The mathematics of RAID-6" (2004).
+//
+// Multiplying a block by a constant c uses the split table method: c*b = L[b & 15] ^ H[b >> 4]
+// with two 16 entry tables per constant, which is one pshufb (SSSE3, AVX2, AVX-512BW) or tbl
+// (NEON) per 16 to 64 bytes.  The table kernel looks each byte up in a full 256x256 product
+// table instead.  As in raidxor.c the fastest supported kernel is chosen at the first call,
+// or the one named by RAID_GF_KERNEL, and all kernels give exactly the same bytes.
+
+typedef void (*gfKernelFn_t)(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate);
+
+typedef struct
+{
+    const char *name;
+    gfKernelFn_t fn;
+    int supported;
+} gfKernel_t;
+
+static unsigned char gfExp[512];
+static unsigned char gfLog[256];
+static unsigned char gfMulTable[256][256];
+static unsigned char gfNibble[256][2][16] __attribute__((aligned(16)));
+
+static gfKernelFn_t gfFn=NULL;
+static pthread_once_t gfOnce=PTHREAD_ONCE_INIT;
+static int gfCurrent=-1;
+
+
+static void gfInit(void);
+
+
+// product by the log tables, which gfInit() builds the other tables with
+static unsigned char gfMulLog(unsigned char a, unsigned char b)
+{
+    if((a == 0) || (b == 0))
+        return 0;
+
+    return gfExp[gfLog[a] + gfLog[b]];
+}
+
+
+unsigned char gfMul(unsigned char a, unsigned char b)
+{
+    pthread_once(&gfOnce, gfInit);
+    return gfMulLog(a, b);
+}
+
+
+// g^power for any power, negative for the inverse powers
+static unsigned char gfPow(int power)
+{
+    power%=255;
+    if(power < 0) power+=255;
+
+    return gfExp[power];
+}
+
+
+static unsigned char gfInv(unsigned char a)
+{
+    return gfExp[255 - gfLog[a]];
+}
+
+
+// the bytes from idx to len one at a time
+static void gfTail(unsigned char *src, unsigned char *dst, unsigned char c, int idx, int len, int accumulate)
+{
+    if(accumulate)
+    {
+        for(; idx < len; idx++)
+            dst[idx]^=gfMulTable[c][src[idx]];
+    }
+    else
+    {
+        for(; idx < len; idx++)
+            dst[idx]=gfMulTable[c][src[idx]];
+    }
+}
+
+
+static void gfTable(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    gfTail(src, dst, c, 0, len, accumulate);
+}
+
+
+#ifdef GF_X86
+
+__attribute__((target("ssse3")))
+static void gfSsse3(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    int idx=0;
+    __m128i lo, hi, mask, x, p;
+
+    lo=_mm_load_si128((const __m128i *)gfNibble[c][0]);
+    hi=_mm_load_si128((const __m128i *)gfNibble[c][1]);
+    mask=_mm_set1_epi8(0x0f);
+
+    for(; idx + 16 <= len; idx+=16)
+    {
+        x=_mm_loadu_si128((const __m128i *)&src[idx]);
+        p=_mm_xor_si128(_mm_shuffle_epi8(lo, _mm_and_si128(x, mask)),
+                        _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask)));
+        if(accumulate) p=_mm_xor_si128(p, _mm_loadu_si128((const __m128i *)&dst[idx]));
+        _mm_storeu_si128((__m128i *)&dst[idx], p);
+    }
+
+    gfTail(src, dst, c, idx, len, accumulate);
+}
+
+
+__attribute__((target("avx2")))
+static void gfAvx2(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    int idx=0;
+    __m256i lo, hi, mask, x, p;
+
+    lo=_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gfNibble[c][0]));
+    hi=_mm256_broadcastsi128_si256(_mm_load_si128((const __m128i *)gfNibble[c][1]));
+    mask=_mm256_set1_epi8(0x0f);
+
+    for(; idx + 32 <= len; idx+=32)
+    {
+        x=_mm256_loadu_si256((const __m256i *)&src[idx]);
+        p=_mm256_xor_si256(_mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask)),
+                           _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask)));
+        if(accumulate) p=_mm256_xor_si256(p, _mm256_loadu_si256((const __m256i *)&dst[idx]));
+        _mm256_storeu_si256((__m256i *)&dst[idx], p);
+    }
+
+    gfTail(src, dst, c, idx, len, accumulate);
+}
+
+
+__attribute__((target("avx512f,avx512bw")))
+static void gfAvx512(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    int idx=0;
+    __m512i lo, hi, mask, x, p;
+
+    lo=_mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)gfNibble[c][0]));
+    hi=_mm512_broadcast_i32x4(_mm_load_si128((const __m128i *)gfNibble[c][1]));
+    mask=_mm512_set1_epi8(0x0f);
+
+    for(; idx + 64 <= len; idx+=64)
+    {
+        x=_mm512_loadu_si512((const void *)&src[idx]);
+        p=_mm512_xor_si512(_mm512_shuffle_epi8(lo, _mm512_and_si512(x, mask)),
+                           _mm512_shuffle_epi8(hi, _mm512_and_si512(_mm512_srli_epi64(x, 4), mask)));
+        if(accumulate) p=_mm512_xor_si512(p, _mm512_loadu_si512((const void *)&dst[idx]));
+        _mm512_storeu_si512((void *)&dst[idx], p);
+    }
+
+    gfTail(src, dst, c, idx, len, accumulate);
+}
+
+#endif
+
+
+#ifdef GF_NEON
+
+static void gfNeon(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    int idx=0;
+    uint8x16_t lo, hi, mask, x, p;
+
+    lo=vld1q_u8(gfNibble[c][0]);
+    hi=vld1q_u8(gfNibble[c][1]);
+    mask=vdupq_n_u8(0x0f);
+
+    for(; idx + 16 <= len; idx+=16)
+    {
+        x=vld1q_u8(&src[idx]);
+        p=veorq_u8(vqtbl1q_u8(lo, vandq_u8(x, mask)), vqtbl1q_u8(hi, vshrq_n_u8(x, 4)));
+        if(accumulate) p=veorq_u8(p, vld1q_u8(&dst[idx]));
+        vst1q_u8(&dst[idx], p);
+    }
+
+    gfTail(src, dst, c, idx, len, accumulate);
+}
+
+#endif
+
+
+// slowest to fastest, so the last supported one is the default
+static gfKernel_t gfKernel[]=
+{
+    {"table", gfTable, TRUE},
+#ifdef GF_X86
+    {"ssse3", gfSsse3, FALSE},
+    {"avx2", gfAvx2, FALSE},
+    {"avx512", gfAvx512, FALSE},
+#endif
+#ifdef GF_NEON
+    {"neon", gfNeon, TRUE},
+#endif
+};
+
+#define NUM_GF_KERNELS ((int)(sizeof(gfKernel)/sizeof(gfKernel_t)))
+
+
+static void gfInit(void)
+{
+    int idx, c, x;
+    unsigned int value=1;
+    char *name;
+
+    // powers of the generator, doubled up so gfExp[log a + log b] needs no modulo
+    for(idx=0; idx < 255; idx++)
+    {
+        gfExp[idx]=gfExp[idx + 255]=(unsigned char)value;
+        gfLog[value]=(unsigned char)idx;
+        value<<=1;
+        if(value & 0x100) value^=0x11d;
+    }
+    gfExp[510]=gfExp[0];
+    gfExp[511]=gfExp[1];
+
+    for(c=0; c < 256; c++)
+    {
+        for(x=0; x < 256; x++)
+            gfMulTable[c][x]=gfMulLog(c, x);
+
+        for(x=0; x < 16; x++)
+        {
+            gfNibble[c][0][x]=gfMulLog(c, x);
+            gfNibble[c][1][x]=gfMulLog(c, x << 4);
+        }
+    }
+
+#ifdef GF_X86
+    __builtin_cpu_init();
+
+    for(idx=0; idx < NUM_GF_KERNELS; idx++)
+    {
+        if(strcmp(gfKernel[idx].name, "ssse3") == 0)
+            gfKernel[idx].supported=__builtin_cpu_supports("ssse3");
+        else if(strcmp(gfKernel[idx].name, "avx2") == 0)
+            gfKernel[idx].supported=__builtin_cpu_supports("avx2");
+        else if(strcmp(gfKernel[idx].name, "avx512") == 0)
+            gfKernel[idx].supported=__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw");
+    }
+#endif
+
+    for(idx=0; idx < NUM_GF_KERNELS; idx++)
+        if(gfKernel[idx].supported) gfCurrent=idx;
+
+    if((name=getenv("RAID_GF_KERNEL")) != NULL)
+    {
+        for(idx=0; idx < NUM_GF_KERNELS; idx++)
+            if((strcmp(gfKernel[idx].name, name) == 0) && gfKernel[idx].supported)
+                gfCurrent=idx;
+    }
+
+    gfFn=gfKernel[gfCurrent].fn;
+}
+
+
+int gfKernelCount(void)
+{
+    pthread_once(&gfOnce, gfInit);
+    return NUM_GF_KERNELS;
+}
+
+
+const char *gfKernelName(int kernel)
+{
+    pthread_once(&gfOnce, gfInit);
+    return ((kernel >= 0) && (kernel < NUM_GF_KERNELS)) ? gfKernel[kernel].name : "none";
+}
+
+
+int gfKernelSupported(int kernel)
+{
+    pthread_once(&gfOnce, gfInit);
+    return ((kernel >= 0) && (kernel < NUM_GF_KERNELS)) ? gfKernel[kernel].supported : FALSE;
+}
+
+
+int gfCurrentKernel(void)
+{
+    pthread_once(&gfOnce, gfInit);
+    return gfCurrent;
+}
+
+
+// returns OK, or ERROR if the kernel is not supported on this CPU
+int gfSelectKernel(int kernel)
+{
+    if(!gfKernelSupported(kernel))
+        return ERROR;
+
+    gfCurrent=kernel;
+    gfFn=gfKernel[kernel].fn;
+
+    return OK;
+}
+
+
+// dst = c*src, or dst ^= c*src with accumulate, over len bytes.  dst may be src.
+void gfMulBlock(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate)
+{
+    pthread_once(&gfOnce, gfInit);
+    gfFn(src, dst, c, len, accumulate);
+}
+
+
+// Q, or with skip1 and skip2 the Q of the other data chunks, into dst
+static void raidSyndromeQ(unsigned char *chunk[], int numData, int len, int skip1, int skip2, unsigned char *dst)
+{
+    int idx, first=TRUE;
+
+    for(idx=0; idx < numData; idx++)
+    {
+        if((idx == skip1) || (idx == skip2))
+            continue;
+
+        gfMulBlock(chunk[idx], dst, gfPow(idx), len, !first);
+        first=FALSE;
+    }
+
+    if(first)
+        memset(dst, 0, len);
+}
+
+
+// dst ^= src over len bytes
+static void raidXorInto(unsigned char *dst, unsigned char *src, int len)
+{
+    unsigned char *pair[2];
+
+    pair[0]=dst;
+    pair[1]=src;
+    xorBlocks(pair, 2, dst, len);
+}
+
+
+// XOR of the chunks from 0 to numChunks-1, except skip1 and skip2, into dst
+static void raidXorExcept(unsigned char *chunk[], int numChunks, int len, int skip1, int skip2, unsigned char *dst)
+{
+    unsigned char *src[RAID_MAX_DATA + 1];
+    int idx, numSrc=0;
+
+    for(idx=0; idx < numChunks; idx++)
+        if((idx != skip1) && (idx != skip2)) src[numSrc++]=chunk[idx];
+
+    if(numSrc == 0)
+        memset(dst, 0, len);
+    else
+        xorBlocks(src, numSrc, dst, len);
+}
+
+
+// Encode the parity of one stripe
+//
+// PRECONDITIONS:
+// 1) chunk[0] to chunk[numData-1] point to len bytes of data each
+// 2) chunk[numData] (P) and for numParity 2 chunk[numData+1] (Q) point to len bytes each
+//
+// POST-CONDITIONS:
+// 1) P and Q hold the parity of the data chunks
+//
+int raidEncodeStripe(unsigned char *chunk[], int numData, int numParity, int len)
+{
+    if((numData < 1) || (numData > RAID_MAX_DATA) || (numParity < 1) || (numParity > 2))
+        return ERROR;
+
+    // gfPow() reads the tables before gfMulBlock() is called
+    pthread_once(&gfOnce, gfInit);
+
+    xorBlocks(chunk, numData, chunk[numData], len);
+
+    if(numParity == 2)
+        raidSyndromeQ(chunk, numData, len, -1, -1, chunk[numData+1]);
+
+    return OK;
+}
+
+
+// Rebuild up to numParity lost chunks of one stripe in place
+//
+// lost1 and lost2 are chunk indexes as for raidEncodeStripe(), numData for P and numData+1 for
+// Q, and -1 for none.  The buffers of the lost chunks must be allocated, their contents are
+// ignored and replaced by the rebuilt data.  Returns ERROR if more chunks are lost than the
+// parity covers.
+//
+int raidRecoverStripe(unsigned char *chunk[], int numData, int numParity, int len, int lost1, int lost2)
+{
+    int x, y, numChunks=numData + numParity, p=numData, q=numData + 1;
+    unsigned char a, b, d;
+
+    if((numData < 1) || (numData > RAID_MAX_DATA) || (numParity < 1) || (numParity > 2) ||
+       (lost1 >= numChunks) || (lost2 >= numChunks))
+        return ERROR;
+
+    pthread_once(&gfOnce, gfInit);
+
+    // x is the lower index lost and y the higher, or -1 if only one is
+    if(lost1 == lost2) lost2=-1;
+    x=(lost1 < lost2) ? lost1 : lost2;
+    y=(lost1 < lost2) ? lost2 : lost1;
+    if(x < 0)
+    {
+        x=y;
+        y=-1;
+    }
+
+    if(x < 0)
+        return OK;
+
+    if((y >= 0) && (numParity < 2))
+        return ERROR;
+
+    // one data chunk or P, P being the XOR of all the others
+    if((y < 0) && (x <= p))
+    {
+        raidXorExcept(chunk, numData + 1, len, x, -1, chunk[x]);
+        return OK;
+    }
+
+    // Q with or without one other chunk: rebuild the other from P, or P itself, then Q
+    if((y < 0) || (y == q))
+    {
+        if(x < q)
+            raidXorExcept(chunk, numData + 1, len, x, -1, chunk[x]);
+
+        raidSyndromeQ(chunk, numData, len, -1, -1, chunk[q]);
+        return OK;
+    }
+
+    // data chunk x and P: Dx = g^-x * (Q ^ Qx), then re-encode P
+    if(y == p)
+    {
+        raidSyndromeQ(chunk, numData, len, x, -1, chunk[x]);
+        raidXorInto(chunk[x], chunk[q], len);
+        gfMulBlock(chunk[x], chunk[x], gfPow(-x), len, FALSE);
+
+        xorBlocks(chunk, numData, chunk[p], len);
+        return OK;
+    }
+
+    // data chunks x and y, with Q ^ Qxy in x and P ^ Pxy in y
+    raidSyndromeQ(chunk, numData, len, x, y, chunk[x]);
+    raidXorInto(chunk[x], chunk[q], len);
+    raidXorExcept(chunk, numData + 1, len, x, y, chunk[y]);
+
+    d=gfPow(y - x) ^ 1;
+    a=gfMul(gfPow(y - x), gfInv(d));
+    b=gfMul(gfPow(-x), gfInv(d));
+
+    // Dx = A*(P ^ Pxy) ^ B*(Q ^ Qxy), Dy = (P ^ Pxy) ^ Dx
+    gfMulBlock(chunk[x], chunk[x], b, len, FALSE);
+    gfMulBlock(chunk[y], chunk[x], a, len, TRUE);
+    raidXorInto(chunk[y], chunk[x], len);
+
+    return OK;
+}
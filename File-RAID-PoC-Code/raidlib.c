@@ -1,21 +1,23 @@
+// O_DIRECT
+#define _GNU_SOURCE
+
 #include <sys/time.h>
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <fcntl.h>
+#include <sys/uio.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <strings.h>
+#include <errno.h>
+#include <pthread.h>
 #include <assert.h>
 
 #include "raidlib.h"
-
-#ifdef RAID64
-#include "raidlib64.h"
-#define PTR_CAST (unsigned long long *)
-#else
-#include "raidlib.h"
-#define PTR_CAST (unsigned char *)
-#endif
+#include "raiduring.h"
 
 
 // RAID-5 encoding
@@ -37,10 +39,9 @@ void xorLBA(unsigned char *LBA1,
 	    unsigned char *LBA4,
 	    unsigned char *PLBA)
 {
-    int idx;
+    unsigned char *src[4]={LBA1, LBA2, LBA3, LBA4};
 
-    for(idx=0; idx<SECTOR_SIZE; idx++)
-        *(PLBA+idx)=(*(LBA1+idx))^(*(LBA2+idx))^(*(LBA3+idx))^(*(LBA4+idx));
+    xorBlocks(src, 4, PLBA, SECTOR_SIZE);
 }
 
 
@@ -56,18 +57,11 @@ void rebuildLBA(unsigned char *LBA1,
 	        unsigned char *PLBA,
 	        unsigned char *RLBA)
 {
-    int idx;
-    unsigned char checkParity;
-
-    for(idx=0; idx<SECTOR_SIZE; idx++)
-    {
-        // Parity check word is simply XOR of remaining good LBAs
-        checkParity=(*(LBA1+idx))^(*(LBA2+idx))^(*(LBA3+idx));
+    // Rebuilt LBA is the XOR of the original parity and the remaining good LBAs, which
+    // preserves the original parity computed over the 4 LBAs
+    unsigned char *src[4]={LBA1, LBA2, LBA3, PLBA};
 
-        // Rebuilt LBA is simply XOR of original parity and parity check word
-        // which will preserve original parity computed over the 4 LBAs
-        *(RLBA+idx) =(*(PLBA+idx))^(checkParity);
-    }
+    xorBlocks(src, 4, RLBA, SECTOR_SIZE);
 }
 
 
@@ -89,446 +83,1596 @@ int checkEquivLBA(unsigned char *LBA1,
 }
 
 
-// returns bytes written or ERROR code
-// 
-int stripeFile(char *inputFileName, int offsetSectors)
+// File striping
+//
+// stripeFile() splits a file into RAID_DATA_CHUNKS data chunk files plus an XOR parity chunk
+// file, a chunk of each per stripe, and restoreFile() reads them back, rebuilding any one
+// chunk file that was lost.  The stripe unit, the bytes of a stripe on each chunk file, is set
+// with raidSetChunkSize() from 4 KB to 1 MB, and must be the same for both.
+//
+// So that a stripe costs a few large system calls instead of one per sector, RAID_IO_BYTES of
+// each chunk file is moved at a time: the input is read with one preadv() scattering the
+// stripe units straight into per chunk buffers, each chunk file is written with one pwrite()
+// of all its units, and restoreFile() gathers them back into the output with one pwritev().
+//
+// Each batch of stripes goes through a pipeline of threads in a slot, a set of buffers for
+// every chunk of the batch, passed between stages on queues:
+//
+//   stripeFile():  caller reads input -> parity workers -> one writer per chunk file
+//   restoreFile(): one reader per surviving chunk file -> rebuild workers -> output writer
+//
+// Every I/O uses an explicit offset, so batches may complete out of order.  The number of
+// slots bounds the queues and the memory used, and raidSetThreads() sets the number of
+// parity workers.
+//
+// With the io_uring engine, the default where the kernel has it, the chunk file readers or
+// writers are replaced by one thread with a ring on which the I/O for all the chunk files of
+// a batch is submitted at once, up to the queue depth of batches in flight, with the slot
+// buffers and the chunk files registered with the kernel.  Otherwise, or if the ring can't be
+// set up, e.g. for lack of locked memory for the buffers, the thread per chunk file is used.
+// RAID_IO_ENGINE=threads or uring in the environment sets the default.
+//
+// The chunk targets are StripeChunk1.bin to StripeChunk4.bin and StripeChunkXOR.bin in the
+// current directory unless set with raidSetChunkPaths(), to other files or to block devices
+// such as loop devices or partitions, and the stripes start offsetSectors into each.  Before
+// the offset is left as it is, and a regular file is cut to the end of the last stripe.  With
+// raidSetDirectIO() the targets are opened O_DIRECT, bypassing the page cache, which the slot
+// buffers, aligned to RAID_MIN_CHUNK_SIZE, and the chunk I/O, whole stripe units, allow for,
+// as long as the offset is a multiple of the logical block size of the target.
+//
+// By default the XOR chunk of every stripe is on the fifth target, as in RAID-4, so that
+// target is written for every stripe written to any of the others.  With raidSetLayout() and
+// RAID_LAYOUT_LEFT_SYMMETRIC the parity rotates as in RAID-5, from the fifth target for stripe
+// 0 back one target per stripe, with the data chunks following it and wrapping around:
+//
+//   stripe 0:  D0 D1 D2 D3 P
+//   stripe 1:  D1 D2 D3 P  D0
+//   stripe 2:  D2 D3 P  D0 D1
+//   stripe 3:  D3 P  D0 D1 D2
+//   stripe 4:  P  D0 D1 D2 D3
+//
+// so consecutive data chunks are on consecutive targets.  The slot buffers are kept per
+// target, so each target is still read or written once per batch, and raidMapLBA() gives the
+// target and sector of each sector of the striped data.  The layout, like the stripe unit,
+// must be the same for restoreFile() as for stripeFile().
+//
+// With a checksum file set by raidSetChecksumPath(), the parity workers of stripeFile() also
+// take the CRC32C of every sector of every target, data and XOR, and write them to it, a row
+// of RAID_CHUNKS checksums for each sector from the offset, the targets in order.  The block
+// writes of raidblock.c keep them up to date.  raidScrub() then streams every target through
+// the same pipeline as restoreFile(), and its workers check each row of sectors, one from each
+// target, against the checksums and for an XOR of zero:
+//
+//   checksums and XOR right         nothing to do
+//   XOR right, checksums wrong      the data agrees with itself, so the checksums are stale
+//   XOR wrong, one checksum wrong   that target's sector is corrupt, and is the XOR of the
+//                                   other four, which its checksum must then match
+//   XOR wrong, checksums right      not located, e.g. a torn update, the XOR chunk is redone
+//   XOR wrong, more checksums wrong more than the XOR chunk covers
+//
+// and when asked to repair, write the sector or checksum found wrong back.  Without a
+// checksum file only the XOR is checked, and a repair redoes the XOR chunk.
+
+static const char *raidDefaultChunkPath[RAID_CHUNKS]=
+{
+    "StripeChunk1.bin",
+    "StripeChunk2.bin",
+    "StripeChunk3.bin",
+    "StripeChunk4.bin",
+    "StripeChunkXOR.bin"
+};
+
+static char raidChunkPath[RAID_CHUNKS][RAID_MAX_PATH];
+static int raidDirectIO=FALSE;
+
+static int raidChunkSize=RAID_DEFAULT_CHUNK_SIZE;
+static int raidThreads=0;
+static int raidEngine=-1;
+static int raidQueueDepth=RAID_DEFAULT_QUEUE_DEPTH;
+static int raidLayout=RAID_LAYOUT_FIXED;
+static char raidChecksumPath[RAID_MAX_PATH];
+
+
+// returns OK, or ERROR unless a multiple of RAID_MIN_CHUNK_SIZE up to RAID_MAX_CHUNK_SIZE
+int raidSetChunkSize(int chunkSize)
+{
+    if((chunkSize < RAID_MIN_CHUNK_SIZE) || (chunkSize > RAID_MAX_CHUNK_SIZE) ||
+       ((chunkSize % RAID_MIN_CHUNK_SIZE) != 0))
+        return ERROR;
+
+    raidChunkSize=chunkSize;
+
+    return OK;
+}
+
+
+int raidGetChunkSize(void)
+{
+    return raidChunkSize;
+}
+
+
+// Set the paths of the chunk targets, data chunks then XOR, or with path NULL or an entry of
+// it NULL the default names.  Returns ERROR if a path is too long.
+int raidSetChunkPaths(const char *path[])
+{
+    int idx;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        if((path != NULL) && (path[idx] != NULL) && (strlen(path[idx]) >= RAID_MAX_PATH))
+            return ERROR;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        strcpy(raidChunkPath[idx], ((path != NULL) && (path[idx] != NULL)) ? path[idx] : raidDefaultChunkPath[idx]);
+
+    return OK;
+}
+
+
+// the path of a chunk target numbered as for missingChunk, 1 to RAID_CHUNKS
+const char *raidGetChunkPath(int chunk)
+{
+    if(raidChunkPath[0][0] == '\0')
+        raidSetChunkPaths(NULL);
+
+    return ((chunk >= 1) && (chunk <= RAID_CHUNKS)) ? raidChunkPath[chunk - 1] : NULL;
+}
+
+
+void raidSetDirectIO(int direct)
+{
+    raidDirectIO=direct;
+}
+
+
+int raidGetDirectIO(void)
+{
+    return raidDirectIO;
+}
+
+
+// returns OK, or ERROR unless 1 to RAID_MAX_THREADS parity workers
+int raidSetThreads(int numThreads)
+{
+    if((numThreads < 1) || (numThreads > RAID_MAX_THREADS))
+        return ERROR;
+
+    raidThreads=numThreads;
+
+    return OK;
+}
+
+
+// one worker per online CPU up to RAID_MAX_THREADS unless set
+int raidGetThreads(void)
+{
+    long cpus;
+
+    if(raidThreads == 0)
+    {
+        cpus=sysconf(_SC_NPROCESSORS_ONLN);
+        raidThreads=(cpus < 1) ? 1 : ((cpus > RAID_MAX_THREADS) ? RAID_MAX_THREADS : (int)cpus);
+    }
+
+    return raidThreads;
+}
+
+
+// returns OK, or ERROR for io_uring where the kernel does not have it
+int raidSetIOEngine(int engine)
 {
-    int fd[5], idx;
-    FILE *fdin;
-    unsigned char stripe[5*512];
-    int offset=0, bread=0, btoread=(4*512), bwritten=0, btowrite=(512), sectorCnt=0, byteCnt=0;
+    if((engine != RAID_IO_THREADS) && ((engine != RAID_IO_URING) || !raidRingAvailable()))
+        return ERROR;
+
+    raidEngine=engine;
 
-    fdin = fopen(inputFileName, "r");
-    fd[0] = open("StripeChunk1.bin", O_RDWR | O_CREAT, 00644);
-    fd[1] = open("StripeChunk2.bin", O_RDWR | O_CREAT, 00644);
-    fd[2] = open("StripeChunk3.bin", O_RDWR | O_CREAT, 00644);
-    fd[3] = open("StripeChunk4.bin", O_RDWR | O_CREAT, 00644);
-    fd[4] = open("StripeChunkXOR.bin", O_RDWR | O_CREAT, 00644);
+    return OK;
+}
 
 
-    do
+int raidGetIOEngine(void)
+{
+    char *name;
+
+    if(raidEngine < 0)
     {
+        raidEngine=raidRingAvailable() ? RAID_IO_URING : RAID_IO_THREADS;
 
-        // read a stripe or to end of file
-        offset=0, bread=0, btoread=(4*512);
-        do
-        {
-            bread=fread(&stripe[offset], 1, btoread, fdin); 
-            offset+=bread;
-            btoread=(4*512)-bread;
-        }
-        while (!(feof(fdin)) && (btoread > 0));
+        if(((name=getenv("RAID_IO_ENGINE")) != NULL) && (strcmp(name, "threads") == 0))
+            raidEngine=RAID_IO_THREADS;
+    }
+
+    return raidEngine;
+}
+
+
+const char *raidIOEngineName(int engine)
+{
+    return (engine == RAID_IO_URING) ? "io_uring" : "threads";
+}
+
+
+// returns OK, or ERROR unless 1 to RAID_MAX_QUEUE_DEPTH batches in flight
+int raidSetQueueDepth(int depth)
+{
+    if((depth < 1) || (depth > RAID_MAX_QUEUE_DEPTH))
+        return ERROR;
+
+    raidQueueDepth=depth;
+
+    return OK;
+}
+
+
+int raidGetQueueDepth(void)
+{
+    return raidQueueDepth;
+}
+
+
+// returns OK, or ERROR unless RAID_LAYOUT_FIXED or RAID_LAYOUT_LEFT_SYMMETRIC
+int raidSetLayout(int layout)
+{
+    if((layout != RAID_LAYOUT_FIXED) && (layout != RAID_LAYOUT_LEFT_SYMMETRIC))
+        return ERROR;
+
+    raidLayout=layout;
+
+    return OK;
+}
+
+
+int raidGetLayout(void)
+{
+    return raidLayout;
+}
+
+
+const char *raidLayoutName(int layout)
+{
+    return (layout == RAID_LAYOUT_LEFT_SYMMETRIC) ? "left-sym" : "fixed";
+}
+
+
+// Keep a CRC32C checksum of every sector of the chunk targets in a file at path, or with path
+// NULL none.  Returns ERROR if the path is too long.
+int raidSetChecksumPath(const char *path)
+{
+    if((path != NULL) && (strlen(path) >= RAID_MAX_PATH))
+        return ERROR;
+
+    strcpy(raidChecksumPath, (path != NULL) ? path : "");
+
+    return OK;
+}
+
+
+// the checksum file, NULL if none
+const char *raidGetChecksumPath(void)
+{
+    return (raidChecksumPath[0] != '\0') ? raidChecksumPath : NULL;
+}
+
+
+// the target index, 0 to RAID_CHUNKS-1, of each chunk of a stripe, the data chunks in order
+// then the XOR chunk
+void raidStripeTargets(int layout, long long stripe, int target[])
+{
+    int parity, idx;
+
+    parity=(layout == RAID_LAYOUT_LEFT_SYMMETRIC) ? (RAID_CHUNKS - 1 - (int)(stripe % RAID_CHUNKS)) : RAID_DATA_CHUNKS;
+
+    for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+        target[idx]=(layout == RAID_LAYOUT_LEFT_SYMMETRIC) ? ((parity + 1 + idx) % RAID_CHUNKS) : idx;
+    target[RAID_DATA_CHUNKS]=parity;
+}
+
+
+// Map a sector of the striped data to the chunk target holding it, 1 to RAID_CHUNKS, and its
+// sector there counted from the start of the stripes, for the stripe unit and layout set.
+// Returns the target of the XOR chunk of that stripe, or ERROR for a negative sector.
+int raidMapLBA(long long lba, int *chunk, long long *chunkLBA)
+{
+    int target[RAID_CHUNKS], unitSectors=raidChunkSize / SECTOR_SIZE;
+    long long unit=lba / unitSectors, stripe=unit / RAID_DATA_CHUNKS;
+
+    if(lba < 0)
+        return ERROR;
+
+    raidStripeTargets(raidLayout, stripe, target);
+
+    *chunk=target[unit % RAID_DATA_CHUNKS] + 1;
+    *chunkLBA=stripe * unitSectors + (lba % unitSectors);
+
+    return target[RAID_DATA_CHUNKS] + 1;
+}
+
+
+// preadv() or pwritev() of all of iov, resuming after short transfers, which updates iov.
+// Returns the bytes transferred, less than asked only at end of file on a read, or ERROR.
+static long long raidVectorIO(int fd, struct iovec *iov, int iovcnt, off_t offset, int write)
+{
+    long long total=0;
+    ssize_t rc;
+
+    while(iovcnt > 0)
+    {
+        rc=write ? pwritev(fd, iov, iovcnt, offset) : preadv(fd, iov, iovcnt, offset);
+
+        if((rc < 0) && (errno == EINTR))
+            continue;
+        if((rc < 0) || ((rc == 0) && write))
+            return ERROR;
+        if(rc == 0)
+            break;
 
+        total+=rc;
+        offset+=rc;
 
-        if((offset < (4*512)) && (feof(fdin)))
+        while((iovcnt > 0) && ((size_t)rc >= iov->iov_len))
         {
-            printf("hit end of file\n");
-            bzero(&stripe[offset], btoread);
-            byteCnt+=offset;
+            rc-=iov->iov_len;
+            iov++;
+            iovcnt--;
         }
-        else
-        {
-            //printf("read full stripe\n");
-            assert(offset == (4*512));
-            byteCnt+=(4*512);
-        };
-
-        // computer xor code for stripe
-        //
-        xorLBA(PTR_CAST &stripe[0],
-               PTR_CAST &stripe[512],
-               PTR_CAST &stripe[1024],
-               PTR_CAST &stripe[1536],
-               PTR_CAST &stripe[2048]);
-
-
-        // write out the stripe + xor code
-        //
-        offset=0, bwritten=0, btowrite=(512);
-        do
+        if(iovcnt > 0)
         {
-            bwritten=write(fd[0], &stripe[offset], 512); 
-            offset+=bwritten;
-            btowrite=(512)-bwritten;
+            iov->iov_base=(unsigned char *)iov->iov_base + rc;
+            iov->iov_len-=rc;
         }
-        while (btowrite > 0);
+    }
 
-        offset=512, bwritten=0, btowrite=(512);
-        do
-        {
-            bwritten=write(fd[1], &stripe[offset], 512); 
-            offset+=bwritten;
-            btowrite=(512)-bwritten;
-        }
-        while (btowrite > 0);
+    return total;
+}
 
-        offset=1024, bwritten=0, btowrite=(512);
-        do
-        {
-            bwritten=write(fd[2], &stripe[offset], 512); 
-            offset+=bwritten;
-            btowrite=(512)-bwritten;
-        }
-        while (btowrite > 0);
 
-        offset=1536, bwritten=0, btowrite=(512);
-        do
-        {
-            bwritten=write(fd[3], &stripe[offset], 512); 
-            offset+=bwritten;
-            btowrite=(512)-bwritten;
-        }
-        while (btowrite > 0);
+static long long raidBlockIO(int fd, unsigned char *buf, long long len, off_t offset, int write)
+{
+    struct iovec iov;
 
-        offset=2048, bwritten=0, btowrite=(512);
-        do
-        {
-            bwritten=write(fd[4], &stripe[offset], 512); 
-            offset+=bwritten;
-            btowrite=(512)-bwritten;
-        }
-        while (btowrite > 0);
+    iov.iov_base=buf;
+    iov.iov_len=len;
+
+    return raidVectorIO(fd, &iov, 1, offset, write);
+}
+
+
+// A batch of stripes, with the chunk units on each chunk target contiguous
+typedef struct
+{
+    unsigned char *chunk[RAID_CHUNKS];
+    long long firstStripe;
+    int numStripes;
+    int pending;                        // stage threads, or ring I/Os, still to finish with it
+    int ioDone[RAID_CHUNKS];            // bytes of each chunk transferred on the ring
+    unsigned int *crc;                  // a row of RAID_CHUNKS for each sector, with checksums
+} raidSlot_t;
+
+// Slot numbers waiting for the next stage, never more than the slots there are
+typedef struct
+{
+    int slot[RAID_MAX_SLOTS];
+    int head;
+    int count;
+    int closed;
+} raidQueue_t;
+
+typedef struct
+{
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int error;
+
+    raidSlot_t slot[RAID_MAX_SLOTS];
+    int numSlots;
+    int chunkSize;
+    int batchStripes;
+    long long stripeBytes;
+
+    raidQueue_t freeQ;                  // empty slots
+    raidQueue_t workQ;                  // slots for the parity workers
+    raidQueue_t chunkQ[RAID_CHUNKS];    // slots for each chunk file reader or writer
+    raidQueue_t ringQ;                  // or for the io_uring thread
+    raidQueue_t outQ;                   // rebuilt slots for the output writer
+    int activeIO;                       // chunk readers still running, the last closes workQ
+    int activeWorkers;                  // workers still running, the last closes the next queue
+
+    int fd[RAID_CHUNKS];
+    int blockSize[RAID_CHUNKS];         // smallest O_DIRECT write to each target, SECTOR_SIZE without
+    int fdFile;                         // input or output file
+    long long chunkOffset;              // of the first stripe on each chunk target
+    long long fileLength;
+    int missingChunk;
+    int numThreads;
+    int layout;
+
+    int engine;
+    int queueDepth;
+    int writeChunks;                    // TRUE to stripe, FALSE to restore
+    raidRing_t ring;
+
+    int fdCrc;                          // the checksum file, -1 if none
+    int repair;                         // raidScrub() rewrites what it finds wrong
+    raidScrubStats_t scrub;
+} raidPipeline_t;
+
+typedef struct
+{
+    raidPipeline_t *pipe;
+    int chunk;
+} raidStage_t;
 
-        sectorCnt+=4;
 
+static void raidQueuePut(raidPipeline_t *pipe, raidQueue_t *queue, int slot)
+{
+    pthread_mutex_lock(&pipe->lock);
+    assert(queue->count < RAID_MAX_SLOTS);
+    queue->slot[(queue->head + queue->count) % RAID_MAX_SLOTS]=slot;
+    queue->count++;
+    pthread_cond_broadcast(&pipe->cond);
+    pthread_mutex_unlock(&pipe->lock);
+}
+
+
+// next slot on the queue, or -1 once it is closed and empty or the pipeline failed, or
+// without wait at once if it is empty
+static int raidQueueWait(raidPipeline_t *pipe, raidQueue_t *queue, int wait)
+{
+    int slot=-1;
+
+    pthread_mutex_lock(&pipe->lock);
+    while(wait && (queue->count == 0) && !queue->closed && !pipe->error)
+        pthread_cond_wait(&pipe->cond, &pipe->lock);
+
+    if((queue->count > 0) && !pipe->error)
+    {
+        slot=queue->slot[queue->head];
+        queue->head=(queue->head + 1) % RAID_MAX_SLOTS;
+        queue->count--;
     }
-    while (!(feof(fdin)));
+    pthread_mutex_unlock(&pipe->lock);
+
+    return slot;
+}
 
-    fclose(fdin);
-    for(idx=0; idx < 5; idx++) close(fd[idx]);
 
-    return(byteCnt);
+static int raidQueueGet(raidPipeline_t *pipe, raidQueue_t *queue)
+{
+    return raidQueueWait(pipe, queue, TRUE);
 }
 
 
-// returns bytes read or ERROR code
-// 
-// missingChunk = 0 for no missing
-//              = 1 ... 4 for missing data chunk
-//              = 5 for missing XOR chunk
-//
-// Ugly repeated code needs to be refactored, but works for now.
-//
-int restoreFile(char *outputFileName, int offsetSectors, int fileLength, int missingChunk)
+// TRUE once a queue is closed and empty or the pipeline failed
+static int raidQueueFinished(raidPipeline_t *pipe, raidQueue_t *queue)
 {
-    int fd[5], idx;
-    FILE *fdout;
-    unsigned char stripe[5*512];
-    int offset=0, bread=0, btoread=(4*512), bwritten=0, btowrite=(512), sectorCnt=fileLength/512;
-    int stripeCnt=fileLength/(4*512);
-    int lastStripeBytes = fileLength % (4*512);
+    int finished;
 
-    fdout = fopen(outputFileName, "w");
+    pthread_mutex_lock(&pipe->lock);
+    finished=((queue->count == 0) && queue->closed) || pipe->error;
+    pthread_mutex_unlock(&pipe->lock);
 
-    fd[0] = open("StripeChunk1.bin", O_RDWR | O_CREAT, 00644);
-    fd[1] = open("StripeChunk2.bin", O_RDWR | O_CREAT, 00644);
-    fd[2] = open("StripeChunk3.bin", O_RDWR | O_CREAT, 00644);
-    fd[3] = open("StripeChunk4.bin", O_RDWR | O_CREAT, 00644);
-    fd[4] = open("StripeChunkXOR.bin", O_RDWR | O_CREAT, 00644);
+    return finished;
+}
 
 
-    for(idx=0; idx < stripeCnt; idx++)
-    {
-        // read in the stripe + xor code
+static void raidQueueClose(raidPipeline_t *pipe, raidQueue_t *queue)
+{
+    pthread_mutex_lock(&pipe->lock);
+    queue->closed=TRUE;
+    pthread_cond_broadcast(&pipe->cond);
+    pthread_mutex_unlock(&pipe->lock);
+}
 
-        if(missingChunk == 1)
-	{
-		printf("will rebuild chunk 1\n");
-	}
-	else
-	{
-            offset=0, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[0], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-
-        if(missingChunk == 2)
-	{
-		printf("will rebuild chunk 2\n");
-	}
-	else
-	{
-            offset=512, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[1], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-
-        if(missingChunk == 3)
-	{
-		printf("will rebuild chunk 3\n");
-	}
-	else
-	{
-            offset=1024, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[2], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        if(missingChunk == 4)
-	{
-		printf("will rebuild chunk 4\n");
-	}
-	else
-	{
-            offset=1536, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[3], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        if(missingChunk == 5)
-	{
-		printf("will rebuild chunk 5\n");
-	}
-	else
-	{
-            offset=2048, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[4], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        // OPTION - check XOR here or re-compute it
-        //
-	if(missingChunk == 1)
-	{
-		rebuildLBA( PTR_CAST &stripe[512], 
-			    PTR_CAST &stripe[1024], 
-			    PTR_CAST &stripe[1536], 
-			    PTR_CAST &stripe[2048], 
-			    PTR_CAST &stripe[0]);
-	}
-
-	if(missingChunk == 2)
-	{
-		rebuildLBA( PTR_CAST &stripe[0], 
-		  	    PTR_CAST &stripe[1024], 
-			    PTR_CAST &stripe[1536], 
-			    PTR_CAST &stripe[2048], 
-			    PTR_CAST &stripe[512]);
-	}
-	if(missingChunk == 3)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1536],
-		           PTR_CAST &stripe[2048],
-		           PTR_CAST &stripe[1024]
-			  );
-	}
-	if(missingChunk == 4)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1024],
-		           PTR_CAST &stripe[2048],
-		           PTR_CAST &stripe[1536]
-			  );
-	}
-	if(missingChunk == 5)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1024],
-		           PTR_CAST &stripe[1536],
-		           PTR_CAST &stripe[2048]
-			  );
-	}
-	
-
-       // write a full stripe
-        offset=0, bwritten=0, btowrite=(4*512);
-
-        do
+
+static void raidPipelineFail(raidPipeline_t *pipe)
+{
+    pthread_mutex_lock(&pipe->lock);
+    pipe->error=TRUE;
+    pthread_cond_broadcast(&pipe->cond);
+    pthread_mutex_unlock(&pipe->lock);
+}
+
+
+static int raidPipelineFailed(raidPipeline_t *pipe)
+{
+    int failed;
+
+    pthread_mutex_lock(&pipe->lock);
+    failed=pipe->error;
+    pthread_mutex_unlock(&pipe->lock);
+
+    return failed;
+}
+
+
+// count one stage thread done with a slot, TRUE for the last one
+static int raidSlotDone(raidPipeline_t *pipe, int slot)
+{
+    int last;
+
+    pthread_mutex_lock(&pipe->lock);
+    last=(--pipe->slot[slot].pending == 0);
+    pthread_mutex_unlock(&pipe->lock);
+
+    return last;
+}
+
+
+// count one thread of a stage done, TRUE for the last one
+static int raidStageDone(raidPipeline_t *pipe, int *active)
+{
+    int last;
+
+    pthread_mutex_lock(&pipe->lock);
+    last=(--(*active) == 0);
+    pthread_mutex_unlock(&pipe->lock);
+
+    return last;
+}
+
+
+static int raidPipelineInit(raidPipeline_t *pipe, int chunkSize, int numThreads, int engine, int queueDepth,
+                            long long fileLength)
+{
+    long long numBatches;
+
+    int slot, idx;
+
+    bzero(pipe, sizeof(raidPipeline_t));
+    pthread_mutex_init(&pipe->lock, NULL);
+    pthread_cond_init(&pipe->cond, NULL);
+
+    pipe->chunkSize=chunkSize;
+    pipe->batchStripes=(RAID_IO_BYTES > chunkSize) ? (RAID_IO_BYTES / chunkSize) : 1;
+    pipe->stripeBytes=(long long)RAID_DATA_CHUNKS * chunkSize;
+    pipe->numThreads=numThreads;
+    pipe->fdFile=-1;
+    pipe->fdCrc=-1;
+    pipe->engine=engine;
+    pipe->queueDepth=queueDepth;
+    pipe->ring.fd=-1;
+
+    // enough for every worker to have a slot while the I/O threads fill and drain as many,
+    // plus the batches in flight on the ring
+    pipe->numSlots=2 * numThreads + 2 + ((engine == RAID_IO_URING) ? queueDepth : 0);
+    if(pipe->numSlots > RAID_MAX_SLOTS) pipe->numSlots=RAID_MAX_SLOTS;
+
+    // but no more than the file has batches, as the ring pins every slot buffer
+    numBatches=(fileLength + pipe->batchStripes * pipe->stripeBytes - 1) / (pipe->batchStripes * pipe->stripeBytes);
+    if(numBatches < 1) numBatches=1;
+    if(pipe->numSlots > numBatches) pipe->numSlots=numBatches;
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        pipe->fd[idx]=-1;
+
+    for(slot=0; slot < pipe->numSlots; slot++)
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
         {
-            bwritten=fwrite(&stripe[offset], 1, btowrite, fdout); 
-            offset+=bwritten;
-            btowrite=(4*512)-bwritten;
+            if(posix_memalign((void **)&pipe->slot[slot].chunk[idx], RAID_MIN_CHUNK_SIZE,
+                              (size_t)pipe->batchStripes * chunkSize) != 0)
+                return ERROR;
         }
-        while ((btowrite > 0));
 
+        pipe->freeQ.slot[slot]=slot;
     }
+    pipe->freeQ.count=pipe->numSlots;
+
+    return OK;
+}
 
 
-    if(lastStripeBytes)
+static void raidPipelineFree(raidPipeline_t *pipe)
+{
+    int slot, idx;
+
+    for(slot=0; slot < pipe->numSlots; slot++)
     {
-        // read in the parital stripe + xor code
-        //
-        if(missingChunk == 1)
-	{
-		printf("will rebuild chunk 1\n");
-	}
-	else
-	{
-            offset=0, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[0], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        if(missingChunk == 2)
-	{
-		printf("will rebuild chunk 2\n");
-	}
-	else
-	{
-            offset=512, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[1], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        if(missingChunk == 3)
-	{
-		printf("will rebuild chunk 3\n");
-	}
-	else
-	{
-            offset=1024, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[2], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        if(missingChunk == 4)
-	{
-		printf("will rebuild chunk 4\n");
-	}
-	else
-	{
-            offset=1536, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[3], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-
-        if(missingChunk == 5)
-	{
-		printf("will rebuild chunk 5\n");
-	}
-	else
-	{
-            offset=2048, bread=0, btoread=(512);
-            do
-            {
-                bread=read(fd[4], &stripe[offset], 512); 
-                offset+=bread;
-                btoread=(512)-bread;
-            }
-            while (btoread > 0);
-	}
-
-        // OPTION - check XOR here
-        //
-	if(missingChunk == 1)
-	{
-		rebuildLBA( PTR_CAST &stripe[512], 
-			    PTR_CAST &stripe[1024], 
-			    PTR_CAST &stripe[1536], 
-			    PTR_CAST &stripe[2048], 
-			    PTR_CAST &stripe[0]);
-	}
-
-	if(missingChunk == 2)
-	{
-		rebuildLBA( PTR_CAST &stripe[0], 
-		  	    PTR_CAST &stripe[1024], 
-			    PTR_CAST &stripe[1536], 
-			    PTR_CAST &stripe[2048], 
-			    PTR_CAST &stripe[512]);
-	}
-	if(missingChunk == 3)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1536],
-		           PTR_CAST &stripe[2048],
-		           PTR_CAST &stripe[1024]
-			  );
-	}
-	if(missingChunk == 4)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1024],
-		           PTR_CAST &stripe[2048],
-		           PTR_CAST &stripe[1536]
-			  );
-	}
-	if(missingChunk == 5)
-	{
-		rebuildLBA(
-			   PTR_CAST &stripe[0],
-		           PTR_CAST &stripe[512],
-		           PTR_CAST &stripe[1024],
-		           PTR_CAST &stripe[1536],
-		           PTR_CAST &stripe[2048]
-			  );
-	}
-
-       // write a partial stripe
-        offset=0, bwritten=0, btowrite=(lastStripeBytes);
-
-        do
-        {
-            bwritten=fwrite(&stripe[offset], 1, btowrite, fdout); 
-            offset+=bwritten;
-            btowrite=lastStripeBytes-bwritten;
-        }
-        while ((btowrite > 0));
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            free(pipe->slot[slot].chunk[idx]);
+        free(pipe->slot[slot].crc);
     }
 
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        if(pipe->fd[idx] >= 0) close(pipe->fd[idx]);
+
+    if(pipe->fdFile >= 0) close(pipe->fdFile);
+    if(pipe->fdCrc >= 0) close(pipe->fdCrc);
+
+    raidRingExit(&pipe->ring);
+
+    pthread_mutex_destroy(&pipe->lock);
+    pthread_cond_destroy(&pipe->cond);
+}
+
+
+// Open the checksum file, if one is set, read-write to write or repair it, and give every slot
+// room for the checksums of its sectors.  Returns ERROR if it can't be opened.
+static int raidPipelineChecksums(raidPipeline_t *pipe, int write)
+{
+    int slot;
+
+    if(raidChecksumPath[0] == '\0')
+        return OK;
+
+    if((pipe->fdCrc=open(raidChecksumPath, write ? (O_RDWR | O_CREAT) : O_RDONLY, 00644)) < 0)
+    {
+        printf("can't open %s\n", raidChecksumPath);
+        return ERROR;
+    }
 
-    fclose(fdout);
-    for(idx=0; idx < 5; idx++) close(fd[idx]);
+    for(slot=0; slot < pipe->numSlots; slot++)
+        if((pipe->slot[slot].crc=malloc((size_t)pipe->batchStripes * (pipe->chunkSize / SECTOR_SIZE) *
+                                        RAID_CHUNKS * sizeof(unsigned int))) == NULL)
+            return ERROR;
 
-    return(fileLength);
+    return OK;
 }
 
+
+// Read or write the checksums of a slot at their place in the checksum file, those never
+// written reading as 0.  Returns ERROR if the I/O fails.
+static int raidSlotChecksumIO(raidPipeline_t *pipe, int slot, int write)
+{
+    raidSlot_t *s=&pipe->slot[slot];
+    long long len, done, rowBytes=RAID_CHUNKS * sizeof(unsigned int);
+
+    len=(long long)s->numStripes * (pipe->chunkSize / SECTOR_SIZE) * rowBytes;
+    done=raidBlockIO(pipe->fdCrc, (unsigned char *)s->crc, len,
+                     s->firstStripe * (pipe->chunkSize / SECTOR_SIZE) * rowBytes, write);
+
+    if((done == ERROR) || (write && (done != len)))
+        return ERROR;
+
+    if(done < len)
+        bzero((unsigned char *)s->crc + done, len - done);
+
+    return OK;
+}
+
+
+// Set up the ring with every slot buffer and the open chunk files registered, or if that
+// fails fall back to the threads, for this and later calls
+static void raidPipelineRing(raidPipeline_t *pipe)
+{
+    struct iovec iov[RAID_MAX_SLOTS * RAID_CHUNKS];
+    int fd[RAID_CHUNKS], slot, idx, numFiles=0;
+
+    if(pipe->engine != RAID_IO_URING)
+        return;
+
+    for(slot=0; slot < pipe->numSlots; slot++)
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+        {
+            iov[slot * RAID_CHUNKS + idx].iov_base=pipe->slot[slot].chunk[idx];
+            iov[slot * RAID_CHUNKS + idx].iov_len=(size_t)pipe->batchStripes * pipe->chunkSize;
+        }
+    }
+
+    // the missing chunk file of a restore is not open, so registered file indexes skip it
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        if(pipe->fd[idx] >= 0) fd[numFiles++]=pipe->fd[idx];
+
+    if((raidRingInit(&pipe->ring, pipe->queueDepth * RAID_CHUNKS) != OK) ||
+       (raidRingRegisterBuffers(&pipe->ring, iov, pipe->numSlots * RAID_CHUNKS) != OK) ||
+       (raidRingRegisterFiles(&pipe->ring, fd, numFiles) != OK))
+    {
+        printf("io_uring setup failed, using a thread per chunk file\n");
+        raidRingExit(&pipe->ring);
+        pipe->engine=RAID_IO_THREADS;
+        raidEngine=RAID_IO_THREADS;
+    }
+}
+
+
+// the chunks of one stripe of a slot, the data chunks in order then the XOR chunk, and the
+// target index of each
+static void raidStripeUnits(raidPipeline_t *pipe, int slot, int stripe, unsigned char *unit[], int target[])
+{
+    raidSlot_t *s=&pipe->slot[slot];
+    int idx;
+
+    raidStripeTargets(pipe->layout, s->firstStripe + stripe, target);
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        unit[idx]=s->chunk[target[idx]] + (size_t)stripe * pipe->chunkSize;
+}
+
+
+// the iovecs of numStripes stripe units of a slot in file order
+static int raidStripeIov(raidPipeline_t *pipe, int slot, int numStripes, struct iovec iov[])
+{
+    unsigned char *unit[RAID_CHUNKS];
+    int target[RAID_CHUNKS];
+    int stripe, idx, iovcnt=0;
+
+    for(stripe=0; stripe < numStripes; stripe++)
+    {
+        raidStripeUnits(pipe, slot, stripe, unit, target);
+
+        for(idx=0; idx < RAID_DATA_CHUNKS; idx++, iovcnt++)
+        {
+            iov[iovcnt].iov_base=unit[idx];
+            iov[iovcnt].iov_len=pipe->chunkSize;
+        }
+    }
+
+    return iovcnt;
+}
+
+
+// stripeFile() workers computing the XOR chunk of each batch, then handing it to every writer
+static void *raidEncodeWorker(void *arg)
+{
+    raidPipeline_t *pipe=(raidPipeline_t *)arg;
+    unsigned char *unit[RAID_CHUNKS];
+    int target[RAID_CHUNKS];
+    raidSlot_t *s;
+    int slot, idx, stripe, row;
+
+    while((slot=raidQueueGet(pipe, &pipe->workQ)) >= 0)
+    {
+        s=&pipe->slot[slot];
+
+        // the whole batch at once where the parity is always on the same target
+        if(pipe->layout == RAID_LAYOUT_FIXED)
+            raidEncodeStripe(s->chunk, RAID_DATA_CHUNKS, 1, s->numStripes * pipe->chunkSize);
+        else
+        {
+            for(stripe=0; stripe < s->numStripes; stripe++)
+            {
+                raidStripeUnits(pipe, slot, stripe, unit, target);
+                raidEncodeStripe(unit, RAID_DATA_CHUNKS, 1, pipe->chunkSize);
+            }
+        }
+
+        if(pipe->fdCrc >= 0)
+        {
+            for(row=0; row < s->numStripes * (pipe->chunkSize / SECTOR_SIZE); row++)
+                for(idx=0; idx < RAID_CHUNKS; idx++)
+                    s->crc[row * RAID_CHUNKS + idx]=crc32c(0, s->chunk[idx] + (size_t)row * SECTOR_SIZE, SECTOR_SIZE);
+
+            if(raidSlotChecksumIO(pipe, slot, TRUE) != OK)
+            {
+                printf("write to %s failed\n", raidChecksumPath);
+                raidPipelineFail(pipe);
+            }
+        }
+
+        s->pending=RAID_CHUNKS;
+        if(pipe->engine == RAID_IO_URING)
+            raidQueuePut(pipe, &pipe->ringQ, slot);
+        else
+            for(idx=0; idx < RAID_CHUNKS; idx++)
+                raidQueuePut(pipe, &pipe->chunkQ[idx], slot);
+    }
+
+    if(raidStageDone(pipe, &pipe->activeWorkers))
+    {
+        raidQueueClose(pipe, &pipe->ringQ);
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            raidQueueClose(pipe, &pipe->chunkQ[idx]);
+    }
+
+    return NULL;
+}
+
+
+// stripeFile() thread writing one chunk file, the last writer of a batch freeing its slot
+static void *raidChunkWriter(void *arg)
+{
+    raidStage_t *stage=(raidStage_t *)arg;
+    raidPipeline_t *pipe=stage->pipe;
+    raidSlot_t *s;
+    long long len;
+    int slot;
+
+    while((slot=raidQueueGet(pipe, &pipe->chunkQ[stage->chunk])) >= 0)
+    {
+        s=&pipe->slot[slot];
+        len=(long long)s->numStripes * pipe->chunkSize;
+
+        if(raidBlockIO(pipe->fd[stage->chunk], s->chunk[stage->chunk], len,
+                       pipe->chunkOffset + (off_t)s->firstStripe * pipe->chunkSize, TRUE) != len)
+        {
+            printf("write to %s failed\n", raidGetChunkPath(stage->chunk + 1));
+            raidPipelineFail(pipe);
+            break;
+        }
+
+        if(raidSlotDone(pipe, slot))
+            raidQueuePut(pipe, &pipe->freeQ, slot);
+    }
+
+    return NULL;
+}
+
+
+// restoreFile() thread reading one surviving chunk file, the last reader of a batch passing
+// it on to the workers
+static void *raidChunkReader(void *arg)
+{
+    raidStage_t *stage=(raidStage_t *)arg;
+    raidPipeline_t *pipe=stage->pipe;
+    raidSlot_t *s;
+    long long len;
+    int slot;
+
+    while((slot=raidQueueGet(pipe, &pipe->chunkQ[stage->chunk])) >= 0)
+    {
+        s=&pipe->slot[slot];
+        len=(long long)s->numStripes * pipe->chunkSize;
+
+        if(raidBlockIO(pipe->fd[stage->chunk], s->chunk[stage->chunk], len,
+                       pipe->chunkOffset + (off_t)s->firstStripe * pipe->chunkSize, FALSE) != len)
+        {
+            printf("read from %s failed or too short\n", raidGetChunkPath(stage->chunk + 1));
+            raidPipelineFail(pipe);
+            break;
+        }
+
+        if(raidSlotDone(pipe, slot))
+            raidQueuePut(pipe, &pipe->workQ, slot);
+    }
+
+    if(raidStageDone(pipe, &pipe->activeIO))
+        raidQueueClose(pipe, &pipe->workQ);
+
+    return NULL;
+}
+
+
+// queue the rest of one chunk of a slot on the ring, after a short transfer if any
+static int raidRingChunk(raidPipeline_t *pipe, int slot, int chunk, int write)
+{
+    raidSlot_t *s=&pipe->slot[slot];
+    long long len=(long long)s->numStripes * pipe->chunkSize;
+    int idx, fileIdx=0;
+
+    for(idx=0; idx < chunk; idx++)
+        if(pipe->fd[idx] >= 0) fileIdx++;
+
+    return raidRingPrepare(&pipe->ring, write, fileIdx, s->chunk[chunk] + s->ioDone[chunk],
+                           len - s->ioDone[chunk],
+                           pipe->chunkOffset + (long long)s->firstStripe * pipe->chunkSize + s->ioDone[chunk],
+                           slot * RAID_CHUNKS + chunk, slot * RAID_CHUNKS + chunk);
+}
+
+
+// The io_uring thread, for stripeFile() writing every chunk file of each batch from the
+// workers and then freeing the slot, or for restoreFile() reading every surviving chunk file
+// of each batch from the caller and then passing it to the workers.  Up to the queue depth
+// of batches are in flight, and when none are it waits for the next.
+static void *raidRingIO(void *arg)
+{
+    raidPipeline_t *pipe=(raidPipeline_t *)arg;
+    raidSlot_t *s;
+    unsigned long long userData;
+    int write=pipe->writeChunks, inFlight=0, slot, chunk, result, idx, prepared;
+
+    while(!raidPipelineFailed(pipe))
+    {
+        prepared=TRUE;
+        while(prepared && (inFlight < pipe->queueDepth) &&
+              ((slot=raidQueueWait(pipe, &pipe->ringQ, inFlight == 0)) >= 0))
+        {
+            s=&pipe->slot[slot];
+            s->pending=0;
+            for(idx=0; prepared && (idx < RAID_CHUNKS); idx++)
+            {
+                s->ioDone[idx]=0;
+                if(pipe->fd[idx] < 0)
+                    continue;
+
+                // only I/O on the ring counts as pending, so the slot is drained below
+                if(raidRingChunk(pipe, slot, idx, write) != OK)
+                {
+                    printf("io_uring prepare failed\n");
+                    raidPipelineFail(pipe);
+                    prepared=FALSE;
+                    continue;
+                }
+                s->pending++;
+            }
+            if(s->pending > 0) inFlight++;
+        }
+
+        if((inFlight == 0) && (!prepared || raidQueueFinished(pipe, &pipe->ringQ)))
+            break;
+
+        if(raidRingSubmit(&pipe->ring, 1) != OK)
+        {
+            printf("io_uring submit failed\n");
+            raidPipelineFail(pipe);
+            break;
+        }
+
+        while(raidRingReap(&pipe->ring, &userData, &result))
+        {
+            slot=userData / RAID_CHUNKS;
+            chunk=userData % RAID_CHUNKS;
+            s=&pipe->slot[slot];
+
+            if(result <= 0)
+            {
+                printf("%s %s failed or too short\n", write ? "write to" : "read from", raidGetChunkPath(chunk + 1));
+                raidPipelineFail(pipe);
+                if(--s->pending == 0) inFlight--;
+                break;
+            }
+
+            s->ioDone[chunk]+=result;
+            if(s->ioDone[chunk] < s->numStripes * pipe->chunkSize)
+            {
+                if(raidRingChunk(pipe, slot, chunk, write) == OK)
+                    continue;
+
+                printf("io_uring prepare failed\n");
+                raidPipelineFail(pipe);
+                if(--s->pending == 0) inFlight--;
+                break;
+            }
+
+            if(--s->pending > 0)
+                continue;
+
+            inFlight--;
+            raidQueuePut(pipe, write ? &pipe->freeQ : &pipe->workQ, slot);
+        }
+    }
+
+    // the ring is torn down with the pipeline, after any I/O still in flight completes
+    while(inFlight > 0)
+    {
+        if(raidRingSubmit(&pipe->ring, 1) != OK)
+            break;
+        while(raidRingReap(&pipe->ring, &userData, &result))
+        {
+            s=&pipe->slot[userData / RAID_CHUNKS];
+            if(--s->pending == 0) inFlight--;
+        }
+    }
+
+    if(!write)
+        raidQueueClose(pipe, &pipe->workQ);
+
+    return NULL;
+}
+
+
+// restoreFile() workers rebuilding the lost chunk of each batch from the other four
+static void *raidRebuildWorker(void *arg)
+{
+    raidPipeline_t *pipe=(raidPipeline_t *)arg;
+    unsigned char *unit[RAID_CHUNKS];
+    int target[RAID_CHUNKS];
+    raidSlot_t *s;
+    int slot, stripe, lost;
+
+    while((slot=raidQueueGet(pipe, &pipe->workQ)) >= 0)
+    {
+        s=&pipe->slot[slot];
+
+        if((pipe->missingChunk > 0) && (pipe->layout == RAID_LAYOUT_FIXED))
+            raidRecoverStripe(s->chunk, RAID_DATA_CHUNKS, 1, s->numStripes * pipe->chunkSize,
+                              pipe->missingChunk - 1, -1);
+        else if(pipe->missingChunk > 0)
+        {
+            // the lost target holds a different chunk of each stripe
+            for(stripe=0; stripe < s->numStripes; stripe++)
+            {
+                raidStripeUnits(pipe, slot, stripe, unit, target);
+                for(lost=0; target[lost] != pipe->missingChunk - 1; lost++);
+                raidRecoverStripe(unit, RAID_DATA_CHUNKS, 1, pipe->chunkSize, lost, -1);
+            }
+        }
+
+        raidQueuePut(pipe, &pipe->outQ, slot);
+    }
+
+    if(raidStageDone(pipe, &pipe->activeWorkers))
+        raidQueueClose(pipe, &pipe->outQ);
+
+    return NULL;
+}
+
+
+// restoreFile() thread gathering the data units of each batch back into the output file,
+// the last stripe only to the file length
+static void *raidFileWriter(void *arg)
+{
+    raidPipeline_t *pipe=(raidPipeline_t *)arg;
+    struct iovec iov[RAID_MAX_IOV];
+    raidSlot_t *s;
+    long long offset, len;
+    int slot, idx, iovcnt;
+
+    while((slot=raidQueueGet(pipe, &pipe->outQ)) >= 0)
+    {
+        s=&pipe->slot[slot];
+        offset=s->firstStripe * pipe->stripeBytes;
+        len=pipe->fileLength - offset;
+        if(len > s->numStripes * pipe->stripeBytes)
+            len=s->numStripes * pipe->stripeBytes;
+
+        iovcnt=raidStripeIov(pipe, slot, s->numStripes, iov);
+        for(idx=0; idx < iovcnt; idx++)
+        {
+            if((long long)(idx + 1) * pipe->chunkSize >= len)
+            {
+                iov[idx].iov_len=len - (long long)idx * pipe->chunkSize;
+                iovcnt=idx + 1;
+                break;
+            }
+        }
+
+        if(raidVectorIO(pipe->fdFile, iov, iovcnt, offset, TRUE) != len)
+        {
+            printf("write of restored file failed\n");
+            raidPipelineFail(pipe);
+            break;
+        }
+
+        raidQueuePut(pipe, &pipe->freeQ, slot);
+    }
+
+    return NULL;
+}
+
+
+// raidScrub() workers checking each row of sectors of a batch, one from each target, for an
+// XOR of zero and against their checksums, and repairing what they find wrong if asked.  A
+// repair writes the block of the target's logical block size holding the sector, from the
+// slot buffer, so an O_DIRECT target on a 4K sector device gets a whole aligned block.
+static void *raidScrubWorker(void *arg)
+{
+    static const unsigned char zero[SECTOR_SIZE];
+    raidPipeline_t *pipe=(raidPipeline_t *)arg;
+    raidScrubStats_t found;
+    unsigned char *rowXor=NULL, *sector;
+    unsigned int crc[RAID_CHUNKS], *stored=NULL;
+    int target[RAID_CHUNKS];
+    raidSlot_t *s;
+    int slot, idx, row, numRows, numBad, bad, dirtyCrc, blockLen;
+    size_t block;
+
+    if(posix_memalign((void **)&rowXor, SECTOR_SIZE, (size_t)pipe->batchStripes * pipe->chunkSize) != 0)
+    {
+        raidPipelineFail(pipe);
+        rowXor=NULL;
+    }
+
+    while((rowXor != NULL) && ((slot=raidQueueGet(pipe, &pipe->workQ)) >= 0))
+    {
+        s=&pipe->slot[slot];
+        numRows=s->numStripes * (pipe->chunkSize / SECTOR_SIZE);
+        bzero(&found, sizeof(found));
+        dirtyCrc=FALSE;
+
+        xorBlocks(s->chunk, RAID_CHUNKS, rowXor, s->numStripes * pipe->chunkSize);
+
+        if((pipe->fdCrc >= 0) && (raidSlotChecksumIO(pipe, slot, FALSE) != OK))
+        {
+            printf("read from %s failed\n", raidChecksumPath);
+            raidPipelineFail(pipe);
+            break;
+        }
+
+        for(row=0; row < numRows; row++)
+        {
+            numBad=0;
+            bad=-1;
+
+            if(pipe->fdCrc >= 0)
+            {
+                stored=&s->crc[row * RAID_CHUNKS];
+                for(idx=0; idx < RAID_CHUNKS; idx++)
+                {
+                    crc[idx]=crc32c(0, s->chunk[idx] + (size_t)row * SECTOR_SIZE, SECTOR_SIZE);
+                    if(crc[idx] != stored[idx])
+                    {
+                        numBad++;
+                        bad=idx;
+                    }
+                }
+                found.checksumErrors+=numBad;
+            }
+
+            if(memcmp(rowXor + (size_t)row * SECTOR_SIZE, zero, SECTOR_SIZE) == 0)
+            {
+                // the sectors agree, so any checksum wrong is stale
+                if((numBad > 0) && pipe->repair)
+                {
+                    memcpy(stored, crc, sizeof(crc));
+                    dirtyCrc=TRUE;
+                    found.repaired+=numBad;
+                }
+                continue;
+            }
+
+            found.parityErrors++;
+
+            if(numBad == 1)
+            {
+                // the sector with the wrong checksum is the XOR of the other four, if that
+                // matches its checksum
+                sector=s->chunk[bad] + (size_t)row * SECTOR_SIZE;
+                xorBlocks((unsigned char *[]){sector, rowXor + (size_t)row * SECTOR_SIZE}, 2, sector, SECTOR_SIZE);
+
+                if(crc32c(0, sector, SECTOR_SIZE) != stored[bad])
+                {
+                    // put the sector back, since a repair in the same block writes it too
+                    xorBlocks((unsigned char *[]){sector, rowXor + (size_t)row * SECTOR_SIZE}, 2, sector, SECTOR_SIZE);
+                    found.unrecoverable++;
+                    continue;
+                }
+
+                found.chunkErrors[bad]++;
+            }
+            else if(numBad == 0)
+            {
+                // nothing says which sector is wrong, so the XOR chunk is taken to be
+                raidStripeTargets(pipe->layout, s->firstStripe + row / (pipe->chunkSize / SECTOR_SIZE), target);
+                bad=target[RAID_DATA_CHUNKS];
+                sector=s->chunk[bad] + (size_t)row * SECTOR_SIZE;
+                xorBlocks((unsigned char *[]){sector, rowXor + (size_t)row * SECTOR_SIZE}, 2, sector, SECTOR_SIZE);
+
+                if(pipe->fdCrc >= 0)
+                {
+                    stored[bad]=crc32c(0, sector, SECTOR_SIZE);
+                    dirtyCrc=pipe->repair;
+                }
+            }
+            else
+            {
+                for(idx=0; idx < RAID_CHUNKS; idx++)
+                    if(crc[idx] != stored[idx])
+                        found.chunkErrors[idx]++;
+                found.unrecoverable++;
+                continue;
+            }
+
+            if(pipe->repair)
+            {
+                blockLen=pipe->blockSize[bad];
+                block=((size_t)row * SECTOR_SIZE) & ~((size_t)blockLen - 1);
+
+                if(raidBlockIO(pipe->fd[bad], s->chunk[bad] + block, blockLen,
+                               pipe->chunkOffset + (off_t)s->firstStripe * pipe->chunkSize + (off_t)block, TRUE) != blockLen)
+                {
+                    printf("repair write to %s failed\n", raidGetChunkPath(bad + 1));
+                    raidPipelineFail(pipe);
+                    break;
+                }
+                found.repaired++;
+            }
+        }
+
+        if(dirtyCrc && (raidSlotChecksumIO(pipe, slot, TRUE) != OK))
+        {
+            printf("write to %s failed\n", raidChecksumPath);
+            raidPipelineFail(pipe);
+        }
+
+        pthread_mutex_lock(&pipe->lock);
+        pipe->scrub.checksumErrors+=found.checksumErrors;
+        pipe->scrub.parityErrors+=found.parityErrors;
+        pipe->scrub.repaired+=found.repaired;
+        pipe->scrub.unrecoverable+=found.unrecoverable;
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            pipe->scrub.chunkErrors[idx]+=found.chunkErrors[idx];
+        pthread_mutex_unlock(&pipe->lock);
+
+        raidQueuePut(pipe, &pipe->freeQ, slot);
+    }
+
+    free(rowXor);
+
+    return NULL;
+}
+
+
+// Logical block size of an O_DIRECT target, from the device for a block device and the file
+// system block for a file, kept between SECTOR_SIZE and the RAID_MIN_CHUNK_SIZE alignment of
+// the slot buffers
+int raidTargetBlockSize(int fd)
+{
+    struct stat chunkStat;
+    int size=RAID_MIN_CHUNK_SIZE;
+
+    if(fstat(fd, &chunkStat) == 0)
+    {
+        if(S_ISBLK(chunkStat.st_mode))
+        {
+            if(ioctl(fd, BLKSSZGET, &size) != 0)
+                size=RAID_MIN_CHUNK_SIZE;
+        }
+        else
+            size=(int)chunkStat.st_blksize;
+    }
+
+    if((size < SECTOR_SIZE) || (size > RAID_MIN_CHUNK_SIZE) || ((size & (size - 1)) != 0))
+        size=RAID_MIN_CHUNK_SIZE;
+
+    return size;
+}
+
+
+// Open the chunk targets but the missing one, read-write to stripe or read only to restore.
+// To stripe, a block device must hold numStripes stripe units past the offset.
+static int raidOpenChunks(raidPipeline_t *pipe, int write, int missingChunk, long long numStripes)
+{
+    struct stat chunkStat;
+    int idx, flags;
+
+    flags=(write ? (O_RDWR | O_CREAT) : O_RDONLY) | (raidDirectIO ? O_DIRECT : 0);
+
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+    {
+        if(idx == missingChunk - 1)
+            continue;
+
+        if((pipe->fd[idx]=open(raidGetChunkPath(idx + 1), flags, 00644)) < 0)
+        {
+            printf("can't open %s%s\n", raidGetChunkPath(idx + 1),
+                   ((errno == EINVAL) && raidDirectIO) ? " with O_DIRECT" : "");
+            return ERROR;
+        }
+
+        pipe->blockSize[idx]=raidDirectIO ? raidTargetBlockSize(pipe->fd[idx]) : SECTOR_SIZE;
+
+        if(write && (fstat(pipe->fd[idx], &chunkStat) == 0) && S_ISBLK(chunkStat.st_mode) &&
+           (lseek(pipe->fd[idx], 0, SEEK_END) < pipe->chunkOffset + numStripes * pipe->chunkSize))
+        {
+            printf("%s is too small for %lld stripe units from sector %lld\n", raidGetChunkPath(idx + 1),
+                   numStripes, pipe->chunkOffset / SECTOR_SIZE);
+            return ERROR;
+        }
+    }
+
+    return OK;
+}
+
+
+// returns bytes written or ERROR code
+//
+// offsetSectors is where the stripes start on each chunk target
+//
+long long stripeFile(char *inputFileName, int offsetSectors)
+{
+    raidPipeline_t pipe;
+    raidStage_t stage[RAID_CHUNKS];
+    pthread_t worker[RAID_MAX_THREADS], writer[RAID_CHUNKS], ringThread;
+    struct iovec iov[RAID_MAX_IOV];
+    unsigned char *unit[RAID_CHUNKS];
+    int target[RAID_CHUNKS];
+    raidSlot_t *s;
+    struct stat inputStat;
+    long long byteCnt=0, stripe=0, bread;
+    int fdin, slot, idx, iovcnt, start;
+
+    if(offsetSectors < 0)
+        return ERROR;
+
+    if(((fdin=open(inputFileName, O_RDONLY)) < 0) || (fstat(fdin, &inputStat) != 0))
+    {
+        printf("can't open %s\n", inputFileName);
+        if(fdin >= 0) close(fdin);
+        return ERROR;
+    }
+
+    if(raidPipelineInit(&pipe, raidChunkSize, raidGetThreads(), raidGetIOEngine(), raidQueueDepth,
+                        inputStat.st_size) != OK)
+    {
+        close(fdin);
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+    pipe.fdFile=fdin;
+    pipe.chunkOffset=(long long)offsetSectors * SECTOR_SIZE;
+    pipe.layout=raidLayout;
+
+    if((raidOpenChunks(&pipe, TRUE, 0, (inputStat.st_size + pipe.stripeBytes - 1) / pipe.stripeBytes) != OK) ||
+       (raidPipelineChecksums(&pipe, TRUE) != OK))
+    {
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+
+    pipe.writeChunks=TRUE;
+    raidPipelineRing(&pipe);
+
+    pipe.activeWorkers=pipe.numThreads;
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_create(&worker[idx], NULL, raidEncodeWorker, &pipe);
+
+    if(pipe.engine == RAID_IO_URING)
+        pthread_create(&ringThread, NULL, raidRingIO, &pipe);
+    else
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+        {
+            stage[idx].pipe=&pipe;
+            stage[idx].chunk=idx;
+            pthread_create(&writer[idx], NULL, raidChunkWriter, &stage[idx]);
+        }
+    }
+
+    // the caller is the reader, a batch of stripes at a time straight into the chunk buffers
+    while((slot=raidQueueGet(&pipe, &pipe.freeQ)) >= 0)
+    {
+        s=&pipe.slot[slot];
+        s->firstStripe=stripe;
+
+        iovcnt=raidStripeIov(&pipe, slot, pipe.batchStripes, iov);
+        if((bread=raidVectorIO(pipe.fdFile, iov, iovcnt, byteCnt, FALSE)) == ERROR)
+        {
+            printf("read from %s failed\n", inputFileName);
+            raidPipelineFail(&pipe);
+            break;
+        }
+
+        if(bread == 0)
+            break;
+
+        // zero fill the last stripe past the end of the file
+        s->numStripes=(bread + pipe.stripeBytes - 1) / pipe.stripeBytes;
+        raidStripeUnits(&pipe, slot, s->numStripes - 1, unit, target);
+        for(idx=0; idx < RAID_DATA_CHUNKS; idx++)
+        {
+            start=bread - (s->numStripes - 1) * pipe.stripeBytes - (long long)idx * pipe.chunkSize;
+            if(start < pipe.chunkSize)
+                bzero(unit[idx] + ((start > 0) ? start : 0), pipe.chunkSize - ((start > 0) ? start : 0));
+        }
+
+        raidQueuePut(&pipe, &pipe.workQ, slot);
+
+        stripe+=s->numStripes;
+        byteCnt+=bread;
+
+        if(bread < pipe.batchStripes * pipe.stripeBytes)
+            break;
+    }
+
+    raidQueueClose(&pipe, &pipe.workQ);
+
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_join(worker[idx], NULL);
+    if(pipe.engine == RAID_IO_URING)
+        pthread_join(ringThread, NULL);
+    else
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            pthread_join(writer[idx], NULL);
+
+    // drop what an earlier, longer stripe left in a chunk file
+    for(idx=0; (idx < RAID_CHUNKS) && !pipe.error; idx++)
+    {
+        if((fstat(pipe.fd[idx], &inputStat) == 0) && S_ISREG(inputStat.st_mode) &&
+           (ftruncate(pipe.fd[idx], pipe.chunkOffset + stripe * pipe.chunkSize) != 0))
+            pipe.error=TRUE;
+    }
+
+    if((pipe.fdCrc >= 0) && !pipe.error &&
+       (ftruncate(pipe.fdCrc, stripe * (pipe.chunkSize / SECTOR_SIZE) * RAID_CHUNKS * sizeof(unsigned int)) != 0))
+        pipe.error=TRUE;
+
+    if(pipe.error)
+        byteCnt=ERROR;
+
+    raidPipelineFree(&pipe);
+
+    return byteCnt;
+}
+
+
+// returns bytes read or ERROR code
+//
+// missingChunk = 0 for no missing
+//              = 1 ... 4 for missing data chunk
+//              = 5 for missing XOR chunk
+//              or with the left symmetric layout the target 1 ... 5 missing
+//
+// offsetSectors is where the stripes start on each chunk target, as for stripeFile()
+//
+long long restoreFile(char *outputFileName, int offsetSectors, long long fileLength, int missingChunk)
+{
+    raidPipeline_t pipe;
+    raidStage_t stage[RAID_CHUNKS];
+    pthread_t worker[RAID_MAX_THREADS], reader[RAID_CHUNKS], writer, ringThread;
+    raidSlot_t *s;
+    long long stripe, totalStripes;
+    int slot, idx;
+
+    if((missingChunk < 0) || (missingChunk > RAID_CHUNKS) || (fileLength < 0) || (offsetSectors < 0))
+        return ERROR;
+
+    if(raidPipelineInit(&pipe, raidChunkSize, raidGetThreads(), raidGetIOEngine(), raidQueueDepth, fileLength) != OK)
+    {
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+    totalStripes=(fileLength + pipe.stripeBytes - 1) / pipe.stripeBytes;
+    pipe.fileLength=fileLength;
+    pipe.missingChunk=missingChunk;
+    pipe.chunkOffset=(long long)offsetSectors * SECTOR_SIZE;
+    pipe.layout=raidLayout;
+
+    if(raidOpenChunks(&pipe, FALSE, missingChunk, totalStripes) != OK)
+    {
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+
+    if((pipe.fdFile=open(outputFileName, O_WRONLY | O_CREAT | O_TRUNC, 00644)) < 0)
+    {
+        printf("can't open %s\n", outputFileName);
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+
+    pipe.writeChunks=FALSE;
+    raidPipelineRing(&pipe);
+
+    // the surviving chunk files are read in parallel, all at once on the ring or one thread each
+    pipe.activeIO=(missingChunk > 0) ? (RAID_CHUNKS - 1) : RAID_CHUNKS;
+    if(pipe.engine == RAID_IO_URING)
+        pthread_create(&ringThread, NULL, raidRingIO, &pipe);
+    else
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+        {
+            stage[idx].pipe=&pipe;
+            stage[idx].chunk=idx;
+            if(idx != missingChunk - 1)
+                pthread_create(&reader[idx], NULL, raidChunkReader, &stage[idx]);
+        }
+    }
+
+    pipe.activeWorkers=pipe.numThreads;
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_create(&worker[idx], NULL, raidRebuildWorker, &pipe);
+
+    pthread_create(&writer, NULL, raidFileWriter, &pipe);
+
+    // the caller hands out the batches to the readers as slots come free
+    for(stripe=0; stripe < totalStripes; stripe+=s->numStripes)
+    {
+        if((slot=raidQueueGet(&pipe, &pipe.freeQ)) < 0)
+            break;
+
+        s=&pipe.slot[slot];
+        s->firstStripe=stripe;
+        s->numStripes=pipe.batchStripes;
+        if(stripe + s->numStripes > totalStripes)
+            s->numStripes=totalStripes - stripe;
+        s->pending=pipe.activeIO;
+
+        if(pipe.engine == RAID_IO_URING)
+            raidQueuePut(&pipe, &pipe.ringQ, slot);
+        else
+            for(idx=0; idx < RAID_CHUNKS; idx++)
+                if(idx != missingChunk - 1)
+                    raidQueuePut(&pipe, &pipe.chunkQ[idx], slot);
+    }
+
+    raidQueueClose(&pipe, &pipe.ringQ);
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        raidQueueClose(&pipe, &pipe.chunkQ[idx]);
+
+    if(pipe.engine == RAID_IO_URING)
+        pthread_join(ringThread, NULL);
+    else
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            if(idx != missingChunk - 1)
+                pthread_join(reader[idx], NULL);
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_join(worker[idx], NULL);
+    pthread_join(writer, NULL);
+
+    if(pipe.error)
+        fileLength=ERROR;
+
+    raidPipelineFree(&pipe);
+
+    return fileLength;
+}
+
+
+// Scrub the stripes holding numSectors sectors of striped data from offsetSectors on each
+// chunk target, checking and with repair set rewriting what is found wrong, see the top of
+// the file.  Returns the stripes scrubbed, with the counts in stats if not NULL, or ERROR if
+// the targets can't be read or a repair written.
+long long raidScrub(int offsetSectors, long long numSectors, int repair, raidScrubStats_t *stats)
+{
+    raidPipeline_t pipe;
+    raidStage_t stage[RAID_CHUNKS];
+    pthread_t worker[RAID_MAX_THREADS], reader[RAID_CHUNKS], ringThread;
+    raidSlot_t *s;
+    long long stripe, totalStripes;
+    int slot, idx;
+
+    if((numSectors < 0) || (offsetSectors < 0))
+        return ERROR;
+
+    if(raidPipelineInit(&pipe, raidChunkSize, raidGetThreads(), raidGetIOEngine(), raidQueueDepth,
+                        numSectors * SECTOR_SIZE) != OK)
+    {
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+    totalStripes=(numSectors * SECTOR_SIZE + pipe.stripeBytes - 1) / pipe.stripeBytes;
+    pipe.chunkOffset=(long long)offsetSectors * SECTOR_SIZE;
+    pipe.layout=raidLayout;
+    pipe.repair=repair;
+
+    if((raidOpenChunks(&pipe, repair, 0, totalStripes) != OK) || (raidPipelineChecksums(&pipe, repair) != OK))
+    {
+        raidPipelineFree(&pipe);
+        return ERROR;
+    }
+
+    pipe.writeChunks=FALSE;
+    raidPipelineRing(&pipe);
+
+    // every chunk file is read, as restoreFile() reads them, and repairs are written by the
+    // workers straight to the targets
+    pipe.activeIO=RAID_CHUNKS;
+    if(pipe.engine == RAID_IO_URING)
+        pthread_create(&ringThread, NULL, raidRingIO, &pipe);
+    else
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+        {
+            stage[idx].pipe=&pipe;
+            stage[idx].chunk=idx;
+            pthread_create(&reader[idx], NULL, raidChunkReader, &stage[idx]);
+        }
+    }
+
+    pipe.activeWorkers=pipe.numThreads;
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_create(&worker[idx], NULL, raidScrubWorker, &pipe);
+
+    for(stripe=0; stripe < totalStripes; stripe+=s->numStripes)
+    {
+        if((slot=raidQueueGet(&pipe, &pipe.freeQ)) < 0)
+            break;
+
+        s=&pipe.slot[slot];
+        s->firstStripe=stripe;
+        s->numStripes=pipe.batchStripes;
+        if(stripe + s->numStripes > totalStripes)
+            s->numStripes=totalStripes - stripe;
+        s->pending=pipe.activeIO;
+
+        if(pipe.engine == RAID_IO_URING)
+            raidQueuePut(&pipe, &pipe.ringQ, slot);
+        else
+            for(idx=0; idx < RAID_CHUNKS; idx++)
+                raidQueuePut(&pipe, &pipe.chunkQ[idx], slot);
+    }
+
+    raidQueueClose(&pipe, &pipe.ringQ);
+    for(idx=0; idx < RAID_CHUNKS; idx++)
+        raidQueueClose(&pipe, &pipe.chunkQ[idx]);
+
+    if(pipe.engine == RAID_IO_URING)
+        pthread_join(ringThread, NULL);
+    else
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+            pthread_join(reader[idx], NULL);
+    for(idx=0; idx < pipe.numThreads; idx++)
+        pthread_join(worker[idx], NULL);
+
+    pipe.scrub.stripes=totalStripes;
+    if(stats != NULL)
+        *stats=pipe.scrub;
+
+    if(pipe.error)
+        totalStripes=ERROR;
+
+    raidPipelineFree(&pipe);
+
+    return totalStripes;
+}
@@ -10,6 +10,10 @@
 
 #define SECTOR_SIZE (512)
 
+// The LBA routines take byte pointers, and the parity kernels below pick the word size, so
+// callers no longer need a separate 64-bit build of the library
+#define PTR_CAST (unsigned char *)
+
 void xorLBA(unsigned char *LBA1,
 	    unsigned char *LBA2,
 	    unsigned char *LBA3,
@@ -26,7 +30,166 @@ void rebuildLBA(unsigned char *LBA1,
 int checkEquivLBA(unsigned char *LBA1,
 		  unsigned char *LBA2);
 
-int stripeFile(char *inputFileName, int offsetSectors);
-int restoreFile(char *outputFileName, int offsetSectors, int fileLength, int missingChunk);
+// Parity kernels in raidxor.c, see there for details.  xorBlocks() XORs numSrc buffers of
+// len bytes into dst with the kernel selected, by default the fastest this CPU supports.
+void xorBlocks(unsigned char *src[], int numSrc, unsigned char *dst, int len);
+int xorKernelCount(void);
+const char *xorKernelName(int kernel);
+int xorKernelSupported(int kernel);
+int xorCurrentKernel(void);
+int xorSelectKernel(int kernel);
+
+// CRC32C checksums in raidcrc.c, started with crc 0 and continued with the result, with the
+// kernels selected like the XOR ones
+unsigned int crc32c(unsigned int crc, const unsigned char *buf, int len);
+int crcKernelCount(void);
+const char *crcKernelName(int kernel);
+int crcKernelSupported(int kernel);
+int crcCurrentKernel(void);
+int crcSelectKernel(int kernel);
+
+// N+1 and N+2 (P+Q) stripe coding in raidgf.c for 1 to RAID_MAX_DATA data chunks.  chunk[]
+// holds the data chunks, then P, then Q, each len bytes, and lost chunks are given by index
+// with -1 for none.  The GF(2^8) multiply kernels are selected like the XOR ones.
+#define RAID_MAX_DATA (253)
+
+int raidEncodeStripe(unsigned char *chunk[], int numData, int numParity, int len);
+int raidRecoverStripe(unsigned char *chunk[], int numData, int numParity, int len, int lost1, int lost2);
+unsigned char gfMul(unsigned char a, unsigned char b);
+void gfMulBlock(unsigned char *src, unsigned char *dst, unsigned char c, int len, int accumulate);
+int gfKernelCount(void);
+const char *gfKernelName(int kernel);
+int gfKernelSupported(int kernel);
+int gfCurrentKernel(void);
+int gfSelectKernel(int kernel);
+
+// File striping in raidlib.c over RAID_DATA_CHUNKS data chunk files and an XOR chunk file,
+// with stripe units of the chunk size, which restoreFile() must be given the same as
+// stripeFile().  Up to RAID_IO_BYTES of each chunk file is read or written per system call,
+// with one I/O thread per chunk file and the number of parity threads set, by default one
+// per CPU.
+#define RAID_DATA_CHUNKS (4)
+#define RAID_CHUNKS (RAID_DATA_CHUNKS + 1)
+#define RAID_MIN_CHUNK_SIZE (4096)
+#define RAID_MAX_CHUNK_SIZE (1024*1024)
+#define RAID_DEFAULT_CHUNK_SIZE (64*1024)
+#define RAID_IO_BYTES (1024*1024)
+#define RAID_MAX_IOV ((RAID_IO_BYTES / RAID_MIN_CHUNK_SIZE) * RAID_DATA_CHUNKS)
+#define RAID_MAX_THREADS (16)
+#define RAID_MAX_SLOTS (2 * RAID_MAX_THREADS + 2 + RAID_MAX_QUEUE_DEPTH)
+
+// Chunk targets, files or block devices, by default StripeChunk1.bin...StripeChunkXOR.bin,
+// opened O_DIRECT if set, when I/O to a target must be whole blocks of raidTargetBlockSize()
+#define RAID_MAX_PATH (256)
+
+int raidSetChunkPaths(const char *path[]);
+const char *raidGetChunkPath(int chunk);
+void raidSetDirectIO(int direct);
+int raidGetDirectIO(void);
+int raidTargetBlockSize(int fd);
+int raidSetChunkSize(int chunkSize);
+int raidGetChunkSize(void);
+int raidSetThreads(int numThreads);
+int raidGetThreads(void);
+
+// Chunk file I/O engines, io_uring by default where the kernel has it, with up to the queue
+// depth of batches in flight, else a thread per chunk file
+#define RAID_IO_THREADS (0)
+#define RAID_IO_URING (1)
+#define RAID_DEFAULT_QUEUE_DEPTH (4)
+#define RAID_MAX_QUEUE_DEPTH (16)
+
+int raidSetIOEngine(int engine);
+int raidGetIOEngine(void);
+const char *raidIOEngineName(int engine);
+int raidSetQueueDepth(int depth);
+int raidGetQueueDepth(void);
+
+// Chunk layouts, the XOR chunk of every stripe on the fifth target as in RAID-4, or rotating
+// over the targets as in RAID-5 left symmetric.  raidMapLBA() maps a sector of the striped
+// data to its target, 1 to RAID_CHUNKS, and the sector there, and returns the XOR target.
+// raidStripeTargets() gives the target index, from 0, of each chunk of a stripe.
+#define RAID_LAYOUT_FIXED (0)
+#define RAID_LAYOUT_LEFT_SYMMETRIC (1)
+
+int raidSetLayout(int layout);
+int raidGetLayout(void);
+const char *raidLayoutName(int layout);
+int raidMapLBA(long long lba, int *chunk, long long *chunkLBA);
+void raidStripeTargets(int layout, long long stripe, int target[]);
+
+long long stripeFile(char *inputFileName, int offsetSectors);
+long long restoreFile(char *outputFileName, int offsetSectors, long long fileLength, int missingChunk);
+
+// Sector checksums, a CRC32C of every sector of every target kept in a file if its path is
+// set, by stripeFile() and block writes.  raidScrub() reads every target of the striped data
+// and checks the XOR and checksums of each row of sectors across them, finds the target of a
+// corrupt sector where they can tell, and with repair set rewrites it, and returns the
+// stripes scrubbed.
+typedef struct
+{
+    long long stripes;
+    long long checksumErrors;           // sectors with a checksum wrong, stale or corrupt
+    long long parityErrors;             // rows of sectors with an XOR not zero
+    long long repaired;                 // sectors or checksums rewritten
+    long long unrecoverable;            // rows with more than one sector corrupt
+    long long chunkErrors[RAID_CHUNKS]; // corrupt sectors found on each target
+} raidScrubStats_t;
+
+int raidSetChecksumPath(const char *path);
+const char *raidGetChecksumPath(void);
+long long raidScrub(int offsetSectors, long long numSectors, int repair, raidScrubStats_t *stats);
+
+// Block access in raidblock.c to the sectors of the striped data on the chunk targets, laid
+// out as by stripeFile() with the settings when opened.  Whole stripe writes need no reads,
+// smaller ones are coalesced in a cache of up to RAID_MAX_CACHE_STRIPES stripes, 0 to write
+// through, and written by read-modify-write of the sectors changed.
+#define RAID_MAX_CACHE_STRIPES (64)
+#define RAID_DEFAULT_CACHE_STRIPES (16)
+
+typedef struct raidArray raidArray_t;
+
+typedef struct
+{
+    long long fullStripeWrites;         // stripes written whole, with no reads
+    long long rmwWrites;                // stripes updated by read-modify-write
+    long long targetReads[RAID_CHUNKS]; // reads and writes of each chunk target
+    long long targetWrites[RAID_CHUNKS];
+    long long degradedReads;            // runs of sectors read as the XOR of the other targets
+} raidArrayStats_t;
+
+int raidSetCacheStripes(int numStripes);
+int raidGetCacheStripes(void);
+raidArray_t *raidOpenArray(int offsetSectors, long long numSectors);
+int raidReadLBA(raidArray_t *array, long long lba, int numSectors, unsigned char *buf);
+int raidWriteLBA(raidArray_t *array, long long lba, int numSectors, unsigned char *buf);
+int raidFlushArray(raidArray_t *array);
+int raidCloseArray(raidArray_t *array);
+void raidGetArrayStats(raidArray_t *array, raidArrayStats_t *stats);
+
+// Degraded arrays, a target lost is read as the XOR of the others, and rebuilt onto a
+// replacement in the background RAID_REBUILD_BYTES of it at a time, at up to the rate set,
+// 0 for no limit
+#define RAID_REBUILD_BYTES (256*1024)
+
+typedef struct
+{
+    int active;                         // TRUE while the rebuild runs
+    int error;
+    int chunk;                          // the target being rebuilt, 1 to RAID_CHUNKS
+    long long stripesDone;
+    long long totalStripes;
+    double percent;
+    double seconds;                     // since the start
+    double mbPerSec;                    // of the target rebuilt
+    double etaSeconds;                  // to go at that rate
+} raidRebuildStatus_t;
+
+int raidSetRebuildRate(int mbPerSec);
+int raidGetRebuildRate(void);
+int raidFailTarget(raidArray_t *array, int chunk);
+int raidStartRebuild(raidArray_t *array, const char *path);
+int raidWaitRebuild(raidArray_t *array);
+void raidGetRebuildStatus(raidArray_t *array, raidRebuildStatus_t *status);
 
 #endif
@@ -33,6 +33,23 @@ void dumpBuffer(unsigned char *bufferToDump)
 }
 
 
+// flip the bits of one byte of a file, as silent corruption would
+void corruptByte(const char *path, off_t offset)
+{
+    unsigned char byte;
+    int fd, rc;
+
+    fd=open(path, O_RDWR);
+    assert(fd >= 0);
+    rc=pread(fd, &byte, 1, offset);
+    assert(rc == 1);
+    byte=~byte;
+    rc=pwrite(fd, &byte, 1, offset);
+    assert(rc == 1);
+    close(fd);
+}
+
+
 
 int main(int argc, char *argv[])
 {
@@ -181,6 +198,1237 @@ int main(int argc, char *argv[])
         //
         // END TEST CASE #2
 
+
+        // TEST CASE #3
+        //
+        // Every parity kernel supported on this CPU must give exactly the same bytes as the
+        // byte kernel, for any number of sources, length and alignment, including lengths that
+        // leave a tail after the last whole vector and a destination that is one of the sources.
+        //
+        printf("TEST CASE 3 (parity kernels bit-exact with the byte kernel):\n");
+
+        {
+            unsigned char *srcBuf[XOR_TEST_SOURCES], *src[XOR_TEST_SOURCES], *refOut, *testOut;
+            int kernel, byteKernel=0, defaultKernel=xorCurrentKernel(), numSrc, len, align, s, idx2;
+
+            srand(1);
+
+            for(s=0; s < XOR_TEST_SOURCES; s++)
+            {
+                srcBuf[s]=malloc(XOR_TEST_MAX_LEN + 64);
+                for(idx2=0; idx2 < XOR_TEST_MAX_LEN + 64; idx2++) srcBuf[s][idx2]=rand();
+            }
+            refOut=malloc(XOR_TEST_MAX_LEN + 64);
+            testOut=malloc(XOR_TEST_MAX_LEN + 64);
+
+            for(kernel=0; kernel < xorKernelCount(); kernel++)
+                if(strcmp(xorKernelName(kernel), "byte") == 0) byteKernel=kernel;
+
+            for(kernel=0; kernel < xorKernelCount(); kernel++)
+            {
+                if(!xorKernelSupported(kernel))
+                {
+                    printf("%s: not supported on this CPU\n", xorKernelName(kernel));
+                    continue;
+                }
+
+                for(idx=0; idx < numTestIterations; idx++)
+                {
+                    numSrc=1 + (rand() % XOR_TEST_SOURCES);
+                    len=rand() % (XOR_TEST_MAX_LEN + 1);
+                    align=rand() % 64;
+
+                    for(s=0; s < numSrc; s++)
+                        src[s]=srcBuf[s] + ((align + s) % 64);
+
+                    xorSelectKernel(byteKernel);
+                    xorBlocks(src, numSrc, refOut + align, len);
+
+                    xorSelectKernel(kernel);
+                    memset(testOut, 0, XOR_TEST_MAX_LEN + 64);
+                    xorBlocks(src, numSrc, testOut + align, len);
+                    assert(memcmp(refOut + align, testOut + align, len) == 0);
+
+                    // in place, parity into the first source as a read-modify-write does
+                    memcpy(testOut, src[0], len);
+                    src[0]=testOut;
+                    xorBlocks(src, numSrc, testOut, len);
+                    assert(memcmp(refOut + align, testOut, len) == 0);
+                }
+
+                printf("%s: %d random cases match\n", xorKernelName(kernel), numTestIterations);
+            }
+
+            xorSelectKernel(defaultKernel);
+            for(s=0; s < XOR_TEST_SOURCES; s++) free(srcBuf[s]);
+            free(refOut);
+            free(testOut);
+        }
+
+        //
+        // END TEST CASE #3
+
+
+        // TEST CASE #4
+        //
+        // The GF(2^8) multiply kernels must match the table kernel, and gfMul() a shift and add
+        // multiply, for every product.  Then for each stripe width every single chunk and every
+        // pair of chunks, data, P or Q, is erased and must be recovered exactly from the rest,
+        // with only P for N+1 and with P and Q for N+2.
+        //
+        printf("TEST CASE 4 (N+1 and P+Q erasure recovery):\n");
+
+        {
+            unsigned char *chunk[RS_TEST_MAX_DATA + 2], *saved[RS_TEST_MAX_DATA + 2], *refOut, *testOut, *srcBuf;
+            unsigned char c, product;
+            int kernel, tableKernel=0, defaultKernel=gfCurrentKernel(), numData, numParity, lost1, lost2;
+            int len, align, accumulate, a, b, s, idx2, numCases;
+
+            srand(2);
+
+            // shift and add, reducing by x^8+x^4+x^3+x^2+1 as each bit is shifted out
+            for(a=0; a < 256; a++)
+            {
+                for(b=0; b < 256; b++)
+                {
+                    product=0;
+                    for(c=a, idx2=b; idx2 != 0; idx2>>=1)
+                    {
+                        if(idx2 & 1) product^=c;
+                        c=(c & 0x80) ? (unsigned char)((c << 1) ^ 0x1d) : (unsigned char)(c << 1);
+                    }
+                    assert(gfMul(a, b) == product);
+                }
+            }
+            printf("gfMul: all 65536 products match\n");
+
+            srcBuf=malloc(RS_TEST_LEN + 64);
+            refOut=malloc(RS_TEST_LEN + 64);
+            testOut=malloc(RS_TEST_LEN + 64);
+            for(idx2=0; idx2 < RS_TEST_LEN + 64; idx2++) srcBuf[idx2]=rand();
+
+            for(kernel=0; kernel < gfKernelCount(); kernel++)
+                if(strcmp(gfKernelName(kernel), "table") == 0) tableKernel=kernel;
+
+            for(kernel=0; kernel < gfKernelCount(); kernel++)
+            {
+                if(!gfKernelSupported(kernel))
+                {
+                    printf("%s: not supported on this CPU\n", gfKernelName(kernel));
+                    continue;
+                }
+
+                for(idx=0; idx < numTestIterations; idx++)
+                {
+                    c=rand();
+                    len=rand() % (RS_TEST_LEN + 1);
+                    align=rand() % 64;
+                    accumulate=rand() & 1;
+
+                    for(idx2=0; idx2 < RS_TEST_LEN + 64; idx2++) refOut[idx2]=testOut[idx2]=idx2;
+
+                    gfSelectKernel(tableKernel);
+                    gfMulBlock(srcBuf + align, refOut + (63 - align), c, len, accumulate);
+
+                    gfSelectKernel(kernel);
+                    gfMulBlock(srcBuf + align, testOut + (63 - align), c, len, accumulate);
+                    assert(memcmp(refOut, testOut, RS_TEST_LEN + 64) == 0);
+
+                    // in place
+                    memcpy(testOut, srcBuf + align, len);
+                    gfMulBlock(testOut, testOut, c, len, FALSE);
+                    gfSelectKernel(tableKernel);
+                    gfMulBlock(srcBuf + align, refOut, c, len, FALSE);
+                    assert(memcmp(refOut, testOut, len) == 0);
+                }
+
+                printf("%s: %d random cases match\n", gfKernelName(kernel), numTestIterations);
+            }
+
+            gfSelectKernel(defaultKernel);
+
+            for(s=0; s < RS_TEST_MAX_DATA + 2; s++)
+            {
+                chunk[s]=malloc(RS_TEST_LEN);
+                saved[s]=malloc(RS_TEST_LEN);
+            }
+
+            for(numParity=1; numParity <= 2; numParity++)
+            {
+                numCases=0;
+
+                for(numData=1; numData <= RS_TEST_MAX_DATA; numData++)
+                {
+                    for(s=0; s < numData; s++)
+                        for(idx2=0; idx2 < RS_TEST_LEN; idx2++) chunk[s][idx2]=rand();
+
+                    rc=raidEncodeStripe(chunk, numData, numParity, RS_TEST_LEN);
+                    assert(rc == OK);
+                    for(s=0; s < numData + numParity; s++) memcpy(saved[s], chunk[s], RS_TEST_LEN);
+
+                    // lost2 of -1 is a single erasure, and the pair is given either way round
+                    for(lost1=0; lost1 < numData + numParity; lost1++)
+                    {
+                        for(lost2=-1; lost2 < numData + numParity; lost2++)
+                        {
+                            if((lost2 >= 0) && ((lost2 <= lost1) || (numParity < 2)))
+                                continue;
+
+                            memset(chunk[lost1], 0xa5, RS_TEST_LEN);
+                            if(lost2 >= 0) memset(chunk[lost2], 0x5a, RS_TEST_LEN);
+
+                            rc=raidRecoverStripe(chunk, numData, numParity, RS_TEST_LEN,
+                                                 (numCases & 1) ? lost2 : lost1,
+                                                 (numCases & 1) ? lost1 : lost2);
+                            assert(rc == OK);
+
+                            for(s=0; s < numData + numParity; s++)
+                                assert(memcmp(saved[s], chunk[s], RS_TEST_LEN) == 0);
+                            numCases++;
+                        }
+                    }
+
+                    // more losses than the parity covers
+                    if(numParity == 1)
+                    {
+                        rc=raidRecoverStripe(chunk, numData, numParity, RS_TEST_LEN, 0, numData);
+                        assert(rc == ERROR);
+                    }
+                }
+
+                printf("N+%d: %d erasure cases recovered for 1 to %d data chunks\n",
+                       numParity, numCases, RS_TEST_MAX_DATA);
+            }
+
+            // the widest stripe, where every coefficient up to g^252 is in use, with random pairs
+            {
+                unsigned char *wide[RAID_MAX_DATA + 2], *wideSaved;
+
+                wideSaved=malloc((RAID_MAX_DATA + 2) * 64);
+                for(s=0; s < RAID_MAX_DATA + 2; s++)
+                {
+                    wide[s]=&wideSaved[s * 64];
+                    for(idx2=0; idx2 < 64; idx2++) wide[s][idx2]=rand();
+                }
+
+                rc=raidEncodeStripe(wide, RAID_MAX_DATA, 2, 64);
+                assert(rc == OK);
+
+                for(idx=0; idx < numTestIterations; idx++)
+                {
+                    lost1=rand() % (RAID_MAX_DATA + 2);
+                    lost2=rand() % (RAID_MAX_DATA + 2);
+                    memcpy(refOut, wide[lost1], 64);
+                    memcpy(testOut, wide[lost2], 64);
+
+                    memset(wide[lost1], 0, 64);
+                    memset(wide[lost2], 0, 64);
+                    rc=raidRecoverStripe(wide, RAID_MAX_DATA, 2, 64, lost1, lost2);
+                    assert(rc == OK);
+                    assert(memcmp(refOut, wide[lost1], 64) == 0);
+                    assert(memcmp(testOut, wide[lost2], 64) == 0);
+                }
+
+                printf("N+2: %d random erasure pairs recovered for %d data chunks\n", numTestIterations, RAID_MAX_DATA);
+                free(wideSaved);
+            }
+
+            for(s=0; s < RS_TEST_MAX_DATA + 2; s++)
+            {
+                free(chunk[s]);
+                free(saved[s]);
+            }
+            free(srcBuf);
+            free(refOut);
+            free(testOut);
+        }
+
+        //
+        // END TEST CASE #4
+
+
+        // TEST CASE #5
+        //
+        // Stripe a file of random data over the chunk files and restore it, with no chunk file
+        // lost and with each one deleted in turn, for the smallest, default and largest stripe
+        // units and lengths from empty to several batches with a partial last stripe, with one
+        // parity thread and with the most, so batches complete out of order, and with each I/O
+        // engine this kernel has, io_uring with one batch in flight and with the most.
+        //
+        printf("TEST CASE 5 (file stripe and restore):\n");
+
+        {
+            unsigned char *inBuf, *outBuf;
+            int chunkSize[]={RAID_MIN_CHUNK_SIZE, RAID_DEFAULT_CHUNK_SIZE, RAID_MAX_CHUNK_SIZE};
+            long long fileLen[]={0, 1, 4*RAID_MIN_CHUNK_SIZE, STRIPE_TEST_LEN};
+            long long bytesWritten, bytesRestored;
+            int sizeIdx, lenIdx, missing, fdin, engine, defaultChunkSize=raidGetChunkSize(), defaultThreads=raidGetThreads();
+            int defaultEngine=raidGetIOEngine();
+            char chunkName[32];
+
+            inBuf=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN);
+            for(idx=0; idx < STRIPE_TEST_LEN; idx++) inBuf[idx]=rand();
+
+            for(engine=RAID_IO_THREADS; engine <= RAID_IO_URING; engine++)
+            {
+            if(raidSetIOEngine(engine) != OK)
+            {
+                printf("%s: not available\n", raidIOEngineName(engine));
+                continue;
+            }
+
+            for(sizeIdx=0; sizeIdx < 3; sizeIdx++)
+            {
+                rc=raidSetChunkSize(chunkSize[sizeIdx]);
+                assert(rc == OK);
+
+                for(lenIdx=0; lenIdx < 4; lenIdx++)
+                {
+                    fdin=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+                    written=write(fdin, inBuf, fileLen[lenIdx]);
+                    assert(written == fileLen[lenIdx]);
+                    close(fdin);
+
+                    for(missing=0; missing <= RAID_CHUNKS; missing++)
+                    {
+                        raidSetThreads((missing & 1) ? 1 : RAID_MAX_THREADS);
+                        raidSetQueueDepth((missing & 2) ? 1 : RAID_MAX_QUEUE_DEPTH);
+                        bytesWritten=stripeFile(STRIPE_TEST_INPUT, 0);
+                        assert(bytesWritten == fileLen[lenIdx]);
+
+                        if(missing > 0)
+                        {
+                            if(missing < RAID_CHUNKS)
+                                sprintf(chunkName, "StripeChunk%d.bin", missing);
+                            else
+                                sprintf(chunkName, "StripeChunkXOR.bin");
+                            rc=unlink(chunkName);
+                            assert(rc == 0);
+                        }
+
+                        bytesRestored=restoreFile(STRIPE_TEST_OUTPUT, 0, bytesWritten, missing);
+                        assert(bytesRestored == bytesWritten);
+
+                        fdin=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                        rc=read(fdin, outBuf, STRIPE_TEST_LEN);
+                        assert(rc == bytesWritten);
+                        close(fdin);
+                        assert(memcmp(inBuf, outBuf, bytesWritten) == 0);
+                    }
+                }
+
+                printf("%s, %d KB stripe unit: %d lengths restored with each chunk lost\n",
+                       raidIOEngineName(engine), chunkSize[sizeIdx] / 1024, lenIdx);
+            }
+
+            // a chunk file cut short, and one lost but not given as missing
+            bytesWritten=stripeFile(STRIPE_TEST_INPUT, 0);
+            assert(bytesWritten == STRIPE_TEST_LEN);
+            rc=truncate("StripeChunk2.bin", RAID_MAX_CHUNK_SIZE / 2);
+            assert(rc == 0);
+            bytesRestored=restoreFile(STRIPE_TEST_OUTPUT, 0, STRIPE_TEST_LEN, 0);
+            assert(bytesRestored == ERROR);
+            bytesRestored=restoreFile(STRIPE_TEST_OUTPUT, 0, STRIPE_TEST_LEN, 2);
+            assert(bytesRestored == STRIPE_TEST_LEN);
+            rc=unlink("StripeChunk1.bin");
+            assert(rc == 0);
+            bytesRestored=restoreFile(STRIPE_TEST_OUTPUT, 0, STRIPE_TEST_LEN, 0);
+            assert(bytesRestored == ERROR);
+            }
+
+            rc=raidSetChunkSize(RAID_MIN_CHUNK_SIZE + SECTOR_SIZE);
+            assert(rc == ERROR);
+            rc=raidSetThreads(RAID_MAX_THREADS + 1);
+            assert(rc == ERROR);
+            rc=raidSetQueueDepth(0);
+            assert(rc == ERROR);
+
+            raidSetChunkSize(defaultChunkSize);
+            raidSetThreads(defaultThreads);
+            raidSetIOEngine(defaultEngine);
+            raidSetQueueDepth(RAID_DEFAULT_QUEUE_DEPTH);
+            free(inBuf);
+            free(outBuf);
+        }
+
+        //
+        // END TEST CASE #5
+
+
+        // TEST CASE #6
+        //
+        // Stripe to chunk targets given by path, opened O_DIRECT, from an offset, with a header
+        // before the offset on each target that must be left as it was, and restore with each
+        // chunk lost, on each I/O engine.  Where the file system has no O_DIRECT, e.g. tmpfs,
+        // the open fails and the case is skipped.
+        //
+        printf("TEST CASE 6 (O_DIRECT chunk targets at an offset):\n");
+
+        {
+            const char *path[RAID_CHUNKS]={"ChunkTarget1.bin", "ChunkTarget2.bin", "ChunkTarget3.bin",
+                                           "ChunkTarget4.bin", "ChunkTargetXOR.bin"};
+            unsigned char *inBuf, *outBuf, header[DIRECT_TEST_OFFSET * SECTOR_SIZE];
+            int chunk, missing, engine, fd, defaultEngine=raidGetIOEngine();
+            long long bytes;
+
+            inBuf=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN);
+            for(idx=0; idx < STRIPE_TEST_LEN; idx++) inBuf[idx]=rand();
+            memset(header, 0x5a, sizeof(header));
+
+            fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            written=write(fd, inBuf, STRIPE_TEST_LEN);
+            assert(written == STRIPE_TEST_LEN);
+            close(fd);
+
+            rc=raidSetChunkPaths(path);
+            assert(rc == OK);
+            assert(strcmp(raidGetChunkPath(RAID_CHUNKS), "ChunkTargetXOR.bin") == 0);
+            raidSetDirectIO(TRUE);
+
+            for(engine=RAID_IO_THREADS; engine <= RAID_IO_URING; engine++)
+            {
+                if(raidSetIOEngine(engine) != OK)
+                    continue;
+
+                for(missing=0; missing <= RAID_CHUNKS; missing++)
+                {
+                    for(chunk=1; chunk <= RAID_CHUNKS; chunk++)
+                    {
+                        fd=open(raidGetChunkPath(chunk), O_WRONLY | O_CREAT | O_TRUNC, 00644);
+                        written=write(fd, header, sizeof(header));
+                        assert(written == sizeof(header));
+                        close(fd);
+                    }
+
+                    if(stripeFile(STRIPE_TEST_INPUT, DIRECT_TEST_OFFSET) != STRIPE_TEST_LEN)
+                    {
+                        printf("O_DIRECT not supported here, skipped\n");
+                        break;
+                    }
+
+                    for(chunk=1; chunk <= RAID_CHUNKS; chunk++)
+                    {
+                        fd=open(raidGetChunkPath(chunk), O_RDONLY);
+                        rc=read(fd, outBuf, sizeof(header));
+                        assert(rc == sizeof(header));
+                        close(fd);
+                        assert(memcmp(outBuf, header, sizeof(header)) == 0);
+                    }
+
+                    if(missing > 0)
+                    {
+                        rc=unlink(raidGetChunkPath(missing));
+                        assert(rc == 0);
+                    }
+
+                    bytes=restoreFile(STRIPE_TEST_OUTPUT, DIRECT_TEST_OFFSET, STRIPE_TEST_LEN, missing);
+                    assert(bytes == STRIPE_TEST_LEN);
+
+                    fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                    rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                    assert(rc == STRIPE_TEST_LEN);
+                    close(fd);
+                    assert(memcmp(inBuf, outBuf, STRIPE_TEST_LEN) == 0);
+                }
+
+                if(missing > RAID_CHUNKS)
+                    printf("%s: restored with each chunk lost from sector %d\n", raidIOEngineName(engine), DIRECT_TEST_OFFSET);
+            }
+
+            bytes=stripeFile(STRIPE_TEST_INPUT, -1);
+            assert(bytes == ERROR);
+
+            raidSetDirectIO(FALSE);
+            raidSetChunkPaths(NULL);
+            raidSetIOEngine(defaultEngine);
+            free(inBuf);
+            free(outBuf);
+        }
+
+        //
+        // END TEST CASE #6
+
+
+        // TEST CASE #7
+        //
+        // Stripe with the XOR chunk rotating over the targets, RAID-5 left symmetric, and check
+        // raidMapLBA() against the layout, that every sector of the file is on the target and at
+        // the sector it maps to, and that each stripe's XOR chunk is where it says, then restore
+        // with each target lost, on each I/O engine and for the smallest and largest units.
+        //
+        printf("TEST CASE 7 (rotating parity layout):\n");
+
+        {
+            unsigned char *inBuf, *outBuf, *chunkBuf[RAID_CHUNKS], parity[SECTOR_SIZE];
+            int chunkSize[]={RAID_MIN_CHUNK_SIZE, RAID_MAX_CHUNK_SIZE};
+            int sizeIdx, chunk, xorChunk, missing, engine, fd, defaultEngine=raidGetIOEngine();
+            int defaultChunkSize=raidGetChunkSize();
+            long long lba, chunkLBA, stripe, numStripes, chunkLen, bytes;
+
+            inBuf=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN);
+            for(idx=0; idx < STRIPE_TEST_LEN; idx++) inBuf[idx]=rand();
+
+            fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            written=write(fd, inBuf, STRIPE_TEST_LEN);
+            assert(written == STRIPE_TEST_LEN);
+            close(fd);
+
+            // the mapping of the first stripes for 4 KB units, 8 sectors each
+            rc=raidSetLayout(RAID_LAYOUT_LEFT_SYMMETRIC);
+            assert(rc == OK);
+            rc=raidSetChunkSize(RAID_MIN_CHUNK_SIZE);
+            assert(rc == OK);
+            xorChunk=raidMapLBA(0, &chunk, &chunkLBA);
+            assert((xorChunk == 5) && (chunk == 1) && (chunkLBA == 0));
+            xorChunk=raidMapLBA(31, &chunk, &chunkLBA);
+            assert((xorChunk == 5) && (chunk == 4) && (chunkLBA == 7));
+            xorChunk=raidMapLBA(32, &chunk, &chunkLBA);
+            assert((xorChunk == 4) && (chunk == 5) && (chunkLBA == 8));
+            xorChunk=raidMapLBA(41, &chunk, &chunkLBA);
+            assert((xorChunk == 4) && (chunk == 1) && (chunkLBA == 9));
+            xorChunk=raidMapLBA(4*32 + 3, &chunk, &chunkLBA);
+            assert((xorChunk == 1) && (chunk == 2) && (chunkLBA == 4*8 + 3));
+            xorChunk=raidMapLBA(5*32, &chunk, &chunkLBA);
+            assert((xorChunk == 5) && (chunk == 1) && (chunkLBA == 5*8));
+            xorChunk=raidMapLBA(-1, &chunk, &chunkLBA);
+            assert(xorChunk == ERROR);
+
+            for(engine=RAID_IO_THREADS; engine <= RAID_IO_URING; engine++)
+            {
+            if(raidSetIOEngine(engine) != OK)
+                continue;
+
+            for(sizeIdx=0; sizeIdx < 2; sizeIdx++)
+            {
+                rc=raidSetChunkSize(chunkSize[sizeIdx]);
+                assert(rc == OK);
+                numStripes=(STRIPE_TEST_LEN + RAID_DATA_CHUNKS * chunkSize[sizeIdx] - 1) / (RAID_DATA_CHUNKS * chunkSize[sizeIdx]);
+                chunkLen=numStripes * chunkSize[sizeIdx];
+
+                for(missing=0; missing <= RAID_CHUNKS; missing++)
+                {
+                    bytes=stripeFile(STRIPE_TEST_INPUT, 0);
+                    assert(bytes == STRIPE_TEST_LEN);
+
+                    if(missing == 0)
+                    {
+                        for(chunk=0; chunk < RAID_CHUNKS; chunk++)
+                        {
+                            chunkBuf[chunk]=malloc(chunkLen);
+                            fd=open(raidGetChunkPath(chunk + 1), O_RDONLY);
+                            rc=read(fd, chunkBuf[chunk], chunkLen);
+                            assert(rc == chunkLen);
+                            close(fd);
+                        }
+
+                        for(lba=0; lba < STRIPE_TEST_LEN / SECTOR_SIZE; lba++)
+                        {
+                            raidMapLBA(lba, &chunk, &chunkLBA);
+                            assert(memcmp(chunkBuf[chunk - 1] + chunkLBA * SECTOR_SIZE, inBuf + lba * SECTOR_SIZE, SECTOR_SIZE) == 0);
+                        }
+
+                        // the first sector of every target of a stripe XORs to zero, and
+                        // the data chunks having been found above, the XOR chunk is the other
+                        for(stripe=0; stripe < numStripes; stripe++)
+                        {
+                            lba=stripe * RAID_DATA_CHUNKS * (chunkSize[sizeIdx] / SECTOR_SIZE);
+                            memset(parity, 0, SECTOR_SIZE);
+                            for(chunk=1; chunk <= RAID_CHUNKS; chunk++)
+                                for(idx=0; idx < SECTOR_SIZE; idx++)
+                                    parity[idx]^=chunkBuf[chunk - 1][stripe * chunkSize[sizeIdx] + idx];
+
+                            xorChunk=raidMapLBA(lba, &chunk, &chunkLBA);
+                            assert(xorChunk == RAID_CHUNKS - (stripe % RAID_CHUNKS));
+                            for(idx=0; idx < SECTOR_SIZE; idx++)
+                                assert(parity[idx] == 0);
+                        }
+
+                        for(chunk=0; chunk < RAID_CHUNKS; chunk++)
+                            free(chunkBuf[chunk]);
+                    }
+                    else
+                    {
+                        rc=unlink(raidGetChunkPath(missing));
+                        assert(rc == 0);
+                    }
+
+                    bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, STRIPE_TEST_LEN, missing);
+                    assert(bytes == STRIPE_TEST_LEN);
+
+                    fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                    rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                    assert(rc == STRIPE_TEST_LEN);
+                    close(fd);
+                    assert(memcmp(inBuf, outBuf, STRIPE_TEST_LEN) == 0);
+                }
+
+                printf("%s, %d KB stripe unit: mapped and restored with each target lost\n",
+                       raidIOEngineName(engine), chunkSize[sizeIdx] / 1024);
+            }
+            }
+
+            rc=raidSetLayout(2);
+            assert(rc == ERROR);
+
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetChunkSize(defaultChunkSize);
+            raidSetIOEngine(defaultEngine);
+            free(inBuf);
+            free(outBuf);
+        }
+
+        //
+        // END TEST CASE #7
+
+
+        // TEST CASE #8
+        //
+        // Block reads and writes of a striped file, for each layout, with the stripe cache and
+        // written through, for small and default stripe units.  Every sector read must match a
+        // model of the data with random writes of random lengths applied, before and after the
+        // flush, and afterwards restoring with each target lost must give the model, so the XOR
+        // chunks were kept right by the read-modify-writes.  Then a stream of small writes must
+        // be coalesced into whole stripe writes with no reads, and a one sector update must
+        // read and write just the data and XOR chunks under it.  Last, the same random I/O of
+        // odd sectors through O_DIRECT, whole and with a target lost, must be widened to the
+        // blocks of the targets and match the model, where the file system has O_DIRECT.
+        //
+        printf("TEST CASE 8 (block read-modify-write and stripe cache):\n");
+
+        {
+            unsigned char *model, *outBuf;
+            int chunkSize[]={RAID_MIN_CHUNK_SIZE, RAID_DEFAULT_CHUNK_SIZE};
+            int sizeIdx, layout, cache, missing, fd, numSectors, count, op, stripeSectors, chunk, parityChunk, fill;
+            int defaultChunkSize=raidGetChunkSize();
+            long long lba, chunkLBA, bytes;
+            raidArray_t *array;
+            raidArrayStats_t stats;
+
+            numSectors=STRIPE_TEST_LEN / SECTOR_SIZE;
+            model=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN);
+
+            for(layout=RAID_LAYOUT_FIXED; layout <= RAID_LAYOUT_LEFT_SYMMETRIC; layout++)
+            {
+            rc=raidSetLayout(layout);
+            assert(rc == OK);
+
+            for(sizeIdx=0; sizeIdx < 2; sizeIdx++)
+            {
+                rc=raidSetChunkSize(chunkSize[sizeIdx]);
+                assert(rc == OK);
+                stripeSectors=RAID_DATA_CHUNKS * chunkSize[sizeIdx] / SECTOR_SIZE;
+
+                for(cache=0; cache <= RAID_DEFAULT_CACHE_STRIPES; cache+=RAID_DEFAULT_CACHE_STRIPES)
+                {
+                    rc=raidSetCacheStripes(cache);
+                    assert(rc == OK);
+
+                    for(idx=0; idx < STRIPE_TEST_LEN; idx++) model[idx]=rand();
+                    fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+                    written=write(fd, model, numSectors * SECTOR_SIZE);
+                    assert(written == numSectors * SECTOR_SIZE);
+                    close(fd);
+                    bytes=stripeFile(STRIPE_TEST_INPUT, 0);
+                    assert(bytes == numSectors * SECTOR_SIZE);
+
+                    array=raidOpenArray(0, numSectors);
+                    assert(array != NULL);
+                    rc=raidReadLBA(array, 0, numSectors, outBuf);
+                    assert(rc == OK);
+                    assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+
+                    for(op=0; op < 2000; op++)
+                    {
+                        lba=rand() % numSectors;
+                        count=1 + rand() % ((op & 1) ? 8 : (2 * stripeSectors));
+                        if(lba + count > numSectors) count=numSectors - lba;
+
+                        if(rand() & 1)
+                        {
+                            fill=rand();
+                            for(idx=0; idx < count * SECTOR_SIZE; idx++) model[lba * SECTOR_SIZE + idx]=fill + idx * 13;
+                            rc=raidWriteLBA(array, lba, count, model + lba * SECTOR_SIZE);
+                            assert(rc == OK);
+                        }
+                        else
+                        {
+                            rc=raidReadLBA(array, lba, count, outBuf);
+                            assert(rc == OK);
+                            assert(memcmp(model + lba * SECTOR_SIZE, outBuf, count * SECTOR_SIZE) == 0);
+                        }
+                    }
+
+                    rc=raidReadLBA(array, 0, numSectors, outBuf);
+                    assert(rc == OK);
+                    assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                    rc=raidReadLBA(array, numSectors - 1, 2, outBuf);
+                    assert(rc == ERROR);
+                    rc=raidWriteLBA(array, -1, 1, outBuf);
+                    assert(rc == ERROR);
+                    rc=raidCloseArray(array);
+                    assert(rc == OK);
+
+                    for(missing=0; missing <= RAID_CHUNKS; missing++)
+                    {
+                        bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, numSectors * SECTOR_SIZE, missing);
+                        assert(bytes == numSectors * SECTOR_SIZE);
+                        fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                        rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                        assert(rc == numSectors * SECTOR_SIZE);
+                        close(fd);
+                        assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                    }
+
+                    // a stream of 8 sector writes over whole stripes, coalesced if cached
+                    array=raidOpenArray(0, numSectors);
+                    assert(array != NULL);
+                    for(lba=0; lba + 8 <= 4 * stripeSectors; lba+=8)
+                    {
+                        rc=raidWriteLBA(array, lba, 8, model + lba * SECTOR_SIZE);
+                        assert(rc == OK);
+                    }
+                    rc=raidFlushArray(array);
+                    assert(rc == OK);
+                    raidGetArrayStats(array, &stats);
+                    if(cache > 0)
+                        assert((stats.fullStripeWrites == 4) && (stats.rmwWrites == 0));
+                    else
+                        assert((stats.fullStripeWrites == 0) && (stats.rmwWrites == 4 * stripeSectors / 8));
+                    rc=raidCloseArray(array);
+                    assert(rc == OK);
+
+                    // one sector, reading and writing it and its XOR sector only
+                    array=raidOpenArray(0, numSectors);
+                    assert(array != NULL);
+                    lba=stripeSectors + 3;
+                    model[lba * SECTOR_SIZE]^=0xff;
+                    rc=raidWriteLBA(array, lba, 1, model + lba * SECTOR_SIZE);
+                    assert(rc == OK);
+                    rc=raidFlushArray(array);
+                    assert(rc == OK);
+                    raidGetArrayStats(array, &stats);
+                    parityChunk=raidMapLBA(lba, &chunk, &chunkLBA);
+                    for(idx=1; idx <= RAID_CHUNKS; idx++)
+                    {
+                        assert(stats.targetReads[idx - 1] == ((idx == chunk) || (idx == parityChunk)));
+                        assert(stats.targetWrites[idx - 1] == ((idx == chunk) || (idx == parityChunk)));
+                    }
+                    assert(stats.rmwWrites == 1);
+                    rc=raidCloseArray(array);
+                    assert(rc == OK);
+
+                    bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, numSectors * SECTOR_SIZE, parityChunk % RAID_CHUNKS + 1);
+                    assert(bytes == numSectors * SECTOR_SIZE);
+                    fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                    rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                    assert(rc == numSectors * SECTOR_SIZE);
+                    close(fd);
+                    assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                }
+
+                printf("%s, %d KB stripe unit: random block I/O matched, cached and written through\n",
+                       raidLayoutName(layout), chunkSize[sizeIdx] / 1024);
+            }
+            }
+
+            raidSetDirectIO(TRUE);
+            rc=raidSetChunkSize(RAID_MIN_CHUNK_SIZE);
+            assert(rc == OK);
+            stripeSectors=RAID_DATA_CHUNKS * RAID_MIN_CHUNK_SIZE / SECTOR_SIZE;
+
+            for(cache=0; cache <= RAID_DEFAULT_CACHE_STRIPES; cache+=RAID_DEFAULT_CACHE_STRIPES)
+            {
+                rc=raidSetCacheStripes(cache);
+                assert(rc == OK);
+
+                for(idx=0; idx < STRIPE_TEST_LEN; idx++) model[idx]=rand();
+                fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+                written=write(fd, model, numSectors * SECTOR_SIZE);
+                assert(written == numSectors * SECTOR_SIZE);
+                close(fd);
+
+                if((stripeFile(STRIPE_TEST_INPUT, 0) != numSectors * SECTOR_SIZE) ||
+                   ((array=raidOpenArray(0, numSectors)) == NULL))
+                {
+                    printf("O_DIRECT not supported here, skipped\n");
+                    break;
+                }
+
+                // odd sectors and lengths, so no I/O is on whole blocks unless widened
+                for(op=0; op < 2000; op++)
+                {
+                    if(op == 1000)
+                    {
+                        rc=raidFailTarget(array, 1);
+                        assert(rc == OK);
+                    }
+
+                    lba=(rand() % (numSectors / 2)) * 2 + 1;
+                    count=1 + (rand() % ((op & 1) ? 4 : stripeSectors)) * 2;
+                    if(lba + count > numSectors) count=numSectors - lba;
+
+                    if(rand() & 1)
+                    {
+                        fill=rand();
+                        for(idx=0; idx < count * SECTOR_SIZE; idx++) model[lba * SECTOR_SIZE + idx]=fill + idx * 7;
+                        rc=raidWriteLBA(array, lba, count, model + lba * SECTOR_SIZE);
+                        assert(rc == OK);
+                    }
+                    else
+                    {
+                        rc=raidReadLBA(array, lba, count, outBuf);
+                        assert(rc == OK);
+                        assert(memcmp(model + lba * SECTOR_SIZE, outBuf, count * SECTOR_SIZE) == 0);
+                    }
+                }
+
+                rc=raidReadLBA(array, 0, numSectors, outBuf);
+                assert(rc == OK);
+                assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                rc=raidCloseArray(array);
+                assert(rc == OK);
+
+                bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, numSectors * SECTOR_SIZE, 1);
+                assert(bytes == numSectors * SECTOR_SIZE);
+                fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                assert(rc == numSectors * SECTOR_SIZE);
+                close(fd);
+                assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+
+                printf("O_DIRECT, %s: odd sector block I/O matched, whole and degraded\n",
+                       (cache > 0) ? "cached" : "written through");
+            }
+            raidSetDirectIO(FALSE);
+
+            rc=raidSetCacheStripes(RAID_MAX_CACHE_STRIPES + 1);
+            assert(rc == ERROR);
+
+            raidSetCacheStripes(RAID_DEFAULT_CACHE_STRIPES);
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetChunkSize(defaultChunkSize);
+            free(model);
+            free(outBuf);
+        }
+
+        //
+        // END TEST CASE #8
+
+
+        // TEST CASE #9
+        //
+        // Lose each target of a striped file in turn, with its file deleted, and check that
+        // every sector still reads back from the other four, before and after random writes
+        // and reads checked against a model, then rebuild the target in the background while
+        // more random writes and reads go on, for each layout, cached and written through.
+        // Restoring with each target lost must then give the model, so the rebuilt target and
+        // the XOR chunks written while degraded are right.  Last, a rebuild limited to a rate
+        // must take as long as the rate says and report its progress as it goes.
+        //
+        printf("TEST CASE 9 (degraded reads and background rebuild):\n");
+
+        {
+            unsigned char *model, *outBuf;
+            int layout, cache, failed, missing, fd, numSectors, count, op, fill, stripeSectors, phase;
+            int defaultChunkSize=raidGetChunkSize();
+            long long lba, bytes;
+            raidArray_t *array;
+            raidArrayStats_t stats;
+            raidRebuildStatus_t status;
+
+            numSectors=STRIPE_TEST_LEN / SECTOR_SIZE;
+            model=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN);
+            rc=raidSetChunkSize(RAID_MIN_CHUNK_SIZE);
+            assert(rc == OK);
+            stripeSectors=RAID_DATA_CHUNKS * RAID_MIN_CHUNK_SIZE / SECTOR_SIZE;
+
+            for(layout=RAID_LAYOUT_FIXED; layout <= RAID_LAYOUT_LEFT_SYMMETRIC; layout++)
+            {
+            rc=raidSetLayout(layout);
+            assert(rc == OK);
+
+            for(cache=0; cache <= RAID_DEFAULT_CACHE_STRIPES; cache+=RAID_DEFAULT_CACHE_STRIPES)
+            {
+                rc=raidSetCacheStripes(cache);
+                assert(rc == OK);
+
+                for(idx=0; idx < STRIPE_TEST_LEN; idx++) model[idx]=rand();
+                fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+                written=write(fd, model, numSectors * SECTOR_SIZE);
+                assert(written == numSectors * SECTOR_SIZE);
+                close(fd);
+                bytes=stripeFile(STRIPE_TEST_INPUT, 0);
+                assert(bytes == numSectors * SECTOR_SIZE);
+
+                for(failed=1; failed <= RAID_CHUNKS; failed++)
+                {
+                    array=raidOpenArray(0, numSectors);
+                    assert(array != NULL);
+                    rc=raidStartRebuild(array, NULL);
+                    assert(rc == ERROR);
+                    rc=raidFailTarget(array, failed);
+                    assert(rc == OK);
+                    rc=raidFailTarget(array, failed % RAID_CHUNKS + 1);
+                    assert(rc == ERROR);
+                    rc=unlink(raidGetChunkPath(failed));
+                    assert(rc == 0);
+
+                    rc=raidReadLBA(array, 0, numSectors, outBuf);
+                    assert(rc == OK);
+                    assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                    raidGetArrayStats(array, &stats);
+                    assert((stats.degradedReads > 0) == ((layout == RAID_LAYOUT_LEFT_SYMMETRIC) || (failed < RAID_CHUNKS)));
+
+                    // degraded, then while the rebuild runs
+                    for(phase=0; phase < 2; phase++)
+                    {
+                        if(phase == 1)
+                        {
+                            rc=raidStartRebuild(array, NULL);
+                            assert(rc == OK);
+                        }
+
+                        for(op=0; op < 1000; op++)
+                        {
+                            lba=rand() % numSectors;
+                            count=1 + rand() % ((op & 1) ? 8 : (2 * stripeSectors));
+                            if(lba + count > numSectors) count=numSectors - lba;
+
+                            if(rand() & 1)
+                            {
+                                fill=rand();
+                                for(idx=0; idx < count * SECTOR_SIZE; idx++) model[lba * SECTOR_SIZE + idx]=fill + idx * 13;
+                                rc=raidWriteLBA(array, lba, count, model + lba * SECTOR_SIZE);
+                                assert(rc == OK);
+                            }
+                            else
+                            {
+                                rc=raidReadLBA(array, lba, count, outBuf);
+                                assert(rc == OK);
+                                assert(memcmp(model + lba * SECTOR_SIZE, outBuf, count * SECTOR_SIZE) == 0);
+                            }
+                        }
+
+                        rc=raidFlushArray(array);
+                        assert(rc == OK);
+                        rc=raidReadLBA(array, 0, numSectors, outBuf);
+                        assert(rc == OK);
+                        assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                    }
+
+                    rc=raidWaitRebuild(array);
+                    assert(rc == OK);
+                    raidGetRebuildStatus(array, &status);
+                    assert(!status.active && !status.error && (status.chunk == failed) &&
+                           (status.stripesDone == status.totalStripes) && (status.percent == 100.0));
+                    rc=raidCloseArray(array);
+                    assert(rc == OK);
+
+                    for(missing=0; missing <= RAID_CHUNKS; missing++)
+                    {
+                        bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, numSectors * SECTOR_SIZE, missing);
+                        assert(bytes == numSectors * SECTOR_SIZE);
+                        fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                        rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                        assert(rc == numSectors * SECTOR_SIZE);
+                        close(fd);
+                        assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+                    }
+                }
+
+                printf("%s, cache %d: read degraded and rebuilt with each target lost\n", raidLayoutName(layout), cache);
+            }
+            }
+
+            // about 0.2 seconds for the 0.75 MB of a target at 4 MB/s
+            rc=raidSetChunkSize(RAID_DEFAULT_CHUNK_SIZE);
+            assert(rc == OK);
+            fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            written=write(fd, model, numSectors * SECTOR_SIZE);
+            assert(written == numSectors * SECTOR_SIZE);
+            close(fd);
+            bytes=stripeFile(STRIPE_TEST_INPUT, 0);
+            assert(bytes == numSectors * SECTOR_SIZE);
+            array=raidOpenArray(0, numSectors);
+            assert(array != NULL);
+            rc=raidFailTarget(array, 2);
+            assert(rc == OK);
+            rc=raidSetRebuildRate(-1);
+            assert(rc == ERROR);
+            rc=raidSetRebuildRate(4);
+            assert(rc == OK);
+            rc=raidStartRebuild(array, NULL);
+            assert(rc == OK);
+            rc=raidStartRebuild(array, NULL);
+            assert(rc == ERROR);
+            usleep(50000);
+            raidGetRebuildStatus(array, &status);
+            assert(status.active && (status.stripesDone > 0) && (status.stripesDone < status.totalStripes) &&
+                   (status.etaSeconds > 0.0));
+            printf("rate limited rebuild: %.0f%% at %.1f MB/s, %.2f s to go\n", status.percent, status.mbPerSec, status.etaSeconds);
+            rc=raidWaitRebuild(array);
+            assert(rc == OK);
+            raidGetRebuildStatus(array, &status);
+            assert(status.seconds > 0.15);
+            rc=raidReadLBA(array, 0, numSectors, outBuf);
+            assert(rc == OK);
+            assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+            rc=raidCloseArray(array);
+            assert(rc == OK);
+
+            raidSetRebuildRate(0);
+            raidSetCacheStripes(RAID_DEFAULT_CACHE_STRIPES);
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetChunkSize(defaultChunkSize);
+            free(model);
+            free(outBuf);
+        }
+
+        //
+        // END TEST CASE #9
+
+
+        // TEST CASE #10
+        //
+        // Every CRC32C kernel must give the check value of "123456789" and the table kernel's
+        // checksum of buffers of every length and alignment, in one call or continued.  Then
+        // stripe a file with checksums, for each engine and layout, and corrupt a sector of
+        // each target in turn, a run of sectors, a checksum, the XOR chunk with no checksums to
+        // go by, and two targets of the same row.  A scrub must find each and locate the
+        // corrupt target, a repair scrub must fix all but the last, and a scrub after must be
+        // clean, with the file restoring whole.  Last, block writes and a rebuild must keep the
+        // checksums right.
+        //
+        printf("TEST CASE 10 (sector checksums and scrub):\n");
+
+        {
+            unsigned char *inBuf, *outBuf, *model;
+            unsigned int crc;
+            int kernel, defaultKernel=crcCurrentKernel(), defaultChunkSize=raidGetChunkSize(), defaultEngine=raidGetIOEngine();
+            int engine, layout, target, stripeTarget[RAID_CHUNKS], numSectors, len, start, fd, op, count, fill;
+            long long numStripes, targetSectors, lba, bytes, stripes;
+            off_t offset;
+            raidScrubStats_t stats;
+            raidArray_t *array;
+
+            // a sector over for the block writes to the zeros past the end of the file
+            inBuf=malloc(STRIPE_TEST_LEN);
+            outBuf=malloc(STRIPE_TEST_LEN + SECTOR_SIZE);
+            model=calloc(1, STRIPE_TEST_LEN + SECTOR_SIZE);
+            for(idx=0; idx < STRIPE_TEST_LEN; idx++) inBuf[idx]=rand();
+
+            for(kernel=0; kernel < crcKernelCount(); kernel++)
+            {
+                if(crcSelectKernel(kernel) != OK)
+                {
+                    printf("%s: not supported on this CPU\n", crcKernelName(kernel));
+                    continue;
+                }
+
+                assert(crc32c(0, (unsigned char *)"123456789", 9) == 0xE3069283);
+                for(len=0; len < XOR_TEST_MAX_LEN; len+=1 + len / 8)
+                {
+                    for(start=0; start < 8; start++)
+                    {
+                        crc=crc32c(0, inBuf + start, len);
+                        assert(crc32c(crc32c(0, inBuf + start, len / 3), inBuf + start + len / 3, len - len / 3) == crc);
+                        rc=crcSelectKernel(0);
+                        assert(rc == OK);
+                        assert(crc32c(0, inBuf + start, len) == crc);
+                        rc=crcSelectKernel(kernel);
+                        assert(rc == OK);
+                    }
+                }
+                printf("%s: check value and table kernel checksums match\n", crcKernelName(kernel));
+            }
+            crcSelectKernel(defaultKernel);
+
+            fd=open(STRIPE_TEST_INPUT, O_WRONLY | O_CREAT | O_TRUNC, 00644);
+            written=write(fd, inBuf, STRIPE_TEST_LEN);
+            assert(written == STRIPE_TEST_LEN);
+            close(fd);
+
+            numSectors=(STRIPE_TEST_LEN + SECTOR_SIZE - 1) / SECTOR_SIZE;
+            rc=raidSetChunkSize(RAID_MIN_CHUNK_SIZE);
+            assert(rc == OK);
+            numStripes=((long long)numSectors * SECTOR_SIZE + RAID_DATA_CHUNKS * RAID_MIN_CHUNK_SIZE - 1) /
+                       (RAID_DATA_CHUNKS * RAID_MIN_CHUNK_SIZE);
+            targetSectors=numStripes * RAID_MIN_CHUNK_SIZE / SECTOR_SIZE;
+
+            for(engine=RAID_IO_THREADS; engine <= RAID_IO_URING; engine++)
+            {
+            if(raidSetIOEngine(engine) != OK)
+            {
+                printf("%s: not available\n", raidIOEngineName(engine));
+                continue;
+            }
+
+            for(layout=RAID_LAYOUT_FIXED; layout <= RAID_LAYOUT_LEFT_SYMMETRIC; layout++)
+            {
+                rc=raidSetLayout(layout);
+                assert(rc == OK);
+                rc=raidSetChecksumPath(CRC_TEST_PATH);
+                assert(rc == OK);
+                bytes=stripeFile(STRIPE_TEST_INPUT, 0);
+                assert(bytes == STRIPE_TEST_LEN);
+
+                stripes=raidScrub(0, numSectors, FALSE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.stripes == numStripes) && (stats.checksumErrors == 0) && (stats.parityErrors == 0));
+
+                // a sector, then a run of sectors spanning stripe units, on each target
+                for(count=1; count <= 16; count+=15)
+                {
+                    for(target=0; target < RAID_CHUNKS; target++)
+                    {
+                        lba=rand() % (targetSectors - count);
+                        for(idx=0; idx < count; idx++)
+                            corruptByte(raidGetChunkPath(target + 1), (lba + idx) * SECTOR_SIZE + rand() % SECTOR_SIZE);
+
+                        stripes=raidScrub(0, numSectors, FALSE, &stats);
+                        assert(stripes == numStripes);
+                        assert((stats.checksumErrors == count) && (stats.parityErrors == count) &&
+                               (stats.chunkErrors[target] == count) && (stats.repaired == 0) && (stats.unrecoverable == 0));
+                        stripes=raidScrub(0, numSectors, TRUE, &stats);
+                        assert(stripes == numStripes);
+                        assert((stats.chunkErrors[target] == count) && (stats.repaired == count));
+                        stripes=raidScrub(0, numSectors, FALSE, &stats);
+                        assert(stripes == numStripes);
+                        assert((stats.checksumErrors == 0) && (stats.parityErrors == 0));
+                    }
+                }
+
+                // a checksum, stale with the sectors right
+                corruptByte(CRC_TEST_PATH, rand() % (targetSectors * RAID_CHUNKS * sizeof(unsigned int)));
+                stripes=raidScrub(0, numSectors, TRUE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.checksumErrors == 1) && (stats.parityErrors == 0) && (stats.repaired == 1));
+
+                // the XOR chunk of a stripe, with no checksums to say which target is wrong
+                raidStripeTargets(layout, numStripes / 2, stripeTarget);
+                target=stripeTarget[RAID_DATA_CHUNKS];
+                offset=(numStripes / 2) * RAID_MIN_CHUNK_SIZE + rand() % RAID_MIN_CHUNK_SIZE;
+                corruptByte(raidGetChunkPath(target + 1), offset);
+                rc=raidSetChecksumPath(NULL);
+                assert(rc == OK);
+                assert(raidGetChecksumPath() == NULL);
+                stripes=raidScrub(0, numSectors, TRUE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.checksumErrors == 0) && (stats.parityErrors == 1) && (stats.repaired == 1));
+                rc=raidSetChecksumPath(CRC_TEST_PATH);
+                assert(rc == OK);
+
+                // an odd sector through O_DIRECT, so the repair write is widened to the aligned
+                // block of the target around it
+                raidSetDirectIO(TRUE);
+                lba=(rand() % (targetSectors / 2)) * 2 + 1;
+                corruptByte(raidGetChunkPath(2), lba * SECTOR_SIZE);
+                if(raidScrub(0, numSectors, TRUE, &stats) == numStripes)
+                {
+                    assert((stats.chunkErrors[1] == 1) && (stats.repaired == 1));
+                    stripes=raidScrub(0, numSectors, FALSE, &stats);
+                    assert(stripes == numStripes);
+                    assert((stats.checksumErrors == 0) && (stats.parityErrors == 0));
+                }
+                else
+                {
+                    printf("O_DIRECT not supported here, repair skipped\n");
+                    raidSetDirectIO(FALSE);
+                    stripes=raidScrub(0, numSectors, TRUE, &stats);
+                    assert(stripes == numStripes);
+                }
+                raidSetDirectIO(FALSE);
+
+                // two targets of one row, more than the XOR chunk can cover, in different bytes
+                // so the XOR doesn't cancel
+                lba=rand() % targetSectors;
+                corruptByte(raidGetChunkPath(1), lba * SECTOR_SIZE);
+                corruptByte(raidGetChunkPath(4), lba * SECTOR_SIZE + 1);
+                stripes=raidScrub(0, numSectors, TRUE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.unrecoverable == 1) && (stats.chunkErrors[0] == 1) && (stats.chunkErrors[3] == 1) &&
+                       (stats.repaired == 0));
+                corruptByte(raidGetChunkPath(1), lba * SECTOR_SIZE);
+                corruptByte(raidGetChunkPath(4), lba * SECTOR_SIZE + 1);
+
+                stripes=raidScrub(0, numSectors, FALSE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.checksumErrors == 0) && (stats.parityErrors == 0));
+                bytes=restoreFile(STRIPE_TEST_OUTPUT, 0, STRIPE_TEST_LEN, 0);
+                assert(bytes == STRIPE_TEST_LEN);
+                fd=open(STRIPE_TEST_OUTPUT, O_RDONLY);
+                rc=read(fd, outBuf, STRIPE_TEST_LEN);
+                assert(rc == STRIPE_TEST_LEN);
+                close(fd);
+                assert(memcmp(inBuf, outBuf, STRIPE_TEST_LEN) == 0);
+
+                printf("%s, %s: corrupt sectors located and repaired\n", raidIOEngineName(engine), raidLayoutName(layout));
+            }
+            }
+            raidSetIOEngine(defaultEngine);
+
+            // block writes cached and through, then a target lost and rebuilt
+            memcpy(model, inBuf, STRIPE_TEST_LEN);
+            for(count=0; count <= RAID_DEFAULT_CACHE_STRIPES; count+=RAID_DEFAULT_CACHE_STRIPES)
+            {
+                rc=raidSetCacheStripes(count);
+                assert(rc == OK);
+                array=raidOpenArray(0, numSectors);
+                assert(array != NULL);
+                for(op=0; op < 500; op++)
+                {
+                    lba=rand() % numSectors;
+                    len=1 + rand() % 64;
+                    if(lba + len > numSectors) len=numSectors - lba;
+                    fill=rand();
+                    for(idx=0; idx < len * SECTOR_SIZE; idx++) model[lba * SECTOR_SIZE + idx]=fill + idx * 13;
+                    rc=raidWriteLBA(array, lba, len, model + lba * SECTOR_SIZE);
+                    assert(rc == OK);
+                }
+                rc=raidCloseArray(array);
+                assert(rc == OK);
+                stripes=raidScrub(0, numSectors, FALSE, &stats);
+                assert(stripes == numStripes);
+                assert((stats.checksumErrors == 0) && (stats.parityErrors == 0));
+            }
+
+            array=raidOpenArray(0, numSectors);
+            assert(array != NULL);
+            rc=raidFailTarget(array, 3);
+            assert(rc == OK);
+            rc=unlink(raidGetChunkPath(3));
+            assert(rc == 0);
+            rc=raidStartRebuild(array, NULL);
+            assert(rc == OK);
+            rc=raidWaitRebuild(array);
+            assert(rc == OK);
+            rc=raidReadLBA(array, 0, numSectors, outBuf);
+            assert(rc == OK);
+            assert(memcmp(model, outBuf, numSectors * SECTOR_SIZE) == 0);
+            rc=raidCloseArray(array);
+            assert(rc == OK);
+            stripes=raidScrub(0, numSectors, FALSE, &stats);
+            assert(stripes == numStripes);
+            assert((stats.checksumErrors == 0) && (stats.parityErrors == 0));
+            printf("block writes and rebuild: checksums kept right\n");
+
+            raidSetChecksumPath(NULL);
+            raidSetCacheStripes(RAID_DEFAULT_CACHE_STRIPES);
+            raidSetLayout(RAID_LAYOUT_FIXED);
+            raidSetChunkSize(defaultChunkSize);
+            free(inBuf);
+            free(outBuf);
+            free(model);
+        }
+
+        //
+        // END TEST CASE #10
+
         printf("FINISHED\n");
 
         
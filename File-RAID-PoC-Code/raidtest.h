@@ -12,17 +12,54 @@
 #include <sys/stat.h>
 #include <fcntl.h>
 
-#ifdef RAID64
-#include "raidlib64.h"
-#define PTR_CAST (unsigned long long *)
-#else
 #include "raidlib.h"
-#define PTR_CAST (unsigned char *)
-#endif
 
 #define TEST_ITERATIONS (1000)
 #define MAX_LBAS (1000)
 
+// parity kernel cross check, up to 8 sources of up to 4 KB plus a tail
+#define XOR_TEST_SOURCES (8)
+#define XOR_TEST_MAX_LEN (4096 + 127)
+
+// P+Q stripe coding, every pair of lost chunks for 1 to 16 data chunks of an odd length
+#define RS_TEST_MAX_DATA (16)
+#define RS_TEST_LEN (4096 + 61)
+
+// file striping round trips, an odd length past several batches of the smallest stripe unit
+#define STRIPE_TEST_LEN (3*1024*1024 + 12345)
+#define STRIPE_TEST_INPUT "ChunkTestInput.bin"
+#define STRIPE_TEST_OUTPUT "ChunkTestOutput.bin"
+#define DIRECT_TEST_OFFSET (8)
+#define CRC_TEST_PATH "StripeChunkCRC.bin"
+
+// parity kernel throughput, 1 GB of data per kernel and block size
+#define PERF_BLOCK_SIZE (1024*1024)
+#define PERF_BYTES (1024*1024*1024)
+
+// stripe coding throughput, 64 KB chunks for each stripe width in PERF_WIDTHS
+#define PERF_CHUNK_SIZE (64*1024)
+#define PERF_WIDTHS {4, 6, 8, 12, 16}
+
+// file striping throughput, stripe and restore of a 1 GB file for each stripe unit
+#define PERF_FILE_BYTES (1024LL*1024*1024)
+#define PERF_CHUNK_SIZES {4*1024, 64*1024, 1024*1024}
+#define PERF_FILE_INPUT "ChunkPerfInput.bin"
+#define PERF_FILE_OUTPUT "ChunkPerfOutput.bin"
+
+// file striping thread scaling, 1, 2, 4 up to PERF_MAX_THREADS parity threads with 64 KB units
+#define PERF_MAX_THREADS (8)
+
+// block writes, PERF_BLOCK_WRITES of PERF_WRITE_SECTORS each over an array of PERF_ARRAY_SECTORS
+#define PERF_ARRAY_SECTORS (512LL*1024)
+#define PERF_WRITE_SECTORS (8)
+#define PERF_BLOCK_WRITES (32*1024)
+
+// rebuild with no limit and at PERF_REBUILD_RATE MB/s, timing random reads meanwhile
+#define PERF_REBUILD_RATE (32)
+
+// scrub throughput, of a file the size of the block array, with sectors corrupted to repair
+#define PERF_SCRUB_CORRUPT (64)
+
 #define TEST_RAID_STRING "#0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ##0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ#"
 
 #define NULL_RAID_STRING "#FFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFFF#"
@@ -0,0 +1,281 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+
+#include "raidlib.h"
+#include "raiduring.h"
+
+#ifdef RAID_HAVE_URING
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+#endif
+
+
+// io_uring ring for raidlib.c
+//
+// The submission queue entries (SQEs) are filled in by raidRingPrepare() and handed to the
+// kernel in one io_uring_enter() by raidRingSubmit(), which can also wait for completions, and
+// each completion queue entry (CQE) is taken by raidRingReap().  The I/O is on files and
+// buffers registered in advance, so the kernel does not look up the file or pin the pages
+// for every request.  A ring is used by one thread only, so the only ordering needed is
+// between that thread and the kernel, with acquire loads of the indexes the kernel moves and
+// release stores of the ones it reads.
+
+#ifdef RAID_HAVE_URING
+
+static int raidRingSetup(unsigned entries, struct io_uring_params *params)
+{
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+
+static int raidRingEnter(int fd, unsigned toSubmit, unsigned minComplete, unsigned flags)
+{
+    return (int)syscall(__NR_io_uring_enter, fd, toSubmit, minComplete, flags, NULL, 0);
+}
+
+
+static int raidRingRegister(int fd, unsigned opcode, void *arg, unsigned numArgs)
+{
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, numArgs);
+}
+
+
+// TRUE if a ring can be set up, e.g. not for kernels before 5.1 or where seccomp blocks it
+int raidRingAvailable(void)
+{
+    static int available=-1;
+    raidRing_t ring;
+
+    if(available < 0)
+    {
+        available=(raidRingInit(&ring, 4) == OK);
+        if(available) raidRingExit(&ring);
+    }
+
+    return available;
+}
+
+
+int raidRingInit(raidRing_t *ring, unsigned entries)
+{
+    struct io_uring_params params;
+    unsigned char *sq, *cq;
+
+    memset(ring, 0, sizeof(raidRing_t));
+    memset(&params, 0, sizeof(params));
+
+    if((ring->fd=raidRingSetup(entries, &params)) < 0)
+        return ERROR;
+
+    ring->entries=params.sq_entries;
+    ring->sqRingLen=params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    ring->cqRingLen=params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    ring->sqeLen=params.sq_entries * sizeof(struct io_uring_sqe);
+
+    // both rings share one mapping on kernels since 5.4
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        if(ring->cqRingLen > ring->sqRingLen) ring->sqRingLen=ring->cqRingLen;
+        ring->cqRingLen=ring->sqRingLen;
+    }
+
+    ring->sqRing=mmap(NULL, ring->sqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring->fd, IORING_OFF_SQ_RING);
+    if(ring->sqRing == MAP_FAILED)
+    {
+        ring->sqRing=NULL;
+        raidRingExit(ring);
+        return ERROR;
+    }
+
+    if(params.features & IORING_FEAT_SINGLE_MMAP)
+        ring->cqRing=ring->sqRing;
+    else
+    {
+        ring->cqRing=mmap(NULL, ring->cqRingLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                          ring->fd, IORING_OFF_CQ_RING);
+        if(ring->cqRing == MAP_FAILED)
+        {
+            ring->cqRing=NULL;
+            raidRingExit(ring);
+            return ERROR;
+        }
+    }
+
+    ring->sqe=mmap(NULL, ring->sqeLen, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                   ring->fd, IORING_OFF_SQES);
+    if(ring->sqe == MAP_FAILED)
+    {
+        ring->sqe=NULL;
+        raidRingExit(ring);
+        return ERROR;
+    }
+
+    sq=(unsigned char *)ring->sqRing;
+    cq=(unsigned char *)ring->cqRing;
+    ring->sqHead=(unsigned *)(sq + params.sq_off.head);
+    ring->sqTail=(unsigned *)(sq + params.sq_off.tail);
+    ring->sqMask=(unsigned *)(sq + params.sq_off.ring_mask);
+    ring->sqArray=(unsigned *)(sq + params.sq_off.array);
+    ring->cqHead=(unsigned *)(cq + params.cq_off.head);
+    ring->cqTail=(unsigned *)(cq + params.cq_off.tail);
+    ring->cqMask=(unsigned *)(cq + params.cq_off.ring_mask);
+    ring->cqe=cq + params.cq_off.cqes;
+
+    return OK;
+}
+
+
+void raidRingExit(raidRing_t *ring)
+{
+    if(ring->sqe != NULL) munmap(ring->sqe, ring->sqeLen);
+    if((ring->cqRing != NULL) && (ring->cqRing != ring->sqRing)) munmap(ring->cqRing, ring->cqRingLen);
+    if(ring->sqRing != NULL) munmap(ring->sqRing, ring->sqRingLen);
+    if(ring->fd >= 0) close(ring->fd);
+
+    memset(ring, 0, sizeof(raidRing_t));
+    ring->fd=-1;
+}
+
+
+int raidRingRegisterBuffers(raidRing_t *ring, struct iovec *iov, unsigned numBuffers)
+{
+    return (raidRingRegister(ring->fd, IORING_REGISTER_BUFFERS, iov, numBuffers) < 0) ? ERROR : OK;
+}
+
+
+int raidRingRegisterFiles(raidRing_t *ring, int *fd, unsigned numFiles)
+{
+    return (raidRingRegister(ring->fd, IORING_REGISTER_FILES, fd, numFiles) < 0) ? ERROR : OK;
+}
+
+
+// Queue a read or write of len bytes at offset of registered file fileIdx, into or from buf
+// within registered buffer bufIdx, returns ERROR if the submission queue is full
+int raidRingPrepare(raidRing_t *ring, int write, int fileIdx, unsigned char *buf, unsigned len,
+                    long long offset, int bufIdx, unsigned long long userData)
+{
+    struct io_uring_sqe *sqe;
+    unsigned tail, idx;
+
+    tail=*ring->sqTail;
+    if(tail - __atomic_load_n(ring->sqHead, __ATOMIC_ACQUIRE) >= ring->entries)
+        return ERROR;
+
+    idx=tail & *ring->sqMask;
+    sqe=&((struct io_uring_sqe *)ring->sqe)[idx];
+    memset(sqe, 0, sizeof(struct io_uring_sqe));
+
+    sqe->opcode=write ? IORING_OP_WRITE_FIXED : IORING_OP_READ_FIXED;
+    sqe->flags=IOSQE_FIXED_FILE;
+    sqe->fd=fileIdx;
+    sqe->off=offset;
+    sqe->addr=(unsigned long long)(unsigned long)buf;
+    sqe->len=len;
+    sqe->buf_index=bufIdx;
+    sqe->user_data=userData;
+
+    ring->sqArray[idx]=idx;
+    __atomic_store_n(ring->sqTail, tail + 1, __ATOMIC_RELEASE);
+    ring->toSubmit++;
+
+    return OK;
+}
+
+
+// submit everything prepared and wait for at least waitFor completions
+int raidRingSubmit(raidRing_t *ring, unsigned waitFor)
+{
+    int rc;
+
+    do
+    {
+        rc=raidRingEnter(ring->fd, ring->toSubmit, waitFor, waitFor ? IORING_ENTER_GETEVENTS : 0);
+    }
+    while((rc < 0) && (errno == EINTR));
+
+    if(rc < 0)
+        return ERROR;
+
+    ring->toSubmit-=rc;
+
+    return OK;
+}
+
+
+// TRUE with the user data and the result, bytes or -errno, of a completion, FALSE if none
+int raidRingReap(raidRing_t *ring, unsigned long long *userData, int *result)
+{
+    struct io_uring_cqe *cqe;
+    unsigned head;
+
+    head=*ring->cqHead;
+    if(head == __atomic_load_n(ring->cqTail, __ATOMIC_ACQUIRE))
+        return FALSE;
+
+    cqe=&((struct io_uring_cqe *)ring->cqe)[head & *ring->cqMask];
+    *userData=cqe->user_data;
+    *result=cqe->res;
+
+    __atomic_store_n(ring->cqHead, head + 1, __ATOMIC_RELEASE);
+
+    return TRUE;
+}
+
+#else
+
+int raidRingAvailable(void)
+{
+    return FALSE;
+}
+
+
+int raidRingInit(raidRing_t *ring, unsigned entries)
+{
+    memset(ring, 0, sizeof(raidRing_t));
+    ring->fd=-1;
+
+    return ERROR;
+}
+
+
+void raidRingExit(raidRing_t *ring)
+{
+}
+
+
+int raidRingRegisterBuffers(raidRing_t *ring, struct iovec *iov, unsigned numBuffers)
+{
+    return ERROR;
+}
+
+
+int raidRingRegisterFiles(raidRing_t *ring, int *fd, unsigned numFiles)
+{
+    return ERROR;
+}
+
+
+int raidRingPrepare(raidRing_t *ring, int write, int fileIdx, unsigned char *buf, unsigned len,
+                    long long offset, int bufIdx, unsigned long long userData)
+{
+    return ERROR;
+}
+
+
+int raidRingSubmit(raidRing_t *ring, unsigned waitFor)
+{
+    return ERROR;
+}
+
+
+int raidRingReap(raidRing_t *ring, unsigned long long *userData, int *result)
+{
+    return FALSE;
+}
+
+#endif
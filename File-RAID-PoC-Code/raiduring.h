@@ -0,0 +1,51 @@
+#ifndef RAIDURING_H
+#define RAIDURING_H
+
+#include <sys/uio.h>
+
+// Minimal io_uring ring for the chunk file I/O in raidlib.c, with the io_uring_setup(),
+// io_uring_enter() and io_uring_register() system calls made directly, so liburing is not
+// needed.  Every function returns ERROR where io_uring is not available, and raidlib.c then
+// does the chunk file I/O from a thread per chunk file instead.
+
+#if defined(__linux__) && defined(__has_include)
+#if __has_include(<linux/io_uring.h>)
+#define RAID_HAVE_URING
+#endif
+#endif
+
+typedef struct
+{
+    int fd;
+    unsigned entries;
+    unsigned toSubmit;
+
+    // shared with the kernel, the indexes only move forward and wrap with the mask
+    unsigned *sqHead;
+    unsigned *sqTail;
+    unsigned *sqMask;
+    unsigned *sqArray;
+    unsigned *cqHead;
+    unsigned *cqTail;
+    unsigned *cqMask;
+    void *sqe;
+    void *cqe;
+
+    void *sqRing;
+    void *cqRing;
+    size_t sqRingLen;
+    size_t cqRingLen;
+    size_t sqeLen;
+} raidRing_t;
+
+int raidRingAvailable(void);
+int raidRingInit(raidRing_t *ring, unsigned entries);
+void raidRingExit(raidRing_t *ring);
+int raidRingRegisterBuffers(raidRing_t *ring, struct iovec *iov, unsigned numBuffers);
+int raidRingRegisterFiles(raidRing_t *ring, int *fd, unsigned numFiles);
+int raidRingPrepare(raidRing_t *ring, int write, int fileIdx, unsigned char *buf, unsigned len,
+                    long long offset, int bufIdx, unsigned long long userData);
+int raidRingSubmit(raidRing_t *ring, unsigned waitFor);
+int raidRingReap(raidRing_t *ring, unsigned long long *userData, int *result);
+
+#endif
@@ -0,0 +1,293 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <stdint.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define XOR_X86
+#endif
+
+#if defined(__ARM_NEON) || defined(__aarch64__)
+#include <arm_neon.h>
+#define XOR_NEON
+#endif
+
+#include "raidlib.h"
+
+
+// Parity XOR kernels
+//
+// xorBlocks() computes dst = src[0] ^ src[1] ^ ... ^ src[numSrc-1] over len bytes, which is
+// both the RAID-5 parity encode (the data LBAs in, parity out) and the rebuild (the surviving
+// LBAs and the parity in, the lost LBA out).
+//
+// Each kernel does the same XOR, one byte, one 64-bit word or one 16, 32 or 64 byte vector
+// at a time, with the bytes past the last whole word or vector done one at a time, so every
+// kernel gives exactly the same result as the byte kernel for any length and alignment.  The
+// vector kernels use unaligned loads and stores and are compiled for their instruction set
+// with the target attribute, so the rest of the library still runs on any CPU of the
+// architecture.  The first call picks the fastest kernel the CPU supports, unless the
+// RAID_XOR_KERNEL environment variable names another one, and xorSelectKernel() can switch
+// kernels at any time, e.g. to compare them in raid_perftest.  The choice is made under
+// pthread_once(), since the first calls may come from several I/O threads at once.
+//
+// dst may be one of the sources, since each word is loaded from every source before it is
+// stored, but must not otherwise overlap them.
+
+typedef void (*xorKernelFn_t)(unsigned char *src[], int numSrc, unsigned char *dst, int len);
+
+typedef struct
+{
+    const char *name;
+    xorKernelFn_t fn;
+    int supported;
+} xorKernel_t;
+
+
+// bytes from idx to len one at a time
+static void xorTail(unsigned char *src[], int numSrc, unsigned char *dst, int idx, int len)
+{
+    int s;
+    unsigned char parity;
+
+    for(; idx < len; idx++)
+    {
+        parity=src[0][idx];
+        for(s=1; s < numSrc; s++)
+            parity^=src[s][idx];
+        dst[idx]=parity;
+    }
+}
+
+
+// the reference, kept a byte loop even when the compiler would vectorize it
+__attribute__((optimize("no-tree-vectorize")))
+static void xorByte(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    xorTail(src, numSrc, dst, 0, len);
+}
+
+
+static void xorWord64(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    int idx=0, s;
+    uint64_t parity, word;
+
+    // memcpy is a plain unaligned 64-bit load or store once optimized
+    for(; idx + 8 <= len; idx+=8)
+    {
+        memcpy(&parity, &src[0][idx], 8);
+        for(s=1; s < numSrc; s++)
+        {
+            memcpy(&word, &src[s][idx], 8);
+            parity^=word;
+        }
+        memcpy(&dst[idx], &parity, 8);
+    }
+
+    xorTail(src, numSrc, dst, idx, len);
+}
+
+
+#ifdef XOR_X86
+
+__attribute__((target("sse2")))
+static void xorSse2(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    int idx=0, s;
+    __m128i p0, p1;
+
+    for(; idx + 32 <= len; idx+=32)
+    {
+        p0=_mm_loadu_si128((const __m128i *)&src[0][idx]);
+        p1=_mm_loadu_si128((const __m128i *)&src[0][idx+16]);
+        for(s=1; s < numSrc; s++)
+        {
+            p0=_mm_xor_si128(p0, _mm_loadu_si128((const __m128i *)&src[s][idx]));
+            p1=_mm_xor_si128(p1, _mm_loadu_si128((const __m128i *)&src[s][idx+16]));
+        }
+        _mm_storeu_si128((__m128i *)&dst[idx], p0);
+        _mm_storeu_si128((__m128i *)&dst[idx+16], p1);
+    }
+
+    xorTail(src, numSrc, dst, idx, len);
+}
+
+
+__attribute__((target("avx2")))
+static void xorAvx2(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    int idx=0, s;
+    __m256i p0, p1;
+
+    for(; idx + 64 <= len; idx+=64)
+    {
+        p0=_mm256_loadu_si256((const __m256i *)&src[0][idx]);
+        p1=_mm256_loadu_si256((const __m256i *)&src[0][idx+32]);
+        for(s=1; s < numSrc; s++)
+        {
+            p0=_mm256_xor_si256(p0, _mm256_loadu_si256((const __m256i *)&src[s][idx]));
+            p1=_mm256_xor_si256(p1, _mm256_loadu_si256((const __m256i *)&src[s][idx+32]));
+        }
+        _mm256_storeu_si256((__m256i *)&dst[idx], p0);
+        _mm256_storeu_si256((__m256i *)&dst[idx+32], p1);
+    }
+
+    xorTail(src, numSrc, dst, idx, len);
+}
+
+
+__attribute__((target("avx512f")))
+static void xorAvx512(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    int idx=0, s;
+    __m512i p0, p1;
+
+    for(; idx + 128 <= len; idx+=128)
+    {
+        p0=_mm512_loadu_si512((const void *)&src[0][idx]);
+        p1=_mm512_loadu_si512((const void *)&src[0][idx+64]);
+        for(s=1; s < numSrc; s++)
+        {
+            p0=_mm512_xor_si512(p0, _mm512_loadu_si512((const void *)&src[s][idx]));
+            p1=_mm512_xor_si512(p1, _mm512_loadu_si512((const void *)&src[s][idx+64]));
+        }
+        _mm512_storeu_si512((void *)&dst[idx], p0);
+        _mm512_storeu_si512((void *)&dst[idx+64], p1);
+    }
+
+    xorTail(src, numSrc, dst, idx, len);
+}
+
+#endif
+
+
+#ifdef XOR_NEON
+
+static void xorNeon(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    int idx=0, s;
+    uint8x16_t p0, p1;
+
+    for(; idx + 32 <= len; idx+=32)
+    {
+        p0=vld1q_u8(&src[0][idx]);
+        p1=vld1q_u8(&src[0][idx+16]);
+        for(s=1; s < numSrc; s++)
+        {
+            p0=veorq_u8(p0, vld1q_u8(&src[s][idx]));
+            p1=veorq_u8(p1, vld1q_u8(&src[s][idx+16]));
+        }
+        vst1q_u8(&dst[idx], p0);
+        vst1q_u8(&dst[idx+16], p1);
+    }
+
+    xorTail(src, numSrc, dst, idx, len);
+}
+
+#endif
+
+
+// slowest to fastest, so the last supported one is the default
+static xorKernel_t xorKernel[]=
+{
+    {"byte", xorByte, TRUE},
+    {"word64", xorWord64, TRUE},
+#ifdef XOR_X86
+    {"sse2", xorSse2, FALSE},
+    {"avx2", xorAvx2, FALSE},
+    {"avx512", xorAvx512, FALSE},
+#endif
+#ifdef XOR_NEON
+    {"neon", xorNeon, TRUE},
+#endif
+};
+
+#define NUM_XOR_KERNELS ((int)(sizeof(xorKernel)/sizeof(xorKernel_t)))
+
+static xorKernelFn_t xorFn=NULL;
+static pthread_once_t xorOnce=PTHREAD_ONCE_INIT;
+static int xorCurrent=-1;
+
+
+static void xorInit(void)
+{
+    int idx;
+    char *name;
+
+#ifdef XOR_X86
+    __builtin_cpu_init();
+
+    for(idx=0; idx < NUM_XOR_KERNELS; idx++)
+    {
+        if(strcmp(xorKernel[idx].name, "sse2") == 0)
+            xorKernel[idx].supported=__builtin_cpu_supports("sse2");
+        else if(strcmp(xorKernel[idx].name, "avx2") == 0)
+            xorKernel[idx].supported=__builtin_cpu_supports("avx2");
+        else if(strcmp(xorKernel[idx].name, "avx512") == 0)
+            xorKernel[idx].supported=__builtin_cpu_supports("avx512f");
+    }
+#endif
+
+    for(idx=0; idx < NUM_XOR_KERNELS; idx++)
+        if(xorKernel[idx].supported) xorCurrent=idx;
+
+    if((name=getenv("RAID_XOR_KERNEL")) != NULL)
+    {
+        for(idx=0; idx < NUM_XOR_KERNELS; idx++)
+            if((strcmp(xorKernel[idx].name, name) == 0) && xorKernel[idx].supported)
+                xorCurrent=idx;
+    }
+
+    xorFn=xorKernel[xorCurrent].fn;
+}
+
+
+int xorKernelCount(void)
+{
+    pthread_once(&xorOnce, xorInit);
+    return NUM_XOR_KERNELS;
+}
+
+
+const char *xorKernelName(int kernel)
+{
+    pthread_once(&xorOnce, xorInit);
+    return ((kernel >= 0) && (kernel < NUM_XOR_KERNELS)) ? xorKernel[kernel].name : "none";
+}
+
+
+int xorKernelSupported(int kernel)
+{
+    pthread_once(&xorOnce, xorInit);
+    return ((kernel >= 0) && (kernel < NUM_XOR_KERNELS)) ? xorKernel[kernel].supported : FALSE;
+}
+
+
+int xorCurrentKernel(void)
+{
+    pthread_once(&xorOnce, xorInit);
+    return xorCurrent;
+}
+
+
+// returns OK, or ERROR if the kernel is not supported on this CPU
+int xorSelectKernel(int kernel)
+{
+    if(!xorKernelSupported(kernel))
+        return ERROR;
+
+    xorCurrent=kernel;
+    xorFn=xorKernel[kernel].fn;
+
+    return OK;
+}
+
+
+void xorBlocks(unsigned char *src[], int numSrc, unsigned char *dst, int len)
+{
+    pthread_once(&xorOnce, xorInit);
+    xorFn(src, numSrc, dst, len);
+}
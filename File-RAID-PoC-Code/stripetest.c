@@ -1,53 +1,140 @@
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 
 #include "raidlib.h"
 
 int main(int argc, char *argv[])
 {
-    int bytesWritten, bytesRestored;
-    char rc;
+    long long bytesWritten, bytesRestored;
+    raidScrubStats_t scrub;
+    int chunkKB, idx, numArgs=0, offsetSectors=0;
+    char *arg[4], *path[RAID_CHUNKS], *paths=NULL;
 
     // For testing, if no data is lost (erased), then the zero default
     // indicates that no data chunk was lost.
     int chunkToRebuild=0;
 
-    if(argc < 3)
+    // options anywhere, the rest in order
+    for(idx=1; idx < argc; idx++)
     {
-        printf("useage: stripetest inputfile outputfile <sector to restore>\n");
+        if(strcmp(argv[idx], "-d") == 0)
+            raidSetDirectIO(TRUE);
+        else if(strcmp(argv[idx], "-r") == 0)
+            raidSetLayout(RAID_LAYOUT_LEFT_SYMMETRIC);
+        else if((strcmp(argv[idx], "-o") == 0) && (idx + 1 < argc))
+            offsetSectors=atoi(argv[++idx]);
+        else if((strcmp(argv[idx], "-c") == 0) && (idx + 1 < argc))
+            paths=argv[++idx];
+        else if((strcmp(argv[idx], "-k") == 0) && (idx + 1 < argc))
+        {
+            if(raidSetChecksumPath(argv[++idx]) != OK)
+            {
+                printf("-k checksum file path too long\n");
+                exit(-1);
+            }
+        }
+        else if(numArgs < 4)
+            arg[numArgs++]=argv[idx];
+    }
+
+    if(numArgs < 2)
+    {
+        printf("useage: stripetest inputfile outputfile <chunk to restore> <chunk KB>\n"
+               "                  [-c chunk1,chunk2,chunk3,chunk4,chunkXOR] [-o offset sectors] [-d] [-r]\n"
+               "                  [-k checksum file]\n");
         exit(-1);
     }
+
+    // chunk targets, files or block devices, comma separated
+    if(paths != NULL)
+    {
+        for(idx=0; idx < RAID_CHUNKS; idx++)
+        {
+            path[idx]=strtok((idx == 0) ? paths : NULL, ",");
+            if(path[idx] == NULL)
+            {
+                printf("-c needs %d comma separated chunk targets\n", RAID_CHUNKS);
+                exit(-1);
+            }
+        }
+        raidSetChunkPaths((const char **)path);
+    }
     
-    if(argc >= 4)
+    if(numArgs >= 3)
     {
-	sscanf(argv[3], "%d", &chunkToRebuild);
+	sscanf(arg[2], "%d", &chunkToRebuild);
         printf("chunk to restore = %d\n", chunkToRebuild);
     }
+
+    if(numArgs >= 4)
+    {
+        sscanf(arg[3], "%d", &chunkKB);
+        if(raidSetChunkSize(chunkKB * 1024) != OK)
+        {
+            printf("chunk size must be a multiple of %d KB up to %d KB\n",
+                   RAID_MIN_CHUNK_SIZE / 1024, RAID_MAX_CHUNK_SIZE / 1024);
+            exit(-1);
+        }
+    }
+    printf("stripe unit = %d KB\n", raidGetChunkSize() / 1024);
   
-    // What is the meaning of the "0" argument here? 
-    // This is an offset in sectors that is not actually used at all in raidlib.c, so we might
-    // want to depricate this argument.
-    bytesWritten=stripeFile(argv[1], 0); 
+    // The "offsetSectors" argument is where the stripes start on each chunk target, so a
+    // partition or file can keep a header before them
+    if((bytesWritten=stripeFile(arg[0], offsetSectors)) == ERROR)
+    {
+        printf("stripeFile of %s failed\n", arg[0]);
+        exit(-1);
+    }
+
+    printf("%s input file was written as 4 data chunks + 1 XOR parity on 5 devices 1...5, %s layout\n",
+           arg[0], raidLayoutName(raidGetLayout()));
+    for(idx=1; idx <= RAID_CHUNKS; idx++)
+        printf("  %s from sector %d%s\n", raidGetChunkPath(idx), offsetSectors, raidGetDirectIO() ? ", O_DIRECT" : "");
 
-    printf("%s input file was written as 4 data chunks + 1 XOR parity on 5 devices 1...5\n", argv[1]);
+    // with sector checksums, scrub the chunks, repairing any sector found corrupt
+    if(raidGetChecksumPath() != NULL)
+    {
+        if(raidScrub(offsetSectors, (bytesWritten + SECTOR_SIZE - 1) / SECTOR_SIZE, TRUE, &scrub) == ERROR)
+        {
+            printf("scrub failed\n");
+            exit(-1);
+        }
 
-    printf("Enter chunk you have erased or 0 for none:");
-    fscanf(stdin, "%d", &chunkToRebuild);
-    printf("Got %d\n", chunkToRebuild);
+        printf("scrubbed %lld stripes with checksums in %s: %lld checksum errors, %lld XOR errors, "
+               "%lld repaired, %lld unrecoverable\n", scrub.stripes, raidGetChecksumPath(),
+               scrub.checksumErrors, scrub.parityErrors, scrub.repaired, scrub.unrecoverable);
+        for(idx=1; idx <= RAID_CHUNKS; idx++)
+            if(scrub.chunkErrors[idx - 1] > 0)
+                printf("  %lld corrupt sectors on %s\n", scrub.chunkErrors[idx - 1], raidGetChunkPath(idx));
+    }
+
+    // the chunk erased can be given on the command line to run without a prompt
+    if(numArgs < 3)
+    {
+        printf("Enter chunk you have erased or 0 for none:");
+        fscanf(stdin, "%d", &chunkToRebuild);
+        printf("Got %d\n", chunkToRebuild);
+    }
 
     if(chunkToRebuild > 0)
     {
-        printf("Will rebuild StripeChunk%1d.bin\n", chunkToRebuild);
+        printf("Will rebuild %s\n", raidGetChunkPath(chunkToRebuild));
         printf("working on restoring file ...\n");
 
-        // What is the meaning of the "0" argument here? 
-        bytesRestored=restoreFile(argv[2], 0, bytesWritten, chunkToRebuild); 
+        bytesRestored=restoreFile(arg[1], offsetSectors, bytesWritten, chunkToRebuild); 
     }
     else
     {
         printf("Nothing erased, so nothing to restore\n");
-        // What is the meaning of the first "0" argument and the second zero here? 
-        bytesRestored=restoreFile(argv[2], 0, bytesWritten, 0); 
+        // the second zero is for no chunk missing
+        bytesRestored=restoreFile(arg[1], offsetSectors, bytesWritten, 0); 
+    }
+
+    if(bytesRestored == ERROR)
+    {
+        printf("restoreFile to %s failed\n", arg[1]);
+        exit(-1);
     }
 
     printf("FINISHED\n");
@@ -0,0 +1,44 @@
+#ifndef _SEQCYCLIC_H
+#define _SEQCYCLIC_H
+
+// Static frame table for a cyclic executive
+//
+// Feasibility/feasibility_cyclic builds the table offline from a task set, choosing a minor
+// frame that meets the Baker-Shaw constraints and placing every job of the hyperperiod (the
+// major frame) in one minor frame.  The table is written either as a C header, to be compiled
+// into the program and given to seq_set_cyclic(), or as a binary file for seq_load_cyclic().
+// Either way SEQ_POLICY_CYCLIC then runs the services of each minor frame in turn, to
+// completion, from a single thread, with no priorities, semaphores or preemption among them.
+//
+// Binary file layout, all little endian as written by the host:
+//
+//   seqCyclicHeader_t
+//   uint64_t                 numServices periods in nanoseconds, in registration order
+//   seqCyclicFrame_t         numFrames of these, in frame order
+//   uint32_t                 numEntries service indexes, frame by frame
+//
+// This header only uses stdint.h so that tools outside sequencer_generic can include it.
+
+#include <stdint.h>
+
+#define SEQ_CYCLIC_MAGIC (0x43514553)   // "SEQC"
+#define SEQ_CYCLIC_VERSION (1)
+
+typedef struct seqCyclicHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numServices;
+    uint32_t numFrames;
+    uint32_t numEntries;
+    uint32_t reserved;
+    uint64_t frameNsec;                 // minor frame
+} seqCyclicHeader_t;
+
+typedef struct seqCyclicFrame
+{
+    uint32_t firstEntry;                // services run in this frame, in order, from the entry list
+    uint32_t numEntries;
+} seqCyclicFrame_t;
+
+#endif
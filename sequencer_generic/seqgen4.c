@@ -0,0 +1,227 @@
+// Sequencer Generic Demonstration using the seqlib service framework
+//
+// Same service set and rates as seqgen3.c, but the services are registered in a table with
+// seqlib.c rather than hand coded, and can be run either as SCHED_FIFO services released by
+// a sequencer or as SCHED_DEADLINE services with runtime derived from measured WCET.
+//
+// Usage: seqgen4 [fifo | deadline | cyclic] [sequence periods] [modechange] [trace=file] [table=file]
+//                [cputime] [affinity.csv]
+//
+// Sequencer - 100 Hz
+// Service_1 - 50 Hz, every other Sequencer loop
+// Service_2 - 20 Hz, every 5th Sequencer loop
+// Service_3 - 10 Hz, every 10th Sequencer loop
+// Service_4 -  5 Hz, every 20th Sequencer loop
+// Service_5 -  2 Hz, every 50th Sequencer loop
+// Service_6 -  1 Hz, every 100th Sequencer loop
+// Service_7 -  1 Hz, every 100th Sequencer loop
+//
+// In fifo mode priorities are assigned rate monotonic from the registered periods and services
+// are partitioned over the available cores by first-fit decreasing utilization, unless an
+// affinity file from Feasibility/feasibility_mp is given (see Feasibility/seqgen4.csv).
+//
+// With "modechange" in fifo mode, a low rate table is requested half way through the sequence
+// and takes effect at the next 1 second hyperperiod boundary.  Overrunning services skip missed
+// releases, except S6 which degrades to a lower rate if it keeps overrunning.
+//
+// While it runs, "seqtop" in another terminal shows live per-service counters, with execution
+// times in thread CPU time given "cputime".  With trace=file every job is recorded, in thread CPU
+// time, and written to the file at the end, for Feasibility/feasibility_trace.
+//
+// In cyclic mode there are no service threads: a cyclic executive runs the services from a frame
+// table of 50 minor frames of 20 msec, either the one compiled in from seqgen4_cyclic.h or one
+// loaded with table=file, both made by Feasibility/feasibility_cyclic from the seqgen4cyclic set
+// in Feasibility/seqgen4.csv.  Every job must fit in a frame beside the 50 Hz service, so S6 is
+// cut to 10 msec of load in this mode.
+//
+// The SCHED_DEADLINE mode needs root (or CAP_SYS_NICE) just like SCHED_FIFO.  With EDF the
+// set is schedulable up to the kernel RT bandwidth limit rather than the RM LUB, so the
+// synthetic loads below can be scaled up further with deadline than with fifo.
+
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <syslog.h>
+#include <sys/sysinfo.h>
+
+#include "seqlib.h"
+#include "seqgen4_cyclic.h"
+
+#define NANOSEC_PER_USEC (1000ULL)
+
+// default to 10 millisecond, 100 Hz
+#define SEQ_TICK_NSEC (10000000ULL)
+#define SEQ_PERIODS (2000)
+#define WCET_SAMPLES (20)
+
+typedef struct
+{
+    int serviceIdx;
+    unsigned long long loadUsec;
+} serviceLoad_t;
+
+// synthetic load for each service in microseconds of CPU time
+static serviceLoad_t serviceLoad[]=
+{
+    {1, 1000}, {2, 2000}, {3, 2000}, {4, 5000}, {5, 10000}, {6, 20000}, {7, 10000}
+};
+
+// S6 load in cyclic mode, short enough to share a 20 msec frame with S1
+#define CYCLIC_S6_LOAD_USEC (10000)
+
+// low rate mode, S1 to S3 at half rate and S7 off
+static const unsigned int lowRateTicks[]={4, 10, 20, 20, 50, 100, 0};
+
+
+// Spin for the requested amount of thread CPU time to emulate a service with a known WCET
+void Service_Load(void *serviceArg)
+{
+    serviceLoad_t *load=(serviceLoad_t *)serviceArg;
+    struct timespec now;
+    unsigned long long start, elapsed;
+
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+    start=(unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec;
+
+    do
+    {
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &now);
+        elapsed=((unsigned long long)now.tv_sec*1000000000ULL + now.tv_nsec) - start;
+    } while(elapsed < (load->loadUsec * NANOSEC_PER_USEC));
+}
+
+
+int main(int argc, char *argv[])
+{
+    seqConfig_t cfg;
+    seqPolicy_t policy=SEQ_POLICY_FIFO;
+    unsigned long long periods=SEQ_PERIODS;
+    int firstCpu, modeChange=FALSE, cpuTime=FALSE, i, rc;
+    char *affinityFile=NULL, *traceFile=NULL, *tableFile=NULL;
+    struct timespec halfway;
+
+    if((argc > 1) && (strcmp(argv[1], "deadline") == 0))
+        policy=SEQ_POLICY_DEADLINE;
+    else if((argc > 1) && (strcmp(argv[1], "cyclic") == 0))
+        policy=SEQ_POLICY_CYCLIC;
+
+    if(argc > 2)
+        sscanf(argv[2], "%llu", &periods);
+
+    for(i=3; i < argc; i++)
+    {
+        if(strcmp(argv[i], "modechange") == 0)
+            modeChange=TRUE;
+        else if(strncmp(argv[i], "trace=", 6) == 0)
+            traceFile=argv[i] + 6;
+        else if(strncmp(argv[i], "table=", 6) == 0)
+            tableFile=argv[i] + 6;
+        else if(strcmp(argv[i], "cputime") == 0)
+            cpuTime=TRUE;
+        else
+            affinityFile=argv[i];
+    }
+
+    printf("Starting Sequencer Framework Demo with %s policy for %llu periods\n",
+           (policy == SEQ_POLICY_DEADLINE) ? "SCHED_DEADLINE" : ((policy == SEQ_POLICY_CYCLIC) ? "cyclic executive" : "SCHED_FIFO"),
+           periods);
+
+    seq_init(&cfg, policy, SEQ_TICK_NSEC, periods);
+    cfg.threadCpuTime=cpuTime;
+
+    if(policy == SEQ_POLICY_CYCLIC)
+        serviceLoad[5].loadUsec=CYCLIC_S6_LOAD_USEC;
+
+    seq_add_service(&cfg, "S1-50Hz", Service_Load, &serviceLoad[0], 2, 0);
+    seq_add_service(&cfg, "S2-20Hz", Service_Load, &serviceLoad[1], 5, 0);
+    seq_add_service(&cfg, "S3-10Hz", Service_Load, &serviceLoad[2], 10, 0);
+    seq_add_service(&cfg, "S4-5Hz", Service_Load, &serviceLoad[3], 20, 0);
+    seq_add_service(&cfg, "S5-2Hz", Service_Load, &serviceLoad[4], 50, 0);
+    seq_add_service(&cfg, "S6-1Hz", Service_Load, &serviceLoad[5], 100, 0);
+    seq_add_service(&cfg, "S7-1Hz", Service_Load, &serviceLoad[6], 100, 0);
+
+    seq_set_overrun_policy(&cfg, 5, SEQ_OVERRUN_DEGRADE);
+    seq_add_mode(&cfg, "low-rate", lowRateTicks);
+
+    seq_measure_wcet(&cfg, WCET_SAMPLES);
+
+    if(policy == SEQ_POLICY_CYCLIC)
+    {
+        if(tableFile != NULL)
+            rc=seq_load_cyclic(&cfg, tableFile);
+        else
+            rc=seq_set_cyclic(&cfg, SEQ_CYCLIC_FRAME_NSEC, seqCyclicPeriodNsec, SEQ_CYCLIC_NUM_SERVICES,
+                              seqCyclicFrames, SEQ_CYCLIC_NUM_FRAMES, seqCyclicEntries, SEQ_CYCLIC_NUM_ENTRIES);
+
+        if(rc != SEQ_OK)
+        {
+            printf("Failed to set up the cyclic frame table\n");
+            exit(-1);
+        }
+    }
+
+    // RM priorities and core assignment, leaving core 0 to the kernel when there is more than
+    // one core, with the sequencer sharing the first service core
+    if(policy == SEQ_POLICY_FIFO)
+    {
+        firstCpu=(get_nprocs() > 1) ? 1 : 0;
+        cfg.seqCpu=firstCpu;
+
+        seq_assign_rm_priorities(&cfg);
+
+        if(affinityFile != NULL)
+        {
+            if(seq_load_affinity(&cfg, affinityFile, firstCpu) != SEQ_OK)
+            {
+                printf("Failed to load core assignment from %s\n", affinityFile);
+                exit(-1);
+            }
+        }
+        else if(seq_partition_ffd(&cfg, firstCpu, get_nprocs() - firstCpu) != SEQ_OK)
+        {
+            printf("Service set does not fit on available cores\n");
+            exit(-1);
+        }
+    }
+
+    if(seq_admission_test(&cfg) != SEQ_OK)
+    {
+        printf("Service set rejected by admission test\n");
+        exit(-1);
+    }
+
+    // live counters for seqtop, no printf or syslog from the services themselves
+    if(seq_telemetry_open(&cfg) != SEQ_OK)
+        printf("Telemetry not available, continuing without it\n");
+
+    // at most one job per service per sequencer tick
+    if((traceFile != NULL) && (seq_trace_open(&cfg, periods + 1) != SEQ_OK))
+        traceFile=NULL;
+
+    if(seq_start(&cfg) != SEQ_OK)
+    {
+        printf("Failed to start services, check for root privileges\n");
+        exit(-1);
+    }
+
+    if(modeChange && (policy == SEQ_POLICY_FIFO))
+    {
+        halfway.tv_sec=(periods * SEQ_TICK_NSEC / 2) / 1000000000ULL;
+        halfway.tv_nsec=(periods * SEQ_TICK_NSEC / 2) % 1000000000ULL;
+        nanosleep(&halfway, NULL);
+        seq_request_mode(&cfg, 1);
+    }
+
+    seq_join(&cfg);
+    seq_report(&cfg);
+    seq_telemetry_close(&cfg);
+
+    if((traceFile != NULL) && (seq_trace_write(&cfg, traceFile) == SEQ_OK))
+        printf("Job trace written to %s\n", traceFile);
+
+    printf("\nTEST COMPLETE\n");
+    return 0;
+}
@@ -0,0 +1,135 @@
+// Cyclic executive table for seqgen4cyclic, generated by Feasibility/feasibility_cyclic
+//
+// 50 minor frames of 20000000 nsec in the major frame, 89 jobs.  Give the tables to
+// seq_set_cyclic() with the services registered in the order of the task set file.
+
+#ifndef _SEQ_CYCLIC_TABLE_H
+#define _SEQ_CYCLIC_TABLE_H
+
+#include "seqcyclic.h"
+
+#define SEQ_CYCLIC_FRAME_NSEC (20000000ULL)
+#define SEQ_CYCLIC_NUM_SERVICES (7)
+#define SEQ_CYCLIC_NUM_FRAMES (50)
+#define SEQ_CYCLIC_NUM_ENTRIES (89)
+
+static const unsigned long long seqCyclicPeriodNsec[SEQ_CYCLIC_NUM_SERVICES]=
+{
+    20000000ULL,
+    50000000ULL,
+    100000000ULL,
+    200000000ULL,
+    500000000ULL,
+    1000000000ULL,
+    1000000000ULL
+};
+
+static const seqCyclicFrame_t seqCyclicFrames[SEQ_CYCLIC_NUM_FRAMES]=
+{
+    {0, 2},    // frame 0, load 11000000 nsec
+    {2, 2},    // frame 1, load 3000000 nsec
+    {4, 1},    // frame 2, load 1000000 nsec
+    {5, 2},    // frame 3, load 3000000 nsec
+    {7, 2},    // frame 4, load 3000000 nsec
+    {9, 2},    // frame 5, load 3000000 nsec
+    {11, 2},    // frame 6, load 3000000 nsec
+    {13, 1},    // frame 7, load 1000000 nsec
+    {14, 2},    // frame 8, load 3000000 nsec
+    {16, 2},    // frame 9, load 6000000 nsec
+    {18, 1},    // frame 10, load 1000000 nsec
+    {19, 2},    // frame 11, load 3000000 nsec
+    {21, 1},    // frame 12, load 1000000 nsec
+    {22, 2},    // frame 13, load 3000000 nsec
+    {24, 2},    // frame 14, load 3000000 nsec
+    {26, 2},    // frame 15, load 3000000 nsec
+    {28, 2},    // frame 16, load 3000000 nsec
+    {30, 1},    // frame 17, load 1000000 nsec
+    {31, 2},    // frame 18, load 3000000 nsec
+    {33, 2},    // frame 19, load 6000000 nsec
+    {35, 2},    // frame 20, load 3000000 nsec
+    {37, 2},    // frame 21, load 3000000 nsec
+    {39, 1},    // frame 22, load 1000000 nsec
+    {40, 2},    // frame 23, load 3000000 nsec
+    {42, 2},    // frame 24, load 11000000 nsec
+    {44, 2},    // frame 25, load 3000000 nsec
+    {46, 2},    // frame 26, load 3000000 nsec
+    {48, 2},    // frame 27, load 11000000 nsec
+    {50, 2},    // frame 28, load 3000000 nsec
+    {52, 2},    // frame 29, load 6000000 nsec
+    {54, 1},    // frame 30, load 1000000 nsec
+    {55, 2},    // frame 31, load 3000000 nsec
+    {57, 1},    // frame 32, load 1000000 nsec
+    {58, 2},    // frame 33, load 3000000 nsec
+    {60, 2},    // frame 34, load 3000000 nsec
+    {62, 2},    // frame 35, load 3000000 nsec
+    {64, 2},    // frame 36, load 3000000 nsec
+    {66, 1},    // frame 37, load 1000000 nsec
+    {67, 2},    // frame 38, load 3000000 nsec
+    {69, 2},    // frame 39, load 6000000 nsec
+    {71, 2},    // frame 40, load 6000000 nsec
+    {73, 2},    // frame 41, load 3000000 nsec
+    {75, 1},    // frame 42, load 1000000 nsec
+    {76, 2},    // frame 43, load 3000000 nsec
+    {78, 2},    // frame 44, load 3000000 nsec
+    {80, 2},    // frame 45, load 3000000 nsec
+    {82, 2},    // frame 46, load 3000000 nsec
+    {84, 1},    // frame 47, load 1000000 nsec
+    {85, 2},    // frame 48, load 3000000 nsec
+    {87, 2}     // frame 49, load 11000000 nsec
+};
+
+static const uint32_t seqCyclicEntries[SEQ_CYCLIC_NUM_ENTRIES]=
+{
+    0, 6,
+    0, 1,
+    0,
+    0, 1,
+    0, 2,
+    0, 2,
+    0, 1,
+    0,
+    0, 1,
+    0, 3,
+    0,
+    0, 1,
+    0,
+    0, 1,
+    0, 2,
+    0, 2,
+    0, 1,
+    0,
+    0, 1,
+    0, 3,
+    0, 2,
+    0, 1,
+    0,
+    0, 1,
+    0, 4,
+    0, 2,
+    0, 1,
+    0, 4,
+    0, 1,
+    0, 3,
+    0,
+    0, 1,
+    0,
+    0, 1,
+    0, 2,
+    0, 2,
+    0, 1,
+    0,
+    0, 1,
+    0, 3,
+    0, 3,
+    0, 1,
+    0,
+    0, 1,
+    0, 2,
+    0, 2,
+    0, 1,
+    0,
+    0, 1,
+    0, 5
+};
+
+#endif
@@ -0,0 +1,1586 @@
+// Sequencer service framework
+//
+// See seqlib.h for an overview.  The SCHED_FIFO path follows seqgen2.c (a sequencer thread using
+// clock_nanosleep, but with an absolute wake-up time so that it does not drift) and the
+// SCHED_DEADLINE path follows deadline/deadline.c.
+//
+// For SCHED_DEADLINE background:
+//
+// 1) https://www.kernel.org/doc/html/latest/scheduler/sched-deadline.html
+// 2) https://man7.org/linux/man-pages/man7/sched.7.html
+//
+// Note that the kernel only admits SCHED_DEADLINE threads whose affinity spans their whole root
+// domain, so the deadline services are scheduled by global EDF over all online cores unless
+// exclusive cpusets are set up by the administrator.  Per service affinity is therefore only
+// applied for SCHED_FIFO.
+
+// This is necessary for CPU affinity macros in Linux
+#define _GNU_SOURCE
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <stdint.h>
+#include <math.h>
+
+#include <pthread.h>
+#include <sched.h>
+#include <time.h>
+#include <semaphore.h>
+#include <signal.h>
+
+#include <syslog.h>
+#include <sys/syscall.h>
+#include <sys/sysinfo.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <errno.h>
+
+#include "seqlib.h"
+#include "seqtime.h"
+#include "seqtelem.h"
+#include "seqtrace.h"
+#include "seqcyclic.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+#define PPM (1000000ULL)
+
+// sanity limit on the frames and jobs of a cyclic table file
+#define SEQ_CYCLIC_MAX_ENTRIES (1U << 24)
+
+#define SEQ_SORT_PERIOD (0)
+#define SEQ_SORT_UTILIZATION (1)
+
+#ifndef SCHED_DEADLINE
+#define SCHED_DEADLINE (6)
+#endif
+
+#ifndef SCHED_FLAG_DL_OVERRUN
+#define SCHED_FLAG_DL_OVERRUN (0x04)
+#endif
+
+struct seq_sched_attr
+{
+    uint32_t size;
+    uint32_t sched_policy;
+    uint64_t sched_flags;
+    int32_t sched_nice;
+    uint32_t sched_priority;
+    uint64_t sched_runtime;
+    uint64_t sched_deadline;
+    uint64_t sched_period;
+};
+
+// SIGXCPU signals taken by the process, which the kernel may deliver to any of its threads
+static volatile unsigned long long seqThrottleSignals=0;
+
+
+// Publish a service's counters after a release, plain stores under the slot sequence lock
+static inline void seq_telem_publish(seqService_t *svc, unsigned long long periodNsec,
+                                     unsigned long long exec, unsigned long long response)
+{
+    seqTelemService_t *slot=svc->telemSlot;
+
+    if(slot == NULL) return;
+
+    seq_telem_write_begin(slot);
+    slot->periodNsec=periodNsec;
+    slot->releases=svc->releaseCnt;
+    slot->misses=svc->missCnt;
+    slot->overruns=svc->overrunCnt;
+    slot->skipped=svc->skipCnt;
+    slot->throttled=svc->throttleCnt;
+    slot->lastExecNsec=exec;
+    slot->maxExecNsec=svc->maxExecNsec;
+    slot->lastResponseNsec=response;
+    slot->maxResponseNsec=svc->maxResponseNsec;
+    seq_telem_write_end(slot);
+}
+
+
+// Record one job in the service's trace buffer, dropping it once the buffer is full
+static inline void seq_trace_record(seqService_t *svc, unsigned long long releaseNsec,
+                                    unsigned long long startNsec, unsigned long long endNsec,
+                                    unsigned long long execNsec)
+{
+    seqTraceJob_t *job;
+
+    if((svc->trace == NULL) || (svc->traceCnt >= svc->traceMax)) return;
+
+    job=&svc->trace[svc->traceCnt++];
+    job->releaseNsec=releaseNsec;
+    job->startNsec=startNsec;
+    job->endNsec=endNsec;
+    job->execNsec=execNsec;
+}
+
+
+static int seq_sched_setattr(pid_t pid, const struct seq_sched_attr *attr, unsigned int flags)
+{
+    return syscall(__NR_sched_setattr, pid, attr, flags);
+}
+
+
+static unsigned long long seq_clock_nsec(clockid_t clock)
+{
+    struct timespec ts;
+
+    clock_gettime(clock, &ts);
+    return ((unsigned long long)ts.tv_sec * NANOSEC_PER_SEC) + (unsigned long long)ts.tv_nsec;
+}
+
+
+// With SCHED_FLAG_DL_OVERRUN the kernel signals SIGXCPU each time a deadline thread exhausts
+// its runtime and is throttled until the next replenishment.  The signal goes to the process,
+// not the thread, so it is only counted here, and each service loop charges its own jobs that
+// ran past their runtime.
+static void seq_throttle_handler(int sig)
+{
+    (void)sig;
+
+    __atomic_add_fetch(&seqThrottleSignals, 1, __ATOMIC_RELAXED);
+}
+
+
+// Read the RT bandwidth limit the kernel applies to SCHED_DEADLINE admission in parts per million
+// of each core.  A runtime of -1 means no limit.
+static unsigned long long seq_rt_bandwidth_ppm(void)
+{
+    FILE *fp;
+    long long rtRuntime=950000, rtPeriod=1000000;
+
+    if((fp=fopen("/proc/sys/kernel/sched_rt_runtime_us", "r")) != NULL)
+    {
+        if(fscanf(fp, "%lld", &rtRuntime) != 1) rtRuntime=950000;
+        fclose(fp);
+    }
+
+    if((fp=fopen("/proc/sys/kernel/sched_rt_period_us", "r")) != NULL)
+    {
+        if(fscanf(fp, "%lld", &rtPeriod) != 1) rtPeriod=1000000;
+        fclose(fp);
+    }
+
+    if((rtRuntime < 0) || (rtPeriod <= 0))
+        return PPM;
+
+    return ((unsigned long long)rtRuntime * PPM) / (unsigned long long)rtPeriod;
+}
+
+
+unsigned long long seq_period_nsec(seqConfig_t *cfg, seqService_t *svc)
+{
+    return (unsigned long long)svc->periodTicks * cfg->tickNsec;
+}
+
+
+// Sort service indexes by increasing period (RM priority order) or decreasing utilization (FFD
+// order).  Insertion sort keeps registration order for ties and the tables are small.
+static void seq_sort_services(seqConfig_t *cfg, int order[], int sortKey)
+{
+    int i, j, tmp;
+    unsigned long long ui, uj;
+
+    for(i=0; i < cfg->numServices; i++)
+        order[i]=i;
+
+    for(i=1; i < cfg->numServices; i++)
+    {
+        for(j=i; j > 0; j--)
+        {
+            if(sortKey == SEQ_SORT_PERIOD)
+            {
+                // a service disabled by its mode, period 0, sorts last
+                if((cfg->service[order[j]].periodTicks == 0) ||
+                   ((cfg->service[order[j-1]].periodTicks > 0) &&
+                    (cfg->service[order[j-1]].periodTicks <= cfg->service[order[j]].periodTicks))) break;
+            }
+            else
+            {
+                ui=(cfg->service[order[j-1]].wcetNsec * PPM) / seq_period_nsec(cfg, &cfg->service[order[j-1]]);
+                uj=(cfg->service[order[j]].wcetNsec * PPM) / seq_period_nsec(cfg, &cfg->service[order[j]]);
+                if(ui >= uj) break;
+            }
+
+            tmp=order[j]; order[j]=order[j-1]; order[j-1]=tmp;
+        }
+    }
+}
+
+
+// Completion time test (Joseph and Pandya response time analysis, as in Feasibility/) for the
+// SCHED_FIFO services on one core, in integer nanoseconds.  The sequencer is included as the
+// highest priority service when it shares the core, since it runs at RT_MAX every tick.
+static int seq_core_rta(seqConfig_t *cfg, int cpu, int verbose)
+{
+    unsigned long long period[SEQ_MAX_SERVICES+1], wcet[SEQ_MAX_SERVICES+1];
+    unsigned long long rn, rnext;
+    int prio[SEQ_MAX_SERVICES+1], svcIdx[SEQ_MAX_SERVICES+1];
+    int i, j, n=0, tmp;
+    unsigned long long tmpT, tmpC;
+
+    if(cfg->seqCpu == cpu)
+    {
+        period[n]=cfg->tickNsec; wcet[n]=cfg->seqWcetNsec;
+        prio[n]=sched_get_priority_max(SCHED_FIFO); svcIdx[n]=-1;
+        n++;
+    }
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        if((cfg->service[i].cpu != cpu) || (cfg->service[i].periodTicks == 0)) continue;
+
+        period[n]=seq_period_nsec(cfg, &cfg->service[i]); wcet[n]=cfg->service[i].wcetNsec;
+        prio[n]=cfg->service[i].prio; svcIdx[n]=i;
+
+        // keep in decreasing priority order
+        for(j=n; (j > 0) && (prio[j-1] < prio[j]); j--)
+        {
+            tmpT=period[j]; period[j]=period[j-1]; period[j-1]=tmpT;
+            tmpC=wcet[j]; wcet[j]=wcet[j-1]; wcet[j-1]=tmpC;
+            tmp=prio[j]; prio[j]=prio[j-1]; prio[j-1]=tmp;
+            tmp=svcIdx[j]; svcIdx[j]=svcIdx[j-1]; svcIdx[j-1]=tmp;
+        }
+        n++;
+    }
+
+    for(i=0; i < n; i++)
+    {
+        rn=0;
+        for(j=0; j <= i; j++) rn+=wcet[j];
+
+        while(rn <= period[i])
+        {
+            rnext=wcet[i];
+            for(j=0; j < i; j++)
+                rnext+=((rn + period[j] - 1) / period[j]) * wcet[j];
+
+            if(rnext == rn) break;
+            rn=rnext;
+        }
+
+        if(verbose)
+            printf("  core %d %-12s prio=%d R=%llu nsec D=%llu nsec\n", cpu,
+                   (svcIdx[i] < 0) ? "Sequencer" : cfg->service[svcIdx[i]].name, prio[i], rn, period[i]);
+
+        if(rn > period[i])
+            return SEQ_ERROR;
+    }
+
+    return SEQ_OK;
+}
+
+
+void seq_init(seqConfig_t *cfg, seqPolicy_t policy, unsigned long long tickNsec, unsigned long long sequencePeriods)
+{
+    memset(cfg, 0, sizeof(seqConfig_t));
+
+    cfg->policy=policy;
+    cfg->tickNsec=tickNsec;
+    cfg->sequencePeriods=sequencePeriods;
+    cfg->runtimeMarginPct=SEQ_DL_RUNTIME_MARGIN_PCT;
+    cfg->seqWcetNsec=SEQ_SEQUENCER_WCET_NSEC;
+
+    // sequencer on core 1 as in seqgen3.c when there is more than one core
+    cfg->seqCpu=(get_nprocs() > 1) ? 1 : 0;
+
+    seq_time_calibrate();
+}
+
+
+int seq_add_service(seqConfig_t *cfg, const char *name, seqServiceFn_t serviceFn, void *serviceArg,
+                    unsigned int periodTicks, unsigned long long wcetNsec)
+{
+    seqService_t *svc;
+
+    if((cfg->numServices >= SEQ_MAX_SERVICES) || (periodTicks == 0) || (serviceFn == NULL))
+        return SEQ_ERROR;
+
+    svc=&cfg->service[cfg->numServices];
+    memset(svc, 0, sizeof(seqService_t));
+
+    svc->name=name;
+    svc->serviceFn=serviceFn;
+    svc->serviceArg=serviceArg;
+    svc->periodTicks=periodTicks;
+    svc->wcetNsec=wcetNsec;
+    svc->cpu=-1;
+
+    // registration order is priority order, highest first, one below the sequencer
+    svc->prio=sched_get_priority_max(SCHED_FIFO) - 1 - cfg->numServices;
+
+    return cfg->numServices++;
+}
+
+
+// Run each service work function samples times in the calling thread and keep the largest
+// execution time in thread CPU time, which is not inflated by preemption.  The deadline runtime
+// budget is then the WCET plus the configured margin.
+int seq_measure_wcet(seqConfig_t *cfg, int samples)
+{
+    int i, s;
+    unsigned long long start, exec, maxExec, periodNsec;
+    seqService_t *svc;
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        svc=&cfg->service[i];
+        maxExec=0;
+
+        for(s=0; s < samples; s++)
+        {
+            start=seq_clock_nsec(CLOCK_THREAD_CPUTIME_ID);
+            svc->serviceFn(svc->serviceArg);
+            exec=seq_clock_nsec(CLOCK_THREAD_CPUTIME_ID) - start;
+
+            if(exec > maxExec) maxExec=exec;
+        }
+
+        if(maxExec > svc->wcetNsec) svc->wcetNsec=maxExec;
+
+        periodNsec=seq_period_nsec(cfg, svc);
+        svc->runtimeNsec=(svc->wcetNsec * (100ULL + cfg->runtimeMarginPct)) / 100ULL;
+        if(svc->runtimeNsec < SEQ_DL_MIN_RUNTIME_NSEC) svc->runtimeNsec=SEQ_DL_MIN_RUNTIME_NSEC;
+        if(svc->runtimeNsec > periodNsec) svc->runtimeNsec=periodNsec;
+
+        printf("%s: measured WCET=%llu nsec over %d samples, runtime=%llu nsec, period=%llu nsec\n",
+               svc->name, maxExec, samples, svc->runtimeNsec, periodNsec);
+    }
+
+    return SEQ_OK;
+}
+
+
+// SEQ_POLICY_CYCLIC: every frame of the table must hold the declared or measured WCETs of its
+// services, the non-preemptive equivalent of a response time test
+static int seq_cyclic_admission(seqConfig_t *cfg)
+{
+    unsigned long long load, maxLoad=0;
+    unsigned int f, e;
+    int fullest=0;
+
+    if(cfg->numFrames == 0)
+    {
+        printf("ADMISSION FAIL: no cyclic frame table, see seq_set_cyclic()\n");
+        return SEQ_ERROR;
+    }
+
+    for(f=0; f < cfg->numFrames; f++)
+    {
+        for(e=cfg->frame[f].firstEntry, load=0; e < cfg->frame[f].firstEntry + cfg->frame[f].numEntries; e++)
+            load+=cfg->service[cfg->entry[e]].wcetNsec;
+
+        if(load > maxLoad)
+        {
+            maxLoad=load;
+            fullest=f;
+        }
+    }
+
+    printf("Cyclic executive admission: %u frames of %llu us, fullest frame %d at %llu us (%llu%%)\n",
+           cfg->numFrames, cfg->frameNsec/1000, fullest, maxLoad/1000, (maxLoad * 100) / cfg->frameNsec);
+
+    if(maxLoad > cfg->frameNsec)
+    {
+        printf("ADMISSION FAIL: frame %d overruns its %llu us\n", fullest, cfg->frameNsec/1000);
+        syslog(LOG_CRIT, "Cyclic executive admission failed, frame %d load %llu nsec\n", fullest, maxLoad);
+        return SEQ_ERROR;
+    }
+
+    return SEQ_OK;
+}
+
+
+// SCHED_DEADLINE: the same utilization test the kernel applies (sum of runtime/period within the
+// RT bandwidth of all cores), so an infeasible set is rejected before any thread is created,
+// plus the Goossens-Funk-Baruah global EDF test which, if passed, also guarantees no deadline
+// is missed with implicit deadlines.
+//
+// SCHED_FIFO: the RM least upper bound for each core, which is sufficient but not necessary,
+// so exceeding it is only reported.
+//
+// SEQ_POLICY_CYCLIC: the load of each frame of the table, see seq_cyclic_admission().
+int seq_admission_test(seqConfig_t *cfg)
+{
+    int i, c, n, ncpus=get_nprocs();
+    unsigned long long u, usum=0, umax=0, limit, gfb;
+    double lub;
+    seqService_t *svc;
+
+    if(cfg->policy == SEQ_POLICY_CYCLIC)
+        return seq_cyclic_admission(cfg);
+
+    if(cfg->policy == SEQ_POLICY_DEADLINE)
+    {
+        for(i=0; i < cfg->numServices; i++)
+        {
+            svc=&cfg->service[i];
+
+            if(svc->runtimeNsec == 0)
+                svc->runtimeNsec=(svc->wcetNsec > SEQ_DL_MIN_RUNTIME_NSEC) ? svc->wcetNsec : SEQ_DL_MIN_RUNTIME_NSEC;
+
+            if(svc->runtimeNsec > seq_period_nsec(cfg, svc))
+            {
+                printf("ADMISSION FAIL: %s runtime %llu > period %llu\n", svc->name, svc->runtimeNsec, seq_period_nsec(cfg, svc));
+                return SEQ_ERROR;
+            }
+
+            u=(svc->runtimeNsec * PPM) / seq_period_nsec(cfg, svc);
+            usum+=u;
+            if(u > umax) umax=u;
+        }
+
+        limit=(unsigned long long)ncpus * seq_rt_bandwidth_ppm();
+        gfb=((unsigned long long)ncpus * PPM) - ((unsigned long long)(ncpus-1) * umax);
+
+        printf("SCHED_DEADLINE admission: U=%llu.%06llu on %d cores, kernel limit=%llu.%06llu, GFB bound=%llu.%06llu\n",
+               usum/PPM, usum%PPM, ncpus, limit/PPM, limit%PPM, gfb/PPM, gfb%PPM);
+
+        if(usum > limit)
+        {
+            printf("ADMISSION FAIL: total bandwidth exceeds kernel limit\n");
+            syslog(LOG_CRIT, "SCHED_DEADLINE admission failed U=%llu ppm limit=%llu ppm\n", usum, limit);
+            return SEQ_ERROR;
+        }
+
+        if(usum > gfb)
+            printf("WARNING: admitted, but above GFB bound so only bounded tardiness is guaranteed\n");
+
+        return SEQ_OK;
+    }
+
+    // SCHED_FIFO, check each core used (-1 is treated as one shared core)
+    for(c=-1; c < ncpus; c++)
+    {
+        usum=0; n=0;
+
+        for(i=0; i < cfg->numServices; i++)
+        {
+            svc=&cfg->service[i];
+            if((svc->cpu != c) || (svc->periodTicks == 0)) continue;
+
+            usum+=(svc->wcetNsec * PPM) / seq_period_nsec(cfg, svc);
+            n++;
+        }
+
+        if(n == 0) continue;
+
+        lub=(double)n * (pow(2.0, 1.0/(double)n) - 1.0);
+        printf("SCHED_FIFO core %d: %d services U=%llu.%06llu, RM LUB=%lf %s\n",
+               c, n, usum/PPM, usum%PPM, lub, ((double)usum/(double)PPM <= lub) ? "FEASIBLE" : "ABOVE LUB");
+
+        if(seq_core_rta(cfg, c, TRUE) != SEQ_OK)
+        {
+            printf("ADMISSION FAIL: core %d fails response time test\n", c);
+            syslog(LOG_CRIT, "SCHED_FIFO admission failed on core %d\n", c);
+            return SEQ_ERROR;
+        }
+    }
+
+    return SEQ_OK;
+}
+
+
+// Rate monotonic priorities: the shortest period gets RT_MAX-1 just below the sequencer and each
+// longer period the next lower priority.  Services with equal periods keep registration order.
+int seq_assign_rm_priorities(seqConfig_t *cfg)
+{
+    int order[SEQ_MAX_SERVICES];
+    int i, rt_max_prio=sched_get_priority_max(SCHED_FIFO), rt_min_prio=sched_get_priority_min(SCHED_FIFO);
+
+    seq_sort_services(cfg, order, SEQ_SORT_PERIOD);
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        cfg->service[order[i]].prio=rt_max_prio - 1 - i;
+        if(cfg->service[order[i]].prio < rt_min_prio)
+            cfg->service[order[i]].prio=rt_min_prio;
+    }
+
+    return SEQ_OK;
+}
+
+
+// First-fit decreasing partitioning: services are taken in order of decreasing utilization and
+// placed on the first core, from firstCpu to firstCpu+numCpus-1, on which the response time test
+// still passes for every service on that core.  RM priorities must already be assigned.
+int seq_partition_ffd(seqConfig_t *cfg, int firstCpu, int numCpus)
+{
+    int order[SEQ_MAX_SERVICES];
+    int i, c, placed;
+    seqService_t *svc;
+
+    for(i=0; i < cfg->numServices; i++)
+        cfg->service[i].cpu=SEQ_CPU_UNASSIGNED;
+
+    seq_sort_services(cfg, order, SEQ_SORT_UTILIZATION);
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        svc=&cfg->service[order[i]];
+        placed=FALSE;
+
+        for(c=firstCpu; c < (firstCpu + numCpus); c++)
+        {
+            svc->cpu=c;
+
+            if(seq_core_rta(cfg, c, FALSE) == SEQ_OK)
+            {
+                placed=TRUE;
+                break;
+            }
+        }
+
+        if(!placed)
+        {
+            svc->cpu=SEQ_CPU_UNASSIGNED;
+            printf("PARTITION FAIL: %s does not fit on cores %d to %d\n", svc->name, firstCpu, firstCpu+numCpus-1);
+            return SEQ_ERROR;
+        }
+    }
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        svc=&cfg->service[i];
+        printf("%s: period=%llu nsec, WCET=%llu nsec, RM prio=%d, core=%d\n",
+               svc->name, seq_period_nsec(cfg, svc), svc->wcetNsec, svc->prio, svc->cpu);
+    }
+
+    return SEQ_OK;
+}
+
+
+// Core assignment from an affinity file written by Feasibility/feasibility_mp, one line per
+// service in registration order as "service,period,wcet,core".  Cores in the file are numbered
+// from 0 and are placed starting at firstCpu, and core -1 leaves the service free to run on any
+// core.  Lines starting with # and the header line are skipped.
+int seq_load_affinity(seqConfig_t *cfg, const char *fileName, int firstCpu)
+{
+    FILE *fp;
+    char line[256];
+    int idx, core, lineNum=0, ncpus=get_nprocs();
+    unsigned int period, wcet;
+    seqService_t *svc;
+
+    if((fp=fopen(fileName, "r")) == NULL)
+    {
+        perror(fileName);
+        return SEQ_ERROR;
+    }
+
+    while(fgets(line, sizeof(line), fp) != NULL)
+    {
+        lineNum++;
+
+        if((line[0] == '#') || (strncmp(line, "service", 7) == 0))
+            continue;
+
+        if(sscanf(line, "%d,%u,%u,%d", &idx, &period, &wcet, &core) != 4)
+            continue;
+
+        if((idx < 0) || (idx >= cfg->numServices) || ((core >= 0) && (firstCpu + core >= ncpus)))
+        {
+            printf("%s:%d: service %d core %d is not available\n", fileName, lineNum, idx, core);
+            fclose(fp);
+            return SEQ_ERROR;
+        }
+
+        svc=&cfg->service[idx];
+        svc->cpu=(core < 0) ? -1 : (firstCpu + core);
+        printf("%s: core=%d from %s\n", svc->name, svc->cpu, fileName);
+    }
+
+    fclose(fp);
+    return SEQ_OK;
+}
+
+
+// Execution time of a job, from seq_job_cpu_start() before the work function and its start and
+// completion counter reads.  Thread CPU time leaves out preemption by higher priority services
+// on the same core, but is two clock_gettime() system calls a job, so it is only taken when
+// svc->threadCpuTime asks for it and otherwise the job is timed start to completion.
+static inline unsigned long long seq_job_cpu_start(seqService_t *svc)
+{
+    return svc->threadCpuTime ? seq_clock_nsec(CLOCK_THREAD_CPUTIME_ID) : 0;
+}
+
+
+static inline unsigned long long seq_job_exec(seqService_t *svc, unsigned long long cpuStart,
+                                              unsigned long long start, unsigned long long end)
+{
+    if(svc->threadCpuTime)
+        return seq_clock_nsec(CLOCK_THREAD_CPUTIME_ID) - cpuStart;
+
+    return seq_time_to_nsec(end) - seq_time_to_nsec(start);
+}
+
+
+// The sequencer publishes each release as a pair, the sequence number and the counter value it
+// was released at, under a per-service seqlock.  A reader that overlaps the update, or reads a
+// 64-bit field torn in two halves on a 32-bit target, sees the lock count change and retries.
+// The sequencer is the only writer and runs at RT_MAX, so a retry never waits long.
+static void seq_release_publish(seqService_t *svc, unsigned long long now)
+{
+    __atomic_add_fetch(&svc->releaseLock, 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    svc->lastReleaseTicks=now;
+    svc->releaseSeq++;
+    __atomic_add_fetch(&svc->releaseLock, 1, __ATOMIC_RELEASE);
+}
+
+
+static unsigned long long seq_release_read(seqService_t *svc, unsigned long long *releaseTicks)
+{
+    unsigned int lock;
+    unsigned long long seq;
+
+    do
+    {
+        while((lock=__atomic_load_n(&svc->releaseLock, __ATOMIC_ACQUIRE)) & 1);
+        seq=svc->releaseSeq;
+        *releaseTicks=svc->lastReleaseTicks;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+    } while(__atomic_load_n(&svc->releaseLock, __ATOMIC_RELAXED) != lock);
+
+    return seq;
+}
+
+
+static void *seq_fifo_service(void *threadp)
+{
+    seqService_t *svc=(seqService_t *)threadp;
+    unsigned long long start, end, cpuStart, exec, response, latest, pending, releaseTicks, releaseNsec, periodNsec;
+
+    while(!svc->abort)
+    {
+        // wait for release from the sequencer
+        sem_wait(&svc->sem);
+        if(svc->abort) break;
+
+        latest=seq_release_read(svc, &releaseTicks);
+        releaseNsec=seq_time_to_nsec(releaseTicks);
+        periodNsec=svc->periodNsec * svc->rateDivider;
+        pending=latest - svc->handledSeq;
+
+        // already handled by an earlier skip which consumed this release
+        if(pending == 0) continue;
+
+        if(pending > 1)
+        {
+            svc->overrunCnt++;
+            svc->overrunRun++;
+            svc->onTimeRun=0;
+
+            if(svc->overrunPolicy == SEQ_OVERRUN_CATCHUP)
+            {
+                // handle the oldest pending release, the semaphore count holds the rest
+                svc->handledSeq++;
+                releaseNsec-=(latest - svc->handledSeq) * periodNsec;
+            }
+            else
+            {
+                // drop the missed releases and their semaphore counts, re-reading the
+                // sequence number after draining so a release posted meanwhile is not lost
+                while(sem_trywait(&svc->sem) == 0);
+                latest=seq_release_read(svc, &releaseTicks);
+                releaseNsec=seq_time_to_nsec(releaseTicks);
+
+                svc->skipCnt+=(latest - svc->handledSeq - 1);
+                svc->handledSeq=latest;
+            }
+
+            if((svc->overrunPolicy == SEQ_OVERRUN_DEGRADE) && (svc->overrunRun >= SEQ_DEGRADE_OVERRUN_RELEASES) &&
+               (svc->rateDivider < SEQ_MAX_RATE_DIVIDER))
+            {
+                svc->rateDivider*=2;
+                svc->overrunRun=0;
+                syslog(LOG_CRIT, "%s degraded to 1/%u rate\n", svc->name, svc->rateDivider);
+            }
+        }
+        else
+        {
+            svc->handledSeq=latest;
+            svc->overrunRun=0;
+            svc->onTimeRun++;
+
+            if((svc->rateDivider > 1) && (svc->onTimeRun >= SEQ_DEGRADE_RECOVER_RELEASES))
+            {
+                svc->rateDivider/=2;
+                svc->onTimeRun=0;
+                syslog(LOG_CRIT, "%s restored to 1/%u rate\n", svc->name, svc->rateDivider);
+            }
+        }
+
+        svc->releaseCnt++;
+
+        start=seq_time_read();
+        cpuStart=seq_job_cpu_start(svc);
+        svc->serviceFn(svc->serviceArg);
+        end=seq_time_read();
+        exec=seq_job_exec(svc, cpuStart, start, end);
+
+        response=seq_time_to_nsec(end) - releaseNsec;
+
+        if(exec > svc->maxExecNsec) svc->maxExecNsec=exec;
+        if(response > svc->maxResponseNsec) svc->maxResponseNsec=response;
+        if(response > periodNsec) svc->missCnt++;
+
+        seq_telem_publish(svc, periodNsec, exec, response);
+        seq_trace_record(svc, releaseNsec, seq_time_to_nsec(start), seq_time_to_nsec(end), exec);
+    }
+
+    pthread_exit((void *)0);
+}
+
+
+static void *seq_deadline_service(void *threadp)
+{
+    seqService_t *svc=(seqService_t *)threadp;
+    struct seq_sched_attr attr;
+    unsigned long long firstRelease, release, start, end, cpuStart, exec, response;
+
+    memset(&attr, 0, sizeof(attr));
+    attr.size=sizeof(attr);
+    attr.sched_policy=SCHED_DEADLINE;
+    attr.sched_flags=SCHED_FLAG_DL_OVERRUN;
+    attr.sched_runtime=svc->runtimeNsec;
+    attr.sched_deadline=svc->periodNsec;
+    attr.sched_period=svc->periodNsec;
+
+    if(seq_sched_setattr(0, &attr, 0) < 0)
+    {
+        perror("sched_setattr SCHED_DEADLINE");
+        syslog(LOG_CRIT, "%s sched_setattr SCHED_DEADLINE failed\n", svc->name);
+        pthread_exit((void *)-1);
+    }
+
+    firstRelease=seq_time_now_nsec();
+
+    while(!svc->abort)
+    {
+        // give up the rest of this period's runtime, the kernel wakes the thread at the
+        // next replenishment, which is the next release
+        sched_yield();
+        if(svc->abort) break;
+
+        start=seq_time_read();
+        release=seq_time_to_nsec(start);
+        release=firstRelease + (((release - firstRelease) / svc->periodNsec) * svc->periodNsec);
+
+        svc->releaseCnt++;
+
+        cpuStart=seq_job_cpu_start(svc);
+        svc->serviceFn(svc->serviceArg);
+        end=seq_time_read();
+        exec=seq_job_exec(svc, cpuStart, start, end);
+
+        response=seq_time_to_nsec(end) - release;
+
+        if(exec > svc->maxExecNsec) svc->maxExecNsec=exec;
+        if(response > svc->maxResponseNsec) svc->maxResponseNsec=response;
+        if(response > svc->periodNsec) svc->missCnt++;
+
+        // a job that ran past its runtime was throttled by the kernel for the rest of the period
+        if(exec > svc->runtimeNsec) svc->throttleCnt++;
+
+        seq_telem_publish(svc, svc->periodNsec, exec, response);
+        seq_trace_record(svc, release, seq_time_to_nsec(start), seq_time_to_nsec(end), exec);
+    }
+
+    pthread_exit((void *)0);
+}
+
+
+static unsigned long long seq_gcd(unsigned long long a, unsigned long long b)
+{
+    unsigned long long t;
+
+    while(b != 0)
+    {
+        t=a % b; a=b; b=t;
+    }
+
+    return a;
+}
+
+
+// LCM of the enabled service periods in ticks
+static unsigned long long seq_hyperperiod_ticks(seqConfig_t *cfg)
+{
+    unsigned long long h=1;
+    int i;
+
+    for(i=0; i < cfg->numServices; i++)
+        if(cfg->service[i].periodTicks > 0)
+            h=(h / seq_gcd(h, cfg->service[i].periodTicks)) * cfg->service[i].periodTicks;
+
+    return h;
+}
+
+
+// Switch to the requested rate table and the RM priorities it was admitted with.  Called by the
+// sequencer at a hyperperiod boundary of the current mode, before any release for that tick, so
+// every service starts its new rate in phase with the new mode.
+static void seq_apply_mode(seqConfig_t *cfg)
+{
+    seqMode_t *mode=&cfg->mode[cfg->requestedMode];
+    struct sched_param param;
+    int i;
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        cfg->service[i].periodTicks=mode->periodTicks[i];
+        cfg->service[i].periodNsec=(unsigned long long)mode->periodTicks[i] * cfg->tickNsec;
+        cfg->service[i].rateDivider=1;
+
+        if(cfg->service[i].prio != mode->prio[i])
+        {
+            cfg->service[i].prio=mode->prio[i];
+            param.sched_priority=mode->prio[i];
+            pthread_setschedparam(cfg->service[i].thread, SCHED_FIFO, &param);
+        }
+    }
+
+    cfg->currentMode=cfg->requestedMode;
+    if(cfg->telem != NULL) cfg->telem->currentMode=cfg->currentMode;
+    cfg->modeStartCnt=cfg->seqCnt;
+    cfg->hyperperiodTicks=seq_hyperperiod_ticks(cfg);
+
+    syslog(LOG_CRIT, "Sequencer mode change to %s at cycle %llu, hyperperiod %llu ticks\n",
+           mode->name, cfg->seqCnt, cfg->hyperperiodTicks);
+}
+
+
+static void *seq_sequencer(void *threadp)
+{
+    seqConfig_t *cfg=(seqConfig_t *)threadp;
+    struct timespec nextTick;
+    unsigned long long now, modeCnt;
+    unsigned int divisor;
+    int i, rc;
+    seqService_t *svc;
+
+    clock_gettime(CLOCK_MONOTONIC, &nextTick);
+    syslog(LOG_CRIT, "Sequencer thread on core %d\n", sched_getcpu());
+
+    while(!cfg->abortTest && (cfg->seqCnt < cfg->sequencePeriods))
+    {
+        // absolute wake-up time so that the latency of each release does not accumulate
+        nextTick.tv_nsec+=cfg->tickNsec;
+        while(nextTick.tv_nsec >= (long)NANOSEC_PER_SEC)
+        {
+            nextTick.tv_nsec-=NANOSEC_PER_SEC;
+            nextTick.tv_sec++;
+        }
+
+        // a signal, e.g. SIGXCPU from a throttled deadline service, only interrupts the sleep, so
+        // sleep again to the same tick rather than skipping it
+        while((rc=clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextTick, NULL)) == EINTR);
+        if(rc != 0)
+        {
+            printf("Sequencer clock_nanosleep failed %d\n", rc);
+            break;
+        }
+
+        cfg->seqCnt++;
+        if(cfg->telem != NULL) __atomic_store_n(&cfg->telem->seqCnt, cfg->seqCnt, __ATOMIC_RELAXED);
+        now=seq_time_read();
+
+        // mode changes only on a hyperperiod boundary of the current mode
+        if((cfg->requestedMode != cfg->currentMode) &&
+           (((cfg->seqCnt - cfg->modeStartCnt) % cfg->hyperperiodTicks) == 0))
+            seq_apply_mode(cfg);
+
+        modeCnt=cfg->seqCnt - cfg->modeStartCnt;
+
+        // release each service at a sub-rate of the sequencer rate
+        for(i=0; i < cfg->numServices; i++)
+        {
+            svc=&cfg->service[i];
+            divisor=svc->periodTicks * svc->rateDivider;
+
+            if((divisor > 0) && ((modeCnt % divisor) == 0))
+            {
+                seq_release_publish(svc, now);
+                sem_post(&svc->sem);
+            }
+        }
+    }
+
+    pthread_exit((void *)0);
+}
+
+
+// Cyclic executive: at each minor frame boundary run the services the table places in that frame
+// to completion, in table order.  A job's release is the start of the period it belongs to,
+// which is the scheduled frame start less the offset of the frame into the period, so a late
+// wake-up counts against the response time.  A frame that runs past the next boundary is
+// counted, and the next frame starts late rather than being skipped.
+static void *seq_cyclic_executive(void *threadp)
+{
+    seqConfig_t *cfg=(seqConfig_t *)threadp;
+    struct timespec nextFrame;
+    unsigned long long totalFrames, frameDueNsec, offsetNsec, releaseNsec, start, end, cpuStart, exec, response;
+    unsigned int f, e;
+    int rc;
+    seqService_t *svc;
+
+    totalFrames=(cfg->sequencePeriods * cfg->tickNsec) / cfg->frameNsec;
+
+    // the frame boundaries on the seq_time_read() timebase, to go with the CLOCK_MONOTONIC ones
+    clock_gettime(CLOCK_MONOTONIC, &nextFrame);
+    frameDueNsec=seq_time_now_nsec();
+    syslog(LOG_CRIT, "Cyclic executive on core %d, %u frames of %llu nsec\n", sched_getcpu(), cfg->numFrames,
+           cfg->frameNsec);
+
+    while(!cfg->abortTest && (cfg->frameCnt < totalFrames))
+    {
+        nextFrame.tv_sec+=cfg->frameNsec / NANOSEC_PER_SEC;
+        nextFrame.tv_nsec+=cfg->frameNsec % NANOSEC_PER_SEC;
+        if(nextFrame.tv_nsec >= (long)NANOSEC_PER_SEC)
+        {
+            nextFrame.tv_nsec-=NANOSEC_PER_SEC;
+            nextFrame.tv_sec++;
+        }
+        frameDueNsec+=cfg->frameNsec;
+
+        // as in seq_sequencer(), a signal only interrupts the sleep, so sleep again to the same frame
+        while((rc=clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &nextFrame, NULL)) == EINTR);
+        if(rc != 0)
+        {
+            printf("Cyclic executive clock_nanosleep failed %d\n", rc);
+            break;
+        }
+
+        f=(unsigned int)(cfg->frameCnt % cfg->numFrames);
+        offsetNsec=(unsigned long long)f * cfg->frameNsec;
+
+        for(e=cfg->frame[f].firstEntry; e < cfg->frame[f].firstEntry + cfg->frame[f].numEntries; e++)
+        {
+            svc=&cfg->service[cfg->entry[e]];
+            releaseNsec=frameDueNsec - (offsetNsec % svc->periodNsec);
+
+            svc->releaseCnt++;
+
+            start=seq_time_read();
+            cpuStart=seq_job_cpu_start(svc);
+            svc->serviceFn(svc->serviceArg);
+            end=seq_time_read();
+            exec=seq_job_exec(svc, cpuStart, start, end);
+
+            response=seq_time_to_nsec(end) - releaseNsec;
+
+            if(exec > svc->maxExecNsec) svc->maxExecNsec=exec;
+            if(response > svc->maxResponseNsec) svc->maxResponseNsec=response;
+            if(response > svc->periodNsec) svc->missCnt++;
+
+            seq_telem_publish(svc, svc->periodNsec, exec, response);
+            seq_trace_record(svc, releaseNsec, seq_time_to_nsec(start), seq_time_to_nsec(end), exec);
+        }
+
+        if(seq_time_now_nsec() - frameDueNsec > cfg->frameNsec)
+            cfg->frameOverrunCnt++;
+
+        cfg->frameCnt++;
+        cfg->seqCnt=(cfg->frameCnt * cfg->frameNsec) / cfg->tickNsec;
+        if(cfg->telem != NULL) __atomic_store_n(&cfg->telem->seqCnt, cfg->seqCnt, __ATOMIC_RELAXED);
+    }
+
+    pthread_exit((void *)0);
+}
+
+
+static void seq_cyclic_free(seqConfig_t *cfg)
+{
+    free(cfg->frame);
+    free(cfg->entry);
+    cfg->frame=NULL;
+    cfg->entry=NULL;
+    cfg->numFrames=0;
+    cfg->numEntries=0;
+}
+
+
+// Install a frame table for SEQ_POLICY_CYCLIC, e.g. the arrays of a header from
+// Feasibility/feasibility_cyclic.  The table must have been built for the registered services:
+// the same number, in the same order, with the same periods, and every job of the major frame
+// exactly once.  The table is copied, so the arrays may be freed after the call.
+int seq_set_cyclic(seqConfig_t *cfg, unsigned long long frameNsec, const unsigned long long periodNsec[],
+                   int numServices, const struct seqCyclicFrame *frame, unsigned int numFrames,
+                   const unsigned int entry[], unsigned int numEntries)
+{
+    unsigned long long majorNsec, jobs[SEQ_MAX_SERVICES];
+    unsigned int f, e;
+    int i;
+
+    if((numServices != cfg->numServices) || (frameNsec == 0) || (numFrames == 0))
+    {
+        printf("Cyclic table is for %d services, %d are registered\n", numServices, cfg->numServices);
+        return SEQ_ERROR;
+    }
+
+    majorNsec=frameNsec * numFrames;
+
+    for(i=0; i < numServices; i++)
+    {
+        jobs[i]=0;
+
+        if((periodNsec[i] != seq_period_nsec(cfg, &cfg->service[i])) || ((majorNsec % periodNsec[i]) != 0))
+        {
+            printf("Cyclic table period of %s is %llu nsec, registered with %llu nsec\n", cfg->service[i].name,
+                   periodNsec[i], seq_period_nsec(cfg, &cfg->service[i]));
+            return SEQ_ERROR;
+        }
+    }
+
+    for(f=0; f < numFrames; f++)
+    {
+        if((frame[f].firstEntry > numEntries) || (frame[f].numEntries > numEntries - frame[f].firstEntry))
+        {
+            printf("Cyclic table frame %u is outside the entry list\n", f);
+            return SEQ_ERROR;
+        }
+
+        for(e=frame[f].firstEntry; e < frame[f].firstEntry + frame[f].numEntries; e++)
+        {
+            if(entry[e] >= (unsigned int)numServices)
+            {
+                printf("Cyclic table frame %u has service %u of %d\n", f, entry[e], numServices);
+                return SEQ_ERROR;
+            }
+
+            jobs[entry[e]]++;
+        }
+    }
+
+    for(i=0; i < numServices; i++)
+    {
+        if(jobs[i] != majorNsec / periodNsec[i])
+        {
+            printf("Cyclic table runs %s %llu times in the major frame rather than %llu\n", cfg->service[i].name,
+                   jobs[i], majorNsec / periodNsec[i]);
+            return SEQ_ERROR;
+        }
+    }
+
+    seq_cyclic_free(cfg);
+
+    cfg->frame=malloc(numFrames * sizeof(seqCyclicFrame_t));
+    cfg->entry=malloc((numEntries + 1) * sizeof(unsigned int));
+
+    if((cfg->frame == NULL) || (cfg->entry == NULL))
+    {
+        perror("malloc cyclic table");
+        seq_cyclic_free(cfg);
+        return SEQ_ERROR;
+    }
+
+    memcpy(cfg->frame, frame, numFrames * sizeof(seqCyclicFrame_t));
+    memcpy(cfg->entry, entry, numEntries * sizeof(unsigned int));
+
+    cfg->frameNsec=frameNsec;
+    cfg->numFrames=numFrames;
+    cfg->numEntries=numEntries;
+
+    printf("Cyclic table: %u frames of %llu us, %u jobs in the %llu us major frame\n", numFrames, frameNsec/1000,
+           numEntries, majorNsec/1000);
+
+    return SEQ_OK;
+}
+
+
+// Load a binary frame table written by Feasibility/feasibility_cyclic -b, see seqcyclic.h
+int seq_load_cyclic(seqConfig_t *cfg, const char *fileName)
+{
+    FILE *fp;
+    seqCyclicHeader_t header;
+    seqCyclicFrame_t *frame=NULL;
+    uint32_t *entry=NULL;
+    uint64_t period;
+    unsigned long long periodNsec[SEQ_MAX_SERVICES];
+    unsigned int i;
+    int rc=SEQ_OK;
+
+    if((fp=fopen(fileName, "rb")) == NULL)
+    {
+        perror(fileName);
+        return SEQ_ERROR;
+    }
+
+    if((fread(&header, sizeof(header), 1, fp) != 1) || (header.magic != SEQ_CYCLIC_MAGIC) ||
+       (header.version != SEQ_CYCLIC_VERSION) || (header.numServices > SEQ_MAX_SERVICES) ||
+       (header.numFrames == 0) || (header.numEntries > SEQ_CYCLIC_MAX_ENTRIES) ||
+       (header.numFrames > SEQ_CYCLIC_MAX_ENTRIES))
+    {
+        printf("%s is not a cyclic frame table\n", fileName);
+        rc=SEQ_ERROR;
+    }
+
+    for(i=0; (rc == SEQ_OK) && (i < header.numServices); i++)
+    {
+        if(fread(&period, sizeof(period), 1, fp) != 1)
+            rc=SEQ_ERROR;
+        periodNsec[i]=period;
+    }
+
+    if(rc == SEQ_OK)
+    {
+        frame=malloc(header.numFrames * sizeof(seqCyclicFrame_t));
+        entry=malloc((header.numEntries + 1) * sizeof(uint32_t));
+
+        if((frame == NULL) || (entry == NULL) ||
+           (fread(frame, sizeof(seqCyclicFrame_t), header.numFrames, fp) != header.numFrames) ||
+           (fread(entry, sizeof(uint32_t), header.numEntries, fp) != header.numEntries))
+        {
+            printf("Failed to read cyclic table %s\n", fileName);
+            rc=SEQ_ERROR;
+        }
+    }
+
+    fclose(fp);
+
+    if(rc == SEQ_OK)
+        rc=seq_set_cyclic(cfg, header.frameNsec, periodNsec, header.numServices, frame, header.numFrames,
+                          entry, header.numEntries);
+
+    free(frame);
+    free(entry);
+
+    return rc;
+}
+
+
+int seq_set_overrun_policy(seqConfig_t *cfg, int serviceIdx, seqOverrunPolicy_t policy)
+{
+    if((serviceIdx < 0) || (serviceIdx >= cfg->numServices))
+        return SEQ_ERROR;
+
+    cfg->service[serviceIdx].overrunPolicy=policy;
+    return SEQ_OK;
+}
+
+
+// Register an alternate rate table, returns the mode index.  Mode 0 is the rate table the
+// services were registered with.
+int seq_add_mode(seqConfig_t *cfg, const char *name, const unsigned int periodTicks[])
+{
+    int i;
+
+    if(cfg->numModes == 0)
+    {
+        cfg->mode[0].name="initial";
+        for(i=0; i < cfg->numServices; i++)
+            cfg->mode[0].periodTicks[i]=cfg->service[i].periodTicks;
+        cfg->numModes=1;
+    }
+
+    if(cfg->numModes >= SEQ_MAX_MODES)
+        return SEQ_ERROR;
+
+    cfg->mode[cfg->numModes].name=name;
+    for(i=0; i < cfg->numServices; i++)
+        cfg->mode[cfg->numModes].periodTicks[i]=periodTicks[i];
+
+    return cfg->numModes++;
+}
+
+
+// Admit the rate table before accepting the request: RM priorities are assigned for its periods
+// and the same admission test as at start-up is run, on a copy of the configuration so that
+// the running services and the sequencer are not touched.  A table that fails is refused and
+// the current mode kept.
+int seq_request_mode(seqConfig_t *cfg, int modeIdx)
+{
+    seqConfig_t *trial;
+    int i, rc;
+
+    if((cfg->policy != SEQ_POLICY_FIFO) || (modeIdx < 0) || (modeIdx >= cfg->numModes))
+        return SEQ_ERROR;
+
+    if((trial=malloc(sizeof(seqConfig_t))) == NULL)
+        return SEQ_ERROR;
+
+    memcpy(trial, cfg, sizeof(seqConfig_t));
+    for(i=0; i < cfg->numServices; i++)
+        trial->service[i].periodTicks=cfg->mode[modeIdx].periodTicks[i];
+
+    seq_assign_rm_priorities(trial);
+    rc=seq_admission_test(trial);
+
+    if(rc == SEQ_OK)
+    {
+        for(i=0; i < cfg->numServices; i++)
+            cfg->mode[modeIdx].prio[i]=trial->service[i].prio;
+    }
+
+    free(trial);
+
+    if(rc != SEQ_OK)
+    {
+        syslog(LOG_CRIT, "Sequencer mode %s refused by admission test, staying in %s\n",
+               cfg->mode[modeIdx].name, cfg->mode[cfg->currentMode].name);
+        return SEQ_ERROR;
+    }
+
+    cfg->requestedMode=modeIdx;
+    syslog(LOG_CRIT, "Sequencer mode change to %s requested at cycle %llu\n", cfg->mode[modeIdx].name, cfg->seqCnt);
+
+    return SEQ_OK;
+}
+
+
+int seq_start(seqConfig_t *cfg)
+{
+    int i, rc;
+    cpu_set_t threadcpu;
+    pthread_attr_t attr;
+    struct sched_param param;
+    struct sigaction sa;
+    seqService_t *svc;
+
+    memset(&sa, 0, sizeof(sa));
+    sa.sa_handler=seq_throttle_handler;
+    sigemptyset(&sa.sa_mask);
+    sigaction(SIGXCPU, &sa, NULL);
+
+    if((cfg->policy == SEQ_POLICY_CYCLIC) && (cfg->numFrames == 0))
+    {
+        printf("No cyclic frame table, see seq_set_cyclic()\n");
+        return SEQ_ERROR;
+    }
+
+    cfg->abortTest=FALSE;
+    cfg->seqCnt=0;
+    cfg->currentMode=0;
+    cfg->requestedMode=0;
+    cfg->modeStartCnt=0;
+    cfg->hyperperiodTicks=seq_hyperperiod_ticks(cfg);
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        svc=&cfg->service[i];
+
+        svc->periodNsec=seq_period_nsec(cfg, svc);
+        // deadline services check their jobs against the runtime, which the kernel charges in CPU time
+        svc->threadCpuTime=cfg->threadCpuTime || (svc->trace != NULL) || (cfg->policy == SEQ_POLICY_DEADLINE);
+        svc->abort=FALSE;
+        svc->releaseLock=0;
+        svc->releaseSeq=0;
+        svc->handledSeq=0;
+        svc->rateDivider=1;
+
+        // the cyclic executive calls the work functions itself
+        if(cfg->policy == SEQ_POLICY_CYCLIC)
+            continue;
+
+        if(sem_init(&svc->sem, 0, 0))
+        {
+            printf("Failed to initialize %s semaphore\n", svc->name);
+            return SEQ_ERROR;
+        }
+
+        pthread_attr_init(&attr);
+
+        if(cfg->policy == SEQ_POLICY_FIFO)
+        {
+            pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+            pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+            param.sched_priority=svc->prio;
+            pthread_attr_setschedparam(&attr, &param);
+
+            if(svc->cpu >= 0)
+            {
+                CPU_ZERO(&threadcpu);
+                CPU_SET(svc->cpu, &threadcpu);
+                pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &threadcpu);
+            }
+
+            rc=pthread_create(&svc->thread, &attr, seq_fifo_service, (void *)svc);
+        }
+        else
+        {
+            // created as SCHED_OTHER, the thread switches itself to SCHED_DEADLINE
+            rc=pthread_create(&svc->thread, &attr, seq_deadline_service, (void *)svc);
+        }
+
+        pthread_attr_destroy(&attr);
+
+        if(rc != 0)
+        {
+            printf("pthread_create for %s failed: %s\n", svc->name, strerror(rc));
+            return SEQ_ERROR;
+        }
+        else
+            printf("pthread_create successful for %s\n", svc->name);
+    }
+
+    if(cfg->policy == SEQ_POLICY_DEADLINE)
+        return SEQ_OK;
+
+    // Sequencer = RT_MAX
+    pthread_attr_init(&attr);
+    pthread_attr_setinheritsched(&attr, PTHREAD_EXPLICIT_SCHED);
+    pthread_attr_setschedpolicy(&attr, SCHED_FIFO);
+    param.sched_priority=sched_get_priority_max(SCHED_FIFO);
+    pthread_attr_setschedparam(&attr, &param);
+
+    CPU_ZERO(&threadcpu);
+    CPU_SET(cfg->seqCpu, &threadcpu);
+    pthread_attr_setaffinity_np(&attr, sizeof(cpu_set_t), &threadcpu);
+
+    if(cfg->policy == SEQ_POLICY_CYCLIC)
+    {
+        cfg->frameCnt=0;
+        cfg->frameOverrunCnt=0;
+        rc=pthread_create(&cfg->seqThread, &attr, seq_cyclic_executive, (void *)cfg);
+    }
+    else
+        rc=pthread_create(&cfg->seqThread, &attr, seq_sequencer, (void *)cfg);
+
+    pthread_attr_destroy(&attr);
+
+    if(rc != 0)
+    {
+        printf("pthread_create for sequencer failed: %s\n", strerror(rc));
+        return SEQ_ERROR;
+    }
+
+    return SEQ_OK;
+}
+
+
+// Wait for the sequence to finish and shut down all services.  With SCHED_DEADLINE there is no
+// sequencer, so the calling thread just sleeps for the length of the sequence.
+void seq_join(seqConfig_t *cfg)
+{
+    int i;
+    unsigned long long durationNsec;
+    struct timespec duration;
+
+    if(cfg->policy == SEQ_POLICY_CYCLIC)
+    {
+        pthread_join(cfg->seqThread, NULL);
+        cfg->abortTest=TRUE;
+        seq_cyclic_free(cfg);
+        return;
+    }
+
+    if(cfg->policy == SEQ_POLICY_FIFO)
+    {
+        pthread_join(cfg->seqThread, NULL);
+    }
+    else
+    {
+        durationNsec=cfg->sequencePeriods * cfg->tickNsec;
+        duration.tv_sec=durationNsec / NANOSEC_PER_SEC;
+        duration.tv_nsec=durationNsec % NANOSEC_PER_SEC;
+        while(clock_nanosleep(CLOCK_MONOTONIC, 0, &duration, &duration) == EINTR);
+        cfg->seqCnt=cfg->sequencePeriods;
+    }
+
+    cfg->abortTest=TRUE;
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        cfg->service[i].abort=TRUE;
+        sem_post(&cfg->service[i].sem);
+    }
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        pthread_join(cfg->service[i].thread, NULL);
+        sem_destroy(&cfg->service[i].sem);
+    }
+}
+
+
+// Create the telemetry segment and bind each registered service to a slot.  Call after all
+// services are registered and before seq_start().  The mapping is populated up front so the
+// RT side never takes a page fault on it.
+int seq_telemetry_open(seqConfig_t *cfg)
+{
+    int fd, i;
+    seqTelem_t *telem;
+
+    if((fd=shm_open(SEQ_TELEM_SHM_NAME, O_CREAT | O_RDWR, 0644)) < 0)
+    {
+        perror("shm_open telemetry");
+        return SEQ_ERROR;
+    }
+
+    if(ftruncate(fd, sizeof(seqTelem_t)) < 0)
+    {
+        perror("ftruncate telemetry");
+        close(fd);
+        return SEQ_ERROR;
+    }
+
+    telem=mmap(NULL, sizeof(seqTelem_t), PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, 0);
+    close(fd);
+
+    if(telem == MAP_FAILED)
+    {
+        perror("mmap telemetry");
+        return SEQ_ERROR;
+    }
+
+    memset(telem, 0, sizeof(seqTelem_t));
+    telem->version=SEQ_TELEM_VERSION;
+    telem->pid=getpid();
+    telem->numServices=cfg->numServices;
+    telem->tickNsec=cfg->tickNsec;
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        strncpy(telem->service[i].name, cfg->service[i].name, SEQ_TELEM_NAME_LEN-1);
+        telem->service[i].periodNsec=seq_period_nsec(cfg, &cfg->service[i]);
+        cfg->service[i].telemSlot=&telem->service[i];
+    }
+
+    // readers check the magic last, once the header is complete
+    __atomic_store_n(&telem->magic, SEQ_TELEM_MAGIC, __ATOMIC_RELEASE);
+
+    cfg->telem=telem;
+    return SEQ_OK;
+}
+
+
+void seq_telemetry_close(seqConfig_t *cfg)
+{
+    int i;
+
+    if(cfg->telem == NULL) return;
+
+    for(i=0; i < cfg->numServices; i++)
+        cfg->service[i].telemSlot=NULL;
+
+    munmap(cfg->telem, sizeof(seqTelem_t));
+    shm_unlink(SEQ_TELEM_SHM_NAME);
+    cfg->telem=NULL;
+}
+
+
+// Allocate a trace buffer of maxJobs records for every registered service.  Call after all
+// services are registered and before seq_start().  The buffers are written once here so the
+// RT side never takes a page fault on them.
+int seq_trace_open(seqConfig_t *cfg, unsigned long long maxJobs)
+{
+    int i;
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        if((cfg->service[i].trace=malloc(maxJobs * sizeof(seqTraceJob_t))) == NULL)
+        {
+            perror("malloc trace");
+            return SEQ_ERROR;
+        }
+
+        memset(cfg->service[i].trace, 0, maxJobs * sizeof(seqTraceJob_t));
+        cfg->service[i].traceCnt=0;
+        cfg->service[i].traceMax=maxJobs;
+    }
+
+    return SEQ_OK;
+}
+
+
+// Save the traced jobs after seq_join() and free the buffers
+int seq_trace_write(seqConfig_t *cfg, const char *fileName)
+{
+    FILE *fp;
+    seqTraceHeader_t header;
+    seqTraceService_t desc;
+    seqService_t *svc;
+    int i, rc=SEQ_OK;
+
+    if((fp=fopen(fileName, "wb")) == NULL)
+    {
+        perror(fileName);
+        rc=SEQ_ERROR;
+    }
+
+    if(rc == SEQ_OK)
+    {
+        memset(&header, 0, sizeof(header));
+        header.magic=SEQ_TRACE_MAGIC;
+        header.version=SEQ_TRACE_VERSION;
+        header.numServices=cfg->numServices;
+        header.tickNsec=cfg->tickNsec;
+
+        if(fwrite(&header, sizeof(header), 1, fp) != 1)
+            rc=SEQ_ERROR;
+
+        for(i=0; (i < cfg->numServices) && (rc == SEQ_OK); i++)
+        {
+            svc=&cfg->service[i];
+
+            memset(&desc, 0, sizeof(desc));
+            strncpy(desc.name, svc->name, SEQ_TRACE_NAME_LEN-1);
+            desc.periodNsec=seq_period_nsec(cfg, svc);
+            desc.wcetNsec=svc->wcetNsec;
+            desc.numJobs=svc->traceCnt;
+
+            if(fwrite(&desc, sizeof(desc), 1, fp) != 1)
+                rc=SEQ_ERROR;
+        }
+
+        for(i=0; (i < cfg->numServices) && (rc == SEQ_OK); i++)
+        {
+            svc=&cfg->service[i];
+
+            if((svc->traceCnt > 0) && (fwrite(svc->trace, sizeof(seqTraceJob_t), svc->traceCnt, fp) != svc->traceCnt))
+                rc=SEQ_ERROR;
+        }
+
+        if(fclose(fp) != 0)
+            rc=SEQ_ERROR;
+
+        if(rc != SEQ_OK)
+            printf("Failed to write trace %s\n", fileName);
+    }
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        free(cfg->service[i].trace);
+        cfg->service[i].trace=NULL;
+        cfg->service[i].traceCnt=0;
+        cfg->service[i].traceMax=0;
+    }
+
+    return rc;
+}
+
+
+void seq_report(seqConfig_t *cfg)
+{
+    int i;
+    seqService_t *svc;
+
+    printf("\n%-12s %10s %10s %8s %8s %8s %12s %12s %10s\n", "service", "period_us", "releases", "misses",
+           "overruns", "skipped", "maxexec_us", "maxresp_us", "throttled");
+
+    for(i=0; i < cfg->numServices; i++)
+    {
+        svc=&cfg->service[i];
+
+        printf("%-12s %10llu %10llu %8llu %8llu %8llu %12llu %12llu %10llu\n",
+               svc->name, seq_period_nsec(cfg, svc)*svc->rateDivider/1000, svc->releaseCnt, svc->missCnt,
+               svc->overrunCnt, svc->skipCnt, svc->maxExecNsec/1000, svc->maxResponseNsec/1000, svc->throttleCnt);
+
+        syslog(LOG_CRIT, "%s releases=%llu misses=%llu overruns=%llu skipped=%llu maxexec=%llu nsec maxresp=%llu nsec throttled=%llu\n",
+               svc->name, svc->releaseCnt, svc->missCnt, svc->overrunCnt, svc->skipCnt, svc->maxExecNsec,
+               svc->maxResponseNsec, svc->throttleCnt);
+    }
+
+    if(cfg->policy == SEQ_POLICY_DEADLINE)
+        printf("SIGXCPU throttle signals: %llu\n", __atomic_load_n(&seqThrottleSignals, __ATOMIC_RELAXED));
+
+    if(cfg->numModes > 0)
+        printf("final mode: %s\n", cfg->mode[cfg->currentMode].name);
+
+    if(cfg->policy == SEQ_POLICY_CYCLIC)
+        printf("cyclic executive: %llu frames of %llu us, %llu overran\n", cfg->frameCnt, cfg->frameNsec/1000,
+               cfg->frameOverrunCnt);
+}
@@ -0,0 +1,223 @@
+#ifndef _SEQLIB_H
+#define _SEQLIB_H
+
+// Sequencer service framework
+//
+// Table driven version of the seqgen*.c examples.  Rather than hand coding a Service_N thread,
+// semaphore, abort flag and priority for every service, a program registers each service with
+// a name, a release period in sequencer ticks and a work function.  The framework creates the
+// threads, releases them at their sub-rate of the sequencer and shuts them down.
+//
+// Scheduling policies:
+//
+// 1) SEQ_POLICY_FIFO     - as in seqgen.c to seqgen3.c, a SCHED_FIFO sequencer at RT_MAX gives
+//                          a semaphore to each SCHED_FIFO service every N ticks.
+// 2) SEQ_POLICY_DEADLINE - each service is a SCHED_DEADLINE thread (EDF with a constant bandwidth
+//                          server) with runtime derived from its measured WCET and deadline equal
+//                          to its period.  The kernel releases the service each period, so no
+//                          sequencer thread is used.
+// 3) SEQ_POLICY_CYCLIC   - a cyclic executive, as in lab1.c and the VxWorks ex0.c and ex3.c but
+//                          from a precomputed frame table (see seqcyclic.h).  One SCHED_FIFO
+//                          thread at RT_MAX wakes every minor frame and calls the work functions
+//                          placed in that frame to completion, so there are no service threads,
+//                          semaphores or preemption among services.  The table comes from
+//                          Feasibility/feasibility_cyclic, compiled in with seq_set_cyclic() or
+//                          loaded with seq_load_cyclic().
+//
+// For SCHED_FIFO, seq_assign_rm_priorities() orders priorities by period and seq_partition_ffd()
+// places services on cores by first-fit decreasing utilization with a response time test per
+// core, replacing the hand assigned priorities and even/odd core split of seqgen3.c.  Or the
+// core assignment can be computed offline by Feasibility/feasibility_mp and loaded with
+// seq_load_affinity().
+//
+// Every release carries a sequence number so a SCHED_FIFO service can tell that it overran and
+// missed releases, and handle that by its seqOverrunPolicy_t rather than silently running
+// back-to-back.  Alternate rate tables can be registered as modes with seq_add_mode(), and a
+// mode change requested with seq_request_mode() takes effect at the next hyperperiod boundary
+// of the current mode, so no service is cut off part way through its hyperperiod.  A requested
+// mode is first given RM priorities for its periods and must pass seq_admission_test(), or it
+// is refused and the current mode kept.
+//
+// Release, completion and execution times in the RT path are taken with seq_time_read() from
+// seqtime.h, a direct counter read, rather than clock_gettime().  Execution time is then start
+// to completion, including any preemption.  Thread CPU time, which leaves preemption out but
+// costs two clock_gettime() system calls a job, is taken instead for traced services, for
+// SCHED_DEADLINE services to check against their runtime, and when threadCpuTime is set, e.g.
+// for seqtop to show it.
+//
+// seq_telemetry_open() makes each service publish its counters to shared memory after every
+// release for the seqtop monitor, instead of printf or syslog in the RT path (see seqtelem.h).
+// seq_trace_open() records the release, start and completion time of every job as well, for
+// Feasibility/feasibility_trace to analyze after the run (see seqtrace.h).
+//
+// See deadline/deadline.c for the minimal SCHED_DEADLINE example this is based upon.
+
+#include <pthread.h>
+#include <semaphore.h>
+
+#define SEQ_MAX_SERVICES (16)
+#define SEQ_MAX_MODES (4)
+
+// SEQ_OVERRUN_DEGRADE halves a service rate after this many overrunning releases in a row, up to
+// SEQ_MAX_RATE_DIVIDER, and doubles it back after SEQ_DEGRADE_RECOVER_RELEASES on-time releases
+#define SEQ_DEGRADE_OVERRUN_RELEASES (3)
+#define SEQ_DEGRADE_RECOVER_RELEASES (10)
+#define SEQ_MAX_RATE_DIVIDER (8)
+
+#define SEQ_OK (0)
+#define SEQ_ERROR (-1)
+
+#ifndef TRUE
+#define TRUE (1)
+#define FALSE (0)
+#endif
+
+// default runtime margin over measured WCET for SCHED_DEADLINE, in percent
+#define SEQ_DL_RUNTIME_MARGIN_PCT (20)
+
+// sequencer execution time per tick assumed by the response time test
+#define SEQ_SEQUENCER_WCET_NSEC (50000ULL)
+
+// service not yet placed on a core by seq_partition_ffd
+#define SEQ_CPU_UNASSIGNED (-2)
+
+// smallest runtime the kernel will accept for SCHED_DEADLINE (1 << DL_SCALE)
+#define SEQ_DL_MIN_RUNTIME_NSEC (1024ULL)
+
+typedef enum
+{
+    SEQ_POLICY_FIFO=0,
+    SEQ_POLICY_DEADLINE=1,
+    SEQ_POLICY_CYCLIC=2
+} seqPolicy_t;
+
+// What a SCHED_FIFO service does when it finds more than one release pending, meaning that it
+// overran and missed at least one release:
+//
+// SEQ_OVERRUN_SKIP    - drop the missed releases and run once for the latest one
+// SEQ_OVERRUN_CATCHUP - run once for every release, back-to-back, as a plain semaphore does
+// SEQ_OVERRUN_DEGRADE - skip, and if the overruns persist, run the service at a lower rate
+//
+// With SCHED_DEADLINE overruns are contained by the kernel throttling the service instead.
+typedef enum
+{
+    SEQ_OVERRUN_SKIP=0,
+    SEQ_OVERRUN_CATCHUP=1,
+    SEQ_OVERRUN_DEGRADE=2
+} seqOverrunPolicy_t;
+
+// A rate table giving the release period in ticks of every service, 0 to disable a service,
+// for one operating mode, and the RM priorities seq_request_mode() admitted it with
+typedef struct
+{
+    const char *name;
+    unsigned int periodTicks[SEQ_MAX_SERVICES];
+    int prio[SEQ_MAX_SERVICES];
+} seqMode_t;
+
+typedef void (*seqServiceFn_t)(void *serviceArg);
+
+typedef struct
+{
+    // configuration
+    const char *name;
+    seqServiceFn_t serviceFn;
+    void *serviceArg;
+    unsigned int periodTicks;           // release every periodTicks sequencer ticks
+    unsigned long long wcetNsec;        // declared or measured WCET
+    unsigned long long runtimeNsec;     // SCHED_DEADLINE budget derived from wcetNsec
+    int cpu;                            // SCHED_FIFO core affinity, -1 for any
+    int prio;                           // SCHED_FIFO priority
+    seqOverrunPolicy_t overrunPolicy;
+
+    // runtime state
+    unsigned long long periodNsec;
+    pthread_t thread;
+    sem_t sem;
+    volatile int abort;
+    volatile unsigned int releaseLock;          // seqlock over the two release fields, odd while written
+    volatile unsigned long long releaseSeq;     // sequence number of the latest release
+    volatile unsigned long long lastReleaseTicks;   // seqtime.h counter at the latest release
+    volatile unsigned int rateDivider;          // > 1 while degraded
+    unsigned long long handledSeq;              // sequence number of the latest release handled
+    unsigned int overrunRun, onTimeRun;
+    unsigned long long releaseCnt;
+    unsigned long long missCnt;
+    unsigned long long overrunCnt;
+    unsigned long long skipCnt;
+    unsigned long long maxExecNsec;
+    unsigned long long maxResponseNsec;
+    volatile unsigned long long throttleCnt;    // SCHED_DEADLINE jobs that ran past their runtime
+    int threadCpuTime;                  // job execution in thread CPU time, set by seq_start()
+    struct seqTelemService *telemSlot;  // shared memory telemetry, NULL if not enabled
+    struct seqTraceJob *trace;          // job trace buffer, NULL if not enabled
+    unsigned long long traceCnt, traceMax;
+} seqService_t;
+
+typedef struct
+{
+    seqPolicy_t policy;
+    unsigned long long tickNsec;        // sequencer period, e.g. 10 msec for 100 Hz
+    unsigned long long sequencePeriods; // number of ticks to run before shutdown
+    int seqCpu;                         // sequencer core for SCHED_FIFO
+    unsigned long long seqWcetNsec;     // sequencer WCET per tick for response time tests
+    int runtimeMarginPct;               // SCHED_DEADLINE runtime margin over WCET
+    int threadCpuTime;                  // TRUE to time every job in thread CPU time
+    int numServices;
+    seqService_t service[SEQ_MAX_SERVICES];
+
+    int numModes;
+    seqMode_t mode[SEQ_MAX_MODES];
+    volatile int currentMode, requestedMode;
+    unsigned long long modeStartCnt;    // tick the current mode started on
+    unsigned long long hyperperiodTicks;
+
+    struct seqTelem *telem;             // shared memory telemetry, NULL if not enabled
+
+    // SEQ_POLICY_CYCLIC frame table, copied by seq_set_cyclic() and freed by seq_join()
+    unsigned long long frameNsec;
+    unsigned int numFrames, numEntries;
+    struct seqCyclicFrame *frame;
+    unsigned int *entry;
+    unsigned long long frameCnt;
+    unsigned long long frameOverrunCnt;
+
+    pthread_t seqThread;
+    volatile int abortTest;
+    unsigned long long seqCnt;
+} seqConfig_t;
+
+
+void seq_init(seqConfig_t *cfg, seqPolicy_t policy, unsigned long long tickNsec, unsigned long long sequencePeriods);
+
+int seq_add_service(seqConfig_t *cfg, const char *name, seqServiceFn_t serviceFn, void *serviceArg,
+                    unsigned int periodTicks, unsigned long long wcetNsec);
+
+int seq_measure_wcet(seqConfig_t *cfg, int samples);
+int seq_admission_test(seqConfig_t *cfg);
+int seq_assign_rm_priorities(seqConfig_t *cfg);
+int seq_partition_ffd(seqConfig_t *cfg, int firstCpu, int numCpus);
+int seq_load_affinity(seqConfig_t *cfg, const char *fileName, int firstCpu);
+
+int seq_set_overrun_policy(seqConfig_t *cfg, int serviceIdx, seqOverrunPolicy_t policy);
+int seq_add_mode(seqConfig_t *cfg, const char *name, const unsigned int periodTicks[]);
+int seq_request_mode(seqConfig_t *cfg, int modeIdx);
+
+int seq_telemetry_open(seqConfig_t *cfg);
+void seq_telemetry_close(seqConfig_t *cfg);
+
+int seq_trace_open(seqConfig_t *cfg, unsigned long long maxJobs);
+int seq_trace_write(seqConfig_t *cfg, const char *fileName);
+
+int seq_set_cyclic(seqConfig_t *cfg, unsigned long long frameNsec, const unsigned long long periodNsec[],
+                   int numServices, const struct seqCyclicFrame *frame, unsigned int numFrames,
+                   const unsigned int entry[], unsigned int numEntries);
+int seq_load_cyclic(seqConfig_t *cfg, const char *fileName);
+
+int seq_start(seqConfig_t *cfg);
+void seq_join(seqConfig_t *cfg);
+void seq_report(seqConfig_t *cfg);
+
+unsigned long long seq_period_nsec(seqConfig_t *cfg, seqService_t *svc);
+
+#endif
@@ -0,0 +1,81 @@
+#ifndef _SEQTELEM_H
+#define _SEQTELEM_H
+
+// Shared memory live telemetry for the sequencer framework
+//
+// Each service publishes its counters into its own slot of a POSIX shared memory segment after
+// every release, and the sequencer publishes its cycle count.  Writes are plain stores bracketed
+// by a per-slot sequence lock, so the RT side makes no system calls and takes no locks.  Each
+// slot has a single writer, the service thread, so the writer side needs no atomic read-modify-
+// write either.
+//
+// A reader (see seqtop.c) copies a slot and retries if the sequence number was odd (write in
+// progress) or changed during the copy.
+
+#include <stdint.h>
+
+#include "seqlib.h"
+
+#define SEQ_TELEM_SHM_NAME "/seqtelemetry"
+#define SEQ_TELEM_MAGIC (0x53455154)    // "SEQT"
+#define SEQ_TELEM_VERSION (1)
+#define SEQ_TELEM_NAME_LEN (32)
+
+typedef struct seqTelemService
+{
+    volatile uint32_t lock;             // sequence lock, odd while an update is in progress
+    char name[SEQ_TELEM_NAME_LEN];
+    uint64_t periodNsec;
+    uint64_t releases;
+    uint64_t misses;
+    uint64_t overruns;
+    uint64_t skipped;
+    uint64_t throttled;
+    uint64_t lastExecNsec;
+    uint64_t maxExecNsec;
+    uint64_t lastResponseNsec;
+    uint64_t maxResponseNsec;
+} __attribute__((aligned(64))) seqTelemService_t;
+
+typedef struct seqTelem
+{
+    uint32_t magic;
+    uint32_t version;
+    int32_t pid;
+    uint32_t numServices;
+    uint64_t tickNsec;
+    volatile uint64_t seqCnt;
+    volatile int32_t currentMode;
+    seqTelemService_t service[SEQ_MAX_SERVICES];
+} seqTelem_t;
+
+
+static inline void seq_telem_write_begin(seqTelemService_t *slot)
+{
+    slot->lock++;
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+}
+
+
+static inline void seq_telem_write_end(seqTelemService_t *slot)
+{
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    slot->lock++;
+}
+
+
+// Copy a consistent snapshot of one slot, retrying while a writer is active
+static inline void seq_telem_read(const seqTelemService_t *slot, seqTelemService_t *copy)
+{
+    uint32_t before, after;
+
+    do
+    {
+        before=__atomic_load_n(&slot->lock, __ATOMIC_ACQUIRE);
+        *copy=*(const seqTelemService_t *)slot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        after=__atomic_load_n(&slot->lock, __ATOMIC_RELAXED);
+    } while((before & 1) || (before != after));
+}
+
+#endif
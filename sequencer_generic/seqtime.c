@@ -0,0 +1,144 @@
+// Counter calibration for seqtime.h
+//
+// For background on high resolution time-stamps and clocks see the notes in seqgen3.c, and:
+//
+// 1) https://www.kernel.org/doc/html/latest/core-api/timekeeping.html
+// 2) https://blog.trailofbits.com/2019/10/03/tsc-frequency-for-all-better-profiling-and-benchmarking/
+// 3) https://developer.arm.com/documentation/102379/latest/ - ARM generic timer
+
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "seqtime.h"
+
+#define NANOSEC_PER_SEC (1000000000ULL)
+
+// time to measure the counter against CLOCK_MONOTONIC_RAW, 50 msec gives better than 1 ppm
+// with a clock resolution of 1 nsec and about 20 nsec of read jitter
+#define SEQTIME_CALIBRATION_NSEC (50000000ULL)
+
+#define SEQTIME_READ_COST_SAMPLES (1000)
+
+seqTimeCal_t seqTimeCal={"clock_gettime", NANOSEC_PER_SEC, 1, 0, 0, 1};
+
+
+static uint64_t seq_time_mono_nsec(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((uint64_t)ts.tv_sec * NANOSEC_PER_SEC) + (uint64_t)ts.tv_nsec;
+}
+
+
+#if defined(__x86_64__) || defined(__i386__)
+// CPUID.80000007H:EDX[8] reports an invariant TSC
+static int seq_time_tsc_invariant(void)
+{
+    uint32_t eax, ebx, ecx, edx;
+
+    asm volatile("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (0x80000000));
+    if(eax < 0x80000007)
+        return 0;
+
+    asm volatile("cpuid" : "=a" (eax), "=b" (ebx), "=c" (ecx), "=d" (edx) : "a" (0x80000007));
+    return (edx >> 8) & 1;
+}
+#endif
+
+
+// Largest shift, at most 32, for which mult = (10^9 << shift) / freq still fits in 32 bits, so the
+// conversion keeps as many fractional bits of nanoseconds per tick as possible.
+static void seq_time_set_mult_shift(uint64_t freqHz)
+{
+    uint32_t shift;
+    uint64_t mult;
+
+    for(shift=32; shift > 0; shift--)
+    {
+        mult=((NANOSEC_PER_SEC << shift) + (freqHz / 2)) / freqHz;
+        if(mult <= 0xffffffffULL)
+            break;
+    }
+
+    seqTimeCal.freqHz=freqHz;
+    seqTimeCal.mult=(uint32_t)mult;
+    seqTimeCal.shift=shift;
+}
+
+
+int seq_time_calibrate(void)
+{
+    uint64_t c0, c1, t0, t1, freqHz;
+    struct timespec delay={0, SEQTIME_CALIBRATION_NSEC};
+    int i;
+
+    seqTimeCal.fallback=0;
+
+#if defined(__x86_64__) || defined(__i386__)
+    seqTimeCal.source="rdtsc";
+    if(!seq_time_tsc_invariant())
+    {
+        printf("TSC is not invariant, using clock_gettime for timestamps\n");
+        seqTimeCal.fallback=1;
+    }
+#elif defined(__aarch64__) || (defined(__arm__) && defined(SEQTIME_ARMV7_CNTVCT))
+    seqTimeCal.source="cntvct";
+#elif defined(__arm__) && defined(SEQTIME_ARM11_CCNT)
+    seqTimeCal.source="ccnt";
+#else
+    seqTimeCal.fallback=1;
+#endif
+
+    if(seqTimeCal.fallback)
+    {
+        seqTimeCal.source="clock_gettime";
+        seqTimeCal.freqHz=NANOSEC_PER_SEC;
+        seqTimeCal.mult=1;
+        seqTimeCal.shift=0;
+    }
+    else
+    {
+        // bracket each counter read with clock reads so the pairing error is one clock read
+        t0=seq_time_mono_nsec(); c0=seq_time_read();
+        nanosleep(&delay, NULL);
+        t1=seq_time_mono_nsec(); c1=seq_time_read();
+
+#if defined(__arm__) && defined(SEQTIME_ARM11_CCNT)
+        // 32-bit counter, which cannot wrap more than once during calibration
+        c1=c0 + ((c1 - c0) & 0xffffffffULL);
+#endif
+        freqHz=((c1 - c0) * NANOSEC_PER_SEC) / (t1 - t0);
+
+#if defined(__aarch64__) || (defined(__arm__) && defined(SEQTIME_ARMV7_CNTVCT))
+        // the generic timer reports its own frequency, prefer it when it agrees with the measurement
+        {
+            uint64_t cntfrq;
+#if defined(__aarch64__)
+            asm volatile("mrs %0, cntfrq_el0" : "=r" (cntfrq));
+#else
+            uint32_t frq;
+            asm volatile("mrc p15, 0, %0, c14, c0, 0" : "=r" (frq));
+            cntfrq=frq;
+#endif
+            if((cntfrq > 0) && (((freqHz > cntfrq) ? (freqHz - cntfrq) : (cntfrq - freqHz)) < (cntfrq / 1000)))
+                freqHz=cntfrq;
+        }
+#endif
+
+        seq_time_set_mult_shift(freqHz);
+    }
+
+    // cost of back-to-back reads, which is the overhead of one probe
+    c0=seq_time_read();
+    for(i=0; i < SEQTIME_READ_COST_SAMPLES; i++)
+        c1=seq_time_read();
+    seqTimeCal.readCostTicks=(c1 - c0) / SEQTIME_READ_COST_SAMPLES;
+
+    printf("seqtime: source=%s freq=%llu Hz mult=%u shift=%u read cost=%llu nsec\n",
+           seqTimeCal.source, (unsigned long long)seqTimeCal.freqHz, seqTimeCal.mult, seqTimeCal.shift,
+           (unsigned long long)seq_time_to_nsec(seqTimeCal.readCostTicks));
+
+    return 0;
+}
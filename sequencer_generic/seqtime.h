@@ -0,0 +1,104 @@
+#ifndef _SEQTIME_H
+#define _SEQTIME_H
+
+// Low overhead timestamps for instrumenting sequencer services
+//
+// clock_gettime() through the vDSO plus the double math of realtime() in seqgen*.c costs tens to
+// hundreds of nanoseconds per probe, and much more when the clocksource is not vDSO capable.
+// seq_time_read() reads the free running counter directly instead:
+//
+// 1) x86 and x64 - RDTSC, used only if the TSC is invariant (constant rate in all P/C states),
+//                  otherwise calibration selects the clock_gettime() fallback at run time
+// 2) AArch64     - CNTVCT_EL0, the ARM generic timer virtual count, which Linux lets user space read
+// 3) ARMv7-A     - CNTVCT with -DSEQTIME_ARMV7_CNTVCT on cores that have the generic timer
+//                  (Cortex-A7/A53/A72, i.e. Raspberry Pi 2 and later running 32-bit Raspbian)
+// 4) ARM1176     - the 32-bit CCNT cycle counter with -DSEQTIME_ARM11_CCNT, which needs the
+//                  raspbian-ccr/enable-ccr.ko module loaded first.  It wraps in a few seconds
+//                  at 700 MHz, so only deltas shorter than that are meaningful.
+// 5) otherwise   - clock_gettime(CLOCK_MONOTONIC_RAW), with a 1 GHz "counter" so that the same
+//                  integer conversion applies
+//
+// seq_time_calibrate() must be called once at startup, before any RT service runs.  It measures
+// the counter against CLOCK_MONOTONIC_RAW and computes a mult/shift pair so that counter ticks
+// convert to nanoseconds with one multiply and one shift, the same approach the kernel uses for
+// its clocksources.  No floating point is used on the read or conversion path.
+
+#include <stdint.h>
+#include <time.h>
+
+typedef struct
+{
+    const char *source;     // name of the counter in use
+    uint64_t freqHz;        // calibrated counter frequency
+    uint32_t mult;          // nsec = (ticks * mult) >> shift
+    uint32_t shift;
+    uint64_t readCostTicks; // measured cost of one seq_time_read()
+    int fallback;           // hardware counter unusable, read the clock instead
+} seqTimeCal_t;
+
+extern seqTimeCal_t seqTimeCal;
+
+int seq_time_calibrate(void);
+
+
+static inline uint64_t seq_time_clock_read(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return ((uint64_t)ts.tv_sec * 1000000000ULL) + (uint64_t)ts.tv_nsec;
+}
+
+
+static inline uint64_t seq_time_read(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+    uint32_t lo, hi;
+
+    if(__builtin_expect(seqTimeCal.fallback, 0))
+        return seq_time_clock_read();
+
+    // RDTSC copies contents of 64-bit TSC into EDX:EAX
+    asm volatile("rdtsc" : "=a" (lo), "=d" (hi));
+    return ((uint64_t)hi << 32) | lo;
+
+#elif defined(__aarch64__)
+    uint64_t cnt;
+
+    asm volatile("isb; mrs %0, cntvct_el0" : "=r" (cnt) :: "memory");
+    return cnt;
+
+#elif defined(__arm__) && defined(SEQTIME_ARMV7_CNTVCT)
+    uint64_t cnt;
+
+    asm volatile("isb; mrrc p15, 1, %Q0, %R0, c14" : "=r" (cnt) :: "memory");
+    return cnt;
+
+#elif defined(__arm__) && defined(SEQTIME_ARM11_CCNT)
+    uint32_t cc;
+
+    // not able to read unless enabled by kernel module
+    asm volatile("mrc p15, 0, %0, c15, c12, 1" : "=r" (cc));
+    return cc;
+
+#else
+    return seq_time_clock_read();
+#endif
+}
+
+
+// Convert a counter delta to nanoseconds.  The delta is split at 32 bits so that neither
+// product can overflow 64 bits, which keeps this valid for deltas of many years.
+static inline uint64_t seq_time_to_nsec(uint64_t ticks)
+{
+    return ((((ticks >> 32) * seqTimeCal.mult)) << (32 - seqTimeCal.shift)) +
+           (((ticks & 0xffffffffULL) * seqTimeCal.mult) >> seqTimeCal.shift);
+}
+
+
+static inline uint64_t seq_time_now_nsec(void)
+{
+    return seq_time_to_nsec(seq_time_read());
+}
+
+#endif
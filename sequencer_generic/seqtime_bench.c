@@ -0,0 +1,80 @@
+// Timestamp probe overhead comparison
+//
+// Compares the cost of one instrumentation probe as done in seqgen*.c, clock_gettime() followed
+// by the double math of realtime(), with a direct counter read through seqtime.h and with a
+// counter read plus integer conversion to nanoseconds.
+//
+// Usage: seqtime_bench [probes]
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <time.h>
+
+#include "seqtime.h"
+
+#define DEFAULT_PROBES (1000000)
+
+#define MY_CLOCK_TYPE CLOCK_MONOTONIC_RAW
+
+
+double realtime(struct timespec *tsptr)
+{
+    return ((double)(tsptr->tv_sec) + (((double)tsptr->tv_nsec)/1000000000.0));
+}
+
+
+static uint64_t elapsed_nsec(struct timespec *start, struct timespec *stop)
+{
+    return ((uint64_t)(stop->tv_sec - start->tv_sec) * 1000000000ULL) + stop->tv_nsec - start->tv_nsec;
+}
+
+
+int main(int argc, char *argv[])
+{
+    struct timespec start, stop, probe;
+    volatile double sinkDouble=0.0;
+    volatile uint64_t sink=0;
+    uint64_t t0, t1, delta;
+    int i, probes=DEFAULT_PROBES;
+
+    if(argc > 1)
+        sscanf(argv[1], "%d", &probes);
+
+    seq_time_calibrate();
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i < probes; i++)
+    {
+        clock_gettime(MY_CLOCK_TYPE, &probe);
+        sinkDouble=realtime(&probe);
+    }
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    printf("clock_gettime + realtime(): %6.2lf nsec per probe\n", (double)elapsed_nsec(&start, &stop) / probes);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i < probes; i++)
+        sink=seq_time_read();
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    printf("seq_time_read():            %6.2lf nsec per probe\n", (double)elapsed_nsec(&start, &stop) / probes);
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for(i=0; i < probes; i++)
+        sink=seq_time_now_nsec();
+    clock_gettime(CLOCK_MONOTONIC, &stop);
+    printf("seq_time_now_nsec():        %6.2lf nsec per probe\n", (double)elapsed_nsec(&start, &stop) / probes);
+
+    // the last value of each probe loop, so the loops are not optimized away
+    printf("last probes: realtime()=%.6lf sec, seq_time_now_nsec()=%llu nsec\n", sinkDouble, (unsigned long long)sink);
+
+    // check the conversion against the clock over a 100 msec interval
+    probe.tv_sec=0; probe.tv_nsec=100000000;
+    clock_gettime(MY_CLOCK_TYPE, &start); t0=seq_time_read();
+    nanosleep(&probe, NULL);
+    clock_gettime(MY_CLOCK_TYPE, &stop); t1=seq_time_read();
+    delta=seq_time_to_nsec(t1 - t0);
+    printf("100 msec interval: clock=%llu nsec, counter=%llu nsec\n",
+           (unsigned long long)elapsed_nsec(&start, &stop), (unsigned long long)delta);
+
+    return 0;
+}
@@ -0,0 +1,119 @@
+// seqtop - live display of sequencer service telemetry
+//
+// Maps the shared memory segment published by a sequencer using seqlib.c (seq_telemetry_open)
+// read-only and displays each service's counters once per second.  All reads go through the
+// per-service sequence lock in seqtelem.h, so the monitor never blocks or perturbs the RT side.
+//
+// Usage: seqtop [iterations]
+//
+// With no argument seqtop runs until the sequencer exits or it is interrupted.
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <time.h>
+#include <errno.h>
+
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+
+#include "seqtelem.h"
+
+#define REFRESH_SEC (1)
+
+
+int main(int argc, char *argv[])
+{
+    int fd, iter, iterations=-1;
+    unsigned int i;
+    seqTelem_t *telem;
+    seqTelemService_t snap;
+    uint64_t lastReleases[SEQ_MAX_SERVICES];
+    uint64_t lastSeqCnt=0;
+    char rate[24];
+    struct timespec delay={REFRESH_SEC, 0};
+
+    if(argc > 1)
+        sscanf(argv[1], "%d", &iterations);
+
+    if((fd=shm_open(SEQ_TELEM_SHM_NAME, O_RDONLY, 0)) < 0)
+    {
+        perror("shm_open " SEQ_TELEM_SHM_NAME " (is a sequencer running?)");
+        exit(-1);
+    }
+
+    telem=mmap(NULL, sizeof(seqTelem_t), PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if(telem == MAP_FAILED)
+    {
+        perror("mmap telemetry");
+        exit(-1);
+    }
+
+    if((__atomic_load_n(&telem->magic, __ATOMIC_ACQUIRE) != SEQ_TELEM_MAGIC) || (telem->version != SEQ_TELEM_VERSION))
+    {
+        printf("telemetry segment not initialized or wrong version\n");
+        exit(-1);
+    }
+
+    memset(lastReleases, 0, sizeof(lastReleases));
+
+    for(iter=0; (iterations < 0) || (iter < iterations); iter++)
+    {
+        // the sequencer process is gone
+        if((kill(telem->pid, 0) < 0) && (errno == ESRCH))
+        {
+            printf("sequencer pid %d exited\n", telem->pid);
+            break;
+        }
+
+        // clear screen and home the cursor when writing to a terminal
+        if(isatty(STDOUT_FILENO))
+            printf("\033[2J\033[H");
+
+        // rates are over the last refresh, so there are none on the first pass
+        if(iter == 0)
+            strcpy(rate, "-");
+        else
+            snprintf(rate, sizeof(rate), "%llu", (unsigned long long)(telem->seqCnt - lastSeqCnt) / REFRESH_SEC);
+
+        printf("seqtop: pid %d, tick %llu nsec, cycle %llu (%s/s), mode %d\n\n",
+               telem->pid, (unsigned long long)telem->tickNsec, (unsigned long long)telem->seqCnt,
+               rate, telem->currentMode);
+        lastSeqCnt=telem->seqCnt;
+
+        printf("%-12s %10s %9s %6s %7s %8s %7s %7s %11s %11s %11s %11s\n",
+               "service", "period_us", "releases", "rel/s", "misses", "overruns", "skipped", "throttl",
+               "exec_us", "maxexec_us", "resp_us", "maxresp_us");
+
+        for(i=0; (i < telem->numServices) && (i < SEQ_MAX_SERVICES); i++)
+        {
+            seq_telem_read(&telem->service[i], &snap);
+
+            if(iter == 0)
+                strcpy(rate, "-");
+            else
+                snprintf(rate, sizeof(rate), "%llu", (unsigned long long)(snap.releases - lastReleases[i]) / REFRESH_SEC);
+
+            printf("%-12s %10llu %9llu %6s %7llu %8llu %7llu %7llu %11llu %11llu %11llu %11llu\n",
+                   snap.name, (unsigned long long)snap.periodNsec/1000, (unsigned long long)snap.releases, rate,
+                   (unsigned long long)snap.misses, (unsigned long long)snap.overruns,
+                   (unsigned long long)snap.skipped, (unsigned long long)snap.throttled,
+                   (unsigned long long)snap.lastExecNsec/1000, (unsigned long long)snap.maxExecNsec/1000,
+                   (unsigned long long)snap.lastResponseNsec/1000, (unsigned long long)snap.maxResponseNsec/1000);
+
+            lastReleases[i]=snap.releases;
+        }
+
+        fflush(stdout);
+        nanosleep(&delay, NULL);
+    }
+
+    munmap(telem, sizeof(seqTelem_t));
+    return 0;
+}
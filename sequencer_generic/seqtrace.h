@@ -0,0 +1,51 @@
+#ifndef _SEQTRACE_H
+#define _SEQTRACE_H
+
+// Binary job trace for offline analysis
+//
+// seq_trace_open() gives every service a buffer of job records, allocated and touched up front,
+// which the service fills with plain stores after each release, and seq_trace_write() saves them
+// once the services have stopped.  It must be called before seq_start(), which then times the
+// traced jobs in thread CPU time.  Feasibility/feasibility_trace reads the file and estimates the
+// period, WCET and jitter of each service to run the feasibility tests on measured numbers.
+//
+// File layout, all little endian as written by the host:
+//
+//   seqTraceHeader_t
+//   seqTraceService_t        numServices of these, in registration order
+//   seqTraceJob_t            numJobs of these for the first service, then the second, ...
+//
+// This header only uses stdint.h so that tools outside sequencer_generic can include it.
+
+#include <stdint.h>
+
+#define SEQ_TRACE_MAGIC (0x52514553)    // "SEQR"
+#define SEQ_TRACE_VERSION (2)         // 1 had no execNsec in the job records
+#define SEQ_TRACE_NAME_LEN (32)
+
+typedef struct seqTraceHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t numServices;
+    uint32_t reserved;
+    uint64_t tickNsec;
+} seqTraceHeader_t;
+
+typedef struct seqTraceService
+{
+    char name[SEQ_TRACE_NAME_LEN];
+    uint64_t periodNsec;
+    uint64_t wcetNsec;              // declared or measured WCET the service was admitted with
+    uint64_t numJobs;
+} seqTraceService_t;
+
+typedef struct seqTraceJob
+{
+    uint64_t releaseNsec;           // release by the sequencer, or the SCHED_DEADLINE period start
+    uint64_t startNsec;
+    uint64_t endNsec;
+    uint64_t execNsec;              // CPU time of the job on its own thread, without preemption
+} seqTraceJob_t;
+
+#endif